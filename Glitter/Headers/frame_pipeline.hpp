@@ -0,0 +1,120 @@
+#ifndef GLITTER_FRAME_PIPELINE_HPP
+#define GLITTER_FRAME_PIPELINE_HPP
+
+#include "job_system.hpp"
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Frame loop that overlaps the CPU work of later frames with submitting
+// the current one.
+//
+// A frame goes through five stages. Sample runs on the calling thread and
+// reads input and the clock; Update advances the simulation and Record
+// writes the frame's data into its slot, both as jobs on the JobSystem;
+// Submit issues the frame's GL commands and Present swaps buffers, back on
+// the calling thread. Step() submits one frame, and before it does, starts
+// frames up to framesInFlight - 1 ahead of it, so their updates and records
+// run on the workers while this one is submitted. Updates run in frame
+// order, each after the previous one; records of different frames may run
+// at once.
+//
+// Each frame in flight owns a slot of one buffer object, persistently
+// mapped when the driver allows and shadowed on the CPU otherwise. Submit
+// fences the slot, and a slot is only handed to a new frame once its fence
+// signals, so framesInFlight bounds how many frames lie between sampling
+// input and the GPU finishing with them. One frame is the old serial loop;
+// every further frame buys throughput with one frame of input latency.
+// History() reports both per frame.
+class FramePipeline {
+public:
+    struct Frame {
+        std::uint64_t index;
+        unsigned int slot;
+        double time;          // Set by Sample; Update and Record should read this rather than the clock
+        unsigned char * data; // The slot; mapped memory if Persistent()
+        GLintptr offset;      // Of the slot within Buffer()
+        std::size_t size;     // Of the slot
+        std::size_t used;     // Set by Record; only this much is uploaded when not persistent
+    };
+
+    typedef std::function<void(Frame & frame)> Stage;
+
+    struct Stages {
+        Stage sample;                  // Calling thread
+        Stage update;                  // Worker, after the previous frame's update
+        Stage record;                  // Worker, after this frame's update
+        Stage submit;                  // Calling thread, once record is done
+        std::function<void()> present; // Calling thread, after the fence
+    };
+
+    // Milliseconds per frame; stages run on the workers are timed where they run
+    struct Timings {
+        std::uint64_t index = 0;
+        double sample = 0.0;
+        double update = 0.0;
+        double record = 0.0;
+        double submit = 0.0;
+        double present = 0.0;
+        double recordWait = 0.0; // Calling thread blocked on Update and Record
+        double fenceWait = 0.0;  // Calling thread blocked on the GPU to free the slot
+        double frame = 0.0;      // Since the previous frame was presented
+        double latency = 0.0;    // Input sampled to presented
+        double completed = 0.0;  // Input sampled to the fence found signaled; zero until then
+    };
+
+    // slotBytes may be zero for frames that stream nothing
+    FramePipeline(JobSystem & jobs, Stages stages, std::size_t slotBytes, unsigned int framesInFlight = 2);
+    ~FramePipeline(); // Finishes the frames already started; needs the context current
+
+    void Step();
+    // Submits every started frame and waits for the GPU, so all of History() is complete
+    void Drain();
+    void Reset();
+
+    unsigned int FramesInFlight() const { return static_cast<unsigned int>(slots.size()); }
+    GLuint Buffer() const { return buffer; }
+    bool Persistent() const { return persistent; }
+    const std::vector<Timings> & History() const { return history; }
+
+private:
+    FramePipeline(const FramePipeline &) = delete;
+    FramePipeline & operator=(const FramePipeline &) = delete;
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct Slot {
+        Frame frame;
+        Timings timings;
+        Clock::time_point sampled; // After Sample
+        std::size_t entry;         // Into history once presented
+        GLsync fence;
+        JobSystem::Counter updated;
+        JobSystem::Counter recorded;
+    };
+
+    void Begin();
+    void Submit();
+    double Retire(Slot & slot, bool wait); // Milliseconds waited
+
+    JobSystem & jobs;
+    Stages stages;
+    std::vector<std::unique_ptr<Slot>> slots;
+    std::vector<unsigned char> shadow;
+    std::vector<Timings> history;
+    std::uint64_t started;   // Frames sampled
+    std::uint64_t submitted; // Frames presented
+    Clock::time_point presented;
+    std::size_t slotBytes;
+    GLuint buffer;
+    unsigned char * mapped;
+    bool persistent;
+};
+
+#endif //GLITTER_FRAME_PIPELINE_HPP
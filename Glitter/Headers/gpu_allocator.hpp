@@ -0,0 +1,138 @@
+#ifndef GLITTER_GPU_ALLOCATOR_HPP
+#define GLITTER_GPU_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Offset bookkeeping for sub-allocating large GPU buffers.
+//
+// Nothing in this header touches OpenGL. The allocators hand out byte
+// offsets into a range of fixed capacity, and gpu_buffer.hpp pairs them with
+// real buffer objects, so they can be exercised without a context (see
+// test_gpu_allocator). When out of space they return InvalidOffset instead
+// of throwing. Alignments must be powers of two.
+const std::size_t InvalidOffset = ~std::size_t(0);
+
+struct AllocatorStats {
+    std::size_t capacity = 0;
+    std::size_t used = 0;          // Bytes handed out, including alignment padding
+    std::size_t peak = 0;
+    std::size_t live = 0;          // Outstanding allocations
+    std::size_t freeBlocks = 0;
+    std::size_t largestFree = 0;
+    std::uint64_t allocations = 0; // Since construction
+    std::uint64_t failures = 0;
+};
+
+// Bump allocator; everything is released at once with Reset().
+class LinearAllocator {
+public:
+    explicit LinearAllocator(std::size_t capacity);
+
+    std::size_t Allocate(std::size_t size, std::size_t alignment = 16);
+    void Reset();
+    AllocatorStats Stats() const;
+
+private:
+    std::size_t head;
+    AllocatorStats stats;
+};
+
+// Ring of allocations retired in the order they were made.
+//
+// Call Fence(id) after the last allocation of a frame, and Release(id) once
+// the GPU is done with that frame; everything allocated before the fence is
+// then reusable. Ids must increase. An allocation that does not fit before
+// the end of the range wraps to the start and the skipped tail counts as
+// used until its fence is released.
+class RingAllocator {
+public:
+    explicit RingAllocator(std::size_t capacity);
+
+    std::size_t Allocate(std::size_t size, std::size_t alignment = 16);
+    void Fence(std::uint64_t id);
+    void Release(std::uint64_t id);
+    bool Pending() const { return !fences.empty(); }
+    std::uint64_t Oldest() const { return fences.front().id; }
+    AllocatorStats Stats() const;
+
+private:
+    // What releasing one fence gives back
+    struct Retirement {
+        std::uint64_t id;
+        std::size_t bytes;
+        std::size_t allocations;
+    };
+
+    std::size_t head;
+    std::size_t tail;
+    Retirement unfenced;
+    std::deque<Retirement> fences;
+    AllocatorStats stats;
+};
+
+// Two-level segregated fit (Masmano et al., ECRTS 2004).
+//
+// Free blocks sit in size-class lists indexed by two bitmaps: the first level
+// is the power of two below the size, the second splits that range into 16
+// linear steps. Allocation rounds the request up to the next class so the
+// head of any non-empty list at or above it fits; finding that list and
+// freeing with immediate coalescing are both constant time. Meant for
+// long-lived data such as mesh geometry. Sizes are rounded up to Granularity.
+class TlsfAllocator {
+public:
+    struct Allocation {
+        std::size_t offset = InvalidOffset;
+        std::size_t size = 0;
+        std::uint32_t block = ~0u;
+        bool Valid() const { return offset != InvalidOffset; }
+    };
+
+    explicit TlsfAllocator(std::size_t capacity);
+
+    Allocation Allocate(std::size_t size, std::size_t alignment = Granularity);
+    void Free(const Allocation & allocation);
+    std::size_t Capacity() const { return stats.capacity; }
+    std::size_t Live() const { return stats.live; }
+    // Walks the free lists for freeBlocks and largestFree
+    AllocatorStats Stats() const;
+    // Walks every block and checks the free lists; for tests
+    bool Validate() const;
+
+    static const std::size_t Granularity = 16;
+
+private:
+    static const std::uint32_t None = ~0u;
+    static const unsigned int SecondLevelLog = 4;
+    static const unsigned int SecondLevels = 1 << SecondLevelLog;
+    static const unsigned int SmallLog = SecondLevelLog + 4; // log2(SecondLevels * Granularity)
+    static const unsigned int FirstLevels = 64 - SmallLog + 1;
+
+    struct Block {
+        std::size_t offset;
+        std::size_t size;
+        std::uint32_t previous;     // Physical neighbours
+        std::uint32_t next;
+        std::uint32_t previousFree; // Size-class list
+        std::uint32_t nextFree;
+        bool free;
+    };
+
+    static void Mapping(std::size_t size, unsigned int & first, unsigned int & second);
+    std::uint32_t Find(std::size_t size) const;
+    void Insert(std::uint32_t block);
+    void Remove(std::uint32_t block);
+    std::uint32_t Split(std::uint32_t block, std::size_t size);
+    std::uint32_t Create();
+
+    std::vector<Block> blocks;
+    std::vector<std::uint32_t> spare;
+    std::uint64_t firstBitmap;
+    std::uint32_t secondBitmap[FirstLevels];
+    std::uint32_t heads[FirstLevels][SecondLevels];
+    AllocatorStats stats;
+};
+
+#endif //GLITTER_GPU_ALLOCATOR_HPP
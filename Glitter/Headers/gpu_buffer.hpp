@@ -0,0 +1,126 @@
+#ifndef GLITTER_GPU_BUFFER_HPP
+#define GLITTER_GPU_BUFFER_HPP
+
+#include "gpu_allocator.hpp"
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Ring of per-frame upload space in one buffer object.
+//
+// Allocate() returns a pointer to write through and the offset to bind or
+// draw from. With OpenGL 4.4 or ARB_buffer_storage the whole buffer is
+// persistently and coherently mapped, so writes need no further calls;
+// otherwise they land in a CPU copy that Flush() sends with glBufferSubData,
+// and Flush() must run before the draws that read them. Advance() fences
+// everything allocated during the frame; that space is reused once the
+// fence signals. Allocate() only blocks when the ring is full of frames the
+// GPU has not finished, and GetStats() counts how often that happened.
+class StreamBuffer {
+public:
+    struct Span {
+        void * data;
+        GLintptr offset;
+        GLsizeiptr size;
+    };
+
+    struct Stats {
+        AllocatorStats ring;
+        std::uint64_t waits;
+        double waitMilliseconds;
+        std::size_t flushed; // Bytes sent by Flush(); zero when persistently mapped
+    };
+
+    StreamBuffer(GLenum target, std::size_t capacity);
+    ~StreamBuffer();
+
+    // data is null if size exceeds what one frame can ever get
+    Span Allocate(std::size_t size, std::size_t alignment = 16);
+    GLintptr Write(const void * data, std::size_t size, std::size_t alignment = 16);
+    void Flush();
+    void Advance();
+
+    GLuint Buffer() const { return buffer; }
+    bool Persistent() const { return persistent; }
+    Stats GetStats() const;
+
+private:
+    StreamBuffer(const StreamBuffer &) = delete;
+    StreamBuffer & operator=(const StreamBuffer &) = delete;
+
+    void Reclaim(bool wait);
+
+    RingAllocator ring;
+    std::deque<std::pair<std::uint64_t, GLsync>> fences;
+    std::vector<unsigned char> shadow;
+    std::vector<std::pair<std::size_t, std::size_t>> dirty; // Offset, size awaiting Flush()
+    GLenum target;
+    GLuint buffer;
+    unsigned char * mapped;
+    bool persistent;
+    std::uint64_t frame;
+    std::uint64_t waits;
+    double waitMilliseconds;
+    std::size_t flushed;
+};
+
+// Long-lived data sub-allocated from a few large buffers.
+//
+// Each page is one buffer object managed by a TlsfAllocator, so thousands of
+// meshes share a handful of buffers instead of owning one each. Requests
+// bigger than a page get a page of their own, which is released as soon as
+// it empties. Vertex and index data may share an allocation: bind the
+// buffer to both targets and offset the attribute pointers and draw calls by
+// the allocation's offset. Freeing space the GPU may still read is safe;
+// later uploads into it go through glBufferSubData, which the driver orders
+// behind earlier draws.
+class BufferHeap {
+public:
+    struct Allocation {
+        GLuint buffer = 0;
+        GLintptr offset = 0;
+        std::size_t size = 0;
+        std::uint32_t page = 0;
+        TlsfAllocator::Allocation block;
+        bool Valid() const { return buffer != 0; }
+    };
+
+    explicit BufferHeap(std::size_t pageSize = 16 << 20);
+    ~BufferHeap();
+
+    // Uploads data right away when given; the allocation is invalid if out of memory
+    Allocation Allocate(std::size_t size, std::size_t alignment = 16, const void * data = nullptr);
+    void Upload(const Allocation & allocation, const void * data, std::size_t size, std::size_t offset = 0);
+    void Free(Allocation & allocation);
+
+    // Sums over every page
+    AllocatorStats Stats() const;
+    std::size_t Pages() const;
+
+    // Shared heap for mesh geometry; never destroyed, the context takes its buffers with it
+    static BufferHeap & Default();
+
+private:
+    BufferHeap(const BufferHeap &) = delete;
+    BufferHeap & operator=(const BufferHeap &) = delete;
+
+    struct Page {
+        explicit Page(std::size_t capacity) : allocator(capacity), buffer(0) {}
+        TlsfAllocator allocator;
+        GLuint buffer;
+    };
+
+    std::vector<std::unique_ptr<Page>> pages;
+    std::size_t pageSize;
+    std::size_t used;
+    std::size_t peak;
+    std::uint64_t failures;
+};
+
+#endif //GLITTER_GPU_BUFFER_HPP
@@ -0,0 +1,12 @@
+#ifndef GLITTER_HASH_HPP
+#define GLITTER_HASH_HPP
+
+#include <cstdint>
+
+// 32-bit FNV-1a over a NUL-terminated name, usable in constant expressions.
+// Shader::Hash and Mirage::uniform both key reflected uniforms with it.
+constexpr std::uint32_t HashName(const char * name, std::uint32_t seed = 2166136261u) {
+    return *name ? HashName(name + 1, (seed ^ static_cast<unsigned char>(*name)) * 16777619u) : seed;
+}
+
+#endif //GLITTER_HASH_HPP
@@ -0,0 +1,36 @@
+#ifndef GLITTER_HEADLESS_HPP
+#define GLITTER_HEADLESS_HPP
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+
+// Window-less OpenGL context that renders into an offscreen framebuffer.
+//
+// Uses EGL with no surface at all (EGL_KHR_surfaceless_context), preferring
+// Mesa's surfaceless platform, so it needs neither a display server nor a
+// GPU and runs on llvmpipe in CI. The framebuffer stays bound after Create(),
+// so code written against the default framebuffer draws into it unchanged.
+class HeadlessContext {
+public:
+    HeadlessContext();
+    ~HeadlessContext();
+
+    bool Create(int width, int height);
+    // Reads back the framebuffer as tightly packed, top-down RGB
+    void ReadPixels(std::vector<unsigned char> & pixels) const;
+    bool WriteImage(const std::string & path) const;
+
+    int Width, Height;
+
+private:
+    HeadlessContext(const HeadlessContext &) = delete;
+    HeadlessContext & operator=(const HeadlessContext &) = delete;
+
+    void * display;
+    void * context;
+    GLuint framebuffer, color, depth;
+};
+
+#endif //GLITTER_HEADLESS_HPP
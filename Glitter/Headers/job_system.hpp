@@ -0,0 +1,132 @@
+#ifndef GLITTER_JOB_SYSTEM_HPP
+#define GLITTER_JOB_SYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing scheduler for frame and loading tasks.
+//
+// Every worker owns a Chase-Lev deque (Chase and Lev, SPAA 2005, with the
+// C11 orderings of Le et al., PPoPP 2013): it pushes and pops jobs at the
+// bottom without locks, and idle workers steal from the top of a random
+// victim. The thread that constructs the system gets a deque as well, so
+// main() spawns without locking; other threads submit through a locked
+// queue. Counters track groups of jobs. Wait()
+// runs other jobs until its counter drains instead of blocking, which is
+// how nested parallelism makes progress without fibers, and After() queues
+// a continuation that only becomes runnable once a counter reaches zero.
+// Workers sleep when there is nothing to steal. Jobs must not throw.
+class JobSystem {
+    struct Job;
+
+public:
+    typedef std::function<void()> Task;
+    typedef std::function<void(std::size_t first, std::size_t last)> Range;
+
+    // Jobs still outstanding in a group. Reusable once Done(), but only
+    // destroy one that has been through Wait(): the job finishing last may
+    // still hold its lock after Done() turns true.
+    class Counter {
+    public:
+        Counter() : value(0) {}
+        bool Done() const { return value.load(std::memory_order_acquire) == 0; }
+
+    private:
+        Counter(const Counter &) = delete;
+        Counter & operator=(const Counter &) = delete;
+
+        std::atomic<int> value;
+        std::mutex mutex;
+        std::vector<Job *> continuations;
+
+        friend class JobSystem;
+    };
+
+    struct Stats {
+        std::uint64_t executed = 0;
+        std::uint64_t stolen = 0;
+        std::uint64_t injected = 0; // Submitted by threads that are not workers
+        std::uint64_t inlined = 0;  // Run at once because the deque was full
+        std::uint64_t sleeps = 0;
+    };
+
+    // Zero workers is allowed: jobs then run inside Wait() on the caller
+    explicit JobSystem(unsigned int workers = DefaultWorkers());
+    ~JobSystem(); // Finishes every job already spawned; destroy on the constructing thread
+
+    void Spawn(Task task, Counter * counter = nullptr);
+    void After(Counter & dependency, Task task, Counter * counter = nullptr);
+    void Wait(Counter & counter);
+    // Splits [first, last) in halves down to grain items and waits for all of them
+    void ParallelFor(std::size_t first, std::size_t last, std::size_t grain, const Range & body);
+
+    unsigned int Size() const { return static_cast<unsigned int>(workers.size() - 1); }
+    Stats Statistics() const;
+
+    // One worker per core beyond the caller's
+    static unsigned int DefaultWorkers();
+
+private:
+    JobSystem(const JobSystem &) = delete;
+    JobSystem & operator=(const JobSystem &) = delete;
+
+    // Fixed-capacity Chase-Lev deque; Push() fails instead of growing
+    class Deque {
+    public:
+        Deque();
+        bool Push(Job * job);
+        Job * Pop();
+        Job * Steal();
+
+    private:
+        static const std::int64_t Capacity = 4096;
+        std::atomic<std::int64_t> top, bottom;
+        std::unique_ptr<std::atomic<Job *>[]> buffer;
+    };
+
+    struct Worker {
+        Deque deque;
+        std::thread thread;
+        std::uint32_t random;
+        std::atomic<std::uint64_t> executed{0}, stolen{0}, inlined{0}, sleeps{0};
+    };
+
+    void Run(Worker * self);
+    void Enqueue(Job * job);
+    void Execute(Job * job, Worker * self);
+    void Finish(Counter & counter);
+    void Split(std::size_t first, std::size_t last, std::size_t grain, const Range & body, Counter & counter);
+    Job * Find(Worker * self);
+    Worker * Current() const;
+
+    // Systems are numbered so a stale thread_local never matches a new one at the same address
+    static std::atomic<std::uint64_t> systems;
+    static thread_local Worker * currentWorker;
+    static thread_local std::uint64_t currentSystem;
+
+    std::vector<std::unique_ptr<Worker>> workers; // The constructing thread's first, then one per thread
+    Worker * previousWorker; // The constructing thread's registration before this system
+    std::uint64_t previousSystem;
+    std::uint64_t id;
+    std::deque<Job *> injected;
+    std::mutex injectedMutex;
+    std::atomic<std::size_t> injectedCount;
+    std::atomic<std::int64_t> queued;      // Jobs sitting in a deque or the injected queue
+    std::atomic<std::int64_t> outstanding; // Spawned jobs not yet finished, including continuations
+    std::atomic<std::uint64_t> external;   // Jobs run by threads that are not workers
+    std::atomic<std::uint64_t> submitted;
+    std::atomic<int> sleeping;
+    std::mutex mutex;
+    std::condition_variable signal;
+    bool stopping;
+};
+
+#endif //GLITTER_JOB_SYSTEM_HPP
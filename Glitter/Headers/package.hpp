@@ -0,0 +1,110 @@
+#ifndef GLITTER_PACKAGE_HPP
+#define GLITTER_PACKAGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// LZ4 block format (no frame header), written from the public spec.
+//
+// Compress() is the greedy single-probe variant; it trades some ratio for
+// speed and emits blocks any LZ4 decoder accepts. Decompress() checks every
+// length and offset against both buffers, so a corrupt block fails instead
+// of reading or writing out of bounds. It returns true only when exactly
+// size bytes were produced.
+struct Lz4 {
+    static std::size_t Bound(std::size_t size) { return size + size / 255 + 16; }
+    static std::size_t Compress(const void * source, std::size_t size, void * destination, std::size_t capacity);
+    static bool Decompress(const void * source, std::size_t size, void * destination, std::size_t decoded);
+};
+
+// Read-only archive of many small assets in one memory-mapped file.
+//
+// Layout: a header, an index sorted by name hash, the names, then every
+// entry at a 16-byte aligned offset. Stored entries are spans straight into
+// the mapping. Compressed entries are LZ4 blocks, decoded on first access
+// into a buffer the package keeps, so later lookups are zero-copy as well.
+// Paths are normalized lexically and resolved against the root given to
+// Open(); paths outside the root miss. Find() and Read() are thread-safe.
+class Package {
+public:
+    struct Span {
+        const unsigned char * data = nullptr;
+        std::size_t size = 0;
+        bool Valid() const { return data != nullptr; }
+    };
+    struct Stats {
+        std::size_t entries = 0;
+        std::size_t compressed = 0;
+        std::size_t decoded = 0;
+        std::uint64_t storedBytes = 0;
+        std::uint64_t rawBytes = 0;
+    };
+
+    Package() = default;
+    ~Package() { Close(); }
+
+    bool Open(const std::string & filename, const std::string & root = "");
+    void Close();
+    bool Mounted() const { return data != nullptr; }
+
+    Span Find(const std::string & path);
+    // Package first, then the file system; for callers that want a copy anyway
+    bool Read(const std::string & path, std::string & contents);
+    std::vector<std::string> Names() const;
+    Stats Statistics() const;
+
+    // Package in $GLITTER_PACKAGE, or ../glitter.pak next to ../Shaders, rooted at ..
+    static Package & Default();
+    static std::string Normalize(const std::string & path);
+
+    static const std::uint32_t Version = 1;
+
+private:
+    Package(const Package &) = delete;
+    Package & operator=(const Package &) = delete;
+
+    struct Entry;
+    const Entry * Lookup(const std::string & name) const;
+
+    unsigned char * data = nullptr;
+    std::size_t size = 0;
+    std::vector<unsigned char> fallback;
+    const Entry * index = nullptr;
+    const char * names = nullptr;
+    std::uint32_t count = 0;
+    std::string root;
+    std::vector<std::unique_ptr<std::vector<unsigned char>>> decoded;
+    mutable std::mutex mutex;
+
+    friend class PackageWriter;
+};
+
+// Collects files for a Package and writes it in one go.
+//
+// Entries compress when LZ4 saves at least an eighth of their size;
+// already-compressed formats such as JPEG stay stored and zero-copy.
+class PackageWriter {
+public:
+    void Add(const std::string & name, const void * data, std::size_t size);
+    bool AddFile(const std::string & name, const std::string & path);
+    // Every regular file below directory, named prefix/relative/path
+    bool AddDirectory(const std::string & prefix, const std::string & directory);
+    bool Write(const std::string & filename) const;
+    std::size_t Size() const { return files.size(); }
+    // Entries added so far, in order; spans stay valid until the next Add()
+    std::vector<std::string> Names() const;
+    Package::Span Find(const std::string & name) const;
+
+private:
+    struct File {
+        std::string name;
+        std::vector<unsigned char> bytes;
+    };
+    std::vector<File> files;
+};
+
+#endif //GLITTER_PACKAGE_HPP
@@ -0,0 +1,71 @@
+#ifndef GLITTER_PROFILER_HPP
+#define GLITTER_PROFILER_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Frame profiler with CPU scopes and GPU timer queries.
+//
+// Use the macros below rather than the class directly, so that building
+// without GLITTER_PROFILE removes every trace of the profiler:
+//
+//     PROFILE_SCOPE("Draw");       // CPU time until the end of the block
+//     PROFILE_GPU_SCOPE("Draw");   // GPU time for commands issued in the block
+//     PROFILE_FRAME();             // once per frame, after SwapBuffers
+//
+// Each thread records CPU scopes into its own ring buffer, so recording
+// never takes a lock. GPU scopes bracket their commands with GL_TIMESTAMP
+// queries spread over several frames. A frame's results are only read once
+// the GPU reports them available, so the pipeline never stalls. Scope names
+// must be string literals or otherwise outlive the profiler.
+class Profiler {
+public:
+    class CpuScope {
+    public:
+        explicit CpuScope(const char * name) : name(name), start(Now()) {}
+        ~CpuScope() { Record(name, start, Now()); }
+    private:
+        const char * name;
+        std::uint64_t start;
+    };
+
+    class GpuScope {
+    public:
+        explicit GpuScope(const char * name) : index(BeginGpu(name)) {}
+        ~GpuScope() { EndGpu(index); }
+    private:
+        int index;
+    };
+
+    // Nanoseconds on a monotonic clock
+    static std::uint64_t Now();
+    static void Record(const char * name, std::uint64_t start, std::uint64_t end);
+    static void Frame();
+    // Prints min/avg/p99 per scope over everything still in the ring buffers
+    static void Summary(FILE * out);
+    // Writes the Chrome trace event format; open in chrome://tracing or Perfetto
+    static bool Export(const std::string & path);
+
+private:
+    static int BeginGpu(const char * name);
+    static void EndGpu(int index);
+};
+
+#ifdef GLITTER_PROFILE
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) Profiler::CpuScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_GPU_SCOPE(name) Profiler::GpuScope PROFILE_CONCAT(profileGpuScope, __LINE__)(name)
+#define PROFILE_FRAME() Profiler::Frame()
+#define PROFILE_SUMMARY(out) Profiler::Summary(out)
+#define PROFILE_EXPORT(path) Profiler::Export(path)
+#else
+#define PROFILE_SCOPE(name) ((void) 0)
+#define PROFILE_GPU_SCOPE(name) ((void) 0)
+#define PROFILE_FRAME() ((void) 0)
+#define PROFILE_SUMMARY(out) ((void) 0)
+#define PROFILE_EXPORT(path) ((void) 0)
+#endif
+
+#endif //GLITTER_PROFILER_HPP
@@ -0,0 +1,36 @@
+#ifndef GLITTER_PROGRAM_CACHE_HPP
+#define GLITTER_PROGRAM_CACHE_HPP
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// On-disk cache of linked program binaries (glGetProgramBinary/glProgramBinary).
+//
+// Entries are keyed by a hash of the final shader sources and the driver's
+// vendor, renderer and version strings, so a driver update or any source or
+// define change simply misses. A binary the driver refuses to load also
+// counts as a miss; the caller then compiles from source and stores again.
+class ProgramCache {
+public:
+    explicit ProgramCache(const std::string & directory);
+
+    std::uint64_t Key(const std::vector<std::string> & sources) const;
+    bool Load(GLuint program, std::uint64_t key) const;
+    bool Store(GLuint program, std::uint64_t key) const;
+    bool Supported() const;
+
+    // Shared cache in $GLITTER_SHADER_CACHE, or ../ShaderCache next to ../Shaders
+    static ProgramCache & Default();
+    static std::uint64_t Hash(const void * data, std::size_t size,
+                              std::uint64_t seed = 14695981039346656037ull);
+
+private:
+    std::string Path(std::uint64_t key) const;
+
+    std::string directory;
+};
+
+#endif //GLITTER_PROGRAM_CACHE_HPP
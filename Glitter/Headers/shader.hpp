@@ -5,22 +5,65 @@
 #ifndef GLITTER_SHADER_HPP
 #define GLITTER_SHADER_HPP
 
+#include "hash.hpp"
+
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
 
 using namespace std;
 
 class Shader {
 public:
     GLuint Program;
-    Shader(const GLchar* vertexSourcePath, const GLchar* fragmentSourcePath);
+    // Startup report: whether the program came from the binary cache, and
+    // how long loading (cached) or compiling and linking (cold) took.
+    bool Cached = false;
+    double LinkMilliseconds = 0.0;
+    std::string VertexPath, FragmentPath;
+    // Defines are injected after #version, e.g. "WOBBLE" or "LIGHTS=4".
+    // Files lists every source the program was built from, includes too.
+    std::vector<std::string> Defines, Files;
+    Shader(const GLchar* vertexSourcePath, const GLchar* fragmentSourcePath,
+           const std::vector<std::string> & defines = {});
     void Use();
 
+    // Compiles (or loads from the binary cache) and links a new program.
+    // Returns 0 on failure. Safe to call on any thread with a context that
+    // shares objects with the rendering context.
+    static GLuint Build(const std::string & vertexPath, const std::string & fragmentPath,
+                        const std::vector<std::string> & defines = {},
+                        bool * cached = nullptr, std::vector<std::string> * files = nullptr);
+
+    // Build() split in two: Submit() issues the compile and link without
+    // waiting, Finish() checks the result and stores the binary. Submitting
+    // several programs before finishing any lets the driver overlap them.
+    struct Job {
+        GLuint program;
+        std::uint64_t key;
+        bool cached;
+        std::vector<std::string> files;
+    };
+    static Job Submit(const std::string & vertexPath, const std::string & fragmentPath,
+                      const std::vector<std::string> & defines);
+    static GLuint Finish(Job & job);
+    // Replaces the program in place and re-reflects uniforms; call between frames
+    void Swap(GLuint program);
+
+    // Uniform locations are reflected once at link time; look them up by
+    // hashed name, ideally outside the render loop. Returns -1 if inactive.
+    GLint Uniform(std::uint32_t hash) const;
+    static constexpr std::uint32_t Hash(const char * name) { return HashName(name); }
+
 private:
-    GLchar *readShaderFile(const GLchar *path) const;
-    GLuint compileShader(int shaderType, const GLchar * code) const;
+    static GLuint compileShader(int shaderType, const std::string & code);
+    void reflectUniforms();
+
+    std::unordered_map<std::uint32_t, GLint> uniforms;
 };
 
 
@@ -0,0 +1,38 @@
+#ifndef GLITTER_SHADER_PERMUTATIONS_HPP
+#define GLITTER_SHADER_PERMUTATIONS_HPP
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Table of programs specialised from one vertex/fragment pair.
+//
+// Bit i of a mask turns on features[i] as a #define, so specialised code is
+// selected at compile time instead of branching on uniforms. Programs build
+// on first use; Prepare() submits a whole set up front so drivers with
+// background compiler threads can work on them in parallel.
+class ShaderPermutations {
+public:
+    ShaderPermutations(const std::string & vertexPath, const std::string & fragmentPath,
+                       const std::vector<std::string> & features);
+    ~ShaderPermutations();
+
+    // Returns 0 if this permutation failed to build
+    GLuint Get(std::uint32_t mask);
+    void Prepare(const std::vector<std::uint32_t> & masks);
+    std::vector<std::string> Defines(std::uint32_t mask) const;
+    std::size_t Size() const { return programs.size(); }
+
+private:
+    ShaderPermutations(const ShaderPermutations &) = delete;
+    ShaderPermutations & operator=(const ShaderPermutations &) = delete;
+
+    std::string vertexPath, fragmentPath;
+    std::vector<std::string> features;
+    std::unordered_map<std::uint32_t, GLuint> programs;
+};
+
+#endif //GLITTER_SHADER_PERMUTATIONS_HPP
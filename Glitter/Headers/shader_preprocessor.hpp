@@ -0,0 +1,45 @@
+#ifndef GLITTER_SHADER_PREPROCESSOR_HPP
+#define GLITTER_SHADER_PREPROCESSOR_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Expands #include "file" and injects #define lines before GLSL sees a shader.
+//
+// Includes resolve relative to the including file and each file is expanded
+// once per program, so headers need no guards. Every included file gets its
+// own #line source number. Errors therefore read "<n>(<line>)", where n
+// indexes Result::files and 0 is the root. Defines such as "LIGHTS=4" become
+// "#define LIGHTS 4" right after the #version line.
+//
+// Results are memoized by content hash. A lookup re-hashes the files a
+// result came from, so editing any include invalidates it.
+class ShaderPreprocessor {
+public:
+    struct Result {
+        std::string source;
+        std::vector<std::string> files;
+        bool valid = false;
+    };
+
+    static Result Process(const std::string & path, const std::vector<std::string> & defines);
+
+private:
+    struct Memo {
+        Result result;
+        std::vector<std::uint64_t> hashes;
+    };
+
+    static bool Expand(const std::string & path, Result & result,
+                       std::vector<std::string> & stack, std::vector<std::uint64_t> & hashes,
+                       const std::vector<std::string> * defines);
+
+    static std::mutex mutex;
+    static std::unordered_map<std::uint64_t, Memo> memo;
+};
+
+#endif //GLITTER_SHADER_PREPROCESSOR_HPP
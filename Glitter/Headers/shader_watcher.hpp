@@ -0,0 +1,62 @@
+#ifndef GLITTER_SHADER_WATCHER_HPP
+#define GLITTER_SHADER_WATCHER_HPP
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "shader.hpp"
+
+// Watches a shader directory and rebuilds affected programs in the background.
+//
+// Rebuilds run on a hidden window whose context shares objects with the
+// rendering context, so compiling never stalls a frame. Finished programs
+// wait in a queue until Poll() swaps them in from the render thread, which
+// keeps every frame on one consistent program. A failed build is logged and
+// the old program stays live. Uses inotify on Linux and polls modification
+// times elsewhere.
+class ShaderWatcher {
+public:
+    // Must be constructed on the main thread, after the window's context exists
+    ShaderWatcher(GLFWwindow * window, const std::string & directory);
+    ~ShaderWatcher();
+
+    // Rebuilds the shader from this directory when any file it includes changes
+    void Watch(Shader & shader);
+    // Swaps in finished programs; returns how many shaders were replaced
+    int Poll();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry {
+        Shader * shader;
+        std::string vertex, fragment;
+        std::vector<std::string> defines, files;
+    };
+    struct Pending {
+        Shader * shader;
+        GLuint program;
+        Clock::time_point changed;
+    };
+
+    void Run();
+    void Changed(const std::string & filename, Clock::time_point when);
+
+    GLFWwindow * context;
+    std::string directory;
+    std::vector<Entry> entries;
+    std::vector<Pending> pending;
+    std::mutex mutex;
+    std::atomic<bool> running;
+    std::thread worker;
+    int notify;
+};
+
+#endif //GLITTER_SHADER_WATCHER_HPP
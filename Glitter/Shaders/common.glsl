@@ -0,0 +1,2 @@
+// Shared by every Glitter shader through #include "common.glsl"
+#define PI 3.1415926
@@ -1,20 +1,24 @@
 #version 410 core
-//#define PI 3.1415926
+#include "common.glsl"
 
-//uniform float multiplier;
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec3 color;
 out vec3 ourColor;
 
+#ifdef WOBBLE
+uniform float multiplier;
+#endif
+
 void main() {
+#ifdef WOBBLE
     gl_Position = vec4(
-//        position.x * sin(2 * PI * multiplier),
-//        position.y * cos(PI * multiplier/3),
-//        position.z + position.z * multiplier,
-        position.x,
-        position.y,
-        position.z,
+        position.x * sin(2 * PI * multiplier),
+        position.y * cos(PI * multiplier/3),
+        position.z + position.z * multiplier,
         1.0
     );
+#else
+    gl_Position = vec4(position, 1.0);
+#endif
     ourColor = color;
 }
@@ -0,0 +1,174 @@
+#include "frame_pipeline.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+    const std::size_t Unrecorded = static_cast<std::size_t>(-1);
+
+    template <typename TimePoint>
+    double Milliseconds(TimePoint start, TimePoint end) {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+}
+
+FramePipeline::FramePipeline(JobSystem & jobs, Stages stages, std::size_t slotBytes, unsigned int framesInFlight)
+    : jobs(jobs), stages(std::move(stages)), started(0), submitted(0), slotBytes(slotBytes),
+      buffer(0), mapped(nullptr), persistent(false) {
+    framesInFlight = std::max(framesInFlight, 1u);
+    std::size_t capacity = slotBytes * framesInFlight;
+    if (capacity > 0) {
+        // The copy target leaves whatever vertex array is bound untouched
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        if (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage) {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_COPY_WRITE_BUFFER, capacity, nullptr, flags);
+            mapped = static_cast<unsigned char *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, capacity, flags));
+            persistent = mapped != nullptr;
+        }
+        if (!persistent) {
+            glBufferData(GL_COPY_WRITE_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+            shadow.resize(capacity);
+            mapped = shadow.data();
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    for (unsigned int i = 0; i < framesInFlight; i++) {
+        std::unique_ptr<Slot> slot(new Slot());
+        slot->frame.index = 0;
+        slot->frame.slot = i;
+        slot->frame.time = 0.0;
+        slot->frame.data = mapped ? mapped + i * slotBytes : nullptr;
+        slot->frame.offset = static_cast<GLintptr>(i * slotBytes);
+        slot->frame.size = slotBytes;
+        slot->frame.used = 0;
+        slot->entry = Unrecorded;
+        slot->fence = nullptr;
+        slots.push_back(std::move(slot));
+    }
+}
+
+FramePipeline::~FramePipeline() {
+    // Jobs still running write into the slots, so they have to finish first
+    for (auto & slot : slots) {
+        jobs.Wait(slot->updated);
+        jobs.Wait(slot->recorded);
+        if (slot->fence) glDeleteSync(slot->fence);
+    }
+    if (persistent) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    if (buffer) glDeleteBuffers(1, &buffer);
+}
+
+void FramePipeline::Step() {
+    // Start every frame there is a slot for; only the oldest slot can make this wait
+    while (started - submitted < slots.size()) Begin();
+    Submit();
+
+    // Note which frames the GPU has finished without waiting for the rest
+    for (auto & slot : slots) Retire(*slot, false);
+}
+
+void FramePipeline::Drain() {
+    while (submitted < started) Submit();
+    for (auto & slot : slots) Retire(*slot, true);
+}
+
+void FramePipeline::Reset() {
+    history.clear();
+    for (auto & slot : slots) slot->entry = Unrecorded;
+}
+
+void FramePipeline::Begin() {
+    Slot & slot = *slots[started % slots.size()];
+    double fenceWait = Retire(slot, true);
+
+    slot.timings = Timings();
+    slot.timings.index = started;
+    slot.timings.fenceWait = fenceWait;
+    slot.frame.index = started;
+    slot.frame.time = 0.0;
+    slot.frame.used = 0;
+
+    auto start = Clock::now();
+    if (stages.sample) stages.sample(slot.frame);
+    slot.sampled = Clock::now();
+    slot.timings.sample = Milliseconds(start, slot.sampled);
+
+    Slot * self = &slot;
+    auto update = [this, self]() {
+        auto start = Clock::now();
+        if (stages.update) stages.update(self->frame);
+        self->timings.update = Milliseconds(start, Clock::now());
+    };
+    auto record = [this, self]() {
+        auto start = Clock::now();
+        if (stages.record) stages.record(self->frame);
+        self->frame.used = std::min(self->frame.used, self->frame.size);
+        self->timings.record = Milliseconds(start, Clock::now());
+    };
+
+    // Updates advance shared simulation state, so each waits for the one
+    // before it unless that frame has already been submitted
+    if (started > submitted) {
+        Slot & previous = *slots[(started - 1) % slots.size()];
+        jobs.After(previous.updated, update, &slot.updated);
+    } else {
+        jobs.Spawn(update, &slot.updated);
+    }
+    jobs.After(slot.updated, record, &slot.recorded);
+    started++;
+}
+
+void FramePipeline::Submit() {
+    Slot & slot = *slots[submitted % slots.size()];
+    auto start = Clock::now();
+    jobs.Wait(slot.recorded);
+    jobs.Wait(slot.updated);
+    auto recorded = Clock::now();
+    slot.timings.recordWait = Milliseconds(start, recorded);
+
+    if (!persistent && slot.frame.used > 0) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, slot.frame.offset, slot.frame.used, slot.frame.data);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    if (stages.submit) stages.submit(slot.frame);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    auto submittedAt = Clock::now();
+    slot.timings.submit = Milliseconds(recorded, submittedAt);
+
+    if (stages.present) stages.present();
+    auto now = Clock::now();
+    slot.timings.present = Milliseconds(submittedAt, now);
+    slot.timings.latency = Milliseconds(slot.sampled, now);
+    if (submitted > 0) slot.timings.frame = Milliseconds(presented, now);
+    presented = now;
+
+    slot.entry = history.size();
+    history.push_back(slot.timings);
+    submitted++;
+}
+
+double FramePipeline::Retire(Slot & slot, bool wait) {
+    if (!slot.fence) return 0.0;
+    double waited = 0.0;
+    GLenum status = glClientWaitSync(slot.fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        if (!wait) return 0.0;
+        auto start = Clock::now();
+        while (status == GL_TIMEOUT_EXPIRED)
+            status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        waited = Milliseconds(start, Clock::now());
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    if (slot.entry != Unrecorded) history[slot.entry].completed = Milliseconds(slot.sampled, Clock::now());
+    slot.entry = Unrecorded;
+    return waited;
+}
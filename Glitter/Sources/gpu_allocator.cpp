@@ -0,0 +1,324 @@
+#include "gpu_allocator.hpp"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+    std::size_t alignUp(std::size_t value, std::size_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    unsigned int highestBit(std::uint64_t value) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return index;
+#else
+        return 63 - __builtin_clzll(value);
+#endif
+    }
+
+    unsigned int lowestBit(std::uint64_t value) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return index;
+#else
+        return __builtin_ctzll(value);
+#endif
+    }
+
+    void track(AllocatorStats & stats, std::size_t bytes) {
+        stats.used += bytes;
+        stats.peak = std::max(stats.peak, stats.used);
+        stats.live++;
+        stats.allocations++;
+    }
+}
+
+LinearAllocator::LinearAllocator(std::size_t capacity) : head(0) {
+    stats.capacity = capacity;
+}
+
+std::size_t LinearAllocator::Allocate(std::size_t size, std::size_t alignment) {
+    std::size_t start = alignUp(head, alignment);
+    if (start > stats.capacity || size > stats.capacity - start) {
+        stats.failures++;
+        return InvalidOffset;
+    }
+    track(stats, start + size - head);
+    head = start + size;
+    return start;
+}
+
+void LinearAllocator::Reset() {
+    head = 0;
+    stats.used = 0;
+    stats.live = 0;
+}
+
+AllocatorStats LinearAllocator::Stats() const {
+    AllocatorStats result = stats;
+    result.freeBlocks = head < stats.capacity ? 1 : 0;
+    result.largestFree = stats.capacity - head;
+    return result;
+}
+
+RingAllocator::RingAllocator(std::size_t capacity) : head(0), tail(0) {
+    stats.capacity = capacity;
+    unfenced.bytes = unfenced.allocations = 0;
+}
+
+std::size_t RingAllocator::Allocate(std::size_t size, std::size_t alignment) {
+    // Free space is [head, tail) modulo capacity; wrapping skips what is left before the end
+    std::size_t capacity = stats.capacity;
+    std::size_t start = alignUp(head, alignment);
+    bool wrap = start > capacity || size > capacity - start;
+    if (wrap) start = 0;
+    std::size_t consumed = (wrap ? capacity - head : start - head) + size;
+    if (size > capacity || consumed > capacity - stats.used) {
+        stats.failures++;
+        return InvalidOffset;
+    }
+    track(stats, consumed);
+    unfenced.bytes += consumed;
+    unfenced.allocations++;
+    head = start + size;
+    return start;
+}
+
+void RingAllocator::Fence(std::uint64_t id) {
+    // Allocations since the previous fence are retired together
+    unfenced.id = id;
+    fences.push_back(unfenced);
+    unfenced.bytes = unfenced.allocations = 0;
+}
+
+void RingAllocator::Release(std::uint64_t id) {
+    while (!fences.empty() && fences.front().id <= id) {
+        tail = (tail + fences.front().bytes) % stats.capacity;
+        stats.used -= fences.front().bytes;
+        stats.live -= fences.front().allocations;
+        fences.pop_front();
+    }
+
+    // Nothing outstanding, so restart at zero and keep the whole range contiguous
+    if (stats.used == 0) head = tail = 0;
+}
+
+AllocatorStats RingAllocator::Stats() const {
+    // The same two candidates Allocate() tries: up to the end, or from zero after skipping it
+    AllocatorStats result = stats;
+    std::size_t free = stats.capacity - stats.used;
+    std::size_t end = std::min(stats.capacity - head, free);
+    std::size_t wrapped = free > stats.capacity - head ? free - (stats.capacity - head) : 0;
+    result.freeBlocks = (end > 0) + (wrapped > 0);
+    result.largestFree = std::max(end, wrapped);
+    return result;
+}
+
+const std::size_t TlsfAllocator::Granularity;
+const std::uint32_t TlsfAllocator::None;
+
+TlsfAllocator::TlsfAllocator(std::size_t capacity) : firstBitmap(0) {
+    std::fill(secondBitmap, secondBitmap + FirstLevels, 0u);
+    std::fill(&heads[0][0], &heads[0][0] + FirstLevels * SecondLevels, None);
+    stats.capacity = capacity & ~(Granularity - 1);
+    if (stats.capacity == 0) return;
+
+    std::uint32_t block = Create();
+    blocks[block].offset = 0;
+    blocks[block].size = stats.capacity;
+    Insert(block);
+}
+
+void TlsfAllocator::Mapping(std::size_t size, unsigned int & first, unsigned int & second) {
+    if (size < (std::size_t(1) << SmallLog)) {
+        first = 0;
+        second = static_cast<unsigned int>(size / Granularity);
+    } else {
+        unsigned int log = highestBit(size);
+        first = log - SmallLog + 1;
+        second = static_cast<unsigned int>(size >> (log - SecondLevelLog)) ^ SecondLevels;
+    }
+}
+
+std::uint32_t TlsfAllocator::Find(std::size_t size) const {
+    // Round up to the next class, so any block listed there is large enough
+    if (size >= (std::size_t(1) << SmallLog))
+        size += (std::size_t(1) << (highestBit(size) - SecondLevelLog)) - 1;
+    unsigned int first, second;
+    Mapping(size, first, second);
+    if (first >= FirstLevels) return None;
+
+    std::uint32_t candidates = second < SecondLevels ? secondBitmap[first] & (~0u << second) : 0;
+    if (!candidates) {
+        std::uint64_t larger = first + 1 < 64 ? firstBitmap & (~std::uint64_t(0) << (first + 1)) : 0;
+        if (!larger) return None;
+        first = lowestBit(larger);
+        candidates = secondBitmap[first];
+    }
+    return heads[first][lowestBit(candidates)];
+}
+
+void TlsfAllocator::Insert(std::uint32_t block) {
+    unsigned int first, second;
+    Mapping(blocks[block].size, first, second);
+    Block & b = blocks[block];
+    b.free = true;
+    b.previousFree = None;
+    b.nextFree = heads[first][second];
+    if (b.nextFree != None) blocks[b.nextFree].previousFree = block;
+    heads[first][second] = block;
+    firstBitmap |= std::uint64_t(1) << first;
+    secondBitmap[first] |= 1u << second;
+}
+
+void TlsfAllocator::Remove(std::uint32_t block) {
+    unsigned int first, second;
+    Mapping(blocks[block].size, first, second);
+    Block & b = blocks[block];
+    if (b.previousFree != None) blocks[b.previousFree].nextFree = b.nextFree;
+    else heads[first][second] = b.nextFree;
+    if (b.nextFree != None) blocks[b.nextFree].previousFree = b.previousFree;
+    if (heads[first][second] == None) {
+        secondBitmap[first] &= ~(1u << second);
+        if (!secondBitmap[first]) firstBitmap &= ~(std::uint64_t(1) << first);
+    }
+    b.free = false;
+}
+
+std::uint32_t TlsfAllocator::Create() {
+    std::uint32_t block;
+    if (!spare.empty()) {
+        block = spare.back();
+        spare.pop_back();
+    } else {
+        block = static_cast<std::uint32_t>(blocks.size());
+        blocks.push_back(Block());
+    }
+    Block & b = blocks[block];
+    b.previous = b.next = b.previousFree = b.nextFree = None;
+    b.free = false;
+    return block;
+}
+
+std::uint32_t TlsfAllocator::Split(std::uint32_t block, std::size_t size) {
+    // Cut the first size bytes off into their own block; returns the remainder
+    std::uint32_t rest = Create();
+    Block & b = blocks[block];
+    Block & r = blocks[rest];
+    r.offset = b.offset + size;
+    r.size = b.size - size;
+    r.previous = block;
+    r.next = b.next;
+    if (b.next != None) blocks[b.next].previous = rest;
+    b.next = rest;
+    b.size = size;
+    return rest;
+}
+
+TlsfAllocator::Allocation TlsfAllocator::Allocate(std::size_t size, std::size_t alignment) {
+    Allocation allocation;
+    alignment = std::max(alignment, Granularity);
+    size = alignUp(std::max<std::size_t>(size, 1), Granularity);
+    std::size_t slack = alignment - Granularity;
+    std::uint32_t block = size <= stats.capacity && slack <= stats.capacity - size ? Find(size + slack) : None;
+    if (block == None) {
+        stats.failures++;
+        return allocation;
+    }
+    Remove(block);
+
+    // Neighbours of a free block are never free, so leftovers are listed as they are
+    std::size_t padding = alignUp(blocks[block].offset, alignment) - blocks[block].offset;
+    if (padding > 0) {
+        std::uint32_t front = block;
+        block = Split(front, padding);
+        Insert(front);
+    }
+    if (blocks[block].size - size >= Granularity) Insert(Split(block, size));
+
+    track(stats, blocks[block].size);
+    allocation.offset = blocks[block].offset;
+    allocation.size = blocks[block].size;
+    allocation.block = block;
+    return allocation;
+}
+
+void TlsfAllocator::Free(const Allocation & allocation) {
+    if (!allocation.Valid()) return;
+    std::uint32_t block = allocation.block;
+    stats.used -= blocks[block].size;
+    stats.live--;
+
+    // Merge with free physical neighbours before listing the result
+    std::uint32_t previous = blocks[block].previous;
+    if (previous != None && blocks[previous].free) {
+        Remove(previous);
+        blocks[previous].size += blocks[block].size;
+        blocks[previous].next = blocks[block].next;
+        if (blocks[block].next != None) blocks[blocks[block].next].previous = previous;
+        spare.push_back(block);
+        block = previous;
+    }
+    std::uint32_t next = blocks[block].next;
+    if (next != None && blocks[next].free) {
+        Remove(next);
+        blocks[block].size += blocks[next].size;
+        blocks[block].next = blocks[next].next;
+        if (blocks[next].next != None) blocks[blocks[next].next].previous = block;
+        spare.push_back(next);
+    }
+    Insert(block);
+}
+
+AllocatorStats TlsfAllocator::Stats() const {
+    AllocatorStats result = stats;
+    for (unsigned int first = 0; first < FirstLevels; first++)
+    for (unsigned int second = 0; second < SecondLevels; second++)
+    for (std::uint32_t block = heads[first][second]; block != None; block = blocks[block].nextFree) {
+        result.freeBlocks++;
+        result.largestFree = std::max(result.largestFree, blocks[block].size);
+    }
+    return result;
+}
+
+bool TlsfAllocator::Validate() const {
+    // Physical chain: starts at zero, contiguous, covers the capacity, never two free in a row
+    std::size_t offset = 0, used = 0, live = 0, free = 0;
+    std::uint32_t previous = None;
+    std::uint32_t block = None;
+    for (std::uint32_t i = 0; i < blocks.size(); i++)
+        if (blocks[i].offset == 0 && blocks[i].previous == None
+            && std::find(spare.begin(), spare.end(), i) == spare.end()) block = i;
+    if (stats.capacity > 0 && block == None) return false;
+    for (; block != None; previous = block, block = blocks[block].next) {
+        const Block & b = blocks[block];
+        if (b.offset != offset || b.previous != previous || b.size == 0 || b.size % Granularity) return false;
+        if (b.free && previous != None && blocks[previous].free) return false;
+        if (b.free) free++;
+        else { used += b.size; live++; }
+        offset += b.size;
+    }
+    if (offset != stats.capacity || used != stats.used || live != stats.live) return false;
+
+    // Size-class lists: every entry free, in the right class, linked both ways, bits set
+    std::size_t listed = 0;
+    for (unsigned int first = 0; first < FirstLevels; first++)
+    for (unsigned int second = 0; second < SecondLevels; second++) {
+        bool bit = (firstBitmap >> first & 1) && (secondBitmap[first] >> second & 1);
+        if (bit != (heads[first][second] != None)) return false;
+        std::uint32_t before = None;
+        for (std::uint32_t i = heads[first][second]; i != None; before = i, i = blocks[i].nextFree) {
+            unsigned int f, s;
+            Mapping(blocks[i].size, f, s);
+            if (!blocks[i].free || f != first || s != second || blocks[i].previousFree != before) return false;
+            listed++;
+        }
+    }
+    return listed == free;
+}
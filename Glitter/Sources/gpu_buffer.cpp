@@ -0,0 +1,205 @@
+#include "gpu_buffer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+StreamBuffer::StreamBuffer(GLenum target, std::size_t capacity)
+    : ring(capacity), target(target), buffer(0), mapped(nullptr), persistent(false),
+      frame(0), waits(0), waitMilliseconds(0.0), flushed(0) {
+    glGenBuffers(1, &buffer);
+    glBindBuffer(target, buffer);
+    if (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(target, capacity, nullptr, flags);
+        mapped = static_cast<unsigned char *>(glMapBufferRange(target, 0, capacity, flags));
+        persistent = mapped != nullptr;
+    }
+    if (!persistent) {
+        glBufferData(target, capacity, nullptr, GL_STREAM_DRAW);
+        shadow.resize(capacity);
+        mapped = shadow.data();
+    }
+    glBindBuffer(target, 0);
+}
+
+StreamBuffer::~StreamBuffer() {
+    for (auto & fence : fences) glDeleteSync(fence.second);
+    if (persistent) {
+        glBindBuffer(target, buffer);
+        glUnmapBuffer(target);
+        glBindBuffer(target, 0);
+    }
+    glDeleteBuffers(1, &buffer);
+}
+
+StreamBuffer::Span StreamBuffer::Allocate(std::size_t size, std::size_t alignment) {
+    // Take back whatever the GPU has finished with, and only wait when that is not enough
+    Reclaim(false);
+    std::size_t offset = ring.Allocate(size, alignment);
+    while (offset == InvalidOffset && ring.Pending()) {
+        Reclaim(true);
+        offset = ring.Allocate(size, alignment);
+    }
+
+    Span span = { nullptr, 0, 0 };
+    if (offset == InvalidOffset) {
+        fprintf(stderr, "Stream Buffer Cannot Fit %zu Bytes in One Frame\n", size);
+        return span;
+    }
+    if (!persistent) {
+        if (!dirty.empty() && dirty.back().first + dirty.back().second == offset)
+            dirty.back().second += size;
+        else dirty.push_back(std::make_pair(offset, size));
+    }
+    span.data = mapped + offset;
+    span.offset = static_cast<GLintptr>(offset);
+    span.size = static_cast<GLsizeiptr>(size);
+    return span;
+}
+
+GLintptr StreamBuffer::Write(const void * data, std::size_t size, std::size_t alignment) {
+    Span span = Allocate(size, alignment);
+    if (!span.data) return -1;
+    std::memcpy(span.data, data, size);
+    return span.offset;
+}
+
+void StreamBuffer::Flush() {
+    if (dirty.empty()) return;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    for (auto & range : dirty) {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, range.first, range.second, shadow.data() + range.first);
+        flushed += range.second;
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    dirty.clear();
+}
+
+void StreamBuffer::Advance() {
+    // Writes nobody flushed would otherwise be lost when the space comes back
+    Flush();
+    ring.Fence(frame);
+    fences.push_back(std::make_pair(frame, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)));
+    frame++;
+}
+
+void StreamBuffer::Reclaim(bool wait) {
+    // Fences signal in submission order, so stop at the first one still pending
+    while (!fences.empty()) {
+        GLsync fence = fences.front().second;
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            if (!wait) return;
+            auto start = std::chrono::steady_clock::now();
+            while (status == GL_TIMEOUT_EXPIRED)
+                status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            waitMilliseconds += std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+            waits++;
+            wait = false;
+        }
+        glDeleteSync(fence);
+        ring.Release(fences.front().first);
+        fences.pop_front();
+    }
+}
+
+StreamBuffer::Stats StreamBuffer::GetStats() const {
+    Stats stats = { ring.Stats(), waits, waitMilliseconds, flushed };
+    return stats;
+}
+
+BufferHeap::BufferHeap(std::size_t pageSize) : pageSize(pageSize), used(0), peak(0), failures(0) {}
+
+BufferHeap::~BufferHeap() {
+    for (auto & page : pages)
+        if (page) glDeleteBuffers(1, &page->buffer);
+}
+
+BufferHeap & BufferHeap::Default() {
+    static BufferHeap * heap = new BufferHeap();
+    return *heap;
+}
+
+BufferHeap::Allocation BufferHeap::Allocate(std::size_t size, std::size_t alignment, const void * data) {
+    Allocation allocation;
+    std::uint32_t index = 0;
+    for (; index < pages.size(); index++) {
+        if (!pages[index]) continue;
+        allocation.block = pages[index]->allocator.Allocate(size, alignment);
+        if (allocation.block.Valid()) break;
+    }
+
+    // Every page is full: open a new one, sized for the request if it is unusually large
+    if (index == pages.size()) {
+        std::size_t capacity = std::max(pageSize, size + std::max(alignment, TlsfAllocator::Granularity));
+        std::unique_ptr<Page> page(new Page(capacity));
+        allocation.block = page->allocator.Allocate(size, alignment);
+        if (!allocation.block.Valid()) {
+            failures++;
+            return Allocation();
+        }
+        glGenBuffers(1, &page->buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, page->buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, page->allocator.Capacity(), nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        auto empty = std::find(pages.begin(), pages.end(), nullptr);
+        index = static_cast<std::uint32_t>(empty - pages.begin());
+        if (empty == pages.end()) pages.push_back(std::move(page));
+        else *empty = std::move(page);
+    }
+
+    allocation.buffer = pages[index]->buffer;
+    allocation.offset = static_cast<GLintptr>(allocation.block.offset);
+    allocation.size = size;
+    allocation.page = index;
+    used += allocation.block.size;
+    peak = std::max(peak, used);
+    if (data) Upload(allocation, data, size);
+    return allocation;
+}
+
+void BufferHeap::Upload(const Allocation & allocation, const void * data, std::size_t size, std::size_t offset) {
+    // The copy target leaves whatever vertex array is bound untouched
+    glBindBuffer(GL_COPY_WRITE_BUFFER, allocation.buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, allocation.offset + offset, size, data);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void BufferHeap::Free(Allocation & allocation) {
+    if (!allocation.Valid()) return;
+    Page & page = *pages[allocation.page];
+    page.allocator.Free(allocation.block);
+    used -= allocation.block.size;
+
+    // Oversized pages hold a single allocation; give their memory back right away
+    if (page.allocator.Capacity() > pageSize && page.allocator.Live() == 0) {
+        glDeleteBuffers(1, &page.buffer);
+        pages[allocation.page].reset();
+    }
+    allocation = Allocation();
+}
+
+AllocatorStats BufferHeap::Stats() const {
+    AllocatorStats total;
+    for (auto & page : pages) {
+        if (!page) continue;
+        AllocatorStats stats = page->allocator.Stats();
+        total.capacity += stats.capacity;
+        total.live += stats.live;
+        total.freeBlocks += stats.freeBlocks;
+        total.largestFree = std::max(total.largestFree, stats.largestFree);
+        total.allocations += stats.allocations;
+    }
+    total.used = used;
+    total.peak = peak;
+    total.failures = failures;
+    return total;
+}
+
+std::size_t BufferHeap::Pages() const {
+    return pages.size() - std::count(pages.begin(), pages.end(), nullptr);
+}
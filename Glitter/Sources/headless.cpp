@@ -0,0 +1,134 @@
+#include "headless.hpp"
+
+// CMake defines GLITTER_HEADLESS when it finds libEGL
+#ifdef GLITTER_HEADLESS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include <cstdio>
+#include <cstring>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+namespace {
+    // EGL_NO_DISPLAY and EGL_NO_CONTEXT are both null; named here so the
+    // constructor builds without EGL's headers
+    void * const NoDisplay = nullptr;
+    void * const NoContext = nullptr;
+}
+
+HeadlessContext::HeadlessContext()
+    : Width(0), Height(0), display(NoDisplay), context(NoContext),
+      framebuffer(0), color(0), depth(0) {}
+
+HeadlessContext::~HeadlessContext() {
+#ifdef GLITTER_HEADLESS
+    if (context != EGL_NO_CONTEXT) {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &color);
+        glDeleteRenderbuffers(1, &depth);
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+    }
+    if (display != EGL_NO_DISPLAY) eglTerminate(display);
+#endif
+}
+
+bool HeadlessContext::Create(int width, int height) {
+    Width = width;
+    Height = height;
+#ifndef GLITTER_HEADLESS
+    fprintf(stderr, "ERROR::HEADLESS::BUILT_WITHOUT_EGL\n");
+    return false;
+#else
+
+    // Mesa's surfaceless platform needs no X11, Wayland or DRM device
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (getPlatformDisplay) display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY) display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        fprintf(stderr, "ERROR::HEADLESS::EGL_INITIALIZE_FAILED 0x%x\n", eglGetError());
+        return false;
+    }
+    const char * extensions = eglQueryString(display, EGL_EXTENSIONS);
+    if (!extensions || !strstr(extensions, "EGL_KHR_surfaceless_context")) {
+        fprintf(stderr, "ERROR::HEADLESS::SURFACELESS_CONTEXT_UNSUPPORTED\n");
+        return false;
+    }
+
+    const EGLint configAttributes[] = {
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_SURFACE_TYPE, 0,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint count = 0;
+    if (!eglBindAPI(EGL_OPENGL_API)
+        || !eglChooseConfig(display, configAttributes, &config, 1, &count) || count == 0) {
+        fprintf(stderr, "ERROR::HEADLESS::EGL_CONFIG_FAILED 0x%x\n", eglGetError());
+        return false;
+    }
+
+    // Same version and profile as the windowed path
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 1,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        fprintf(stderr, "ERROR::HEADLESS::EGL_CONTEXT_FAILED 0x%x\n", eglGetError());
+        return false;
+    }
+    gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress));
+
+    glGenRenderbuffers(1, &color);
+    glBindRenderbuffer(GL_RENDERBUFFER, color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        fprintf(stderr, "ERROR::HEADLESS::FRAMEBUFFER_INCOMPLETE\n");
+        return false;
+    }
+    glViewport(0, 0, width, height);
+    return true;
+#endif
+}
+
+void HeadlessContext::ReadPixels(std::vector<unsigned char> & pixels) const {
+    std::size_t stride = static_cast<std::size_t>(Width) * 3;
+    pixels.resize(stride * Height);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, Width, Height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    // OpenGL rows start at the bottom; images start at the top
+    std::vector<unsigned char> row(stride);
+    for (int y = 0; y < Height / 2; y++) {
+        unsigned char * top = &pixels[y * stride];
+        unsigned char * bottom = &pixels[(Height - 1 - y) * stride];
+        std::memcpy(row.data(), top, stride);
+        std::memcpy(top, bottom, stride);
+        std::memcpy(bottom, row.data(), stride);
+    }
+}
+
+bool HeadlessContext::WriteImage(const std::string & path) const {
+    std::vector<unsigned char> pixels;
+    ReadPixels(pixels);
+    return stbi_write_png(path.c_str(), Width, Height, 3, pixels.data(), Width * 3) != 0;
+}
@@ -0,0 +1,275 @@
+#include "job_system.hpp"
+
+#include <algorithm>
+#include <utility>
+
+struct JobSystem::Job {
+    Task task;
+    Counter * counter;
+};
+
+std::atomic<std::uint64_t> JobSystem::systems(0);
+thread_local JobSystem::Worker * JobSystem::currentWorker = nullptr;
+thread_local std::uint64_t JobSystem::currentSystem = 0;
+
+namespace {
+    // Failed searches before a worker goes to sleep; each one yields
+    const int SpinLimit = 64;
+
+    // Victim choice for threads that are not workers
+    thread_local std::uint32_t externalRandom = 0x9e3779b9u;
+
+    std::uint32_t xorshift(std::uint32_t & state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+}
+
+JobSystem::Deque::Deque() : top(0), bottom(0), buffer(new std::atomic<Job *>[Capacity]) {
+    for (std::int64_t i = 0; i < Capacity; i++) buffer[i].store(nullptr, std::memory_order_relaxed);
+}
+
+// Owner only
+bool JobSystem::Deque::Push(Job * job) {
+    std::int64_t b = bottom.load(std::memory_order_relaxed);
+    std::int64_t t = top.load(std::memory_order_acquire);
+    if (b - t >= Capacity) return false;
+    buffer[b & (Capacity - 1)].store(job, std::memory_order_relaxed);
+    bottom.store(b + 1, std::memory_order_release);
+    return true;
+}
+
+// Owner only; races thieves for the last job through top
+JobSystem::Job * JobSystem::Deque::Pop() {
+    std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_seq_cst);
+    std::int64_t t = top.load(std::memory_order_seq_cst);
+    if (t > b) {
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    Job * job = buffer[b & (Capacity - 1)].load(std::memory_order_relaxed);
+    if (t == b) {
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            job = nullptr;
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+// Any thread; null when empty or when another thief won
+JobSystem::Job * JobSystem::Deque::Steal() {
+    std::int64_t t = top.load(std::memory_order_seq_cst);
+    std::int64_t b = bottom.load(std::memory_order_seq_cst);
+    if (t >= b) return nullptr;
+    Job * job = buffer[t & (Capacity - 1)].load(std::memory_order_relaxed);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;
+    return job;
+}
+
+JobSystem::JobSystem(unsigned int count)
+    : previousWorker(currentWorker), previousSystem(currentSystem), id(++systems),
+      injectedCount(0), queued(0), outstanding(0), external(0), submitted(0), sleeping(0), stopping(false) {
+    for (unsigned int i = 0; i <= count; i++) {
+        workers.emplace_back(new Worker);
+        workers.back()->random = 2654435761u * (i + 1);
+    }
+    currentWorker = workers.front().get();
+    currentSystem = id;
+    // Start only once every deque exists, since workers steal from all of them
+    for (std::size_t i = 1; i < workers.size(); i++)
+        workers[i]->thread = std::thread(&JobSystem::Run, this, workers[i].get());
+}
+
+JobSystem::~JobSystem() {
+    Worker * self = Current();
+    while (outstanding.load(std::memory_order_acquire) > 0) {
+        if (Job * job = Find(self)) Execute(job, self);
+        else std::this_thread::yield();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    signal.notify_all();
+    for (std::size_t i = 1; i < workers.size(); i++) workers[i]->thread.join();
+    if (currentSystem == id) {
+        currentWorker = previousWorker;
+        currentSystem = previousSystem;
+    }
+}
+
+void JobSystem::Spawn(Task task, Counter * counter) {
+    if (counter) counter->value.fetch_add(1, std::memory_order_relaxed);
+    outstanding.fetch_add(1, std::memory_order_relaxed);
+    Enqueue(new Job{std::move(task), counter});
+}
+
+void JobSystem::After(Counter & dependency, Task task, Counter * counter) {
+    if (counter) counter->value.fetch_add(1, std::memory_order_relaxed);
+    outstanding.fetch_add(1, std::memory_order_relaxed);
+    Job * job = new Job{std::move(task), counter};
+    {
+        // Finish() drops the count to zero under this lock, so the job is either
+        // parked before the last decrement or the dependency is already done
+        std::lock_guard<std::mutex> lock(dependency.mutex);
+        if (dependency.value.load(std::memory_order_acquire) > 0) {
+            dependency.continuations.push_back(job);
+            return;
+        }
+    }
+    Enqueue(job);
+}
+
+void JobSystem::Wait(Counter & counter) {
+    Worker * self = Current();
+    while (!counter.Done()) {
+        if (Job * job = Find(self)) Execute(job, self);
+        else std::this_thread::yield();
+    }
+    // Let the last Finish() release the counter before the caller may destroy it
+    std::lock_guard<std::mutex> lock(counter.mutex);
+}
+
+void JobSystem::ParallelFor(std::size_t first, std::size_t last, std::size_t grain, const Range & body) {
+    if (first >= last) return;
+    Counter counter;
+    Split(first, last, std::max<std::size_t>(grain, 1), body, counter);
+    Wait(counter);
+}
+
+// Keep the left half and spawn the right until one grain is left; thieves
+// take the oldest, and so largest, halves first
+void JobSystem::Split(std::size_t first, std::size_t last, std::size_t grain, const Range & body, Counter & counter) {
+    while (last - first > grain) {
+        std::size_t middle = first + (last - first) / 2;
+        Spawn([this, middle, last, grain, &body, &counter]() { Split(middle, last, grain, body, counter); }, &counter);
+        last = middle;
+    }
+    body(first, last);
+}
+
+JobSystem::Stats JobSystem::Statistics() const {
+    Stats stats;
+    stats.executed = external.load(std::memory_order_relaxed);
+    stats.injected = submitted.load(std::memory_order_relaxed);
+    for (auto & worker : workers) {
+        stats.executed += worker->executed.load(std::memory_order_relaxed);
+        stats.stolen += worker->stolen.load(std::memory_order_relaxed);
+        stats.inlined += worker->inlined.load(std::memory_order_relaxed);
+        stats.sleeps += worker->sleeps.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+unsigned int JobSystem::DefaultWorkers() {
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 0;
+}
+
+void JobSystem::Run(Worker * self) {
+    currentWorker = self;
+    currentSystem = id;
+    for (int misses = 0;;) {
+        if (Job * job = Find(self)) {
+            Execute(job, self);
+            misses = 0;
+        } else if (++misses < SpinLimit) {
+            std::this_thread::yield();
+        } else {
+            // Enqueue() bumps queued before it reads sleeping, and a sleeper bumps
+            // sleeping before it reads queued, so one of them always sees the other
+            std::unique_lock<std::mutex> lock(mutex);
+            sleeping.fetch_add(1, std::memory_order_seq_cst);
+            if (queued.load(std::memory_order_seq_cst) <= 0 && !stopping) {
+                self->sleeps.fetch_add(1, std::memory_order_relaxed);
+                signal.wait(lock, [this]() { return stopping || queued.load(std::memory_order_seq_cst) > 0; });
+            }
+            sleeping.fetch_sub(1, std::memory_order_relaxed);
+            if (stopping && queued.load(std::memory_order_acquire) <= 0) return;
+            misses = 0;
+        }
+    }
+}
+
+void JobSystem::Enqueue(Job * job) {
+    queued.fetch_add(1, std::memory_order_seq_cst);
+    Worker * self = Current();
+    if (self) {
+        if (!self->deque.Push(job)) {
+            // A full deque means plenty of parallel slack already; run it here
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            self->inlined.fetch_add(1, std::memory_order_relaxed);
+            Execute(job, self);
+            return;
+        }
+    } else {
+        std::lock_guard<std::mutex> lock(injectedMutex);
+        injected.push_back(job);
+        injectedCount.fetch_add(1, std::memory_order_release);
+        submitted.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (sleeping.load(std::memory_order_seq_cst) > 0) {
+        // Taking the lock orders this notify after a sleeper's predicate check
+        { std::lock_guard<std::mutex> lock(mutex); }
+        signal.notify_one();
+    }
+}
+
+void JobSystem::Execute(Job * job, Worker * self) {
+    job->task();
+    Counter * counter = job->counter;
+    delete job;
+    if (counter) Finish(*counter);
+    if (self) self->executed.fetch_add(1, std::memory_order_relaxed);
+    else external.fetch_add(1, std::memory_order_relaxed);
+    outstanding.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void JobSystem::Finish(Counter & counter) {
+    // Counts above one drop without the lock; nobody can be waiting on them yet
+    int value = counter.value.load(std::memory_order_relaxed);
+    while (value > 1)
+        if (counter.value.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+            return;
+
+    std::vector<Job *> ready;
+    {
+        std::lock_guard<std::mutex> lock(counter.mutex);
+        if (counter.value.fetch_sub(1, std::memory_order_acq_rel) == 1) ready.swap(counter.continuations);
+    }
+    // The counter may be gone by now; only the parked jobs are touched
+    for (Job * job : ready) Enqueue(job);
+}
+
+JobSystem::Job * JobSystem::Find(Worker * self) {
+    Job * job = self ? self->deque.Pop() : nullptr;
+    if (!job && injectedCount.load(std::memory_order_acquire) > 0) {
+        std::lock_guard<std::mutex> lock(injectedMutex);
+        if (!injected.empty()) {
+            job = injected.front();
+            injected.pop_front();
+            injectedCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+    if (!job) {
+        // Sweep every victim once from a random start
+        std::uint32_t seed = xorshift(self ? self->random : externalRandom);
+        std::size_t start = seed % workers.size();
+        for (std::size_t i = 0; i < workers.size() && !job; i++) {
+            Worker * victim = workers[(start + i) % workers.size()].get();
+            if (victim == self) continue;
+            job = victim->deque.Steal();
+            if (job && self) self->stolen.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (job) queued.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+}
+
+JobSystem::Worker * JobSystem::Current() const {
+    return currentSystem == id ? currentWorker : nullptr;
+}
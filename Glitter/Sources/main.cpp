@@ -11,51 +11,105 @@
 #include "stb_image.h"
 
 // Standard Headers
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <cache.hpp>
+#include <compress.hpp>
+#include <frame_pipeline.hpp>
+#include <gpu_buffer.hpp>
+#include <headless.hpp>
+#include <job_system.hpp>
+#include <package.hpp>
+#include <profiler.hpp>
 #include <shader.hpp>
+#include <shader_watcher.hpp>
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 
-void loadTexture(std::string const & filename);
+// Decoded Pixels, or Prebuilt Compressed Levels, Waiting for a Context to Upload Them
+struct Image {
+    unsigned char * pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    Mirage::CompressedImage compressed;
+};
 
-int main(int argc, char * argv[]) {
-    
-    // Load GLFW and Create a Window
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-    glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
-    
-    auto window = glfwCreateWindow(mWidth, mHeight, "OpenGL", nullptr, nullptr);
-    glfwSetKeyCallback(window, key_callback);
+Image decodeTexture(std::string const & filename);
+void uploadTexture(Image & image);
 
-    // Check for Valid Context
-    if (window == nullptr) {
-        fprintf(stderr, "Failed to Create OpenGL Context");
+// Command Line Options; Windowed Unless --headless Is Given
+struct Options {
+    bool headless = false;
+    int frames = 300;
+    int warmup = 10;
+    int width = mWidth;
+    int height = mHeight;
+    int framesInFlight = 2;
+    int triangles = 0;
+    std::string dump;
+    std::string json;
+};
+
+// Small Triangles Moved on the CPU Every Frame, So Update and Record Have Work to Overlap
+struct Swarm {
+    std::vector<glm::vec2> positions;
+    std::vector<glm::vec2> velocities;
+    std::vector<std::vector<glm::vec2>> snapshots; // Per Pipeline Slot, Read by Record
+    std::vector<GLfloat> multipliers;             // Per Pipeline Slot, Read by Submit
+    double time = 0.0;
+};
+
+// Interleaved Position and Color, Like the Scene Triangle
+const std::size_t SwarmVertexBytes = 6 * sizeof(GLfloat);
+
+bool parseOptions(int argc, char * argv[], Options & options);
+GLFWwindow * createWindow(Options const & options);
+void createSwarm(Swarm & swarm, int triangles, int framesInFlight);
+void updateSwarm(Swarm & swarm, FramePipeline::Frame & frame);
+void recordSwarm(Swarm & swarm, FramePipeline::Frame & frame, JobSystem & jobs);
+void drawScene(Shader & shader, GLint multiplierLocation, GLuint VAO, GLfloat multiplier);
+void drawSwarm(FramePipeline::Frame const & frame, GLuint VAO, GLuint buffer);
+FramePipeline::Timings averageTimings(std::vector<FramePipeline::Timings> const & history, std::size_t count);
+void reportPipeline(FILE * out, FramePipeline const & pipeline, std::size_t frames);
+const char * glString(GLenum name);
+std::string escapeJson(const char * text);
+int runBenchmark(Options const & options, Shader & shader, FramePipeline & pipeline, bool const & failed);
+
+int main(int argc, char * argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        fprintf(stderr, "Usage: %s [--headless] [--frames N] [--warmup N] [--size WxH] [--frames-in-flight N] "
+                        "[--triangles N] [--dump DIR] [--json FILE]\n", argv[0]);
         return EXIT_FAILURE;
     }
 
-    // Create Context and Load OpenGL Functions
-    glfwMakeContextCurrent(window);
-    gladLoadGL();
-    fprintf(stderr, "OpenGL %s\n", glGetString(GL_VERSION));
+    // Decode textures on the workers while the context comes up and the
+    // shader compiles; only the upload has to wait for both
+    Image container;
+    JobSystem::Counter decoded;
+    JobSystem jobs(std::max(JobSystem::DefaultWorkers(), 1u)); // The frame pipeline needs a worker to overlap with
+    jobs.Spawn([&container]() { container = decodeTexture("../Textures/container.jpg"); }, &decoded);
+
+    // Render Offscreen Without a Window System
+    HeadlessContext headless;
+    GLFWwindow * window = nullptr;
+    if (options.headless) {
+        if (!headless.Create(options.width, options.height)) {
+            fprintf(stderr, "Failed to Create Headless OpenGL Context\n");
+            return EXIT_FAILURE;
+        }
+    } else if ((window = createWindow(options)) == nullptr) {
+        return EXIT_FAILURE;
+    }
+    fprintf(stderr, "OpenGL %s\n", glString(GL_VERSION));
 
     GLint nrAttributes;
     glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &nrAttributes);
     fprintf(stderr, "Maximum nr of vertex attributes supported: %d\n", nrAttributes);
 
-    // Define the viewport dimensions
-    int width, height;
-    glfwGetFramebufferSize(window, &width, &height);
-    glViewport(0, 0, width, height);
-
-    //=========================================================
-    // Texture loading
-    //=========================================================
-    loadTexture("../Textures/container.jpg");
     //=========================================================
     // Init objects
     //=========================================================
@@ -73,67 +127,455 @@ int main(int argc, char * argv[]) {
             0.5f, 1.0f // Top-center corner
     };
 
-    GLuint VAO, VBO;
+    // Sub-allocated from the shared heap rather than a buffer of its own
+    GLuint VAO;
     glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    
+    BufferHeap::Allocation VBO = BufferHeap::Default().Allocate(sizeof(vertices), 16, vertices);
+
     glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO.buffer);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(VBO.offset));
     glEnableVertexAttribArray(0);
 
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(VBO.offset + 3 * sizeof(GLfloat)));
     glEnableVertexAttribArray(1);
 
     glBindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     Shader ourShader("../Shaders/shader.vert", "../Shaders/shader.frag");
+    fprintf(stdout, "Shader program ready in %.2f ms (%s)\n", ourShader.LinkMilliseconds,
+            ourShader.Cached ? "binary cache" : "compiled from source");
+    GLint multiplierLocation = ourShader.Uniform(Shader::Hash("multiplier"));
+
+    //=========================================================
+    // Texture loading
+    //=========================================================
+    jobs.Wait(decoded);
+    uploadTexture(container);
 
-    while (!glfwWindowShouldClose(window)) {
+    // Update and record the next frames on the workers while this one is
+    // submitted; each frame in flight gets its own fenced slot of vertices
+    Swarm swarm;
+    createSwarm(swarm, options.triangles, options.framesInFlight);
+    GLuint swarmVAO, swarmBuffer = 0;
+    glGenVertexArrays(1, &swarmVAO);
+
+    ShaderWatcher * watcher = nullptr;
+    bool failed = false;
+    FramePipeline::Stages stages;
+    stages.sample = [&](FramePipeline::Frame & frame) {
+        if (options.headless) {
+            frame.time = frame.index / 60.0;
+            return;
+        }
+        PROFILE_SCOPE("PollEvents");
         glfwPollEvents();
-        
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-
-        ourShader.Use();
-
-        GLfloat timeValue = glfwGetTime();
-        GLfloat multiplierValue = (sin(timeValue) / 2) + 0.5;
-        GLint multiplierLocation = glGetUniformLocation(ourShader.Program, "multiplier");
-        glUniform1f(multiplierLocation, multiplierValue);
-
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
-        glBindVertexArray(0);
-        
-        // Flip Buffers and Draw
-        glfwSwapBuffers(window);
+        if (watcher && watcher->Poll() > 0) {
+            multiplierLocation = ourShader.Uniform(Shader::Hash("multiplier"));
+        }
+        frame.time = glfwGetTime();
+    };
+    stages.update = [&](FramePipeline::Frame & frame) { updateSwarm(swarm, frame); };
+    stages.record = [&](FramePipeline::Frame & frame) { recordSwarm(swarm, frame, jobs); };
+    stages.submit = [&](FramePipeline::Frame & frame) {
+        drawScene(ourShader, multiplierLocation, VAO, swarm.multipliers[frame.slot]);
+        drawSwarm(frame, swarmVAO, swarmBuffer);
+    };
+    unsigned long presented = 0;
+    stages.present = [&]() {
+        PROFILE_SCOPE("SwapBuffers");
+        unsigned long frame = presented++;
+        if (!options.headless) {
+            glfwSwapBuffers(window);
+            return;
+        }
+        // Nothing swaps a headless context, so make sure the driver starts on the frame
+        glFlush();
+        unsigned long first = options.warmup, last = first + options.frames;
+        if (options.dump.empty() || frame < first || frame >= last || failed) return;
+        char name[32];
+        snprintf(name, sizeof(name), "/frame_%05lu.png", frame - options.warmup);
+        if (!headless.WriteImage(options.dump + name)) {
+            fprintf(stderr, "Failed to Write %s%s\n", options.dump.c_str(), name);
+            failed = true;
+        }
+    };
+
+    int result = EXIT_SUCCESS;
+    {
+        // Scoped So the Pipeline Deletes Its Buffer and Fences While the Context Lives
+        std::size_t slotBytes = swarm.positions.size() * 3 * SwarmVertexBytes;
+        FramePipeline pipeline(jobs, stages, slotBytes, options.framesInFlight);
+        swarmBuffer = pipeline.Buffer();
+        fprintf(stderr, "%u frames in flight, %d triangles streamed through a %s buffer\n",
+                pipeline.FramesInFlight(), options.triangles, pipeline.Persistent() ? "persistently mapped" : "shadowed");
+
+        if (options.headless) {
+            result = runBenchmark(options, ourShader, pipeline, failed);
+        } else {
+            // Edit Glitter/Shaders/ while running; changes go live at the next frame
+            ShaderWatcher shaderWatcher(window, PROJECT_SOURCE_DIR "/Glitter/Shaders");
+            shaderWatcher.Watch(ourShader);
+            watcher = &shaderWatcher;
+
+            unsigned long frame = 0;
+            while (!glfwWindowShouldClose(window)) {
+                pipeline.Step();
+                PROFILE_FRAME();
+                if (++frame % 600 == 0) {
+                    PROFILE_SUMMARY(stdout);
+                    reportPipeline(stdout, pipeline, pipeline.History().size());
+                    pipeline.Reset();
+                }
+            }
+            pipeline.Drain();
+            watcher = nullptr;
+            PROFILE_EXPORT("glitter_trace.json");
+        }
     }
+    glDeleteVertexArrays(1, &swarmVAO);
     glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    
-    glfwTerminate();
+    BufferHeap::Default().Free(VBO);
+
+    if (!options.headless) glfwTerminate();
+    return result;
+}
+
+GLFWwindow * createWindow(Options const & options) {
+    // Load GLFW and Create a Window
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
+
+    auto window = glfwCreateWindow(options.width, options.height, "OpenGL", nullptr, nullptr);
+
+    // Check for Valid Context
+    if (window == nullptr) {
+        fprintf(stderr, "Failed to Create OpenGL Context");
+        return nullptr;
+    }
+    glfwSetKeyCallback(window, key_callback);
+
+    // Create Context and Load OpenGL Functions
+    glfwMakeContextCurrent(window);
+    gladLoadGL();
+
+    // Define the viewport dimensions
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+    glViewport(0, 0, width, height);
+    return window;
+}
+
+bool parseOptions(int argc, char * argv[], Options & options) {
+    for (int i = 1; i < argc; i++) {
+        bool more = i + 1 < argc;
+        if (!strcmp(argv[i], "--headless")) {
+            options.headless = true;
+        } else if (!strcmp(argv[i], "--frames") && more) {
+            options.frames = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--warmup") && more) {
+            options.warmup = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--size") && more) {
+            if (sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2) return false;
+        } else if (!strcmp(argv[i], "--frames-in-flight") && more) {
+            options.framesInFlight = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--triangles") && more) {
+            options.triangles = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--dump") && more) {
+            options.dump = argv[++i];
+        } else if (!strcmp(argv[i], "--json") && more) {
+            options.json = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return options.frames > 0 && options.warmup >= 0 && options.width > 0 && options.height > 0
+        && options.framesInFlight > 0 && options.triangles >= 0;
+}
+
+void createSwarm(Swarm & swarm, int triangles, int framesInFlight) {
+    std::uint32_t seed = 12345;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (seed >> 8) / 8388608.0f - 1.0f;
+    };
+    for (int i = 0; i < triangles; i++) {
+        swarm.positions.push_back(glm::vec2(random(), random()));
+        swarm.velocities.push_back(glm::vec2(random(), random()) * 0.5f);
+    }
+    swarm.snapshots.resize(framesInFlight);
+    swarm.multipliers.resize(framesInFlight);
+}
+
+// Runs on a worker, after the previous frame's update and before its record
+void updateSwarm(Swarm & swarm, FramePipeline::Frame & frame) {
+    PROFILE_SCOPE("Update");
+    float step = static_cast<float>(std::min(std::max(frame.time - swarm.time, 0.0), 0.1));
+    swarm.time = frame.time;
+    for (std::size_t i = 0; i < swarm.positions.size(); i++) {
+        glm::vec2 & position = swarm.positions[i];
+        glm::vec2 & velocity = swarm.velocities[i];
+        position += velocity * step;
+        for (int axis = 0; axis < 2; axis++) {
+            if (position[axis] < -1.0f || position[axis] > 1.0f) {
+                position[axis] = std::min(std::max(position[axis], -1.0f), 1.0f);
+                velocity[axis] = -velocity[axis];
+            }
+        }
+    }
+
+    // The next update may start before this frame is recorded, so record reads a copy
+    swarm.snapshots[frame.slot] = swarm.positions;
+    swarm.multipliers[frame.slot] = static_cast<GLfloat>(sin(frame.time) / 2 + 0.5);
+}
+
+void recordSwarm(Swarm & swarm, FramePipeline::Frame & frame, JobSystem & jobs) {
+    PROFILE_SCOPE("Record");
+    std::vector<glm::vec2> const & positions = swarm.snapshots[frame.slot];
+    if (positions.empty() || !frame.data) return;
+    GLfloat * vertices = reinterpret_cast<GLfloat *>(frame.data);
+    jobs.ParallelFor(0, positions.size(), 4096, [&](std::size_t first, std::size_t last) {
+        const float size = 0.01f;
+        const glm::vec2 corners[] = { glm::vec2(size, -size), glm::vec2(-size, -size), glm::vec2(0.0f, size) };
+        for (std::size_t i = first; i < last; i++) {
+            glm::vec2 p = positions[i];
+            GLfloat * out = vertices + i * 18;
+            for (int corner = 0; corner < 3; corner++, out += 6) {
+                out[0] = p.x + corners[corner].x;
+                out[1] = p.y + corners[corner].y;
+                out[2] = 0.0f;
+                out[3] = p.x * 0.5f + 0.5f;
+                out[4] = p.y * 0.5f + 0.5f;
+                out[5] = corner * 0.5f;
+            }
+        }
+    });
+    frame.used = positions.size() * 3 * SwarmVertexBytes;
+}
+
+void drawScene(Shader & shader, GLint multiplierLocation, GLuint VAO, GLfloat multiplier) {
+    PROFILE_SCOPE("Draw");
+    PROFILE_GPU_SCOPE("Draw");
+    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    shader.Use();
+    glUniform1f(multiplierLocation, multiplier);
+
+    glBindVertexArray(VAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+void drawSwarm(FramePipeline::Frame const & frame, GLuint VAO, GLuint buffer) {
+    if (frame.used == 0) return;
+    PROFILE_SCOPE("DrawSwarm");
+    PROFILE_GPU_SCOPE("DrawSwarm");
+
+    // Every frame in flight has its own slot, so point the attributes at this one's
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, SwarmVertexBytes, (GLvoid*)(frame.offset));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, SwarmVertexBytes, (GLvoid*)(frame.offset + 3 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(frame.used / SwarmVertexBytes));
+}
+
+// Averages over the first count frames of the history
+FramePipeline::Timings averageTimings(std::vector<FramePipeline::Timings> const & history, std::size_t count) {
+    FramePipeline::Timings average;
+    count = std::min(count, history.size());
+    for (std::size_t i = 0; i < count; i++) {
+        FramePipeline::Timings const & t = history[i];
+        average.sample += t.sample;
+        average.update += t.update;
+        average.record += t.record;
+        average.submit += t.submit;
+        average.present += t.present;
+        average.recordWait += t.recordWait;
+        average.fenceWait += t.fenceWait;
+        average.frame += t.frame;
+        average.latency += t.latency;
+        average.completed += t.completed;
+    }
+    if (count == 0) return average;
+    double * fields[] = { &average.sample, &average.update, &average.record, &average.submit, &average.present,
+                          &average.recordWait, &average.fenceWait, &average.frame, &average.latency, &average.completed };
+    for (double * field : fields) *field /= count;
+    return average;
+}
+
+void reportPipeline(FILE * out, FramePipeline const & pipeline, std::size_t frames) {
+    FramePipeline::Timings average = averageTimings(pipeline.History(), frames);
+    fprintf(out, "Pipeline (%u in flight): %.2f ms/frame, latency %.2f ms to present, %.2f ms to GPU done\n",
+            pipeline.FramesInFlight(), average.frame, average.latency, average.completed);
+    fprintf(out, "  sample %.3f  update %.3f  record %.3f  submit %.3f  present %.3f  "
+                 "record wait %.3f  fence wait %.3f ms\n",
+            average.sample, average.update, average.record, average.submit, average.present,
+            average.recordWait, average.fenceWait);
+}
+
+// glGetString returns unsigned bytes, or null without a current context
+const char * glString(GLenum name) {
+    const char * value = reinterpret_cast<const char *>(glGetString(name));
+    return value ? value : "unknown";
+}
+
+// Quotes, backslashes and control characters would break the report
+std::string escapeJson(const char * text) {
+    std::string escaped;
+    for (const char * c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            escaped += '\\';
+            escaped += *c;
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned char>(*c));
+            escaped += code;
+        } else {
+            escaped += *c;
+        }
+    }
+    return escaped;
+}
+
+// Renders a fixed number of frames with a fixed timestep, so runs are
+// comparable, then prints a JSON summary. A frame's time runs from one
+// present to the next. With one frame in flight every frame waits for the
+// GPU before the next one is sampled, so it covers update, submission and
+// rendering; with more, the next frames update and record while this one
+// renders. Warm-up frames are not recorded; they absorb driver shader JIT
+// and first-touch allocations.
+int runBenchmark(Options const & options, Shader & shader, FramePipeline & pipeline, bool const & failed) {
+    for (int i = 0; i < options.warmup; i++) pipeline.Step();
+    pipeline.Reset();
+    for (int i = 0; i < options.frames && !failed; i++) {
+        pipeline.Step();
+        PROFILE_FRAME();
+    }
+    // Frames started ahead finish too, which fills in when the GPU completed the last ones
+    pipeline.Drain();
+    if (failed) return EXIT_FAILURE;
+
+    std::vector<FramePipeline::Timings> const & history = pipeline.History();
+    std::vector<double> frames, latencies, completions;
+    for (int i = 0; i < options.frames; i++) {
+        frames.push_back(history[i].frame);
+        latencies.push_back(history[i].latency);
+        completions.push_back(history[i].completed);
+    }
+    FramePipeline::Timings average = averageTimings(history, options.frames);
+
+    std::vector<double> sorted(frames);
+    std::sort(sorted.begin(), sorted.end());
+    std::sort(latencies.begin(), latencies.end());
+    std::sort(completions.begin(), completions.end());
+    double total = 0.0;
+    for (double frame : frames) total += frame;
+    auto percentile = [](std::vector<double> const & values, double p) {
+        return values[static_cast<size_t>((values.size() - 1) * p)];
+    };
+
+    FILE * out = options.json.empty() ? stdout : fopen(options.json.c_str(), "w");
+    if (!out) {
+        fprintf(stderr, "Failed to Open %s\n", options.json.c_str());
+        return EXIT_FAILURE;
+    }
+    fprintf(out, "{\n");
+    fprintf(out, "  \"renderer\": \"%s\",\n", escapeJson(glString(GL_RENDERER)).c_str());
+    fprintf(out, "  \"width\": %d,\n  \"height\": %d,\n  \"frames\": %d,\n  \"warmup\": %d,\n",
+            options.width, options.height, options.frames, options.warmup);
+    fprintf(out, "  \"frames_in_flight\": %u,\n  \"triangles\": %d,\n  \"persistent\": %s,\n",
+            pipeline.FramesInFlight(), options.triangles, pipeline.Persistent() ? "true" : "false");
+    fprintf(out, "  \"shader_ms\": %.3f,\n  \"shader_cached\": %s,\n",
+            shader.LinkMilliseconds, shader.Cached ? "true" : "false");
+    fprintf(out, "  \"frame_ms\": { \"min\": %.4f, \"avg\": %.4f, \"p50\": %.4f, "
+                 "\"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f },\n",
+            sorted.front(), total / frames.size(), percentile(sorted, 0.50),
+            percentile(sorted, 0.95), percentile(sorted, 0.99), sorted.back());
+    fprintf(out, "  \"stage_ms\": { \"sample\": %.4f, \"update\": %.4f, \"record\": %.4f, \"submit\": %.4f, "
+                 "\"present\": %.4f, \"record_wait\": %.4f, \"fence_wait\": %.4f },\n",
+            average.sample, average.update, average.record, average.submit, average.present,
+            average.recordWait, average.fenceWait);
+    fprintf(out, "  \"latency_ms\": { \"avg\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"max\": %.4f },\n",
+            average.latency, percentile(latencies, 0.50), percentile(latencies, 0.95), latencies.back());
+    fprintf(out, "  \"completed_ms\": { \"avg\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"max\": %.4f },\n",
+            average.completed, percentile(completions, 0.50), percentile(completions, 0.95), completions.back());
+    fprintf(out, "  \"fps\": %.2f,\n  \"samples\": [", 1000.0 * frames.size() / total);
+    for (size_t i = 0; i < frames.size(); i++) fprintf(out, "%s%.4f", i ? ", " : "", frames[i]);
+    fprintf(out, "]\n}\n");
+    if (out != stdout) fclose(out);
+    PROFILE_SUMMARY(stderr);
     return EXIT_SUCCESS;
 }
 
-void loadTexture(std::string const & filename) {
-    int width, height, channels;
-    unsigned char * image = stbi_load(filename.c_str(), &width, &height, &channels, 0);
-    if (!image) {
+// Needs no context, so it can run on any thread
+Image decodeTexture(std::string const & filename) {
+    // Prefer the block-compressed mip chain glitter_pack --dds stored beside
+    // the source; it is keyed by the source bytes, so a stale copy is skipped
+    Image image;
+    Package::Span packed = Package::Default().Find(filename);
+    Package::Span dds = Package::Default().Find(filename + ".dds");
+    if (packed.Valid() && dds.Valid() && Mirage::readDDS(dds.data, dds.size, image.compressed,
+                                                         Mirage::MeshCache::hash(packed.data, packed.size))) {
+        return image;
+    }
+
+    // Otherwise decode straight out of the mapped package when it has the file
+    int channels;
+    image.pixels = packed.Valid()
+        ? stbi_load_from_memory(packed.data, static_cast<int>(packed.size), &image.width, &image.height, &channels, 0)
+        : stbi_load(filename.c_str(), &image.width, &image.height, &channels, 0);
+    if (!image.pixels) {
         fprintf(stderr, "%s %s\n", "Failed to Load Texture", filename.c_str());
     }
+    return image;
+}
 
+void uploadTexture(Image & image) {
     GLuint texture;
     glGenTextures(1, &texture);
     glBindTexture(GL_TEXTURE_2D, texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    if (image.compressed.levels.empty()) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.pixels);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    } else {
+        // Every level is prebuilt; decode on the CPU only if the driver lacks the format
+        Mirage::CompressedImage const & compressed = image.compressed;
+        GLenum internal = compressed.internalFormat();
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+        std::vector<GLint> formats(std::max(count, 0));
+        if (count > 0) glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+        bool native = internal == GL_COMPRESSED_RED_RGTC1 || internal == GL_COMPRESSED_RG_RGTC2
+                   || std::find(formats.begin(), formats.end(), static_cast<GLint>(internal)) != formats.end();
+
+        std::vector<unsigned char> rgba;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(compressed.levels.size() - 1));
+        for (std::size_t i = 0; i < compressed.levels.size(); i++) {
+            Mirage::CompressedImage::Level const & level = compressed.levels[i];
+            if (native) {
+                glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), internal, level.width, level.height,
+                                       0, static_cast<GLsizei>(level.size), &compressed.data[level.offset]);
+            } else {
+                Mirage::decompress(compressed, i, rgba);
+                glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), GL_RGBA8, level.width, level.height,
+                             0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+            }
+        }
+        image.compressed = Mirage::CompressedImage();
+    }
     glBindTexture(GL_TEXTURE_2D, 0);
 
-    stbi_image_free(image);
+    stbi_image_free(image.pixels);
+    image.pixels = nullptr;
 }
 
 // Is called whenever a key is pressed/released via GLFW
@@ -0,0 +1,456 @@
+#include "package.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+    const std::uint32_t Magic = 0x4b415047; // "GPAK"
+    const std::size_t Alignment = 16;
+    const std::uint32_t Compressed = 1;
+
+    struct Header {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t count;
+        std::uint32_t namesSize;
+        std::uint64_t namesOffset;
+    };
+
+    std::uint64_t hash(const std::string & name) {
+        // 64-bit FNV-1a
+        std::uint64_t seed = 14695981039346656037ull;
+        for (unsigned char c : name) {
+            seed ^= c;
+            seed *= 1099511628211ull;
+        }
+        return seed;
+    }
+
+    std::size_t align(std::size_t offset) { return (offset + Alignment - 1) & ~(Alignment - 1); }
+
+    std::uint32_t load32(const unsigned char * p) {
+        std::uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    // Literal and match lengths of 15 and up spill into extra bytes of 255
+    void putLength(unsigned char *& out, std::size_t length) {
+        for (; length >= 255; length -= 255) *out++ = 255;
+        *out++ = static_cast<unsigned char>(length);
+    }
+
+    bool getLength(const unsigned char *& in, const unsigned char * end, std::size_t & length) {
+        unsigned char byte;
+        do {
+            if (in == end) return false;
+            byte = *in++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    }
+
+    void sequence(unsigned char *& out, const unsigned char * literals, std::size_t literalCount,
+                  std::size_t offset, std::size_t match) {
+        unsigned char * token = out++;
+        *token = static_cast<unsigned char>(std::min<std::size_t>(literalCount, 15) << 4);
+        if (literalCount >= 15) putLength(out, literalCount - 15);
+        if (literalCount > 0) std::memcpy(out, literals, literalCount);
+        out += literalCount;
+        if (match == 0) return; // The last sequence ends after its literals
+
+        *out++ = static_cast<unsigned char>(offset);
+        *out++ = static_cast<unsigned char>(offset >> 8);
+        match -= 4;
+        *token |= static_cast<unsigned char>(std::min<std::size_t>(match, 15));
+        if (match >= 15) putLength(out, match - 15);
+    }
+}
+
+std::size_t Lz4::Compress(const void * source, std::size_t size, void * destination, std::size_t capacity) {
+    if (capacity < Bound(size)) return 0;
+    const unsigned char * in = static_cast<const unsigned char *>(source);
+    unsigned char * out = static_cast<unsigned char *>(destination);
+
+    // The spec keeps the last five bytes literal and starts no match in the last twelve
+    const std::size_t HashBits = 14, MinMatch = 4, LastLiterals = 5, MatchLimit = 12;
+    std::vector<std::uint32_t> table(std::size_t(1) << HashBits, 0);
+    std::size_t anchor = 0, position = 1, misses = 0;
+    while (size > MatchLimit && position < size - MatchLimit) {
+        std::uint32_t sequence4 = load32(in + position);
+        std::uint32_t slot = (sequence4 * 2654435761u) >> (32 - HashBits);
+        std::size_t candidate = table[slot];
+        table[slot] = static_cast<std::uint32_t>(position);
+        if (candidate >= position || position - candidate > 65535 || load32(in + candidate) != sequence4) {
+            // Skip ahead faster through data that does not compress
+            position += 1 + (misses++ >> 6);
+            continue;
+        }
+        misses = 0;
+
+        std::size_t match = MinMatch;
+        while (position + match < size - LastLiterals && in[candidate + match] == in[position + match]) match++;
+        sequence(out, in + anchor, position - anchor, position - candidate, match);
+        position += match;
+        anchor = position;
+    }
+    sequence(out, in + anchor, size - anchor, 0, 0);
+    return static_cast<std::size_t>(out - static_cast<unsigned char *>(destination));
+}
+
+bool Lz4::Decompress(const void * source, std::size_t size, void * destination, std::size_t decoded) {
+    const unsigned char * in = static_cast<const unsigned char *>(source);
+    const unsigned char * end = in + size;
+    unsigned char * out = static_cast<unsigned char *>(destination);
+    unsigned char * begin = out;
+    unsigned char * limit = out + decoded;
+    while (in < end) {
+        unsigned char token = *in++;
+        std::size_t literals = token >> 4;
+        if (literals == 15 && !getLength(in, end, literals)) return false;
+        if (literals > std::size_t(end - in) || literals > std::size_t(limit - out)) return false;
+        if (literals > 0) std::memcpy(out, in, literals);
+        in += literals;
+        out += literals;
+        if (in == end) break;
+
+        if (end - in < 2) return false;
+        std::size_t offset = in[0] | (std::size_t(in[1]) << 8);
+        in += 2;
+        std::size_t match = token & 15;
+        if (match == 15 && !getLength(in, end, match)) return false;
+        match += 4;
+        if (offset == 0 || offset > std::size_t(out - begin) || match > std::size_t(limit - out)) return false;
+
+        // Overlapping copies repeat the bytes just written, so go one at a time
+        const unsigned char * from = out - offset;
+        if (offset >= match) std::memcpy(out, from, match);
+        else for (std::size_t i = 0; i < match; i++) out[i] = from[i];
+        out += match;
+    }
+    return out == limit;
+}
+
+struct Package::Entry {
+    std::uint64_t hash;
+    std::uint64_t offset;
+    std::uint64_t stored;
+    std::uint64_t size;
+    std::uint32_t name;
+    std::uint32_t length;
+    std::uint32_t flags;
+    std::uint32_t reserved;
+};
+
+bool Package::Open(const std::string & filename, const std::string & directory) {
+    Close();
+#ifdef _WIN32
+    std::ifstream fd(filename, std::ios::binary);
+    if (!fd) return false;
+    fallback.assign(std::istreambuf_iterator<char>(fd), std::istreambuf_iterator<char>());
+    data = fallback.data();
+    size = fallback.size();
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void * address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) return false;
+    data = static_cast<unsigned char *>(address);
+    size = static_cast<std::size_t>(info.st_size);
+#endif
+
+    // Check every range once here so lookups can trust the index
+    Header header;
+    bool valid = size >= sizeof(Header);
+    if (valid) {
+        std::memcpy(&header, data, sizeof(header));
+        valid = header.magic == Magic && header.version == Version
+             && (size - sizeof(Header)) / sizeof(Entry) >= header.count
+             && header.namesOffset <= size && header.namesSize <= size - header.namesOffset;
+    }
+    index = reinterpret_cast<const Entry *>(data + sizeof(Header));
+    for (std::uint32_t i = 0; valid && i < header.count; i++) {
+        const Entry & entry = index[i];
+        valid = entry.offset <= size && entry.stored <= size - entry.offset
+             && std::uint64_t(entry.name) + entry.length <= header.namesSize
+             && ((entry.flags & Compressed) || entry.stored == entry.size)
+             && (i == 0 || index[i - 1].hash <= entry.hash);
+    }
+    if (!valid) {
+        fprintf(stderr, "Invalid Package %s\n", filename.c_str());
+        Close();
+        return false;
+    }
+
+    count = header.count;
+    names = reinterpret_cast<const char *>(data + header.namesOffset);
+    root = directory.empty() ? std::string() : Normalize(directory) + "/";
+    decoded.clear();
+    decoded.resize(count);
+    return true;
+}
+
+void Package::Close() {
+#ifndef _WIN32
+    if (data) munmap(data, size);
+#endif
+    std::lock_guard<std::mutex> lock(mutex);
+    fallback.clear();
+    decoded.clear();
+    data = nullptr;
+    size = 0;
+    index = nullptr;
+    names = nullptr;
+    count = 0;
+}
+
+const Package::Entry * Package::Lookup(const std::string & name) const {
+    std::uint64_t key = hash(name);
+    const Entry * first = std::lower_bound(index, index + count, key,
+                                           [](const Entry & entry, std::uint64_t value) { return entry.hash < value; });
+    for (; first != index + count && first->hash == key; first++) {
+        if (first->length == name.size() && std::memcmp(names + first->name, name.data(), name.size()) == 0) return first;
+    }
+    return nullptr;
+}
+
+Package::Span Package::Find(const std::string & path) {
+    Span span;
+    if (!data) return span;
+    std::string name = Normalize(path);
+    if (!root.empty()) {
+        if (name.compare(0, root.size(), root) != 0) return span;
+        name.erase(0, root.size());
+    }
+    const Entry * entry = Lookup(name);
+    if (!entry) return span;
+
+    span.size = static_cast<std::size_t>(entry->size);
+    if (!(entry->flags & Compressed)) {
+        span.data = data + entry->offset;
+        return span;
+    }
+
+    // Decoded once; the buffer lives as long as the package stays open
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<std::vector<unsigned char>> & buffer = decoded[entry - index];
+    if (!buffer) {
+        std::unique_ptr<std::vector<unsigned char>> bytes(new std::vector<unsigned char>(span.size));
+        if (!Lz4::Decompress(data + entry->offset, static_cast<std::size_t>(entry->stored), bytes->data(), span.size)) {
+            fprintf(stderr, "Corrupt Package Entry %s\n", name.c_str());
+            return Span();
+        }
+        buffer = std::move(bytes);
+    }
+    span.data = buffer->data();
+    return span;
+}
+
+bool Package::Read(const std::string & path, std::string & contents) {
+    Span span = Find(path);
+    if (span.Valid()) {
+        contents.assign(reinterpret_cast<const char *>(span.data), span.size);
+        return true;
+    }
+    std::ifstream fd(path, std::ios::binary);
+    if (!fd) return false;
+    contents.assign(std::istreambuf_iterator<char>(fd), std::istreambuf_iterator<char>());
+    return true;
+}
+
+std::vector<std::string> Package::Names() const {
+    std::vector<std::string> result;
+    for (std::uint32_t i = 0; i < count; i++) result.emplace_back(names + index[i].name, index[i].length);
+    return result;
+}
+
+Package::Stats Package::Statistics() const {
+    Stats stats;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (std::uint32_t i = 0; i < count; i++) {
+        stats.entries++;
+        stats.compressed += (index[i].flags & Compressed) ? 1 : 0;
+        stats.decoded += decoded[i] ? 1 : 0;
+        stats.storedBytes += index[i].stored;
+        stats.rawBytes += index[i].size;
+    }
+    return stats;
+}
+
+Package & Package::Default() {
+    static Package package;
+    static std::once_flag opened;
+    std::call_once(opened, [] {
+        const char * path = std::getenv("GLITTER_PACKAGE");
+        package.Open(path ? path : "../glitter.pak", "..");
+    });
+    return package;
+}
+
+std::string Package::Normalize(const std::string & path) {
+    // Lexical only: "a/./b/../c" is "a/c", and leading ".." components are kept
+    std::vector<std::string> parts;
+    std::size_t start = 0;
+    while (start <= path.size()) {
+        std::size_t slash = path.find_first_of("/\\", start);
+        if (slash == std::string::npos) slash = path.size();
+        std::string part = path.substr(start, slash - start);
+        if (part == "..") {
+            if (!parts.empty() && parts.back() != "..") parts.pop_back();
+            else parts.push_back(part);
+        } else if (!part.empty() && part != ".") {
+            parts.push_back(part);
+        }
+        start = slash + 1;
+    }
+    std::string result = !path.empty() && (path[0] == '/' || path[0] == '\\') ? "/" : "";
+    for (std::size_t i = 0; i < parts.size(); i++) result += (i ? "/" : "") + parts[i];
+    return result;
+}
+
+void PackageWriter::Add(const std::string & name, const void * data, std::size_t size) {
+    File file;
+    file.name = Package::Normalize(name);
+    file.bytes.assign(static_cast<const unsigned char *>(data), static_cast<const unsigned char *>(data) + size);
+    files.push_back(std::move(file));
+}
+
+bool PackageWriter::AddFile(const std::string & name, const std::string & path) {
+    std::ifstream fd(path, std::ios::binary);
+    if (!fd) return false;
+    std::vector<char> bytes((std::istreambuf_iterator<char>(fd)), std::istreambuf_iterator<char>());
+    Add(name, bytes.data(), bytes.size());
+    return true;
+}
+
+std::vector<std::string> PackageWriter::Names() const {
+    std::vector<std::string> result;
+    for (const auto & file : files) result.push_back(file.name);
+    return result;
+}
+
+Package::Span PackageWriter::Find(const std::string & name) const {
+    Package::Span span;
+    std::string normalized = Package::Normalize(name);
+    for (const auto & file : files) {
+        if (file.name != normalized) continue;
+        span.data = file.bytes.data();
+        span.size = file.bytes.size();
+        break;
+    }
+    return span;
+}
+
+bool PackageWriter::AddDirectory(const std::string & prefix, const std::string & directory) {
+    std::vector<std::string> names;
+#ifdef _WIN32
+    WIN32_FIND_DATAA found;
+    HANDLE handle = FindFirstFileA((directory + "\\*").c_str(), &found);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    do {
+        std::string name = found.cFileName;
+        if (name == "." || name == "..") continue;
+        names.push_back((found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? name + "/" : name);
+    } while (FindNextFileA(handle, &found));
+    FindClose(handle);
+#else
+    DIR * handle = opendir(directory.c_str());
+    if (!handle) return false;
+    while (dirent * found = readdir(handle)) {
+        std::string name = found->d_name;
+        if (name == "." || name == "..") continue;
+        struct stat info;
+        if (stat((directory + "/" + name).c_str(), &info) != 0) continue;
+        if (S_ISDIR(info.st_mode)) names.push_back(name + "/");
+        else if (S_ISREG(info.st_mode)) names.push_back(name);
+    }
+    closedir(handle);
+#endif
+
+    // Sorted so the same tree always packs to the same bytes
+    std::sort(names.begin(), names.end());
+    std::string base = prefix.empty() ? "" : prefix + "/";
+    for (const auto & name : names) {
+        bool ok = name.back() == '/'
+                ? AddDirectory(base + name.substr(0, name.size() - 1), directory + "/" + name.substr(0, name.size() - 1))
+                : AddFile(base + name, directory + "/" + name);
+        if (!ok) return false;
+    }
+    return true;
+}
+
+bool PackageWriter::Write(const std::string & filename) const {
+    std::vector<Package::Entry> entries(files.size());
+    std::string names;
+    for (std::size_t i = 0; i < files.size(); i++) {
+        Package::Entry & entry = entries[i];
+        std::memset(&entry, 0, sizeof(entry));
+        entry.hash = hash(files[i].name);
+        entry.name = static_cast<std::uint32_t>(names.size());
+        entry.length = static_cast<std::uint32_t>(files[i].name.size());
+        entry.size = files[i].bytes.size();
+        entry.reserved = static_cast<std::uint32_t>(i); // Source file until the index is sorted
+        names += files[i].name;
+    }
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const Package::Entry & a, const Package::Entry & b) { return a.hash < b.hash; });
+    for (std::size_t i = 1; i < entries.size(); i++) {
+        const File & a = files[entries[i - 1].reserved];
+        const File & b = files[entries[i].reserved];
+        if (a.name == b.name) {
+            fprintf(stderr, "Duplicate Package Entry %s\n", a.name.c_str());
+            return false;
+        }
+    }
+
+    Header header = { Magic, Package::Version, static_cast<std::uint32_t>(entries.size()),
+                      static_cast<std::uint32_t>(names.size()), sizeof(Header) + entries.size() * sizeof(Package::Entry) };
+    std::vector<unsigned char> out(align(header.namesOffset + names.size()), 0);
+    std::memcpy(&out[header.namesOffset], names.data(), names.size());
+
+    std::vector<unsigned char> packed;
+    for (auto & entry : entries) {
+        const std::vector<unsigned char> & bytes = files[entry.reserved].bytes;
+        packed.resize(Lz4::Bound(bytes.size()));
+        std::size_t stored = bytes.size() >= 64 ? Lz4::Compress(bytes.data(), bytes.size(), packed.data(), packed.size()) : 0;
+        bool compress = stored > 0 && stored <= bytes.size() - bytes.size() / 8;
+        const unsigned char * source = compress ? packed.data() : bytes.data();
+        entry.stored = compress ? stored : bytes.size();
+        entry.flags = compress ? Compressed : 0;
+        entry.offset = out.size();
+        entry.reserved = 0;
+        out.insert(out.end(), source, source + entry.stored);
+        out.resize(align(out.size()), 0);
+    }
+    std::memcpy(&out[0], &header, sizeof(header));
+    if (!entries.empty()) std::memcpy(&out[sizeof(Header)], entries.data(), entries.size() * sizeof(Package::Entry));
+
+    // Write beside the target and rename, so a running reader never sees half a file
+    std::string temporary = filename + ".tmp";
+    {
+        std::ofstream fd(temporary, std::ios::binary | std::ios::trunc);
+        if (!fd.write(reinterpret_cast<const char *>(out.data()), out.size())) return false;
+    }
+    std::remove(filename.c_str());
+    return std::rename(temporary.c_str(), filename.c_str()) == 0;
+}
@@ -0,0 +1,222 @@
+#include "profiler.hpp"
+
+// Without GLITTER_PROFILE the macros expand to nothing and none of this is built
+#ifdef GLITTER_PROFILE
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+    struct Event {
+        const char * name;
+        std::uint64_t start, end;
+    };
+
+    // Single writer; readers only look at events well behind the write head
+    struct ThreadBuffer {
+        static const std::size_t Capacity = 1 << 14;
+        static const std::size_t Slack = 1 << 10;
+        std::vector<Event> events;
+        std::atomic<std::uint64_t> count;
+        int id;
+        ThreadBuffer(int id) : events(Capacity), count(0), id(id) {}
+
+        void Push(const Event & event) {
+            std::uint64_t n = count.load(std::memory_order_relaxed);
+            events[n % Capacity] = event;
+            count.store(n + 1, std::memory_order_release);
+        }
+
+        template <typename Function> void ForEach(Function function) const {
+            std::uint64_t n = count.load(std::memory_order_acquire);
+            std::uint64_t first = n > Capacity - Slack ? n - (Capacity - Slack) : 0;
+            for (std::uint64_t i = first; i < n; i++) function(events[i % Capacity]);
+        }
+    };
+
+    // Queries are recycled every Latency frames, by which point they have
+    // normally completed; any that have not are dropped rather than waited on
+    const int Latency = 3;
+
+    struct GpuQuery {
+        const char * name;
+        GLuint begin, end;
+    };
+
+    struct GpuFrame {
+        std::vector<GpuQuery> queries;
+        std::size_t used = 0;
+        std::int64_t offset = 0;
+    };
+
+    struct State {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> threads;
+        ThreadBuffer gpu;
+        GpuFrame frames[Latency];
+        int current = 0;
+        std::uint64_t frameStart = 0;
+        std::uint64_t dropped = 0;
+        State() : gpu(0) {}
+    };
+
+    State & state() {
+        static State instance;
+        return instance;
+    }
+
+    ThreadBuffer & threadBuffer() {
+        thread_local ThreadBuffer * buffer = nullptr;
+        if (!buffer) {
+            State & s = state();
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.threads.emplace_back(new ThreadBuffer(static_cast<int>(s.threads.size()) + 1));
+            buffer = s.threads.back().get();
+        }
+        return *buffer;
+    }
+
+    std::string escape(const char * name) {
+        std::string out;
+        for (; *name; name++) {
+            if (*name == '"' || *name == '\\') out += '\\';
+            out += *name;
+        }
+        return out;
+    }
+}
+
+std::uint64_t Profiler::Now() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::Record(const char * name, std::uint64_t start, std::uint64_t end) {
+    threadBuffer().Push({ name, start, end });
+}
+
+int Profiler::BeginGpu(const char * name) {
+    GpuFrame & frame = state().frames[state().current];
+    if (frame.used == frame.queries.size()) {
+        GpuQuery query = { name, 0, 0 };
+        glGenQueries(1, &query.begin);
+        glGenQueries(1, &query.end);
+        frame.queries.push_back(query);
+    }
+    GpuQuery & query = frame.queries[frame.used];
+    query.name = name;
+    glQueryCounter(query.begin, GL_TIMESTAMP);
+    return static_cast<int>(frame.used++);
+}
+
+void Profiler::EndGpu(int index) {
+    GpuFrame & frame = state().frames[state().current];
+    glQueryCounter(frame.queries[index].end, GL_TIMESTAMP);
+}
+
+void Profiler::Frame() {
+    State & s = state();
+    std::uint64_t now = Now();
+    if (s.frameStart) Record("Frame", s.frameStart, now);
+    s.frameStart = now;
+
+    // Advance to the oldest slot and harvest whatever it recorded
+    s.current = (s.current + 1) % Latency;
+    GpuFrame & frame = s.frames[s.current];
+    for (std::size_t i = 0; i < frame.used; i++) {
+        const GpuQuery & query = frame.queries[i];
+        GLint available = GL_FALSE;
+        glGetQueryObjectiv(query.end, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            s.dropped++;
+            continue;
+        }
+        GLuint64 begin, end;
+        glGetQueryObjectui64v(query.begin, GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(query.end, GL_QUERY_RESULT, &end);
+        s.gpu.Push({ query.name, begin + frame.offset, end + frame.offset });
+    }
+    frame.used = 0;
+
+    // Reading the GPU clock directly does not wait for queued commands
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    frame.offset = static_cast<std::int64_t>(Now()) - gpuNow;
+}
+
+void Profiler::Summary(FILE * out) {
+    State & s = state();
+    std::map<std::string, std::vector<double>> cpu, gpu;
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (const auto & thread : s.threads) {
+            thread->ForEach([&](const Event & event) {
+                cpu[event.name].push_back((event.end - event.start) / 1e6);
+            });
+        }
+    }
+    s.gpu.ForEach([&](const Event & event) {
+        gpu[event.name].push_back((event.end - event.start) / 1e6);
+    });
+
+    fprintf(out, "%-4s %-24s %8s %10s %10s %10s\n", "", "Scope", "Count", "Min (ms)", "Avg (ms)", "P99 (ms)");
+    for (auto * table : { &cpu, &gpu }) {
+        for (auto & scope : *table) {
+            auto & samples = scope.second;
+            std::sort(samples.begin(), samples.end());
+            double total = 0.0;
+            for (double sample : samples) total += sample;
+            fprintf(out, "%-4s %-24s %8zu %10.3f %10.3f %10.3f\n", table == &cpu ? "CPU" : "GPU",
+                    scope.first.c_str(), samples.size(), samples.front(), total / samples.size(),
+                    samples[(samples.size() - 1) * 99 / 100]);
+        }
+    }
+    if (s.dropped) fprintf(out, "GPU queries dropped (not ready in time): %llu\n",
+                           static_cast<unsigned long long>(s.dropped));
+}
+
+bool Profiler::Export(const std::string & path) {
+    FILE * out = fopen(path.c_str(), "w");
+    if (!out) {
+        fprintf(stderr, "ERROR::PROFILER::EXPORT_FAILED %s\n", path.c_str());
+        return false;
+    }
+
+    State & s = state();
+    std::uint64_t origin = s.frameStart;
+    std::vector<const ThreadBuffer *> buffers(1, &s.gpu);
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (const auto & thread : s.threads) buffers.push_back(thread.get());
+    }
+    for (auto buffer : buffers) buffer->ForEach([&](const Event & event) {
+        origin = std::min(origin, event.start);
+    });
+
+    // Chrome trace timestamps are microseconds; complete ("X") events carry a duration
+    fprintf(out, "{\"traceEvents\":[\n");
+    bool first = true;
+    for (auto buffer : buffers) {
+        fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                     "\"args\":{\"name\":\"%s %d\"}}", first ? "" : ",\n", buffer->id,
+                buffer->id == 0 ? "GPU" : "CPU", buffer->id);
+        first = false;
+        buffer->ForEach([&](const Event & event) {
+            fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    escape(event.name).c_str(), buffer->id,
+                    (static_cast<std::int64_t>(event.start - origin)) / 1e3,
+                    (event.end - event.start) / 1e3);
+        });
+    }
+    fprintf(out, "\n]}\n");
+    return fclose(out) == 0;
+}
+
+#endif
@@ -0,0 +1,131 @@
+#include "program_cache.hpp"
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+namespace {
+    const std::uint32_t Magic = 0x4e494250; // "PBIN"
+
+    struct Header {
+        std::uint32_t magic;
+        std::uint32_t format;
+        std::uint64_t key;
+        std::uint64_t length;
+    };
+
+    std::string driverString(GLenum name) {
+        const GLubyte * value = glGetString(name);
+        return value ? reinterpret_cast<const char *>(value) : "";
+    }
+}
+
+ProgramCache::ProgramCache(const std::string & directory) : directory(directory) {}
+
+ProgramCache & ProgramCache::Default() {
+    static ProgramCache cache(std::getenv("GLITTER_SHADER_CACHE")
+                              ? std::getenv("GLITTER_SHADER_CACHE") : "../ShaderCache");
+    return cache;
+}
+
+std::uint64_t ProgramCache::Hash(const void * data, std::size_t size, std::uint64_t seed) {
+    // 64-bit FNV-1a
+    const unsigned char * bytes = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < size; i++) {
+        seed ^= bytes[i];
+        seed *= 1099511628211ull;
+    }
+    return seed;
+}
+
+std::uint64_t ProgramCache::Key(const std::vector<std::string> & sources) const {
+    // Hash lengths as well as contents, so ("ab", "c") and ("a", "bc") differ
+    std::uint64_t key = Hash(nullptr, 0);
+    for (const auto & source : sources) {
+        std::uint64_t length = source.size();
+        key = Hash(&length, sizeof(length), key);
+        key = Hash(source.data(), source.size(), key);
+    }
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+        std::string value = driverString(name);
+        key = Hash(value.data(), value.size() + 1, key);
+    }
+    return key;
+}
+
+bool ProgramCache::Supported() const {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+std::string ProgramCache::Path(std::uint64_t key) const {
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.bin", static_cast<unsigned long long>(key));
+    return directory + name;
+}
+
+bool ProgramCache::Load(GLuint program, std::uint64_t key) const {
+    if (!Supported()) return false;
+
+    std::ifstream fd(Path(key), std::ios::binary | std::ios::ate);
+    std::streamoff size = fd.tellg();
+    Header header;
+    if (size < static_cast<std::streamoff>(sizeof(header))) return false;
+    fd.seekg(0);
+    if (!fd.read(reinterpret_cast<char *>(&header), sizeof(header))) return false;
+    if (header.magic != Magic || header.key != key) return false;
+
+    // A truncated or corrupt entry must not size the allocation
+    std::uint64_t remaining = static_cast<std::uint64_t>(size) - sizeof(header);
+    if (header.length == 0 || header.length != remaining) return false;
+
+    std::vector<char> binary(header.length);
+    if (!fd.read(binary.data(), binary.size())) return false;
+
+    // The driver may still reject a binary, e.g. after a silent update
+    glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    return success == GL_TRUE;
+}
+
+bool ProgramCache::Store(GLuint program, std::uint64_t key) const {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return false;
+
+    Header header;
+    GLenum format = 0;
+    std::vector<char> binary(length);
+    glGetProgramBinary(program, length, nullptr, &format, binary.data());
+    header.magic = Magic;
+    header.format = format;
+    header.key = key;
+    header.length = binary.size();
+
+#ifdef _WIN32
+    _mkdir(directory.c_str());
+#else
+    mkdir(directory.c_str(), 0755);
+#endif
+    // Write to a temporary first so a crash never leaves a torn entry behind
+    std::string path = Path(key), temporary = path + ".tmp";
+    {
+        std::ofstream fd(temporary, std::ios::binary | std::ios::trunc);
+        fd.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        fd.write(binary.data(), binary.size());
+        if (!fd) {
+            fprintf(stderr, "ERROR::SHADER::CACHE::WRITE_FAILED %s\n", temporary.c_str());
+            return false;
+        }
+    }
+    std::remove(path.c_str());
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
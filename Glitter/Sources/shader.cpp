@@ -5,79 +5,140 @@
 #include <GLFW/glfw3.h>
 
 // Standard Headers
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 
+#include "program_cache.hpp"
 #include "shader.hpp"
+#include "shader_preprocessor.hpp"
 
-Shader::Shader(const GLchar* vertexPath, const GLchar* fragmentPath) {
+Shader::Shader(const GLchar* vertexPath, const GLchar* fragmentPath, const std::vector<std::string> & defines)
+    : VertexPath(vertexPath), FragmentPath(fragmentPath), Defines(defines) {
+    auto start = std::chrono::steady_clock::now();
+    this->Program = Build(VertexPath, FragmentPath, Defines, &this->Cached, &this->Files);
+    reflectUniforms();
 
-    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexPath);
-    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentPath);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    this->LinkMilliseconds = elapsed.count();
+}
+
+GLuint Shader::Build(const std::string & vertexPath, const std::string & fragmentPath,
+                     const std::vector<std::string> & defines, bool * cached, std::vector<std::string> * files) {
+    Job job = Submit(vertexPath, fragmentPath, defines);
+    if (cached) *cached = job.cached;
+    if (files) *files = job.files;
+    return Finish(job);
+}
+
+Shader::Job Shader::Submit(const std::string & vertexPath, const std::string & fragmentPath,
+                           const std::vector<std::string> & defines) {
+    Job job = { 0, 0, false, {} };
+    ShaderPreprocessor::Result vertex = ShaderPreprocessor::Process(vertexPath, defines);
+    ShaderPreprocessor::Result fragment = ShaderPreprocessor::Process(fragmentPath, defines);
+    if (!vertex.valid || !fragment.valid) return job;
+    job.files = vertex.files;
+    job.files.insert(job.files.end(), fragment.files.begin(), fragment.files.end());
+
+    // Try the driver's own binary before compiling anything
+    ProgramCache & cache = ProgramCache::Default();
+    job.key = cache.Key({ vertex.source, fragment.source });
+    job.program = glCreateProgram();
+    job.cached = cache.Load(job.program, job.key);
+    if (job.cached) return job;
+
+    // A rejected binary leaves the program unlinked, so start over
+    glDeleteProgram(job.program);
+    job.program = glCreateProgram();
 
-    this->Program = glCreateProgram();
-    glAttachShader(this->Program, vertexShader);
-    glAttachShader(this->Program, fragmentShader);
-    glLinkProgram(this->Program);
+    // Nothing below waits on the driver; Finish() does
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertex.source);
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragment.source);
+    glAttachShader(job.program, vertexShader);
+    glAttachShader(job.program, fragmentShader);
+    glProgramParameteri(job.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(job.program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    return job;
+}
+
+GLuint Shader::Finish(Job & job) {
+    if (!job.program || job.cached) return job.program;
 
     GLint success;
     GLchar infoLog[512];
 
-    glGetProgramiv(this->Program, GL_LINK_STATUS, &success);
+    // Shaders stay attached until here so their logs survive a failed link
+    GLuint shaders[2];
+    GLsizei count = 0;
+    glGetAttachedShaders(job.program, 2, &count, shaders);
+    glGetProgramiv(job.program, GL_LINK_STATUS, &success);
     if (!success) {
-        glGetProgramInfoLog(this->Program, 512, NULL, infoLog);
+        for (GLsizei i = 0; i < count; i++) {
+            glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &success);
+            if (!success) {
+                GLint type;
+                glGetShaderiv(shaders[i], GL_SHADER_TYPE, &type);
+                glGetShaderInfoLog(shaders[i], 512, NULL, infoLog);
+                fprintf(stderr, "ERROR::SHADER::%s::COMPILATION_FAILED %s\n",
+                        type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT", infoLog);
+            }
+        }
+        glGetProgramInfoLog(job.program, 512, NULL, infoLog);
         fprintf(stderr, "ERROR::SHADER::PROGRAM::LINKING_FAILED %s\n", infoLog);
+        glDeleteProgram(job.program);
+        job.program = 0;
+        return 0;
     }
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    for (GLsizei i = 0; i < count; i++) glDetachShader(job.program, shaders[i]);
+    ProgramCache::Default().Store(job.program, job.key);
+    return job.program;
 }
 
-GLuint Shader::compileShader(int shaderType, const GLchar * path) const {
-    fprintf(stdout, "path: %s\n", path);
+void Shader::Swap(GLuint program) {
+    glDeleteProgram(this->Program);
+    this->Program = program;
+    uniforms.clear();
+    reflectUniforms();
+}
 
-    std::ifstream fd(path);
-    auto src = std::string(std::istreambuf_iterator<char>(fd),
-                           (std::istreambuf_iterator<char>()));
+void Shader::reflectUniforms() {
+    if (!this->Program) return;
+    GLint count, maxLength;
+    glGetProgramiv(this->Program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(this->Program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
 
-    const GLchar * code = (GLchar *) src.c_str();
+    std::string name(maxLength + 1, '\0');
+    for (GLint i = 0; i < count; i++) {
+        GLint size;
+        GLenum type;
+        GLsizei length;
+        glGetActiveUniform(this->Program, i, maxLength + 1, &length, &size, &type, &name[0]);
+        std::string uniform = name.substr(0, length);
+        GLint location = glGetUniformLocation(this->Program, uniform.c_str());
+        if (location == -1) continue;
 
-    GLint success;
-    GLchar infoLog[512];
+        uniforms[Hash(uniform.c_str())] = location;
+        // Arrays are reported as "name[0]", make the bare name work too
+        auto bracket = uniform.find("[0]");
+        if (bracket != std::string::npos) {
+            uniforms[Hash(uniform.substr(0, bracket).c_str())] = location;
+        }
+    }
+}
+
+GLint Shader::Uniform(std::uint32_t hash) const {
+    auto it = uniforms.find(hash);
+    return it == uniforms.end() ? -1 : it->second;
+}
 
+GLuint Shader::compileShader(int shaderType, const std::string & src) {
+    const GLchar * code = src.c_str();
     GLuint shader = glCreateShader(shaderType);
     glShaderSource(shader, 1, &code, NULL);
     glCompileShader(shader);
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(shader, 512, NULL, infoLog);
-        fprintf(stderr, "ERROR::SHADER::VERTEX::COMPILATION_FAILED %s %d\n", infoLog, shaderType);
-    };
     return shader;
 }
 
-GLchar *Shader::readShaderFile(const GLchar *path) const {
-//    std::string code;
-//    std::ifstream file;
-//    file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-//
-//    try {
-//        file.open(path);
-//        stringstream vShaderStream;
-//        vShaderStream << file.rdbuf();
-//        file.close();
-//        code = vShaderStream.str();
-//    } catch (ios_base::failure e) {
-//        fprintf(stderr, "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: %s", path);
-//    }
-//
-//    return (GLchar *)code.c_str();
-    fprintf(stdout, "path: %s\n", path);
-    std::ifstream fd(path);
-    auto src = std::string(std::istreambuf_iterator<char>(fd),
-                           (std::istreambuf_iterator<char>()));
-
-    // Create a Shader Object
-    return (GLchar *) src.c_str();
-}
-
 void Shader::Use() { glUseProgram(this->Program); }
\ No newline at end of file
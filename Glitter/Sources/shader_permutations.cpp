@@ -0,0 +1,37 @@
+#include "shader_permutations.hpp"
+#include "shader.hpp"
+
+ShaderPermutations::ShaderPermutations(const std::string & vertexPath, const std::string & fragmentPath,
+                                       const std::vector<std::string> & features)
+    : vertexPath(vertexPath), fragmentPath(fragmentPath), features(features) {}
+
+ShaderPermutations::~ShaderPermutations() {
+    for (auto & program : programs) glDeleteProgram(program.second);
+}
+
+std::vector<std::string> ShaderPermutations::Defines(std::uint32_t mask) const {
+    std::vector<std::string> defines;
+    for (std::size_t i = 0; i < features.size() && i < 32; i++) {
+        if (mask & (1u << i)) defines.push_back(features[i]);
+    }
+    return defines;
+}
+
+GLuint ShaderPermutations::Get(std::uint32_t mask) {
+    auto it = programs.find(mask);
+    if (it != programs.end()) return it->second;
+    // Failures are remembered too, so a broken permutation is reported once
+    GLuint program = Shader::Build(vertexPath, fragmentPath, Defines(mask));
+    programs[mask] = program;
+    return program;
+}
+
+void ShaderPermutations::Prepare(const std::vector<std::uint32_t> & masks) {
+    std::vector<std::pair<std::uint32_t, Shader::Job>> jobs;
+    for (auto mask : masks) {
+        if (programs.count(mask)) continue;
+        programs[mask] = 0;
+        jobs.push_back(std::make_pair(mask, Shader::Submit(vertexPath, fragmentPath, Defines(mask))));
+    }
+    for (auto & job : jobs) programs[job.first] = Shader::Finish(job.second);
+}
@@ -0,0 +1,142 @@
+#include "shader_preprocessor.hpp"
+#include "package.hpp"
+#include "program_cache.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+
+std::mutex ShaderPreprocessor::mutex;
+std::unordered_map<std::uint64_t, ShaderPreprocessor::Memo> ShaderPreprocessor::memo;
+
+namespace {
+    // The mounted package wins; paths outside it fall through to the file system
+    bool readFile(const std::string & path, std::string & contents) {
+        return Package::Default().Read(path, contents);
+    }
+
+    std::string directoryOf(const std::string & path) {
+        auto slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+    }
+
+    // Returns the quoted or bracketed name for an #include line, empty otherwise
+    std::string includeName(const std::string & line) {
+        auto start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line.compare(start, 1, "#") != 0) return "";
+        start = line.find_first_not_of(" \t", start + 1);
+        if (start == std::string::npos || line.compare(start, 7, "include") != 0) return "";
+        auto open = line.find_first_of("\"<", start + 7);
+        if (open == std::string::npos) return "";
+        auto close = line.find(line[open] == '"' ? '"' : '>', open + 1);
+        if (close == std::string::npos) return "";
+        return line.substr(open + 1, close - open - 1);
+    }
+
+    std::string defineLine(std::string define) {
+        auto equals = define.find('=');
+        if (equals != std::string::npos) define[equals] = ' ';
+        return "#define " + define + "\n";
+    }
+
+    bool isVersion(const std::string & line) {
+        auto start = line.find_first_not_of(" \t");
+        return start != std::string::npos && line.compare(start, 8, "#version") == 0;
+    }
+}
+
+ShaderPreprocessor::Result ShaderPreprocessor::Process(const std::string & path,
+                                                       const std::vector<std::string> & defines) {
+    std::string root;
+    if (!readFile(path, root)) {
+        fprintf(stderr, "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ: %s\n", path.c_str());
+        return Result();
+    }
+
+    std::uint64_t key = ProgramCache::Hash(path.data(), path.size());
+    for (const auto & define : defines) key = ProgramCache::Hash(define.data(), define.size() + 1, key);
+    key = ProgramCache::Hash(root.data(), root.size(), key);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = memo.find(key);
+        if (it != memo.end()) {
+            // The root matched by key; includes must still be unchanged
+            bool fresh = true;
+            std::string contents;
+            for (std::size_t i = 1; fresh && i < it->second.result.files.size(); i++) {
+                fresh = readFile(it->second.result.files[i], contents)
+                     && ProgramCache::Hash(contents.data(), contents.size()) == it->second.hashes[i];
+            }
+            if (fresh) return it->second.result;
+        }
+    }
+
+    Memo entry;
+    std::vector<std::string> stack;
+    entry.result.valid = Expand(path, entry.result, stack, entry.hashes, &defines);
+    if (entry.result.valid) {
+        std::lock_guard<std::mutex> lock(mutex);
+        memo[key] = entry;
+    }
+    return entry.result;
+}
+
+bool ShaderPreprocessor::Expand(const std::string & path, Result & result,
+                                std::vector<std::string> & stack, std::vector<std::uint64_t> & hashes,
+                                const std::vector<std::string> * defines) {
+    if (std::find(stack.begin(), stack.end(), path) != stack.end()) {
+        fprintf(stderr, "ERROR::SHADER::PREPROCESSOR::CIRCULAR_INCLUDE %s\n", path.c_str());
+        return false;
+    }
+    // Each file is pasted in once per program
+    if (std::find(result.files.begin(), result.files.end(), path) != result.files.end()) return true;
+
+    std::string contents;
+    if (!readFile(path, contents)) {
+        fprintf(stderr, "ERROR::SHADER::PREPROCESSOR::INCLUDE_NOT_FOUND %s\n", path.c_str());
+        return false;
+    }
+
+    std::size_t number = result.files.size();
+    result.files.push_back(path);
+    hashes.push_back(ProgramCache::Hash(contents.data(), contents.size()));
+    stack.push_back(path);
+
+    // #line may not precede #version, so only included files start with one
+    if (number > 0) result.source += "#line 1 " + std::to_string(number) + "\n";
+
+    std::istringstream input(contents);
+    std::string text;
+    std::size_t current = 0;
+    bool injected = defines == nullptr;
+    while (std::getline(input, text)) {
+        current++;
+        std::string name = includeName(text);
+        if (!name.empty()) {
+            if (!Expand(directoryOf(path) + name, result, stack, hashes, nullptr)) {
+                fprintf(stderr, "  included from %s:%zu\n", path.c_str(), current);
+                return false;
+            }
+            result.source += "#line " + std::to_string(current + 1) + " " + std::to_string(number) + "\n";
+            continue;
+        }
+
+        result.source += text;
+        result.source += '\n';
+        if (!injected && isVersion(text)) {
+            for (const auto & define : *defines) result.source += defineLine(define);
+            result.source += "#line " + std::to_string(current + 1) + " 0\n";
+            injected = true;
+        }
+    }
+
+    // Shaders without a #version line get their defines up front
+    if (!injected) {
+        std::string prefix;
+        for (const auto & define : *defines) prefix += defineLine(define);
+        result.source = prefix + "#line 1 0\n" + result.source;
+    }
+    stack.pop_back();
+    return true;
+}
@@ -0,0 +1,156 @@
+#include "shader_watcher.hpp"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#include <sys/stat.h>
+#include <map>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <set>
+
+namespace {
+    std::string basename(const std::string & path) {
+        auto slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? path : path.substr(slash + 1);
+    }
+}
+
+ShaderWatcher::ShaderWatcher(GLFWwindow * window, const std::string & directory)
+    : directory(directory), running(true), notify(-1) {
+    // GLFW only creates windows on the main thread; the worker just borrows it
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+    context = glfwCreateWindow(1, 1, "Shader Watcher", nullptr, window);
+    glfwWindowHint(GLFW_VISIBLE, GL_TRUE);
+    if (context == nullptr) {
+        fprintf(stderr, "ERROR::SHADER::WATCHER::CONTEXT_FAILED\n");
+        running = false;
+        return;
+    }
+
+#ifdef __linux__
+    notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    // Editors either rewrite in place or write a temporary and rename it over
+    if (notify < 0 || inotify_add_watch(notify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        fprintf(stderr, "ERROR::SHADER::WATCHER::INOTIFY_FAILED %s\n", directory.c_str());
+        running = false;
+        return;
+    }
+#endif
+    worker = std::thread(&ShaderWatcher::Run, this);
+}
+
+ShaderWatcher::~ShaderWatcher() {
+    running = false;
+    if (worker.joinable()) worker.join();
+#ifdef __linux__
+    if (notify >= 0) close(notify);
+#endif
+    for (auto & entry : pending) glDeleteProgram(entry.program);
+    if (context) glfwDestroyWindow(context);
+}
+
+void ShaderWatcher::Watch(Shader & shader) {
+    Entry entry = { &shader, basename(shader.VertexPath), basename(shader.FragmentPath), shader.Defines, {} };
+    for (const auto & file : shader.Files) entry.files.push_back(basename(file));
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.push_back(entry);
+}
+
+int ShaderWatcher::Poll() {
+    std::vector<Pending> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.swap(pending);
+    }
+    for (auto & entry : ready) {
+        entry.shader->Swap(entry.program);
+        std::chrono::duration<double, std::milli> latency = Clock::now() - entry.changed;
+        fprintf(stdout, "Reloaded %s + %s in %.1f ms\n", entry.shader->VertexPath.c_str(),
+                entry.shader->FragmentPath.c_str(), latency.count());
+    }
+    return static_cast<int>(ready.size());
+}
+
+void ShaderWatcher::Run() {
+    glfwMakeContextCurrent(context);
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+    while (running) {
+        pollfd fd = { notify, POLLIN, 0 };
+        if (poll(&fd, 1, 100) <= 0) continue;
+        Clock::time_point when = Clock::now();
+
+        // One save often arrives as several events; let the burst settle
+        std::set<std::string> names;
+        do {
+            ssize_t length;
+            while ((length = read(notify, buffer, sizeof(buffer))) > 0) {
+                for (char * p = buffer; p < buffer + length;) {
+                    auto event = reinterpret_cast<inotify_event *>(p);
+                    if (event->len) names.insert(event->name);
+                    p += sizeof(inotify_event) + event->len;
+                }
+            }
+        } while (poll(&fd, 1, 20) > 0);
+
+        for (const auto & name : names) Changed(name, when);
+    }
+#else
+    std::map<std::string, time_t> times;
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        std::set<std::string> names;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto & entry : entries) names.insert(entry.files.begin(), entry.files.end());
+        }
+        for (const auto & name : names) {
+            struct stat info;
+            if (stat((directory + "/" + name).c_str(), &info) != 0) continue;
+            auto previous = times.find(name);
+            bool modified = previous != times.end() && previous->second != info.st_mtime;
+            times[name] = info.st_mtime;
+            if (modified) Changed(name, Clock::now());
+        }
+    }
+#endif
+    glfwMakeContextCurrent(nullptr);
+}
+
+void ShaderWatcher::Changed(const std::string & filename, Clock::time_point when) {
+    std::vector<Entry> affected;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto & entry : entries) {
+            if (std::find(entry.files.begin(), entry.files.end(), filename) != entry.files.end()) {
+                affected.push_back(entry);
+            }
+        }
+    }
+
+    for (const auto & entry : affected) {
+        std::vector<std::string> files;
+        GLuint program = Shader::Build(directory + "/" + entry.vertex, directory + "/" + entry.fragment,
+                                       entry.defines, nullptr, &files);
+        if (!program) {
+            fprintf(stderr, "ERROR::SHADER::WATCHER::RELOAD_FAILED %s, keeping the previous program\n",
+                    filename.c_str());
+            continue;
+        }
+        // The render thread must never see a program still being linked
+        glFinish();
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back({ entry.shader, program, when });
+        // Includes may have been added or removed
+        for (auto & watched : entries) {
+            if (watched.shader != entry.shader) continue;
+            watched.files.clear();
+            for (const auto & file : files) watched.files.push_back(basename(file));
+        }
+    }
+}
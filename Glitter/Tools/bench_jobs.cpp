@@ -0,0 +1,228 @@
+// Measures JobSystem scheduling overhead and scaling.
+//
+//     bench_jobs [max threads] [items]
+//
+// For 1, 2, 4 ... max threads, counting the caller, it times spawning empty
+// jobs from the main thread, which owns a deque, and from a thread outside
+// the system, which goes through the locked queue, then a ParallelFor over uniform and over skewed
+// items, and a recursive Fibonacci whose jobs Wait() on their children. The
+// loops also run on a shared-FIFO pool with one mutex, the scheduler
+// Mirage::ThreadPool used before, as a baseline. Each figure is the median
+// of five runs, and every result is checked against a serial one.
+#include "job_system.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+    const int Runs = 5;
+
+    // Workers popping one shared deque under one lock; run() helps from the caller
+    class MutexPool {
+    public:
+        explicit MutexPool(unsigned int count) : stopping(false) {
+            for (unsigned int i = 0; i < count; i++) threads.emplace_back([this]() { Work(); });
+        }
+
+        ~MutexPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            signal.notify_all();
+            for (auto & thread : threads) thread.join();
+        }
+
+        void Submit(std::function<void()> task) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.push_back(std::move(task));
+            }
+            signal.notify_one();
+        }
+
+        // One task per index, as the old ThreadPool::run() handed them out
+        void Run(std::size_t count, const std::function<void(std::size_t)> & task) {
+            std::atomic<std::size_t> remaining(count);
+            for (std::size_t i = 0; i < count; i++) {
+                Submit([&task, &remaining, i]() {
+                    task(i);
+                    remaining.fetch_sub(1, std::memory_order_release);
+                });
+            }
+            while (remaining.load(std::memory_order_acquire) > 0) {
+                if (!RunOne()) std::this_thread::yield();
+            }
+        }
+
+    private:
+        bool RunOne() {
+            std::function<void()> task;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (tasks.empty()) return false;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+            return true;
+        }
+
+        void Work() {
+            for (;;) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    signal.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                    if (tasks.empty()) return;
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+                task();
+            }
+        }
+
+        std::vector<std::thread> threads;
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+        std::condition_variable signal;
+        bool stopping;
+    };
+
+    template <typename Function>
+    double median(Function function) {
+        std::vector<double> times;
+        for (int run = 0; run < Runs; run++) {
+            auto start = Clock::now();
+            function();
+            times.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+        std::sort(times.begin(), times.end());
+        return times[Runs / 2];
+    }
+
+    // Enough arithmetic that the loop is not bound by memory
+    double work(std::size_t item, int iterations) {
+        double x = 1.0 + item * 1e-9;
+        for (int i = 0; i < iterations; i++) x = std::sqrt(x * 1.000001 + 0.5);
+        return x;
+    }
+
+    // Uniform items cost 64 iterations; skewed ones between 0 and 2048, heaviest at the end
+    int cost(std::size_t item, std::size_t items, bool skewed) {
+        if (!skewed) return 64;
+        double t = static_cast<double>(item) / items;
+        return static_cast<int>(2048.0 * t * t * t);
+    }
+
+    std::uint64_t fibonacci(JobSystem & jobs, int n) {
+        if (n < 12) return n < 2 ? n : fibonacci(jobs, n - 1) + fibonacci(jobs, n - 2);
+        std::uint64_t left = 0;
+        JobSystem::Counter counter;
+        jobs.Spawn([&jobs, &left, n]() { left = fibonacci(jobs, n - 1); }, &counter);
+        std::uint64_t right = fibonacci(jobs, n - 2);
+        jobs.Wait(counter);
+        return left + right;
+    }
+
+    std::uint64_t fibonacci(int n) { return n < 2 ? n : fibonacci(n - 1) + fibonacci(n - 2); }
+}
+
+int main(int argc, char * argv[]) {
+    unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int most = argc > 1 ? std::max(1, atoi(argv[1])) : cores;
+    std::size_t items = argc > 2 ? std::max(1, atoi(argv[2])) : 1 << 18;
+    const std::size_t Spawns = 102400;
+    const std::size_t Batch = 1024; // Well inside a deque, so none run inline
+    const std::size_t Grain = 256;
+    const int Fibonacci = 32;
+
+    // Serial references; sums are added in item order so they match exactly
+    std::vector<double> results(items);
+    double expected[2] = {};
+    double serial[2] = {};
+    for (int skewed = 0; skewed < 2; skewed++) {
+        serial[skewed] = median([&]() {
+            for (std::size_t i = 0; i < items; i++) results[i] = work(i, cost(i, items, skewed != 0));
+        });
+        for (double result : results) expected[skewed] += result;
+    }
+    std::uint64_t fibonacciExpected = 0;
+    double fibonacciSerial = median([&]() { fibonacciExpected = fibonacci(Fibonacci); });
+
+    printf("%u hardware threads; %zu items, grain %zu; serial uniform %.2f ms, skewed %.2f ms, fib(%d) %.2f ms\n",
+           cores, items, Grain, serial[0], serial[1], Fibonacci, fibonacciSerial);
+    printf("%-8s %14s %14s %14s %12s %12s %12s %12s %10s\n", "Threads", "Local ns/job", "Inject ns/job",
+           "Mutex ns/job", "Uniform ms", "(mutex ms)", "Skewed ms", "(mutex ms)", "Fib ms");
+
+    bool valid = true;
+    for (unsigned int threads = 1;; threads = std::min(threads * 2, most)) {
+        JobSystem jobs(threads - 1);
+        MutexPool pool(threads - 1);
+
+        // Empty jobs from the main thread, then from a thread the system does not know
+        auto spawn = [&jobs]() {
+            JobSystem::Counter counter;
+            for (std::size_t i = 0; i < Spawns; i += Batch) {
+                for (std::size_t j = 0; j < Batch; j++) jobs.Spawn([]() {}, &counter);
+                jobs.Wait(counter);
+            }
+        };
+        double local = median(spawn);
+        double injected = median([&]() { std::thread(spawn).join(); });
+        double locked = median([&]() { pool.Run(Spawns, [](std::size_t) {}); });
+
+        double loops[2][2];
+        for (int skewed = 0; skewed < 2; skewed++) {
+            loops[skewed][0] = median([&]() {
+                jobs.ParallelFor(0, items, Grain, [&](std::size_t first, std::size_t last) {
+                    for (std::size_t i = first; i < last; i++) results[i] = work(i, cost(i, items, skewed != 0));
+                });
+            });
+            double sum = 0.0;
+            for (double result : results) sum += result;
+            valid = valid && sum == expected[skewed];
+
+            std::fill(results.begin(), results.end(), 0.0);
+            loops[skewed][1] = median([&]() {
+                pool.Run((items + Grain - 1) / Grain, [&](std::size_t chunk) {
+                    for (std::size_t i = chunk * Grain; i < std::min(items, (chunk + 1) * Grain); i++)
+                        results[i] = work(i, cost(i, items, skewed != 0));
+                });
+            });
+            sum = 0.0;
+            for (double result : results) sum += result;
+            valid = valid && sum == expected[skewed];
+        }
+
+        std::uint64_t value = 0;
+        double tree = median([&]() { value = fibonacci(jobs, Fibonacci); });
+        valid = valid && value == fibonacciExpected;
+
+        printf("%-8u %14.1f %14.1f %14.1f %12.2f %12.2f %12.2f %12.2f %10.2f\n", threads,
+               local * 1e6 / Spawns, injected * 1e6 / Spawns, locked * 1e6 / Spawns,
+               loops[0][0], loops[0][1], loops[1][0], loops[1][1], tree);
+
+        JobSystem::Stats stats = jobs.Statistics();
+        printf("         %llu jobs run, %llu stolen, %llu injected, %llu inlined, %llu sleeps\n",
+               static_cast<unsigned long long>(stats.executed), static_cast<unsigned long long>(stats.stolen),
+               static_cast<unsigned long long>(stats.injected), static_cast<unsigned long long>(stats.inlined),
+               static_cast<unsigned long long>(stats.sleeps));
+        if (threads == most) break;
+    }
+
+    if (!valid) fprintf(stderr, "Parallel Results Differ From the Serial Ones\n");
+    return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
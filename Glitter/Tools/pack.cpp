@@ -0,0 +1,85 @@
+// Packs asset directories into one archive for Package to map at startup.
+//
+//     glitter_pack [--dds] <output.pak> <name>=<directory or file> ...
+//
+// Each directory is added recursively under its name, so
+// "Shaders=Glitter/Shaders" stores Glitter/Shaders/shader.vert as
+// "Shaders/shader.vert". The archive is only replaced once it is complete.
+//
+// With --dds every image also gets a block-compressed sibling with its whole
+// mip chain, "Textures/container.jpg.dds", keyed by a hash of the source
+// bytes. Encoding and Kaiser filtering happen here, once per build, so the
+// application only uploads the prebuilt levels.
+#include "package.hpp"
+#include "cache.hpp"
+#include "compress.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static bool isImage(const std::string & name) {
+    for (const char * extension : { ".jpg", ".jpeg", ".png", ".tga", ".bmp" }) {
+        std::size_t length = strlen(extension);
+        if (name.size() > length && name.compare(name.size() - length, length, extension) == 0) return true;
+    }
+    return false;
+}
+
+// Adds name.dds for every image already in the writer
+static bool addCompressed(PackageWriter & writer) {
+    for (const auto & name : writer.Names()) {
+        if (!isImage(name)) continue;
+        Package::Span source = writer.Find(name);
+        int width, height, channels;
+        unsigned char * pixels = stbi_load_from_memory(source.data, static_cast<int>(source.size),
+                                                       &width, &height, &channels, 0);
+        if (!pixels) {
+            fprintf(stderr, "Failed to Decode %s\n", name.c_str());
+            return false;
+        }
+        Mirage::CompressedImage image = Mirage::compress(pixels, width, height, channels, Mirage::MipFilter::Kaiser);
+        stbi_image_free(pixels);
+        std::vector<unsigned char> bytes = Mirage::writeDDS(image, Mirage::MeshCache::hash(source.data, source.size));
+        writer.Add(name + ".dds", bytes.data(), bytes.size());
+    }
+    return true;
+}
+
+int main(int argc, char * argv[]) {
+    bool dds = argc > 1 && !strcmp(argv[1], "--dds");
+    int first = dds ? 2 : 1;
+    if (argc < first + 2) {
+        fprintf(stderr, "Usage: %s [--dds] <output.pak> <name>=<directory or file> ...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    PackageWriter writer;
+    for (int i = first + 1; i < argc; i++) {
+        std::string argument = argv[i];
+        auto equals = argument.find('=');
+        std::string name = equals == std::string::npos ? "" : argument.substr(0, equals);
+        std::string path = equals == std::string::npos ? argument : argument.substr(equals + 1);
+        if (!writer.AddDirectory(name, path) && !writer.AddFile(name, path)) {
+            fprintf(stderr, "Failed to Read %s\n", path.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+    if (dds && !addCompressed(writer)) return EXIT_FAILURE;
+    if (!writer.Write(argv[first])) {
+        fprintf(stderr, "Failed to Write %s\n", argv[first]);
+        return EXIT_FAILURE;
+    }
+
+    Package package;
+    if (!package.Open(argv[first])) return EXIT_FAILURE;
+    Package::Stats stats = package.Statistics();
+    fprintf(stdout, "%s: %zu entries, %zu compressed, %llu bytes stored for %llu\n", argv[first], stats.entries,
+            stats.compressed, static_cast<unsigned long long>(stats.storedBytes),
+            static_cast<unsigned long long>(stats.rawBytes));
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,386 @@
+// Local Headers
+#include "animation.hpp"
+#include "headless.hpp"
+#include "mesh.hpp"
+#include "pool.hpp"
+
+// System Headers
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Characters Animated per Millisecond at Increasing Thread Counts
+//
+//     bench_animation [characters] [frames] [threads] [image.png]
+//
+// Builds a 53-joint humanoid and two looping clips, a walk and a run,
+// resampled into compact clips. Every character cross-fades the two at its
+// own phase and weight, as a locomotion blend would. Palettes are first
+// checked against a plain glm evaluation of the same poses, then timed on
+// the CPU with 1, 2, 4 ... threads up to the given count, which defaults to
+// the core count. If a headless OpenGL context is available, a last pass
+// computes the palettes straight into a PaletteBuffer and draws every
+// character with GPU skinning, optionally saving the final frame.
+namespace
+{
+    typedef std::chrono::high_resolution_clock Clock;
+    typedef std::chrono::duration<double, std::milli> Milliseconds;
+
+    char const * Vertex = R"(
+        #version 330 core
+        layout(location = 0) in vec3 position;
+        layout(location = 1) in vec3 normal;
+        layout(location = 3) in uvec4 joints;
+        layout(location = 4) in vec4 weights;
+        uniform samplerBuffer palettes;
+        uniform int paletteBase;
+        uniform int jointCount;
+        uniform int side;
+        uniform mat4 viewProjection;
+        out vec3 surface;
+        void main()
+        {
+            int base = paletteBase + gl_InstanceID * jointCount * 3;
+            vec4 rows[3] = vec4[3](vec4(0.0), vec4(0.0), vec4(0.0));
+            for (int i = 0; i < 4; i++)
+            for (int r = 0; r < 3; r++)
+                rows[r] += weights[i] * texelFetch(palettes, base + int(joints[i]) * 3 + r);
+            vec4 p = vec4(position, 1.0);
+            vec3 skinned = vec3(dot(rows[0], p), dot(rows[1], p), dot(rows[2], p));
+            surface = vec3(dot(rows[0].xyz, normal), dot(rows[1].xyz, normal), dot(rows[2].xyz, normal));
+            vec3 offset = vec3(float(gl_InstanceID % side), 0.0, float(gl_InstanceID / side)) * 1.5;
+            gl_Position = viewProjection * vec4(skinned + offset, 1.0);
+        })";
+
+    char const * Fragment = R"(
+        #version 330 core
+        in vec3 surface;
+        out vec4 color;
+        void main()
+        {
+            float light = max(dot(normalize(surface), normalize(vec3(1, 2, 3))), 0.0);
+            color = vec4(vec3(0.8, 0.7, 0.6) * (0.3 + 0.7 * light), 1.0);
+        })";
+
+    GLuint program()
+    {
+        char const * sources[] = { Vertex, Fragment };
+        GLenum stages[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+        GLuint program = glCreateProgram();
+        for (int i = 0; i < 2; i++)
+        {   GLuint shader = glCreateShader(stages[i]);
+            glShaderSource(shader, 1, & sources[i], nullptr);
+            glCompileShader(shader);
+            glAttachShader(program, shader);
+            glDeleteShader(shader);
+        }
+        glLinkProgram(program);
+        GLint status = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, & status);
+        return status ? program : 0;
+    }
+
+    glm::quat rotation(float angle, glm::vec3 const & axis)
+    {
+        glm::vec3 v = axis * std::sin(angle * 0.5f);
+        return glm::quat(std::cos(angle * 0.5f), v.x, v.y, v.z);
+    }
+
+    int chain(Mirage::Skeleton & skeleton, std::string const & name, int parent, int count, glm::vec3 const & step)
+    {
+        for (int i = 0; i < count; i++)
+            parent = static_cast<int>(skeleton.add(name + std::to_string(i), parent, glm::translate(glm::mat4(1.0f), step)));
+        return parent;
+    }
+
+    // Hips, Spine, Head, Two Arms With Five Three-Joint Fingers Each, and Two Legs
+    Mirage::Skeleton humanoid()
+    {
+        Mirage::Skeleton skeleton;
+        int hips  = static_cast<int>(skeleton.add("hips", -1, glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 1.0f, 0.0f))));
+        int chest = chain(skeleton, "spine", hips, 4, glm::vec3(0.0f, 0.12f, 0.0f));
+        chain(skeleton, "neck", chest, 2, glm::vec3(0.0f, 0.1f, 0.0f));
+        for (float side : { -1.0f, 1.0f })
+        {   std::string prefix = side < 0.0f ? "left_" : "right_";
+            int hand = chain(skeleton, prefix + "arm", chest, 4, glm::vec3(side * 0.16f, 0.0f, 0.0f));
+            for (int finger = 0; finger < 5; finger++)
+                chain(skeleton, prefix + "finger" + std::to_string(finger) + "_", hand, 3,
+                      glm::vec3(side * 0.03f, 0.0f, (finger - 2) * 0.012f));
+            int hip = chain(skeleton, prefix + "hip", hips, 1, glm::vec3(side * 0.1f, 0.0f, 0.0f));
+            chain(skeleton, prefix + "leg", hip, 3, glm::vec3(0.0f, -0.3f, 0.0f));
+        }   return skeleton;
+    }
+
+    // Analytic Gait: Each Joint Swings About Its Own Axis, the Hips Bob Twice per Cycle
+    void gait(Mirage::Skeleton const & skeleton, float period, float amplitude, float time, Mirage::Pose & pose)
+    {
+        const float Tau = 6.28318531f;
+        pose = skeleton.bindPose();
+        for (std::size_t j = 0; j < skeleton.size(); j++)
+        {   glm::vec3 translation, scale;
+            glm::quat bind;
+            pose.get(j, translation, bind, scale);
+            float angle = amplitude * std::sin(Tau * time / period + 0.7f * j);
+            glm::vec3 axis = (j % 2) ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 0.0f, 1.0f);
+            if (j == 0) translation.y += 0.05f * std::sin(2.0f * Tau * time / period);
+            pose.set(j, translation, bind * rotation(angle, axis), scale);
+        }
+    }
+
+    Mirage::AnimationClip record(Mirage::Skeleton const & skeleton, std::string const & name, float period, float amplitude)
+    {
+        Mirage::AnimationClip clip(skeleton, period, 30.0f, name);
+        Mirage::Pose pose;
+        for (std::size_t frame = 0; frame < clip.frames(); frame++)
+        {   gait(skeleton, period, amplitude, clip.time(frame), pose);
+            for (std::size_t j = 0; j < skeleton.size(); j++)
+            {   glm::vec3 translation, scale;
+                glm::quat q;
+                pose.get(j, translation, q, scale);
+                clip.set(frame, j, translation, q, scale);
+            }
+        }   return clip;
+    }
+
+    // Scalar Reference: glm Matrices Built Joint by Joint
+    std::vector<glm::mat4> models(Mirage::Skeleton const & skeleton, Mirage::Pose const & pose)
+    {
+        std::vector<glm::mat4> model(skeleton.size());
+        for (std::size_t j = 0; j < skeleton.size(); j++)
+        {   glm::vec3 translation, scale;
+            glm::quat q;
+            pose.get(j, translation, q, scale);
+            glm::mat4 local = glm::scale(glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(q), scale);
+            model[j] = skeleton.parent(j) < 0 ? local : model[skeleton.parent(j)] * local;
+        }   return model;
+    }
+
+    void mix(Mirage::Pose const & a, Mirage::Pose const & b, float weight, Mirage::Pose & result)
+    {
+        result = a;
+        for (std::size_t j = 0; j < a.size(); j++)
+        {   glm::vec3 ta, sa, tb, sb;
+            glm::quat qa, qb;
+            a.get(j, ta, qa, sa);
+            b.get(j, tb, qb, sb);
+            if (glm::dot(qa, qb) < 0.0f) qb = -qb;
+            result.set(j, glm::mix(ta, tb, weight), glm::normalize(qa * (1.0f - weight) + qb * weight), glm::mix(sa, sb, weight));
+        }
+    }
+
+    // Every Fourth Character Plays One Clip Alone; the Rest Blend at Scattered Weights
+    std::vector<Mirage::AnimationState> populate(std::vector<Mirage::AnimationClip> const & clips, std::size_t count)
+    {
+        std::vector<Mirage::AnimationState> states(count);
+        for (std::size_t i = 0; i < count; i++)
+        {   Mirage::AnimationState & state = states[i];
+            state.clips[0] = & clips[0];
+            state.clips[1] = (i % 4) ? & clips[1] : nullptr;
+            state.times[0] = clips[0].duration() * ((i * 37) % 101) / 101.0f;
+            state.times[1] = clips[1].duration() * ((i * 53) % 97) / 97.0f;
+            state.weight = ((i * 29) % 64) / 63.0f;
+        }   return states;
+    }
+
+    void advance(std::vector<Mirage::AnimationState> & states, float seconds)
+    {
+        for (auto & state : states)
+        {   state.times[0] += seconds;
+            state.times[1] += seconds;
+        }
+    }
+
+    // Limbs as Boxes From Each Parent to Its Child; the Child End Blends Both Joints
+    void limbs(Mirage::Skeleton const & skeleton, std::vector<Mirage::Vertex> & vertices,
+               std::vector<GLuint> & indices, std::vector<Mirage::SkinWeight> & skin)
+    {
+        std::vector<glm::mat4> bind = models(skeleton, skeleton.bindPose());
+        for (std::size_t j = 0; j < skeleton.size(); j++)
+        {
+            int p = skeleton.parent(j);
+            if (p < 0) continue;
+            glm::vec3 from(bind[p][3]), to(bind[j][3]), along = to - from;
+            float length = glm::length(along);
+            glm::vec3 up = std::fabs(along.y) > 0.9f * length ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+            glm::vec3 u = glm::normalize(glm::cross(along, up)), v = glm::normalize(glm::cross(u, along));
+            float width = std::min(0.05f, std::max(0.008f, length * 0.3f));
+            glm::vec3 axes[3] = { u * width, v * width, along };
+            for (int axis = 0; axis < 3; axis++)
+            for (int sign = -1; sign <= 1; sign += 2)
+            {
+                glm::vec3 normal = glm::normalize(axes[axis]) * static_cast<float>(sign);
+                GLuint base = static_cast<GLuint>(vertices.size());
+                for (int corner = 0; corner < 4; corner++)
+                {   float c[3];
+                    c[axis] = static_cast<float>(sign);
+                    c[(axis + 1) % 3] = (corner & 1) ? 1.0f : -1.0f;
+                    c[(axis + 2) % 3] = (corner & 2) ? 1.0f : -1.0f;
+                    float t = c[2] * 0.5f + 0.5f;
+                    Mirage::Vertex vertex;
+                    vertex.position = from + axes[0] * c[0] + axes[1] * c[1] + along * t;
+                    vertex.normal = normal;
+                    vertex.uv = glm::vec2(0.0f);
+                    vertices.push_back(vertex);
+                    Mirage::SkinWeight weight = { { static_cast<std::uint8_t>(p), static_cast<std::uint8_t>(j), 0, 0 },
+                                                  { static_cast<std::uint8_t>(t > 0.5f ? 128 : 255),
+                                                    static_cast<std::uint8_t>(t > 0.5f ? 127 : 0), 0, 0 } };
+                    skin.push_back(weight);
+                }
+                GLuint quad[] = { 0, 1, 3, 0, 3, 2 };
+                for (auto index : quad) indices.push_back(base + index);
+            }
+        }
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    int frames = argc > 2 ? std::max(1, std::atoi(argv[2])) : 60;
+    unsigned int hardware = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int maximum = argc > 3 ? std::max(1, std::atoi(argv[3])) : hardware;
+    char const * image = argc > 4 ? argv[4] : nullptr;
+
+    Mirage::Skeleton skeleton = humanoid();
+    std::vector<Mirage::AnimationClip> clips;
+    clips.push_back(record(skeleton, "walk", 1.0f, 0.35f));
+    clips.push_back(record(skeleton, "run", 0.6f, 0.7f));
+    std::size_t joints = skeleton.size();
+    std::size_t keys = 0, bytes = 0;
+    for (auto const & clip : clips) { keys += clip.frames() * joints; bytes += clip.bytes(); }
+    fprintf(stdout, "%zu characters, %zu joints, %zu clips: %.1f KB, %.1f bytes per joint key (40 as floats)\n",
+            count, joints, clips.size(), bytes / 1024.0, double(bytes) / keys);
+
+    // Check Sampling, Blending and Palettes Against glm at Keyframe Times
+    std::vector<Mirage::AnimationState> states = populate(clips, count);
+    std::vector<glm::mat4> inverseBind = models(skeleton, skeleton.bindPose());
+    for (auto & matrix : inverseBind) matrix = glm::inverse(matrix);
+    float worst = 0.0f;
+    for (std::size_t i = 0; i < std::min<std::size_t>(count, 64); i++)
+    {
+        Mirage::AnimationState state = states[i];
+        state.times[0] = clips[0].time(i % clips[0].frames());
+        state.times[1] = clips[1].time(i % clips[1].frames());
+        std::vector<Mirage::Affine> palette(joints);
+        Mirage::computePalettes(skeleton, & state, 1, palette.data());
+
+        Mirage::Pose a, b;
+        gait(skeleton, clips[0].duration(), 0.35f, state.times[0], a);
+        gait(skeleton, clips[1].duration(), 0.7f,  state.times[1], b);
+        if (state.clips[1]) mix(a, b, state.weight, a);
+        std::vector<glm::mat4> model = models(skeleton, a);
+        for (std::size_t j = 0; j < joints; j++)
+        {   glm::mat4 expected = model[j] * inverseBind[j];
+            for (int r = 0; r < 3; r++)
+            for (int c = 0; c < 4; c++)
+                worst = std::max(worst, std::fabs(palette[j].rows[r][c] - expected[c][r]));
+        }
+    }
+    fprintf(stdout, "Largest palette difference from glm: %.2e\n", worst);
+    if (worst > 2e-3f)
+    {   fprintf(stderr, "Palettes Disagree With the Reference\n");
+        return EXIT_FAILURE;
+    }
+
+    // CPU Only: the Calling Thread Works Too, So n Threads Is n - 1 Pool Workers
+    std::vector<Mirage::Affine> palettes(count * joints);
+    std::vector<unsigned int> counts;
+    for (unsigned int threads = 1; threads < maximum; threads *= 2) counts.push_back(threads);
+    counts.push_back(maximum);
+    fprintf(stdout, "%8s %10s %14s %8s\n", "threads", "ms/frame", "characters/ms", "speedup");
+    double single = 0.0;
+    for (unsigned int threads : counts)
+    {
+        std::unique_ptr<Mirage::ThreadPool> pool(threads > 1 ? new Mirage::ThreadPool(threads - 1) : nullptr);
+        Mirage::computePalettes(skeleton, states.data(), count, palettes.data(), pool.get());
+        auto start = Clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        {   advance(states, 1.0f / 60.0f);
+            Mirage::computePalettes(skeleton, states.data(), count, palettes.data(), pool.get());
+        }
+        double milliseconds = Milliseconds(Clock::now() - start).count() / frames;
+        if (threads == 1) single = milliseconds;
+        fprintf(stdout, "%8u %10.3f %14.1f %8.2f\n", threads, milliseconds, count / milliseconds, single / milliseconds);
+    }
+
+    // GPU Skinning: Palettes Written Straight Into the Stream Buffer, One Instanced Draw
+    HeadlessContext context;
+    if (!context.Create(1280, 720))
+    {   fprintf(stdout, "No OpenGL Context; Skipping the Upload Pass\n");
+        return EXIT_SUCCESS;
+    }
+    GLuint shader = program();
+    if (!shader)
+    {   fprintf(stderr, "Failed to Build the Benchmark Shaders\n");
+        return EXIT_FAILURE;
+    }
+    std::vector<Mirage::Vertex> vertices;
+    std::vector<GLuint> indices;
+    std::vector<Mirage::SkinWeight> skin;
+    limbs(skeleton, vertices, indices, skin);
+    Mirage::Mesh mesh(vertices.data(), vertices.size(), indices.data(), indices.size(),
+                      std::map<GLuint, std::string>(), nullptr, nullptr,
+                      std::vector<Mirage::LevelOfDetail>(), skin.data());
+    Mirage::PaletteBuffer buffer(3 * count * joints * sizeof(Mirage::Affine) + 4096);
+
+    int side = static_cast<int>(std::ceil(std::sqrt(double(count))));
+    float extent = side * 1.5f;
+    glm::mat4 viewProjection = glm::perspective(glm::radians(50.0f), 1280.0f / 720.0f, 0.1f, extent * 4.0f)
+                             * glm::lookAt(glm::vec3(extent * 0.5f, extent * 0.45f, -extent * 0.35f),
+                                           glm::vec3(extent * 0.5f, 0.0f, extent * 0.45f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glUseProgram(shader);
+    glUniform1i(glGetUniformLocation(shader, "palettes"), 0);
+    glUniform1i(glGetUniformLocation(shader, "jointCount"), static_cast<GLint>(joints));
+    glUniform1i(glGetUniformLocation(shader, "side"), side);
+    glUniformMatrix4fv(glGetUniformLocation(shader, "viewProjection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
+    GLint paletteBase = glGetUniformLocation(shader, "paletteBase");
+    glEnable(GL_DEPTH_TEST);
+
+    unsigned int threads = counts.back();
+    std::unique_ptr<Mirage::ThreadPool> pool(threads > 1 ? new Mirage::ThreadPool(threads - 1) : nullptr);
+    double animating = 0.0, drawing = 0.0;
+    for (int frame = 0; frame < frames; frame++)
+    {
+        auto start = Clock::now();
+        advance(states, 1.0f / 60.0f);
+        GLint base;
+        Mirage::Affine * destination = buffer.allocate(count * joints, base);
+        if (!destination)
+        {   fprintf(stderr, "Palettes Do Not Fit the Stream Buffer\n");
+            return EXIT_FAILURE;
+        }
+        Mirage::computePalettes(skeleton, states.data(), count, destination, pool.get());
+        buffer.flush();
+        auto animated = Clock::now();
+
+        glClearColor(0.2f, 0.25f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glUseProgram(shader);
+        glUniform1i(paletteBase, base);
+        buffer.bind(0);
+        mesh.draw(shader, static_cast<GLsizei>(count));
+        buffer.advance();
+        glFinish();
+        animating += Milliseconds(animated - start).count();
+        drawing += Milliseconds(Clock::now() - animated).count();
+    }
+    fprintf(stdout, "GPU skinning with %u threads: %.3f ms animating into the %s buffer, %.3f ms drawing %zu triangles per frame\n",
+            threads, animating / frames, buffer.stream().Persistent() ? "mapped" : "shadowed",
+            drawing / frames, count * indices.size() / 3);
+    if (image && !context.WriteImage(image)) fprintf(stderr, "Failed to Write %s\n", image);
+    return glGetError() == GL_NO_ERROR ? EXIT_SUCCESS : EXIT_FAILURE;
+}
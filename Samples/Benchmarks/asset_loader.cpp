@@ -0,0 +1,68 @@
+// Local Headers
+#include "loader.hpp"
+
+// System Headers
+#include <dirent.h>
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// Texture Decode Throughput at 1/2/4/8 Workers; Runs Without an OpenGL Context
+//
+//     bench_asset_loader <texture directory>
+//
+// The upload hook only touches the decoded pixels, so the numbers measure
+// decoding plus the hand-off through the ready queue.
+int main(int argc, char * argv[])
+{
+    using Clock = std::chrono::high_resolution_clock;
+    if (argc < 2)
+    {   fprintf(stderr, "Usage: %s <texture directory>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Collect Every JPEG and PNG in the Directory
+    std::vector<std::string> files;
+    DIR * directory = opendir(argv[1]);
+    if (!directory)
+    {   fprintf(stderr, "Failed to Open Directory %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    while (dirent * item = readdir(directory))
+    {
+        std::string name = item->d_name;
+        auto index = name.rfind(".");
+        if (index == std::string::npos) continue;
+        std::string ext = name.substr(index + 1);
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        if (ext == "jpg" || ext == "jpeg" || ext == "png")
+            files.push_back(std::string(argv[1]) + "/" + name);
+    }   closedir(directory);
+
+    std::size_t pixels = 0;
+    auto upload = [&pixels](Mirage::Image const & image) -> GLuint
+    {   pixels += static_cast<std::size_t>(image.width) * image.height;
+        return image.pixels[0] + 1;
+    };
+
+    fprintf(stdout, "%zu textures in %s\n", files.size(), argv[1]);
+    fprintf(stdout, "%8s %10s %10s %9s\n", "workers", "ms", "MP/s", "speedup");
+    double baseline = 0.0;
+    for (unsigned int workers : { 1u, 2u, 4u, 8u })
+    {
+        pixels = 0;
+        auto start = Clock::now();
+        {
+            Mirage::AssetLoader loader(workers, upload);
+            for (auto const & file : files) loader.request(file);
+            loader.finish();
+        }
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (workers == 1) baseline = ms;
+        fprintf(stdout, "%8u %10.2f %10.2f %8.2fx\n", workers, ms,
+                pixels / (ms * 1000.0), baseline / ms);
+    }   return EXIT_SUCCESS;
+}
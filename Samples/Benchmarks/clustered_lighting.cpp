@@ -0,0 +1,216 @@
+// Local Headers
+#include "headless.hpp"
+#include "lighting.hpp"
+#include "mesh.hpp"
+#include "pool.hpp"
+
+// System Headers
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Forward Shading Against Clustered Deferred Shading as the Light Count Grows
+//
+//     bench_clustered_lighting [frames] [width] [height]
+//
+// Renders a field of boxes lit by 64, 256 and 1024 point lights, first with
+// every fragment looping over every light, then through the G-buffer with
+// the lights binned on the GPU and on the CPU. Each frame is timed up to a
+// glFinish(). The GPU's light lists are read back and compared with the CPU
+// reference cluster by cluster, and the deferred image is compared with the
+// forward one. A few lights that graze a cluster's corner may land on
+// different sides of the test on each, so a handful of differing clusters is
+// expected; the images only have to match while no cluster is full, since a
+// full one drops lights the forward path still applies.
+namespace
+{
+    typedef std::chrono::high_resolution_clock Clock;
+    typedef std::chrono::duration<double, std::milli> Milliseconds;
+
+    // Unit Cube With Per-Face Normals
+    void cube(std::vector<Mirage::Vertex> & vertices, std::vector<GLuint> & indices)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        for (int sign = -1; sign <= 1; sign += 2)
+        {
+            glm::vec3 normal(0.0f), u(0.0f), v(0.0f);
+            normal[axis] = static_cast<float>(sign);
+            u[(axis + 1) % 3] = 0.5f;
+            v[(axis + 2) % 3] = 0.5f;
+            GLuint base = static_cast<GLuint>(vertices.size());
+            for (int corner = 0; corner < 4; corner++)
+            {   Mirage::Vertex vertex;
+                float a = (corner & 1) ? 1.0f : -1.0f, b = (corner & 2) ? 1.0f : -1.0f;
+                vertex.position = normal * 0.5f + u * a + v * b;
+                vertex.normal = normal;
+                vertex.uv = glm::vec2(a, b);
+                vertices.push_back(vertex);
+            }
+            GLuint quad[] = { 0, 1, 3, 0, 3, 2 };
+            for (auto index : quad) indices.push_back(base + index);
+        }
+    }
+
+    // Reproducible Scene: a Floor Slab and a Grid of Boxes of Varying Height
+    struct Object
+    {
+        glm::mat4 model;
+        glm::vec4 color;
+    };
+
+    std::vector<Object> scene(int side, float spacing)
+    {
+        std::vector<Object> objects;
+        Object floor = { glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -0.5f, 0.0f)),
+                                    glm::vec3(side * spacing, 1.0f, side * spacing)),
+                         glm::vec4(0.8f, 0.8f, 0.8f, 0.2f) };
+        objects.push_back(floor);
+        for (int z = 0; z < side; z++)
+        for (int x = 0; x < side; x++)
+        {   float height = 1.0f + float((x * 7 + z * 13) % 5);
+            glm::vec3 position((x - side * 0.5f + 0.5f) * spacing, height * 0.5f, (z - side * 0.5f + 0.5f) * spacing);
+            Object box = { glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(1.0f, height, 1.0f)),
+                           glm::vec4(0.4f + 0.6f * float(x % 3) / 2.0f, 0.4f + 0.6f * float(z % 4) / 3.0f, 0.7f, 0.8f) };
+            objects.push_back(box);
+        }   return objects;
+    }
+
+    void scatter(std::vector<Mirage::PointLight> & lights, std::size_t count, float extent, std::mt19937 & random)
+    {
+        std::uniform_real_distribution<float> across(-extent, extent), up(0.3f, 4.0f);
+        std::uniform_real_distribution<float> radius(3.0f, 8.0f), hue(0.2f, 1.0f);
+        lights.resize(count);
+        for (auto & light : lights)
+        {   light.position = glm::vec4(across(random), up(random), across(random), radius(random));
+            light.color = glm::vec4(hue(random), hue(random), hue(random), 16.0f / std::sqrt(float(count)));
+        }
+    }
+
+    // Clusters Whose Lists Differ, and How Many Lights Differ Between Them
+    void compare(Mirage::LightGrid const & a, Mirage::LightGrid const & b, std::size_t & clusters, std::size_t & lights)
+    {
+        clusters = lights = 0;
+        for (std::size_t c = 0; c * 2 < a.cells.size(); c++)
+        {   auto first = a.indices.begin() + a.cells[c * 2], second = b.indices.begin() + b.cells[c * 2];
+            std::vector<std::uint32_t> left(first, first + a.cells[c * 2 + 1]), right(second, second + b.cells[c * 2 + 1]);
+            if (left == right) continue;
+            std::vector<std::uint32_t> difference;
+            std::set_symmetric_difference(left.begin(), left.end(), right.begin(), right.end(), std::back_inserter(difference));
+            clusters++;
+            lights += difference.size();
+        }
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    int frames = argc > 1 ? std::atoi(argv[1]) : 10;
+    int width  = argc > 2 ? std::atoi(argv[2]) : 1280;
+    int height = argc > 3 ? std::atoi(argv[3]) : 720;
+
+    HeadlessContext context;
+    if (!context.Create(width, height)) return EXIT_FAILURE;
+    if (!GLAD_GL_VERSION_4_3)
+    {   fprintf(stderr, "Clustered Shading Needs OpenGL 4.3\n");
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Mirage::Vertex> vertices;
+    std::vector<GLuint> indices;
+    cube(vertices, indices);
+    Mirage::Mesh mesh(vertices, indices, std::map<GLuint, std::string>());
+    std::vector<Object> objects = scene(24, 3.0f);
+    auto draw = [&](Mirage::ClusteredRenderer::Pass const & pass)
+    {
+        for (auto const & object : objects)
+        {   glUniformMatrix4fv(pass.model, 1, GL_FALSE, glm::value_ptr(object.model));
+            glUniform4fv(pass.color, 1, glm::value_ptr(object.color));
+            mesh.draw(pass.program);
+        }
+    };
+
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), float(width) / float(height), 0.5f, 150.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 22.0f, 48.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    Mirage::ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    Mirage::ClusteredRenderer renderer(width, height, 1024);
+    renderer.pool(& pool);
+    Mirage::ClusterGrid const & grid = renderer.grid();
+
+    std::mt19937 random(1234);
+    bool valid = glGetError() == GL_NO_ERROR;
+    printf("Renderer: %s, %dx%d, %d x %d x %d clusters\n", reinterpret_cast<char const *>(glGetString(GL_RENDERER)),
+           width, height, grid.tilesX, grid.tilesY, grid.slices);
+    printf("%8s %16s %12s %12s %12s %14s %14s\n", "Lights", "Path", "Frame (ms)", "Lights/Cell", "Full Cells",
+           "Lists Differ", "Pixels Differ");
+    for (std::size_t count : { 64, 256, 1024 })
+    {
+        scatter(renderer.lights(), count, 36.0f, random);
+        struct Path { char const * name; Mirage::ClusteredRenderer::Mode mode; Mirage::ClusteredRenderer::Binning binning; };
+        Path paths[] = { { "forward",      Mirage::ClusteredRenderer::Mode::Forward,  Mirage::ClusteredRenderer::Binning::Gpu },
+                         { "deferred/gpu", Mirage::ClusteredRenderer::Mode::Deferred, Mirage::ClusteredRenderer::Binning::Gpu },
+                         { "deferred/cpu", Mirage::ClusteredRenderer::Mode::Deferred, Mirage::ClusteredRenderer::Binning::Cpu } };
+        std::vector<unsigned char> reference, image;
+        for (auto const & path : paths)
+        {
+            renderer.mode(path.mode);
+            renderer.binning(path.binning);
+            renderer.render(view, projection, draw);
+            glFinish();
+            auto start = Clock::now();
+            for (int frame = 0; frame < frames; frame++)
+                renderer.render(view, projection, draw);
+            glFinish();
+            double elapsed = Milliseconds(Clock::now() - start).count() / frames;
+
+            // The Forward Image Is the Reference Every Deferred Frame Should Match
+            context.ReadPixels(path.mode == Mirage::ClusteredRenderer::Mode::Forward ? reference : image);
+            if (path.mode == Mirage::ClusteredRenderer::Mode::Forward)
+            {   printf("%8zu %16s %12.2f %12s %12s %14s %14s\n", count, path.name, elapsed, "-", "-", "-", "-");
+                continue;
+            }
+            std::size_t pixels = 0;
+            for (std::size_t i = 0; i < image.size(); i += 3)
+                if (std::abs(image[i] - reference[i]) > 4 || std::abs(image[i + 1] - reference[i + 1]) > 4
+                    || std::abs(image[i + 2] - reference[i + 2]) > 4) pixels++;
+
+            // Bin the Same View-Space Lights on the CPU and Hold the GPU's Lists Against Them
+            std::vector<Mirage::PointLight> lights = renderer.lights();
+            for (auto & light : lights)
+            {   glm::vec4 position = view * glm::vec4(light.position.x, light.position.y, light.position.z, 1.0f);
+                light.position = glm::vec4(position.x, position.y, position.z, light.position.w);
+            }
+            Mirage::LightGrid gpu, cpu;
+            renderer.read(gpu);
+            Mirage::bin(grid, projection, lights, cpu, & pool);
+            std::size_t clusters, differing;
+            compare(gpu, cpu, clusters, differing);
+            std::size_t full = 0;
+            for (std::size_t c = 0; c < grid.size(); c++)
+                if (cpu.cells[c * 2 + 1] == Mirage::ClusteredRenderer::MaxLightsPerCluster) full++;
+            double perCell = double(cpu.indices.size()) / grid.size();
+            char lists[32];
+            snprintf(lists, sizeof(lists), "%zu (%zu)", clusters, differing);
+            printf("%8zu %16s %12.2f %12.2f %12zu %14s %13.2f%%\n", count, path.name, elapsed, perCell, full, lists,
+                   100.0 * pixels / (image.size() / 3));
+            valid = valid && clusters * 200 <= grid.size() && (full > 0 || pixels * 100 <= image.size() / 3);
+        }
+    }
+
+    valid = valid && glGetError() == GL_NO_ERROR;
+    if (!valid) fprintf(stderr, "Deferred Output Disagrees With the Forward Reference\n");
+    return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
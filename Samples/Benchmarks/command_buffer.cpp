@@ -0,0 +1,344 @@
+// Local Headers
+#include "batch.hpp"
+#include "command.hpp"
+#include "headless.hpp"
+#include "mesh.hpp"
+#include "pool.hpp"
+
+// System Headers
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// State Changes per Frame Before and After Sorting the Command Buffer
+//
+//     bench_command_buffer [frames] [objects]
+//
+// A grid of textured boxes drawn with four programs, 24 materials and three
+// shapes, in the shuffled order a scene traversal would visit them. Every
+// frame is recorded from all cores into per-thread buckets, then submitted
+// three ways: in recorded order binding everything for every packet, which
+// is what Mesh::draw() does; in recorded order with redundant binds
+// skipped; and radix sorted by key with redundant binds skipped. The images
+// of the last two are compared with the first. Then the same boxes are baked
+// in place as a static scene and drawn once as one Mesh per submesh, each
+// with its own vertex array and draw call, and once from a MeshBatch, which
+// issues one multi-draw per texture set; both batch paths must match the
+// per-submesh image.
+namespace
+{
+    typedef std::chrono::high_resolution_clock Clock;
+    typedef std::chrono::duration<double, std::milli> Milliseconds;
+
+    char const * Vertex = R"(
+        #version 330 core
+        layout(location = 0) in vec3 position;
+        layout(location = 1) in vec3 normal;
+        layout(location = 2) in vec2 uv;
+        uniform mat4 viewProjection;
+        uniform mat4 model;
+        out vec3 surface;
+        out vec2 coordinates;
+        void main()
+        {
+            surface = mat3(model) * normal;
+            coordinates = uv;
+            gl_Position = viewProjection * model * vec4(position, 1.0);
+        })";
+
+    // Four Variants of One Fragment Shader, So Programs Differ Only by Name
+    char const * Fragment = R"(
+        #version 330 core
+        in vec3 surface;
+        in vec2 coordinates;
+        uniform sampler2D diffuse;
+        uniform vec4 tint;
+        out vec4 color;
+        void main()
+        {
+            vec4 albedo = texture(diffuse, coordinates * 0.5 + 0.5) * tint;
+            float light = max(dot(normalize(surface), normalize(vec3(1, 2, 3))), 0.0);
+        #if VARIANT == 1
+            light = floor(light * 4.0) / 4.0;
+        #elif VARIANT == 2
+            albedo.rgb = albedo.bgr;
+        #elif VARIANT == 3
+            albedo.rgb = vec3(dot(albedo.rgb, vec3(0.3, 0.59, 0.11)));
+        #endif
+            color = vec4(albedo.rgb * (0.3 + 0.7 * light), 1.0);
+        })";
+
+    GLuint program(int variant)
+    {
+        std::string fragment = Fragment;
+        fragment.insert(fragment.find('\n', fragment.find("#version")) + 1, "#define VARIANT " + std::to_string(variant) + "\n");
+        char const * sources[] = { Vertex, fragment.c_str() };
+        GLenum stages[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+        GLuint program = glCreateProgram();
+        for (int i = 0; i < 2; i++)
+        {   GLuint shader = glCreateShader(stages[i]);
+            glShaderSource(shader, 1, & sources[i], nullptr);
+            glCompileShader(shader);
+            glAttachShader(program, shader);
+            glDeleteShader(shader);
+        }
+        glLinkProgram(program);
+        GLint status = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, & status);
+        return status ? program : 0;
+    }
+
+    // Box With Per-Face Normals, Stretched to the Given Size
+    void box(glm::vec3 const & size, std::vector<Mirage::Vertex> & vertices, std::vector<GLuint> & indices)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        for (int sign = -1; sign <= 1; sign += 2)
+        {
+            glm::vec3 normal(0.0f), u(0.0f), v(0.0f);
+            normal[axis] = static_cast<float>(sign);
+            u[(axis + 1) % 3] = 0.5f;
+            v[(axis + 2) % 3] = 0.5f;
+            GLuint base = static_cast<GLuint>(vertices.size());
+            for (int corner = 0; corner < 4; corner++)
+            {   Mirage::Vertex vertex;
+                float a = (corner & 1) ? 1.0f : -1.0f, b = (corner & 2) ? 1.0f : -1.0f;
+                vertex.position = (normal * 0.5f + u * a + v * b) * size;
+                vertex.normal = normal;
+                vertex.uv = glm::vec2(a, b);
+                vertices.push_back(vertex);
+            }
+            GLuint quad[] = { 0, 1, 3, 0, 3, 2 };
+            for (auto index : quad) indices.push_back(base + index);
+        }
+    }
+
+    // Small Checkerboard in Two Colors
+    GLuint texture(std::mt19937 & random)
+    {
+        std::uniform_int_distribution<int> channel(64, 255);
+        unsigned char a[] = { (unsigned char) channel(random), (unsigned char) channel(random), (unsigned char) channel(random), 255 };
+        unsigned char b[] = { (unsigned char) (a[0] / 2), (unsigned char) (a[1] / 2), (unsigned char) (a[2] / 2), 255 };
+        std::vector<unsigned char> pixels;
+        for (int texel = 0; texel < 16; texel++)
+            pixels.insert(pixels.end(), ((texel % 4 + texel / 4) % 2) ? a : b, (((texel % 4 + texel / 4) % 2) ? a : b) + 4);
+        GLuint name;
+        glGenTextures(1, & name);
+        glBindTexture(GL_TEXTURE_2D, name);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 4, 4, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        return name;
+    }
+
+    struct Object
+    {
+        std::size_t mesh;
+        std::size_t program;
+        glm::mat4 model;
+        glm::vec4 tint;
+        glm::vec3 position;
+    };
+
+    struct Row
+    {
+        char const * name;
+        bool sorted;
+        bool tracking;
+    };
+}
+
+int main(int argc, char * argv[])
+{
+    int frames = argc > 1 ? std::atoi(argv[1]) : 20;
+    std::size_t count = argc > 2 ? std::atoi(argv[2]) : 4096;
+    const int Width = 1280, Height = 720;
+    const std::size_t Programs = 4, Materials = 24, Shapes = 3;
+
+    HeadlessContext context;
+    if (!context.Create(Width, Height)) return EXIT_FAILURE;
+    std::mt19937 random(1234);
+
+    // Every Shape and Material Pairing Is a Mesh of Its Own, Each With a Vertex Array
+    GLuint programs[Programs];
+    GLint models[Programs], tints[Programs];
+    for (std::size_t i = 0; i < Programs; i++)
+    {   programs[i] = program(static_cast<int>(i));
+        if (!programs[i])
+        {   fprintf(stderr, "Failed to Build the Benchmark Shaders\n");
+            return EXIT_FAILURE;
+        }
+        models[i] = glGetUniformLocation(programs[i], "model");
+        tints[i] = glGetUniformLocation(programs[i], "tint");
+    }
+    std::vector<GLuint> textures;
+    for (std::size_t i = 0; i < Materials; i++) textures.push_back(texture(random));
+    glm::vec3 sizes[Shapes] = { glm::vec3(1.0f), glm::vec3(1.6f, 0.5f, 1.6f), glm::vec3(0.6f, 2.0f, 0.6f) };
+    std::vector<std::unique_ptr<Mirage::Mesh>> meshes;
+    for (std::size_t shape = 0; shape < Shapes; shape++)
+    for (std::size_t material = 0; material < Materials; material++)
+    {   std::vector<Mirage::Vertex> vertices;
+        std::vector<GLuint> indices;
+        box(sizes[shape], vertices, indices);
+        std::map<GLuint, std::string> set;
+        set[textures[material]] = "diffuse";
+        meshes.emplace_back(new Mirage::Mesh(vertices, indices, set));
+    }
+
+    // A Grid Visited in Shuffled Order, Like Objects Coming Out of a Scene Graph
+    std::vector<Object> objects(count);
+    std::size_t side = static_cast<std::size_t>(std::ceil(std::sqrt(double(count))));
+    std::uniform_int_distribution<std::size_t> pickMesh(0, meshes.size() - 1), pickProgram(0, Programs - 1);
+    std::uniform_real_distribution<float> shade(0.6f, 1.0f);
+    for (std::size_t i = 0; i < count; i++)
+    {   Object & object = objects[i];
+        object.position = glm::vec3((float(i % side) - side * 0.5f) * 2.5f, 0.0f, (float(i / side) - side * 0.5f) * 2.5f);
+        object.mesh = pickMesh(random);
+        object.program = pickProgram(random);
+        object.model = glm::translate(glm::mat4(1.0f), object.position);
+        object.tint = glm::vec4(shade(random), shade(random), shade(random), 1.0f);
+    }
+    std::shuffle(objects.begin(), objects.end(), random);
+
+    glm::vec3 eye(0.0f, side * 1.2f, side * 1.6f);
+    glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), float(Width) / Height, 0.5f, side * 8.0f)
+                             * glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    for (std::size_t i = 0; i < Programs; i++)
+    {   glUseProgram(programs[i]);
+        glUniformMatrix4fv(glGetUniformLocation(programs[i], "viewProjection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
+    }
+    glEnable(GL_DEPTH_TEST);
+
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    Mirage::ThreadPool pool(threads);
+    Mirage::CommandBuffer commands(threads);
+    auto record = [&](std::size_t bucket)
+    {
+        Mirage::CommandBucket & out = commands.bucket(bucket);
+        std::size_t first = count * bucket / commands.buckets(), last = count * (bucket + 1) / commands.buckets();
+        for (std::size_t i = first; i < last; i++)
+        {   Object const & object = objects[i];
+            out.uniform(models[object.program], object.model);
+            out.uniform(tints[object.program], object.tint);
+            meshes[object.mesh]->record(out, 0, programs[object.program], glm::length(object.position - eye));
+        }
+    };
+
+    printf("Renderer: %s, %zu objects, %zu programs, %zu materials, %zu meshes, %u buckets\n",
+           reinterpret_cast<char const *>(glGetString(GL_RENDERER)), count, Programs, Materials, meshes.size(), threads);
+    printf("%-20s %9s %9s %9s %9s %9s %9s %11s %10s %10s %11s %10s %9s\n", "Order", "Programs", "Arrays",
+           "Units", "Textures", "Samplers", "Uniforms", "State/Frame", "Record ms", "Sort ms", "Submit ms", "Frame ms",
+           "Differ");
+    Row rows[] = { { "recorded, bind all", false, false },
+                   { "recorded, tracked",  false, true  },
+                   { "sorted, tracked",    true,  true  } };
+    bool valid = true;
+    std::size_t baseline = 0;
+    std::vector<unsigned char> reference, image;
+    for (auto const & row : rows)
+    {
+        Mirage::RenderBackend backend(row.tracking);
+        double recording = 0.0, sorting = 0.0, submitting = 0.0, total = 0.0;
+        for (int frame = -1; frame < frames; frame++)
+        {
+            // The First Frame Warms Up; the Backend Carries Its State From One Frame to the Next
+            if (frame == 0) backend.reset();
+            auto start = Clock::now();
+            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            commands.clear();
+            pool.run(commands.buckets(), record);
+            auto recorded = Clock::now();
+            if (row.sorted) commands.sort();
+            auto sorted = Clock::now();
+            commands.submit(backend);
+            auto submitted = Clock::now();
+            glFinish();
+            if (frame < 0) continue;
+            recording += Milliseconds(recorded - start).count();
+            sorting += Milliseconds(sorted - recorded).count();
+            submitting += Milliseconds(submitted - sorted).count();
+            total += Milliseconds(Clock::now() - start).count();
+        }
+
+        // Every Order Has to Produce the Same Picture
+        std::size_t differ = 0;
+        context.ReadPixels(reference.empty() ? reference : image);
+        if (!image.empty())
+            for (std::size_t i = 0; i < image.size(); i += 3)
+                differ += image[i] != reference[i] || image[i + 1] != reference[i + 1] || image[i + 2] != reference[i + 2];
+
+        Mirage::StateChanges const & changes = backend.changes();
+        std::size_t state = changes.total() / frames;
+        if (baseline == 0) baseline = state;
+        valid = valid && differ * 1000 <= reference.size() / 3 && changes.draws == std::size_t(frames) * count;
+        printf("%-20s %9zu %9zu %9zu %9zu %9zu %9zu %11zu %10.2f %10.2f %11.2f %10.2f %8.3f%%\n", row.name,
+               changes.programs / frames, changes.vertexArrays / frames, changes.units / frames,
+               changes.textures / frames, changes.samplers / frames, changes.uniforms / frames, state,
+               recording / frames, sorting / frames, submitting / frames, total / frames,
+               image.empty() ? 0.0 : 100.0 * differ / (image.size() / 3));
+        if (row.sorted) printf("Sorting removes %.1f%% of the state changes\n", 100.0 - 100.0 * state / baseline);
+    }
+
+    // Static Scene: Boxes Baked Into World Space, Every One a Submesh With Its Own Textures
+    std::vector<std::unique_ptr<Mirage::Mesh>> submeshes;
+    Mirage::MeshBatch batch;
+    for (auto const & object : objects)
+    {   std::vector<Mirage::Vertex> vertices;
+        std::vector<GLuint> indices;
+        box(sizes[object.mesh / Materials], vertices, indices);
+        for (auto & vertex : vertices) vertex.position += object.position;
+        std::map<GLuint, std::string> set;
+        set[textures[object.mesh % Materials]] = "diffuse";
+        submeshes.emplace_back(new Mirage::Mesh(vertices, indices, set));
+        batch.append(vertices.data(), vertices.size(), indices.data(), indices.size(), set);
+    }
+    glUseProgram(programs[0]);
+    glUniformMatrix4fv(models[0], 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+    glUniform4f(tints[0], 1.0f, 1.0f, 1.0f, 1.0f);
+
+    printf("\n%-20s %11s %10s %9s\n", "Static Scene", "Draws/Frame", "Frame ms", "Differ");
+    std::vector<unsigned char> separate;
+    for (int path = 0; path < 3; path++)
+    {
+        char const * names[] = { "per-submesh", "batch, multi-draw", "batch, indirect" };
+        double total = 0.0;
+        for (int frame = -1; frame < frames; frame++)
+        {   auto start = Clock::now();
+            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            if (path == 0) for (auto & mesh : submeshes) mesh->draw(programs[0]);
+            else batch.draw(programs[0], path == 2);
+            glFinish();
+            if (frame >= 0) total += Milliseconds(Clock::now() - start).count();
+        }
+
+        std::size_t differ = 0;
+        context.ReadPixels(path == 0 ? separate : image);
+        if (path > 0)
+            for (std::size_t i = 0; i < image.size(); i += 3)
+                differ += image[i] != separate[i] || image[i + 1] != separate[i + 1] || image[i + 2] != separate[i + 2];
+        valid = valid && differ * 1000 <= separate.size() / 3;
+        printf("%-20s %11zu %10.2f %8.3f%%\n", names[path], path == 0 ? submeshes.size() : batch.groups(),
+               total / frames, path == 0 ? 0.0 : 100.0 * differ / (separate.size() / 3));
+    }
+
+    valid = valid && glGetError() == GL_NO_ERROR;
+    for (auto name : textures) glDeleteTextures(1, & name);
+    for (auto name : programs) glDeleteProgram(name);
+    if (!valid) fprintf(stderr, "Submission Orders or Batched Draws Disagree\n");
+    return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
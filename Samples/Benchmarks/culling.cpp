@@ -0,0 +1,122 @@
+// Local Headers
+#include "culling.hpp"
+
+// System Headers
+#include <glm/gtc/matrix_transform.hpp>
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+// BVH Frustum and Occlusion Culling Against a Brute-Force Loop; Runs Without a GPU
+//
+//     bench_culling [boxes] [views]
+//
+// Scatters boxes through a large volume, then looks at them from several
+// directions. Exits with failure if the BVH, on one thread or many, keeps a
+// different set of boxes than testing every box against the frustum.
+int main(int argc, char * argv[])
+{
+    using Clock = std::chrono::high_resolution_clock;
+    std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    int views = argc > 2 ? std::max(1, std::atoi(argv[2])) : 16;
+
+    // Reproducible Scene: Small Boxes in a Cube Around the Camera
+    std::mt19937 random(1337);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> size(0.5f, 5.0f);
+    std::vector<Mirage::Bounds> boxes(count);
+    Mirage::Scene scene;
+    for (std::size_t i = 0; i < count; i++)
+    {   glm::vec3 center(position(random), position(random), position(random));
+        glm::vec3 extent(size(random), size(random), size(random));
+        boxes[i].min = center - extent;
+        boxes[i].max = center + extent;
+        scene.add(boxes[i], static_cast<std::uint32_t>(i));
+    }
+
+    auto start = Clock::now();
+    scene.build();
+    double build = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    fprintf(stdout, "%zu boxes, %zu nodes, built in %.2f ms\n", scene.size(), scene.nodes(), build);
+
+    // A Wall of Occluders a Short Distance in Front of the Camera
+    Mirage::ThreadPool pool(std::thread::hardware_concurrency());
+    Mirage::OcclusionBuffer occlusion;
+    std::vector<Mirage::Bounds> walls;
+    for (int i = -2; i <= 2; i++)
+    {   Mirage::Bounds wall = { glm::vec3(i * 12.0f - 5.0f, -20.0f, -40.0f),
+                                glm::vec3(i * 12.0f + 5.0f,  20.0f, -38.0f) };
+        walls.push_back(wall);
+    }
+
+    bool mismatch = false;
+    double times[4] = { 0.0, 0.0, 0.0, 0.0 };
+    Mirage::Scene::Statistics totals[4] = {};
+    std::vector<std::uint32_t> reference, serial, parallel, occluded;
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+    for (int view = 0; view < views; view++)
+    {
+        // Turn the Camera Around the Vertical Axis; the Walls Turn With It
+        glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), view * 6.2831853f / views, glm::vec3(0, 1, 0));
+        glm::mat4 viewProjection = projection * rotation;
+        Mirage::Frustum frustum(viewProjection);
+
+        start = Clock::now();
+        reference.clear();
+        for (std::size_t i = 0; i < count; i++)
+            if (frustum.visible(boxes[i])) reference.push_back(static_cast<std::uint32_t>(i));
+        times[0] += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        totals[0].total   += count;
+        totals[0].tested  += count;
+        totals[0].visible += reference.size();
+        totals[0].frustum += count - reference.size();
+
+        Mirage::Scene::Statistics statistics[3];
+        start = Clock::now();
+        statistics[0] = scene.cull(frustum, serial);
+        times[1] += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        start = Clock::now();
+        statistics[1] = scene.cull(frustum, parallel, & pool);
+        times[2] += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        // Occluders Are Drawn Every Frame, So Their Cost Counts
+        start = Clock::now();
+        occlusion.begin(viewProjection);
+        glm::mat4 inverse = glm::transpose(rotation);
+        for (auto const & wall : walls) occlusion.rasterize(Mirage::transform(wall, inverse));
+        statistics[2] = scene.cull(frustum, occluded, & pool, & occlusion);
+        times[3] += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        for (int i = 0; i < 3; i++)
+        {   totals[i + 1].total    += statistics[i].total;
+            totals[i + 1].tested   += statistics[i].tested;
+            totals[i + 1].frustum  += statistics[i].frustum;
+            totals[i + 1].occluded += statistics[i].occluded;
+            totals[i + 1].visible  += statistics[i].visible;
+        }
+
+        // Traversal Order Differs From Index Order; Compare as Sets
+        if (serial != parallel) mismatch = true;
+        std::sort(serial.begin(), serial.end());
+        if (serial != reference) mismatch = true;
+        for (auto statistic : statistics)
+            if (statistic.frustum + statistic.occluded + statistic.visible != count)
+                mismatch = true;
+    }
+
+    char const * names[4] = { "brute force", "bvh", "bvh + pool", "bvh + pool + occlusion" };
+    fprintf(stdout, "%-24s %10s %10s %10s %10s %8s %9s\n", "mode", "tests", "frustum",
+            "occluded", "visible", "culled", "ms/view");
+    for (int i = 0; i < 4; i++)
+        fprintf(stdout, "%-24s %10zu %10zu %10zu %10zu %7.1f%% %9.3f\n", names[i],
+                totals[i].tested / views, totals[i].frustum / views, totals[i].occluded / views,
+                totals[i].visible / views, 100.0 * (totals[i].total - totals[i].visible) / totals[i].total,
+                times[i] / views);
+    if (mismatch) fprintf(stderr, "BVH results do not match the brute-force reference\n");
+    return mismatch ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,267 @@
+// Local Headers
+#include "gpu_allocator.hpp"
+#include "gpu_buffer.hpp"
+#include "headless.hpp"
+
+// System Headers
+#include <glad/glad.h>
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+// Sub-Allocator Timing, Then Streaming and Heap Uploads; the First Half Needs No GPU
+//
+//     bench_gpu_allocator [operations]
+//
+// Replays one random mix of mesh-sized allocations and frees against the
+// TLSF allocator and a sorted first-fit list, and drives the ring like a
+// stream with three frames in flight. With a headless context the last
+// section streams through a StreamBuffer and packs meshes into a BufferHeap,
+// next to one glBufferData buffer per mesh. test_gpu_allocator checks the
+// ranges these allocators hand out.
+namespace
+{
+    typedef std::chrono::high_resolution_clock Clock;
+
+    struct Operation
+    {
+        std::size_t size;
+        std::size_t alignment;
+        std::size_t victim; // Index Into the Live List, or Allocate If Out of Range
+    };
+
+    // Sorted Free List Searched Front to Back; Coalesces on Free
+    class FirstFit
+    {
+    public:
+        FirstFit(std::size_t capacity) { mFree[0] = capacity; }
+        std::size_t allocate(std::size_t size, std::size_t alignment)
+        {
+            for (auto i = mFree.begin(); i != mFree.end(); ++i)
+            {   std::size_t start = (i->first + alignment - 1) & ~(alignment - 1);
+                if (start + size > i->first + i->second) continue;
+                std::size_t offset = i->first, end = i->first + i->second;
+                mFree.erase(i);
+                if (start > offset) mFree[offset] = start - offset;
+                if (end > start + size) mFree[start + size] = end - start - size;
+                return start;
+            }   return InvalidOffset;
+        }
+        void free(std::size_t offset, std::size_t size)
+        {
+            auto next = mFree.lower_bound(offset);
+            if (next != mFree.end() && next->first == offset + size)
+            {   size += next->second;
+                next = mFree.erase(next);
+            }
+            if (next != mFree.begin())
+            {   auto previous = std::prev(next);
+                if (previous->first + previous->second == offset)
+                {   previous->second += size;
+                    return;
+                }
+            }   mFree[offset] = size;
+        }
+    private:
+        std::map<std::size_t, std::size_t> mFree;
+    };
+
+    std::vector<Operation> workload(std::size_t count, std::size_t target, std::mt19937 & random)
+    {
+        // Sizes Are Log-Uniform From 64 Bytes to 256 KB; the Live Count Hovers Around target
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        std::vector<Operation> operations;
+        std::size_t live = 0;
+        for (std::size_t i = 0; i < count; i++)
+        {   Operation operation = { static_cast<std::size_t>(64.0 * std::pow(4096.0, unit(random))),
+                                    std::size_t(16) << (random() % 5), ~std::size_t(0) };
+            if (live > 0 && unit(random) < (live < target ? 0.4 : 0.6))
+                operation.victim = random() % live--;
+            else live++;
+            operations.push_back(operation);
+        }   return operations;
+    }
+
+    void print(char const * name, double nanoseconds, AllocatorStats const & stats)
+    {
+        double free = double(stats.capacity - stats.used);
+        fprintf(stdout, "%-12s %9.1f %12zu %12zu %8zu %10llu %13.1f%%\n", name, nanoseconds,
+                stats.used, stats.peak, stats.live, static_cast<unsigned long long>(stats.failures),
+                free > 0 ? 100.0 * (1.0 - stats.largestFree / free) : 0.0);
+    }
+
+    void general(std::vector<Operation> const & operations, std::size_t capacity)
+    {
+        fprintf(stdout, "%-12s %9s %12s %12s %8s %10s %14s\n", "allocator", "ns/op", "used",
+                "peak", "live", "failures", "fragmented");
+
+        // Both Replay the Same Operations
+        {
+            TlsfAllocator tlsf(capacity);
+            std::vector<TlsfAllocator::Allocation> live;
+            auto start = Clock::now();
+            for (auto const & operation : operations)
+            {   if (operation.victim < live.size())
+                {   tlsf.Free(live[operation.victim]);
+                    live[operation.victim] = live.back();
+                    live.pop_back();
+                }
+                else live.push_back(tlsf.Allocate(operation.size, operation.alignment));
+            }
+            double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            print("tlsf", elapsed / operations.size(), tlsf.Stats());
+        }
+        {
+            FirstFit list(capacity);
+            std::vector<std::pair<std::size_t, std::size_t>> live;
+            std::size_t used = 0, peak = 0, failures = 0;
+            auto start = Clock::now();
+            for (auto const & operation : operations)
+            {   if (operation.victim < live.size())
+                {   if (live[operation.victim].first != InvalidOffset)
+                    {   list.free(live[operation.victim].first, live[operation.victim].second);
+                        used -= live[operation.victim].second;
+                    }
+                    live[operation.victim] = live.back();
+                    live.pop_back();
+                }
+                else
+                {   std::size_t offset = list.allocate(operation.size, operation.alignment);
+                    failures += offset == InvalidOffset;
+                    if (offset != InvalidOffset) used += operation.size;
+                    peak = std::max(peak, used);
+                    live.push_back(std::make_pair(offset, operation.size));
+                }
+            }
+            double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            AllocatorStats stats;
+            stats.capacity = capacity;
+            stats.used = used;
+            stats.peak = peak;
+            stats.live = live.size();
+            stats.failures = failures;
+            stats.largestFree = capacity - used; // Not Tracked; Reported as Unfragmented
+            print("first-fit", elapsed / operations.size(), stats);
+        }
+    }
+
+    void ring(std::size_t frames, std::mt19937 & random)
+    {
+        // Three Frames in Flight, Released as the Fourth Is Fenced
+        const std::size_t capacity = 4 << 20;
+        RingAllocator ring(capacity);
+        std::size_t count = 0;
+        double elapsed = 0.0;
+        for (std::size_t frame = 0; frame < frames; frame++)
+        {
+            std::size_t allocations = 64 + random() % 128;
+            for (std::size_t i = 0; i < allocations; i++)
+            {   std::size_t size = 16 + random() % 8192, alignment = std::size_t(16) << (random() % 5);
+                auto start = Clock::now();
+                ring.Allocate(size, alignment);
+                elapsed += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+                count++;
+            }
+            ring.Fence(frame);
+            if (frame >= 3) ring.Release(frame - 3);
+        }
+        print("ring", elapsed / count, ring.Stats());
+    }
+
+    void linear(std::size_t count)
+    {
+        LinearAllocator linear(1 << 20);
+        auto start = Clock::now();
+        for (std::size_t i = 0; i < count; i++)
+            if (linear.Allocate(64 + (i & 63)) == InvalidOffset)
+            {   linear.Reset();
+                linear.Allocate(64 + (i & 63));
+            }
+        double elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        print("linear", elapsed / count, linear.Stats());
+    }
+
+    void streaming(std::size_t frames)
+    {
+        // Eight 1 MB Frames Fit in the Ring, So Waits Only Happen When the GPU Falls Behind
+        StreamBuffer stream(GL_ARRAY_BUFFER, 8 << 20);
+        std::vector<unsigned char> payload(64 << 10, 0x5a);
+        auto start = Clock::now();
+        for (std::size_t frame = 0; frame < frames; frame++)
+        {   for (int i = 0; i < 16; i++) stream.Write(payload.data(), payload.size(), 256);
+            stream.Flush();
+            glFlush();
+            stream.Advance();
+        }
+        glFinish();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        StreamBuffer::Stats stats = stream.GetStats();
+        fprintf(stdout, "stream: %s, %.0f MB/s, %llu waits (%.2f ms), %zu bytes flushed\n",
+                stream.Persistent() ? "persistent" : "glBufferSubData",
+                frames * 16.0 * payload.size() / seconds / (1 << 20),
+                static_cast<unsigned long long>(stats.waits), stats.waitMilliseconds, stats.flushed);
+    }
+
+    void heap(std::size_t meshes, std::mt19937 & random)
+    {
+        // Same Sizes Both Ways: One Buffer Object Each, Then Packed Into Heap Pages
+        std::vector<std::size_t> sizes;
+        for (std::size_t i = 0; i < meshes; i++) sizes.push_back(1024 + random() % (256 << 10));
+        std::vector<unsigned char> data(257 << 10, 0x3c);
+
+        auto start = Clock::now();
+        std::vector<GLuint> buffers(meshes);
+        glGenBuffers(static_cast<GLsizei>(meshes), buffers.data());
+        for (std::size_t i = 0; i < meshes; i++)
+        {   glBindBuffer(GL_ARRAY_BUFFER, buffers[i]);
+            glBufferData(GL_ARRAY_BUFFER, sizes[i], data.data(), GL_STATIC_DRAW);
+        }
+        glFinish();
+        double separate = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        glDeleteBuffers(static_cast<GLsizei>(meshes), buffers.data());
+
+        BufferHeap heap;
+        std::vector<BufferHeap::Allocation> allocations;
+        start = Clock::now();
+        for (auto size : sizes) allocations.push_back(heap.Allocate(size, 32, data.data()));
+        glFinish();
+        double packed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        // Churn Half of Them to See How Well Freed Space Is Reused
+        for (std::size_t i = 0; i < meshes; i += 2) heap.Free(allocations[i]);
+        for (std::size_t i = 0; i < meshes; i += 2) allocations[i] = heap.Allocate(sizes[(i * 7) % meshes], 32);
+        AllocatorStats stats = heap.Stats();
+        fprintf(stdout, "heap: %zu meshes in %.1f ms as buffers, %.1f ms packed into %zu pages; "
+                "%.1f of %.1f MB used, %zu free blocks\n", meshes, separate, packed, heap.Pages(),
+                stats.used / 1048576.0, stats.capacity / 1048576.0, stats.freeBlocks);
+        for (auto & allocation : allocations) heap.Free(allocation);
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    std::mt19937 random(1234);
+    std::vector<Operation> operations = workload(count, 4000, random);
+    general(operations, 256 << 20);
+    ring(count / 128, random);
+    linear(count);
+
+    HeadlessContext context;
+    if (!context.Create(64, 64))
+    {   fprintf(stdout, "no OpenGL context; skipping StreamBuffer and BufferHeap\n");
+        return EXIT_SUCCESS;
+    }
+    streaming(600);
+    heap(4096, random);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,192 @@
+// Local Headers
+#include "headless.hpp"
+#include "instance.hpp"
+#include "mesh.hpp"
+
+// System Headers
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Standard Headers
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// CPU Submission Time per Frame, 1k to 100k Instances; Runs Headless on llvmpipe
+//
+//     bench_instancing [frames] [moving percent]
+//
+// The "loop" path is what callers do without instancing: one uniform upload
+// and one draw per copy. The "instanced" path moves a fraction of the
+// instances each frame, publishes only those through InstanceBuffer and
+// issues a single instanced draw. Submission stops at the last draw call;
+// the frame column also covers fencing and waiting for the GPU.
+namespace
+{
+    char const * Vertex = R"(
+        #version 430 core
+        layout(location = 0) in vec3 position;
+        layout(location = 1) in vec3 normal;
+        struct Instance { mat4 transform; vec4 color; };
+        layout(std430, binding = 0) readonly buffer Instances { Instance instances[]; };
+        uniform mat4 viewProjection;
+        uniform mat4 model;
+        uniform bool instanced;
+        out vec4 shade;
+        void main()
+        {
+            mat4 transform = instanced ? instances[gl_InstanceID].transform : model;
+            vec4 color = instanced ? instances[gl_InstanceID].color : vec4(1.0);
+            float light = max(dot(mat3(transform) * normal, normalize(vec3(1, 2, 3))), 0.0);
+            shade = color * (0.3 + 0.7 * light);
+            gl_Position = viewProjection * transform * vec4(position, 1.0);
+        })";
+
+    char const * Fragment = R"(
+        #version 430 core
+        in vec4 shade;
+        out vec4 color;
+        void main() { color = shade; })";
+
+    GLuint program()
+    {
+        GLuint program = glCreateProgram();
+        for (auto stage : { std::make_pair(GL_VERTEX_SHADER, Vertex), std::make_pair(GL_FRAGMENT_SHADER, Fragment) })
+        {   GLuint shader = glCreateShader(stage.first);
+            glShaderSource(shader, 1, & stage.second, nullptr);
+            glCompileShader(shader);
+            glAttachShader(program, shader);
+            glDeleteShader(shader);
+        }
+        glLinkProgram(program);
+        GLint status = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, & status);
+        return status ? program : 0;
+    }
+
+    // Unit Cube With Per-Face Normals
+    void cube(std::vector<Mirage::Vertex> & vertices, std::vector<GLuint> & indices)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        for (int sign = -1; sign <= 1; sign += 2)
+        {
+            glm::vec3 normal(0.0f), u(0.0f), v(0.0f);
+            normal[axis] = static_cast<float>(sign);
+            u[(axis + 1) % 3] = 0.5f;
+            v[(axis + 2) % 3] = 0.5f;
+            GLuint base = static_cast<GLuint>(vertices.size());
+            for (int corner = 0; corner < 4; corner++)
+            {   Mirage::Vertex vertex;
+                float a = (corner & 1) ? 1.0f : -1.0f, b = (corner & 2) ? 1.0f : -1.0f;
+                vertex.position = normal * 0.5f + u * a + v * b;
+                vertex.normal = normal;
+                vertex.uv = glm::vec2(a, b);
+                vertices.push_back(vertex);
+            }
+            GLuint quad[] = { 0, 1, 3, 0, 3, 2 };
+            for (auto index : quad) indices.push_back(base + index);
+        }
+    }
+
+    glm::mat4 place(std::size_t index, std::size_t count, float time)
+    {
+        auto side = static_cast<std::size_t>(std::ceil(std::cbrt(static_cast<double>(count))));
+        glm::vec3 position(float(index % side), float(index / side % side), float(index / side / side));
+        position = (position - glm::vec3(side * 0.5f)) * 2.0f;
+        return glm::rotate(glm::translate(glm::mat4(1.0f), position), time + index, glm::vec3(0, 1, 0));
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    using Clock = std::chrono::high_resolution_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    int frames = argc > 1 ? std::atoi(argv[1]) : 60;
+    double moving = argc > 2 ? std::atof(argv[2]) / 100.0 : 0.05;
+
+    HeadlessContext context;
+    if (!context.Create(1280, 800)) return EXIT_FAILURE;
+    GLuint shader = program();
+    if (!shader)
+    {   fprintf(stderr, "Failed to Build the Benchmark Shader\n");
+        return EXIT_FAILURE;
+    }
+    glUseProgram(shader);
+    glEnable(GL_DEPTH_TEST);
+    GLint model = glGetUniformLocation(shader, "model");
+    GLint instanced = glGetUniformLocation(shader, "instanced");
+    glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 1.6f, 0.1f, 1000.0f)
+                             * glm::lookAt(glm::vec3(0, 40, 120), glm::vec3(0), glm::vec3(0, 1, 0));
+    glUniformMatrix4fv(glGetUniformLocation(shader, "viewProjection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
+
+    std::vector<Mirage::Vertex> vertices;
+    std::vector<GLuint> indices;
+    cube(vertices, indices);
+    Mirage::Mesh mesh(vertices, indices, std::map<GLuint, std::string>());
+
+    printf("Renderer: %s\n", reinterpret_cast<char const *>(glGetString(GL_RENDERER)));
+    printf("%10s %10s %14s %14s %14s\n", "Instances", "Path", "Submit (ms)", "Frame (ms)", "Upload (KB)");
+    for (std::size_t count : { 1000, 10000, 100000 })
+    {
+        // Without Instancing; Skipped Where It Would Take Minutes
+        if (count <= 10000)
+        {
+            double submit = 0.0, total = 0.0;
+            glUniform1i(instanced, GL_FALSE);
+            for (int frame = 0; frame < frames; frame++)
+            {
+                auto start = Clock::now();
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                for (std::size_t i = 0; i < count; i++)
+                {   glm::mat4 transform = place(i, count, frame * 0.016f);
+                    glUniformMatrix4fv(model, 1, GL_FALSE, glm::value_ptr(transform));
+                    mesh.draw(shader);
+                }
+                submit += Milliseconds(Clock::now() - start).count();
+                glFinish();
+                total += Milliseconds(Clock::now() - start).count();
+            }
+            printf("%10zu %10s %14.3f %14.3f %14s\n", count, "loop", submit / frames, total / frames, "-");
+        }
+
+        // Instanced; Only the Moving Fraction Is Rewritten Each Frame
+        Mirage::InstanceBuffer buffer(count);
+        for (std::size_t i = 0; i < count; i++)
+        {   Mirage::Instance instance;
+            instance.transform = place(i, count, 0.0f);
+            instance.color = glm::vec4(float(i % 7) / 6.0f, float(i % 11) / 10.0f, float(i % 13) / 12.0f, 1.0f);
+            buffer.set(i, instance);
+        }
+
+        double submit = 0.0, total = 0.0, uploaded = 0.0;
+        std::size_t stride = static_cast<std::size_t>(count * moving), cursor = 0;
+        glUniform1i(instanced, GL_TRUE);
+        for (int frame = 0; frame < frames; frame++)
+        {
+            auto start = Clock::now();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            Mirage::Instance * moved = buffer.edit(cursor, stride);
+            for (std::size_t i = 0; i < stride; i++)
+                moved[i].transform = place(cursor + i, count, frame * 0.016f);
+            cursor = (cursor + stride) % (count - stride + 1);
+            buffer.bind(0);
+            mesh.draw(shader, static_cast<GLsizei>(count));
+            submit += Milliseconds(Clock::now() - start).count();
+            uploaded += buffer.uploaded();
+
+            // Fencing Flushes; Software Drivers Rasterize Right Here
+            buffer.advance();
+            glFinish();
+            total += Milliseconds(Clock::now() - start).count();
+        }
+        printf("%10zu %10s %14.3f %14.3f %14.1f\n", count, "instanced",
+               submit / frames, total / frames, uploaded / frames / 1024.0);
+    }
+
+    glDeleteProgram(shader);
+    return EXIT_SUCCESS;
+}
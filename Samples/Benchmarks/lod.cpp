@@ -0,0 +1,232 @@
+// Local Headers
+#include "lod.hpp"
+#include "mesh.hpp"
+#include "optimize.hpp"
+
+// System Headers
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Simplification Time, Triangle Counts and Error per Level, Then Selection Along a Fly-By; Runs Without a GPU
+//
+//     bench_lod [model ...]
+//
+// Without models it generates a UV sphere and a torus, both closed but cut
+// by UV seams, and a noisy terrain patch with open borders. Every level is
+// checked for out-of-range or degenerate triangles, for errors that shrink
+// and for closed meshes that open up. The fly-by places a thousand copies
+// of each asset along a corridor and moves the camera through it with some
+// jitter, selecting levels with and without hysteresis, and reports the
+// triangles drawn per frame and how many instances switched level.
+namespace
+{
+    typedef std::chrono::high_resolution_clock Clock;
+
+    struct Asset
+    {
+        std::string name;
+        std::vector<Mirage::MeshData> meshes;
+    };
+
+    Mirage::Vertex vertex(glm::vec3 const & position, glm::vec3 const & normal, glm::vec2 const & uv)
+    {
+        Mirage::Vertex v;
+        v.position = position;
+        v.normal = normal;
+        v.uv = uv;
+        return v;
+    }
+
+    // Grid of (columns + 1) x (rows + 1) Vertices; the Last Column Repeats the First Position With u = 1
+    template<typename Surface>
+    Mirage::MeshData grid(int columns, int rows, Surface surface)
+    {
+        Mirage::MeshData mesh;
+        for (int j = 0; j <= rows; j++)
+        for (int i = 0; i <= columns; i++)
+        {   glm::vec2 uv(float(i) / columns, float(j) / rows);
+            glm::vec3 position, normal;
+            surface(uv, position, normal);
+            mesh.vertices.push_back(vertex(position, normal, uv));
+        }
+        for (int j = 0; j < rows; j++)
+        for (int i = 0; i < columns; i++)
+        {   GLuint a = j * (columns + 1) + i, b = a + 1, c = a + columns + 1, d = c + 1;
+            GLuint quad[] = { a, c, b, b, c, d };
+            mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+        }
+        mesh.bounds = Mirage::Mesh::measure(mesh.vertices.data(), mesh.vertices.size());
+        return mesh;
+    }
+
+    std::vector<Asset> generate()
+    {
+        const float Pi = 3.14159265f;
+        std::vector<Asset> assets(3);
+        assets[0].name = "sphere";
+        assets[0].meshes.push_back(grid(256, 128, [&](glm::vec2 uv, glm::vec3 & p, glm::vec3 & n)
+        {   float theta = std::fmod(uv.x, 1.0f) * 2.0f * Pi, phi = uv.y * Pi;
+            n = glm::vec3(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+            if (uv.y == 0.0f || uv.y == 1.0f) n = glm::vec3(0.0f, uv.y == 0.0f ? 1.0f : -1.0f, 0.0f);
+            p = n;
+        }));
+
+        assets[1].name = "torus";
+        assets[1].meshes.push_back(grid(256, 96, [&](glm::vec2 uv, glm::vec3 & p, glm::vec3 & n)
+        {   float theta = std::fmod(uv.x, 1.0f) * 2.0f * Pi, phi = std::fmod(uv.y, 1.0f) * 2.0f * Pi;
+            glm::vec3 ring(std::cos(theta), 0.0f, std::sin(theta));
+            n = ring * std::cos(phi) + glm::vec3(0.0f, std::sin(phi), 0.0f);
+            p = ring + n * 0.3f;
+        }));
+
+        assets[2].name = "terrain";
+        assets[2].meshes.push_back(grid(255, 255, [&](glm::vec2 uv, glm::vec3 & p, glm::vec3 & n)
+        {   float h = 0.08f * std::sin(uv.x * 9.0f) * std::cos(uv.y * 7.0f)
+                    + 0.02f * std::sin(uv.x * 41.0f + uv.y * 23.0f);
+            p = glm::vec3(uv.x * 2.0f - 1.0f, h, uv.y * 2.0f - 1.0f);
+            n = glm::vec3(0.0f, 1.0f, 0.0f);
+        }));
+        return assets;
+    }
+
+    // Edges With One Face After Welding Positions; Zero for a Closed Surface
+    std::size_t open(std::vector<Mirage::Vertex> const & vertices, GLuint const * indices, std::size_t count)
+    {
+        std::map<std::tuple<float, float, float>, GLuint> welded;
+        std::vector<GLuint> ids(vertices.size());
+        for (std::size_t i = 0; i < vertices.size(); i++)
+        {   glm::vec3 const & p = vertices[i].position;
+            ids[i] = welded.insert(std::make_pair(std::make_tuple(p.x, p.y, p.z), GLuint(welded.size()))).first->second;
+        }
+
+        std::map<std::pair<GLuint, GLuint>, int> edges;
+        for (std::size_t t = 0; t < count; t += 3)
+        for (int k = 0; k < 3; k++)
+        {   GLuint a = ids[indices[t + k]], b = ids[indices[t + (k + 1) % 3]];
+            edges[std::make_pair(std::min(a, b), std::max(a, b))]++;
+        }
+        std::size_t result = 0;
+        for (auto const & edge : edges) result += edge.second == 1;
+        return result;
+    }
+
+    bool validate(Mirage::MeshData const & mesh, std::size_t level)
+    {
+        Mirage::LevelOfDetail const & lod = mesh.lods[level];
+        GLuint const * indices = mesh.lodIndices.data() + lod.indexOffset;
+        std::size_t previous = level == 0 ? mesh.indices.size() : mesh.lods[level - 1].indexCount;
+        float error = level == 0 ? 0.0f : mesh.lods[level - 1].error;
+        if (lod.indexCount % 3 != 0 || lod.indexCount >= previous || lod.error < error) return false;
+        for (std::size_t t = 0; t < lod.indexCount; t += 3)
+        {   for (int k = 0; k < 3; k++) if (indices[t + k] >= mesh.vertices.size()) return false;
+            if (indices[t] == indices[t + 1] || indices[t + 1] == indices[t + 2] || indices[t] == indices[t + 2]) return false;
+        }   return true;
+    }
+
+    // Fly Through a Corridor of Copies; Returns Triangles per Frame and Level Switches per Frame
+    std::pair<double, double> flyby(std::vector<float> const & errors, std::vector<std::size_t> const & triangles,
+                                    float size, float hysteresis, int frames, std::mt19937 random)
+    {
+        const std::size_t Copies = 1000;
+        std::uniform_real_distribution<float> across(-60.0f, 60.0f), along(0.0f, 600.0f);
+        std::vector<glm::vec3> positions(Copies);
+        for (auto & position : positions) position = glm::vec3(across(random), 0.0f, -along(random));
+
+        std::vector<float> scaled(errors);
+        for (auto & error : scaled) error *= size;
+        Mirage::LodSelector selector(1.0f, hysteresis);
+        selector.viewport(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f), 1080);
+        double drawn = 0.0;
+        for (int frame = 0; frame < frames; frame++)
+        {
+            // Forward at a Steady Pace With a Small Back-and-Forth Wobble
+            glm::vec3 eye(0.0f, 2.0f, 50.0f - frame * 0.5f + 1.5f * std::sin(frame * 0.9f));
+            for (std::size_t i = 0; i < Copies; i++)
+            {   float distance = glm::length(positions[i] - eye) - size * 0.5f;
+                drawn += triangles[selector.select(i, scaled.data(), scaled.size(), distance)];
+            }
+        }   return std::make_pair(drawn / frames, double(selector.switches()) / (frames - 1));
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    std::vector<Asset> assets;
+    for (int i = 1; i < argc; i++)
+    {   Asset asset;
+        std::string source = argv[i];
+        asset.name = source.substr(source.find_last_of("/\\") + 1);
+        if (Mirage::Mesh::import(source, asset.meshes)) assets.push_back(asset);
+    }
+    if (argc < 2) assets = generate();
+
+    bool valid = true;
+    std::mt19937 random(1234);
+    printf("%-16s %5s %6s %10s %8s %12s %8s\n", "asset", "mesh", "level", "triangles", "ratio", "error (%)", "open");
+    for (auto & asset : assets)
+    {
+        double milliseconds = 0.0;
+        std::size_t total = 0;
+        std::vector<float> errors(1, 0.0f);
+        std::vector<std::size_t> triangles(1, 0);
+        for (std::size_t j = 0; j < asset.meshes.size(); j++)
+        {
+            auto & mesh = asset.meshes[j];
+            Mirage::optimize(mesh);
+            auto start = Clock::now();
+            Mirage::generateLevels(mesh, 8);
+            milliseconds += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            total += mesh.indices.size() / 3;
+
+            float diagonal = glm::length(mesh.bounds.max - mesh.bounds.min);
+            std::size_t border = open(mesh.vertices, mesh.indices.data(), mesh.indices.size());
+            printf("%-16s %5zu %6d %10zu %8.3f %12.3f %8zu\n", asset.name.c_str(), j, 0,
+                   mesh.indices.size() / 3, 1.0, 0.0, border);
+            for (std::size_t level = 0; level < mesh.lods.size(); level++)
+            {
+                auto const & lod = mesh.lods[level];
+                std::size_t edges = open(mesh.vertices, mesh.lodIndices.data() + lod.indexOffset, lod.indexCount);
+                bool ok = validate(mesh, level) && (border > 0 || edges == 0);
+                valid = valid && ok;
+                printf("%-16s %5zu %6zu %10u %8.3f %12.3f %8zu%s\n", asset.name.c_str(), j, level + 1,
+                       lod.indexCount / 3, double(lod.indexCount) / mesh.indices.size(),
+                       diagonal > 0.0f ? 100.0 * lod.error / diagonal : 0.0, edges, ok ? "" : "  INVALID");
+            }
+
+            // Whole-Asset Levels for the Fly-By, Summed and Maxed Across Submeshes
+            float scale = diagonal > 0.0f ? 1.0f / diagonal : 1.0f;
+            if (errors.size() < mesh.lods.size() + 1)
+            {   errors.resize(mesh.lods.size() + 1, errors.back());
+                triangles.resize(mesh.lods.size() + 1, triangles.back());
+            }
+            for (std::size_t level = 0; level < errors.size(); level++)
+            {   std::size_t clamped = std::min(level, mesh.lods.size());
+                triangles[level] += clamped == 0 ? mesh.indices.size() / 3 : mesh.lods[clamped - 1].indexCount / 3;
+                if (clamped > 0) errors[level] = std::max(errors[level], mesh.lods[clamped - 1].error * scale);
+            }
+        }
+        printf("%-16s %zu triangles simplified in %.1f ms (%.2f Mtri/s)\n", asset.name.c_str(), total, milliseconds,
+               total / milliseconds / 1000.0);
+
+        // Every Copy Is Scaled to the Same Diagonal So Assets Compare Fairly
+        int frames = 800;
+        auto none  = flyby(errors, triangles, 20.0f, 0.0f,  frames, random);
+        auto eased = flyby(errors, triangles, 20.0f, 0.25f, frames, random);
+        printf("%-16s fly-by: %.0f triangles/frame at full detail, %.0f with LOD; "
+               "%.1f switches/frame without hysteresis, %.1f with\n\n", asset.name.c_str(),
+               double(triangles[0]) * 1000, eased.first, none.second, eased.second);
+    }   return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,64 @@
+// Local Headers
+#include "cache.hpp"
+#include "mesh.hpp"
+
+// Standard Headers
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// Cold vs Warm Model Loading; Runs Without an OpenGL Context
+//
+//     bench_mesh_cache <cache directory> <model> [model ...]
+//
+// A cold load is a full Assimp import plus writing the cache entry. A warm
+// load maps the cache entry and validates it, which is everything the mesh
+// constructor does before handing the arrays to glBufferData.
+int main(int argc, char * argv[])
+{
+    using Clock = std::chrono::high_resolution_clock;
+    if (argc < 3)
+    {   fprintf(stderr, "Usage: %s <cache directory> <model> [model ...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const int iterations = 10;
+    Mirage::MeshCache cache(argv[1]);
+    fprintf(stdout, "%-32s %10s %10s %12s %9s\n", "model", "cold ms", "warm ms", "vertices", "speedup");
+    for (int i = 2; i < argc; i++)
+    {
+        std::string source = argv[i];
+        std::remove(cache.locate(source).c_str());
+
+        // Cold Path: Assimp Import and Cache Population
+        auto start = Clock::now();
+        std::vector<Mirage::MeshData> meshes;
+        if (!Mirage::Mesh::import(source, meshes)) continue;
+        cache.store(source, Mirage::Mesh::ImportFlags, meshes);
+        double cold = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        // Warm Path: Map and Validate, Touching Every Vertex Once
+        std::size_t vertices = 0;
+        start = Clock::now();
+        for (int j = 0; j < iterations; j++)
+        {
+            Mirage::MeshCache::Entry entry;
+            if (!cache.load(source, Mirage::Mesh::ImportFlags, entry))
+            {   fprintf(stderr, "Cache Miss After Store: %s\n", source.c_str());
+                return EXIT_FAILURE;
+            }
+
+            float checksum = 0.0f; vertices = 0;
+            for (auto const & view : entry.meshes)
+            for (std::uint32_t k = 0; k < view.vertexCount; k++)
+                checksum += view.vertices[k].position.x;
+            for (auto const & view : entry.meshes)
+                vertices += view.vertexCount;
+            if (checksum != checksum) fprintf(stderr, "NaN in %s\n", source.c_str());
+        }
+        double warm = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / iterations;
+        fprintf(stdout, "%-32s %10.2f %10.2f %12zu %8.1fx\n",
+                source.substr(source.find_last_of("/\\") + 1).c_str(),
+                cold, warm, vertices, cold / warm);
+    }   return EXIT_SUCCESS;
+}
@@ -0,0 +1,50 @@
+// Local Headers
+#include "mesh.hpp"
+#include "optimize.hpp"
+
+// Standard Headers
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// Per-Mesh ACMR/ATVR Before and After Optimization; Runs Without a GPU
+//
+//     bench_mesh_optimize <model> [model ...]
+//
+// Exits with failure if any mesh ends up with a worse ACMR than it started
+// with, so CI can track vertex cache efficiency without rendering.
+int main(int argc, char * argv[])
+{
+    using Clock = std::chrono::high_resolution_clock;
+    if (argc < 2)
+    {   fprintf(stderr, "Usage: %s <model> [model ...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    bool regressed = false;
+    fprintf(stdout, "%-24s %5s %9s %9s %9s %9s %10s %10s %9s\n", "model", "mesh",
+            "acmr", "acmr'", "atvr", "atvr'", "bytes", "packed", "ms");
+    for (int i = 1; i < argc; i++)
+    {
+        std::string source = argv[i];
+        std::vector<Mirage::MeshData> meshes;
+        if (!Mirage::Mesh::import(source, meshes)) continue;
+        for (std::size_t j = 0; j < meshes.size(); j++)
+        {
+            auto & mesh = meshes[j];
+            auto before = Mirage::analyze(mesh.indices, mesh.vertices.size());
+            auto start = Clock::now();
+            Mirage::optimize(mesh);
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            auto after = Mirage::analyze(mesh.indices, mesh.vertices.size());
+            auto packed = Mirage::pack(mesh.vertices);
+
+            regressed |= after.acmr > before.acmr;
+            fprintf(stdout, "%-24s %5zu %9.3f %9.3f %9.3f %9.3f %10zu %10zu %9.2f\n",
+                    source.substr(source.find_last_of("/\\") + 1).c_str(), j,
+                    before.acmr, after.acmr, before.atvr, after.atvr,
+                    mesh.vertices.size() * sizeof(Mirage::Vertex),
+                    packed.vertices.size() * sizeof(Mirage::PackedVertex), ms);
+        }
+    }   return regressed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,264 @@
+// Local Headers
+#include "package.hpp"
+
+// System Headers
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+// Cold-Cache Startup: Thousands of Loose Files Against One Mapped Package
+//
+//     bench_package [directory] [files]
+//
+// Writes a tree of small assets under directory: the Glitter shaders and
+// textures plus generated shader sources, vertex data and incompressible
+// blobs. It packs the tree, then opens, reads and checksums every asset both
+// ways. Before each cold run the page cache is dropped for every file with
+// posix_fadvise, and mincore reports how much of the data stayed resident
+// anyway, since eviction does nothing on tmpfs. Warm runs repeat the same
+// work with everything cached.
+namespace
+{
+    typedef std::chrono::high_resolution_clock Clock;
+    typedef std::chrono::duration<double, std::milli> Milliseconds;
+
+    struct Asset
+    {
+        std::string name;
+        std::vector<unsigned char> bytes;
+    };
+
+    void makeDirectory(std::string const & path)
+    {
+#ifdef _WIN32
+        _mkdir(path.c_str());
+#else
+        mkdir(path.c_str(), 0755);
+#endif
+    }
+
+    bool readFile(std::string const & path, std::vector<unsigned char> & bytes)
+    {
+        std::ifstream fd(path, std::ios::binary);
+        if (!fd) return false;
+        bytes.assign(std::istreambuf_iterator<char>(fd), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    // Word Sums Touch Every Byte Without Costing More Than the Reads
+    std::uint64_t checksum(unsigned char const * data, std::size_t size)
+    {
+        std::uint64_t sum = size;
+        std::size_t words = size / 8;
+        for (std::size_t i = 0; i < words; i++)
+        {   std::uint64_t word;
+            std::memcpy(& word, data + i * 8, 8);
+            sum += word;
+        }
+        for (std::size_t i = words * 8; i < size; i++) sum += data[i];
+        return sum;
+    }
+
+    // Generated Assets Roughly Shaped Like a Game's: Many Small Texts, Some Meshes, Some Media
+    std::vector<Asset> generate(std::size_t count, std::mt19937 & random)
+    {
+        std::vector<Asset> assets;
+        std::vector<unsigned char> vertex, fragment, texture;
+        readFile(PROJECT_SOURCE_DIR "/Glitter/Shaders/shader.vert", vertex);
+        readFile(PROJECT_SOURCE_DIR "/Glitter/Shaders/shader.frag", fragment);
+        readFile(PROJECT_SOURCE_DIR "/Glitter/Textures/container.jpg", texture);
+        if (!vertex.empty())   assets.push_back({ "Shaders/shader.vert", vertex });
+        if (!fragment.empty()) assets.push_back({ "Shaders/shader.frag", fragment });
+        if (!texture.empty())  assets.push_back({ "Textures/container.jpg", texture });
+
+        std::uniform_int_distribution<int> kind(0, 9), byte(0, 255);
+        std::normal_distribution<float> noise(0.0f, 1.0f);
+        for (std::size_t i = 0; assets.size() < count; i++)
+        {
+            Asset asset;
+            char name[64];
+            int type = kind(random);
+            if (type < 6)
+            {   // Shader Variants: Mostly Shared Text With a Few Defines Changed
+                std::string text = "#version 330 core\n#define VARIANT " + std::to_string(i) + "\n";
+                for (std::size_t line = 0, lines = 40 + i % 200; line < lines; line++)
+                    text += "uniform vec4 parameter" + std::to_string(line % 37) + ";  // Material Input "
+                          + std::to_string(line * 7 % 13) + "\n";
+                snprintf(name, sizeof(name), "Shaders/Generated/%02zu/variant_%05zu.glsl", i % 32, i);
+                asset.bytes.assign(text.begin(), text.end());
+            }
+            else if (type < 9)
+            {   // Vertex Arrays: Smooth Positions and Normals, Compressible but Not by Much
+                std::size_t vertices = 256 + i % 2048;
+                std::vector<float> floats(vertices * 8);
+                for (std::size_t v = 0; v < vertices; v++)
+                for (int c = 0; c < 8; c++)
+                    floats[v * 8 + c] = std::floor((std::sin(v * 0.01f * (c + 1)) + 0.01f * noise(random)) * 1024.0f) / 1024.0f;
+                snprintf(name, sizeof(name), "Meshes/%02zu/mesh_%05zu.bin", i % 32, i);
+                asset.bytes.resize(floats.size() * sizeof(float));
+                std::memcpy(asset.bytes.data(), floats.data(), asset.bytes.size());
+            }
+            else
+            {   // Already-Compressed Media
+                asset.bytes.resize(4096 + i % 28672);
+                for (auto & b : asset.bytes) b = static_cast<unsigned char>(byte(random));
+                snprintf(name, sizeof(name), "Media/%02zu/blob_%05zu.dat", i % 32, i);
+            }
+            asset.name = name;
+            assets.push_back(asset);
+        }   return assets;
+    }
+
+    // Drop a File From the Page Cache; Dirty Pages Have to Reach the Disk First
+    void evict(std::string const & path)
+    {
+#ifndef _WIN32
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        fdatasync(fd);
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+#else
+        (void) path;
+#endif
+    }
+
+    // Bytes Still in the Page Cache, Counted in Whole Pages
+    std::size_t resident(std::string const & path)
+    {
+        std::size_t bytes = 0;
+#ifndef _WIN32
+        int fd = open(path.c_str(), O_RDONLY);
+        struct stat info;
+        if (fd < 0 || fstat(fd, & info) != 0 || info.st_size == 0)
+        {   if (fd >= 0) close(fd);
+            return 0;
+        }
+        void * address = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (address == MAP_FAILED) return 0;
+        std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        std::vector<unsigned char> pages((info.st_size + page - 1) / page);
+        if (mincore(address, info.st_size, pages.data()) == 0)
+            for (auto p : pages) bytes += (p & 1) ? page : 0;
+        munmap(address, info.st_size);
+        bytes = std::min<std::size_t>(bytes, static_cast<std::size_t>(info.st_size));
+#else
+        (void) path;
+#endif
+        return bytes;
+    }
+
+    std::uint64_t loadLoose(std::string const & directory, std::vector<Asset> const & assets)
+    {
+        std::uint64_t sum = 0;
+        std::vector<unsigned char> bytes;
+        for (auto const & asset : assets)
+        {   if (!readFile(directory + "/" + asset.name, bytes)) return 0;
+            sum += checksum(bytes.data(), bytes.size());
+        }   return sum;
+    }
+
+    std::uint64_t loadPackage(std::string const & filename, std::vector<Asset> const & assets)
+    {
+        Package package;
+        if (!package.Open(filename)) return 0;
+        std::uint64_t sum = 0;
+        for (auto const & asset : assets)
+        {   Package::Span span = package.Find(asset.name);
+            if (!span.Valid()) return 0;
+            sum += checksum(span.data, span.size);
+        }   return sum;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    std::string directory = argc > 1 ? argv[1] : "package_bench";
+    std::size_t count = argc > 2 ? std::atoi(argv[2]) : 4000;
+    std::string archive = directory + ".pak";
+    std::mt19937 random(1234);
+
+    // Write the Loose Tree, Then Pack It
+    std::vector<Asset> assets = generate(count, random);
+    std::uint64_t bytes = 0;
+    PackageWriter writer;
+    makeDirectory(directory);
+    for (auto const & asset : assets)
+    {   for (std::size_t slash = asset.name.find('/'); slash != std::string::npos; slash = asset.name.find('/', slash + 1))
+            makeDirectory(directory + "/" + asset.name.substr(0, slash));
+        std::ofstream fd(directory + "/" + asset.name, std::ios::binary | std::ios::trunc);
+        fd.write(reinterpret_cast<char const *>(asset.bytes.data()), asset.bytes.size());
+        writer.Add(asset.name, asset.bytes.data(), asset.bytes.size());
+        bytes += asset.bytes.size();
+    }
+    auto start = Clock::now();
+    if (!writer.Write(archive))
+    {   fprintf(stderr, "Failed to Write %s\n", archive.c_str());
+        return EXIT_FAILURE;
+    }
+    double packing = Milliseconds(Clock::now() - start).count();
+
+    std::uint64_t expected = 0;
+    for (auto const & asset : assets) expected += checksum(asset.bytes.data(), asset.bytes.size());
+    Package package;
+    package.Open(archive);
+    Package::Stats stats = package.Statistics();
+    package.Close();
+    printf("%zu assets, %.1f MB loose; package %.1f MB with %zu of them LZ4 compressed, packed in %.0f ms\n",
+           assets.size(), bytes / 1048576.0, stats.storedBytes / 1048576.0, stats.compressed, packing);
+
+    printf("%-10s %-8s %12s %12s %14s\n", "Source", "Cache", "Opens", "Time (ms)", "Resident (%)");
+    bool valid = true;
+    const int Runs = 3;
+    for (bool cold : { true, false })
+    for (bool packed : { false, true })
+    {
+        std::vector<double> times;
+        double residency = 0.0;
+        for (int run = 0; run < Runs; run++)
+        {
+            if (cold)
+            {   std::size_t kept = 0;
+                if (packed) evict(archive);
+                else for (auto const & asset : assets) evict(directory + "/" + asset.name);
+                if (packed) kept = resident(archive);
+                else for (auto const & asset : assets) kept += resident(directory + "/" + asset.name);
+                residency += 100.0 * kept / std::max<double>(packed ? stats.storedBytes : bytes, 1.0) / Runs;
+            }
+            else (packed ? loadPackage(archive, assets) : loadLoose(directory, assets));
+
+            auto begin = Clock::now();
+            std::uint64_t sum = packed ? loadPackage(archive, assets) : loadLoose(directory, assets);
+            times.push_back(Milliseconds(Clock::now() - begin).count());
+            valid = valid && sum == expected;
+        }
+        std::sort(times.begin(), times.end());
+        char kept[16] = "-";
+        if (cold) snprintf(kept, sizeof(kept), "%.1f", residency);
+        printf("%-10s %-8s %12zu %12.2f %14s\n", packed ? "package" : "loose", cold ? "cold" : "warm",
+               packed ? std::size_t(1) : assets.size(), times[Runs / 2], kept);
+    }
+
+    if (!valid) fprintf(stderr, "Package Contents Differ From the Loose Files\n");
+    return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,126 @@
+// Local Headers
+#include "mesh.hpp"
+#include "physics.hpp"
+
+// System Headers
+#include <glm/gtc/matrix_transform.hpp>
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// Fixed-Step Cost vs Thread Count, Then the Render-Side Handoff; Runs Without a GPU
+//
+//     bench_physics [bodies] [steps] [model]
+//
+// Drops a grid of bodies onto a triangle-mesh floor and steps the world
+// synchronously once per thread count. Bodies are convex hulls of the
+// given model, or of a unit cube without one. Thread counts above one only
+// differ when Bullet is built with BT_THREADSAFE. The last pass runs the
+// world on its own thread and polls it like a render loop would, reporting
+// how long read() took and how many snapshots arrived.
+namespace
+{
+    Mirage::MeshData quad(float half)
+    {
+        Mirage::MeshData mesh;
+        for (int i = 0; i < 4; i++)
+        {   Mirage::Vertex vertex;
+            vertex.position = glm::vec3((i & 1) ? half : -half, 0.0f, (i & 2) ? half : -half);
+            vertex.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+            mesh.vertices.push_back(vertex);
+        }
+        mesh.indices = { 0, 2, 1, 1, 2, 3 };
+        mesh.bounds = Mirage::Mesh::measure(mesh.vertices.data(), mesh.vertices.size());
+        return mesh;
+    }
+
+    Mirage::MeshData cube()
+    {
+        Mirage::MeshData mesh;
+        for (int i = 0; i < 8; i++)
+        {   Mirage::Vertex vertex;
+            vertex.position = glm::vec3((i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f, (i & 4) ? 0.5f : -0.5f);
+            mesh.vertices.push_back(vertex);
+        }
+        mesh.indices = { 0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4,
+                         2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5 };
+        mesh.bounds = Mirage::Mesh::measure(mesh.vertices.data(), mesh.vertices.size());
+        return mesh;
+    }
+
+    void populate(Mirage::PhysicsWorld & world, std::vector<Mirage::MeshData> const & body, std::size_t count)
+    {
+        std::vector<Mirage::MeshData> floor(1, quad(1000.0f));
+        world.add(world.shape(floor, false), 0.0f, glm::mat4(1.0f));
+
+        // Loose Columns So Bodies Land on Each Other and Keep the Solver Busy
+        btCollisionShape * shape = world.shape(body, true);
+        int side = std::max(1, static_cast<int>(std::sqrt(count / 8.0)));
+        for (std::size_t i = 0; i < count; i++)
+        {   int x = static_cast<int>(i % side), z = static_cast<int>((i / side) % side), y = static_cast<int>(i / (side * side));
+            glm::vec3 position((x - side / 2) * 1.5f, 2.0f + y * 1.2f, (z - side / 2) * 1.5f);
+            world.add(shape, 1.0f, glm::translate(glm::mat4(1.0f), position));
+        }
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    using Clock = std::chrono::high_resolution_clock;
+    std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4000;
+    int steps = argc > 2 ? std::max(1, std::atoi(argv[2])) : 240;
+
+    std::vector<Mirage::MeshData> body;
+    if (argc > 3 && !Mirage::Mesh::import(argv[3], body))
+    {   fprintf(stderr, "Failed to Import %s\n", argv[3]);
+        return EXIT_FAILURE;
+    }
+    if (body.empty()) body.push_back(cube());
+
+    unsigned int hardware = std::max(1u, std::thread::hardware_concurrency());
+    fprintf(stdout, "%zu bodies, %d steps of 1/60 s\n", count, steps);
+    fprintf(stdout, "%8s %8s %10s %10s\n", "threads", "actual", "ms/step", "max ms");
+    for (unsigned int threads = 1; threads <= hardware; threads *= 2)
+    {
+        Mirage::PhysicsWorld world(1.0 / 60.0, threads);
+        populate(world, body, count);
+
+        double slowest = 0.0;
+        for (int i = 0; i < steps; i++)
+        {   auto start = Clock::now();
+            world.step();
+            slowest = std::max(slowest, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+        fprintf(stdout, "%8u %8u %10.3f %10.3f\n", threads, world.threads(), world.milliseconds(), slowest);
+    }
+
+    // Let the World Run Free and Poll It at Roughly 144 Hz
+    Mirage::PhysicsWorld world(1.0 / 60.0, hardware);
+    populate(world, body, count);
+    world.start();
+    std::vector<glm::mat4> transforms;
+    std::size_t reads = 0, fresh = 0;
+    double total = 0.0, slowest = 0.0;
+    auto finish = Clock::now() + std::chrono::seconds(2);
+    while (Clock::now() < finish)
+    {
+        auto start = Clock::now();
+        fresh += world.read(transforms, world.time());
+        double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        total += us;
+        slowest = std::max(slowest, us);
+        reads++;
+        std::this_thread::sleep_for(std::chrono::microseconds(6944));
+    }
+    world.stop();
+    fprintf(stdout, "threaded: %llu steps at %.3f ms, %zu reads (%zu fresh), read %.1f us avg %.1f us max\n",
+            static_cast<unsigned long long>(world.steps()), world.milliseconds(),
+            reads, fresh, total / reads, slowest);
+    return transforms.size() == world.size() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,119 @@
+// Local Headers
+#include "program_cache.hpp"
+
+// System Headers
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+// Standard Headers
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+// Cold vs Cached Program Link Times; Needs a Context, Works on llvmpipe
+//
+//     bench_program_cache <cache directory> <vertex> <fragment> [iterations]
+//
+// A cold link compiles both stages from source, links and stores the binary.
+// A cached link is glProgramBinary on the stored entry, which is all the
+// Shader constructors do on a hit.
+namespace
+{
+    std::string read(char const * filename)
+    {
+        std::ifstream fd(filename);
+        return std::string(std::istreambuf_iterator<char>(fd),
+                          (std::istreambuf_iterator<char>()));
+    }
+
+    GLuint compile(GLenum type, std::string const & src)
+    {
+        char const * source = src.c_str();
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, & source, nullptr);
+        glCompileShader(shader);
+        return shader;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    using Clock = std::chrono::high_resolution_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    if (argc < 4)
+    {   fprintf(stderr, "Usage: %s <cache directory> <vertex> <fragment> [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Hidden Window; Only the Context Is Needed
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+    auto window = glfwCreateWindow(64, 64, "bench_program_cache", nullptr, nullptr);
+    if (window == nullptr)
+    {   fprintf(stderr, "Failed to Create OpenGL Context\n");
+        return EXIT_FAILURE;
+    }
+    glfwMakeContextCurrent(window);
+    gladLoadGL();
+
+    ProgramCache cache(argv[1]);
+    if (!cache.Supported())
+    {   fprintf(stderr, "Driver Exposes No Program Binary Formats\n");
+        return EXIT_FAILURE;
+    }
+
+    std::string vertex = read(argv[2]);
+    std::string fragment = read(argv[3]);
+    int iterations = argc > 4 ? std::atoi(argv[4]) : 10;
+    std::uint64_t key = cache.Key({ vertex, fragment });
+
+    // Most Drivers Memoise Compiled Sources, So Salt Each Cold Iteration
+    double cold = 0.0, cached = 0.0;
+    for (int i = 0; i < iterations; i++)
+    {
+        std::string salt = "\n// " + std::to_string(i) + "\n";
+        auto start = Clock::now();
+        GLuint program = glCreateProgram();
+        GLuint vs = compile(GL_VERTEX_SHADER, vertex + salt);
+        GLuint fs = compile(GL_FRAGMENT_SHADER, fragment + salt);
+        glAttachShader(program, vs);
+        glAttachShader(program, fs);
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(program);
+        GLint status = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, & status);
+        if (status == GL_FALSE)
+        {   fprintf(stderr, "Failed to Link %s %s\n", argv[2], argv[3]);
+            return EXIT_FAILURE;
+        }
+        cache.Store(program, key);
+        glFinish();
+        cold += Milliseconds(Clock::now() - start).count();
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+        glDeleteProgram(program);
+
+        start = Clock::now();
+        program = glCreateProgram();
+        if (!cache.Load(program, key))
+        {   fprintf(stderr, "Driver Rejected Its Own Program Binary\n");
+            return EXIT_FAILURE;
+        }
+        glFinish();
+        cached += Milliseconds(Clock::now() - start).count();
+        glDeleteProgram(program);
+    }
+
+    printf("Renderer: %s\n", reinterpret_cast<char const *>(glGetString(GL_RENDERER)));
+    printf("Cold:     %8.3f ms\n", cold / iterations);
+    printf("Cached:   %8.3f ms\n", cached / iterations);
+    printf("Speedup:  %8.2fx\n", cold / cached);
+    glfwTerminate();
+    return EXIT_SUCCESS;
+}
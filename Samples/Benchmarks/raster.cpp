@@ -0,0 +1,306 @@
+// Local Headers
+#include "headless.hpp"
+#include "mesh.hpp"
+#include "pool.hpp"
+#include "raster.hpp"
+#include "shader_preprocessor.hpp"
+
+// System Headers
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Software Rasterizer Throughput, and Image Diffs Against OpenGL When There Is a GPU
+//
+//     bench_raster [triangles] [frames]
+//
+// Builds the scenes test_raster checks against its stored references:
+// Glitter's triangle through each permutation of shader.vert and
+// shader.frag, a grid of overlapping spheres in perspective with one
+// sphere cutting through the near plane, and a field of small triangles.
+// If a headless OpenGL context comes up, each scene is drawn with OpenGL as
+// well, the triangle with the real Glitter shaders, and at most 0.5% of the
+// pixels may be off by more than a few levels, which leaves room for edge
+// pixels and depth ties. The spheres and a field of the requested size are
+// then timed on one thread and on the pool.
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+    typedef std::chrono::duration<double, std::milli> Milliseconds;
+
+    const int Width = 640, Height = 360;
+    const std::size_t FieldTriangles = 200000; // Of the Field test_raster Stores
+
+    // shader.vert and shader.frag With a Transform in Front, as Mirage::Shading Applies It
+    char const * VertexSource = R"(
+        #version 330 core
+        layout (location = 0) in vec3 position;
+        layout (location = 1) in vec3 color;
+        uniform mat4 transform;
+        out vec3 ourColor;
+        void main()
+        {
+            gl_Position = transform * vec4(position, 1.0);
+            ourColor = color;
+        })";
+
+    char const * FragmentSource = R"(
+        #version 330 core
+        in vec3 ourColor;
+        out vec4 color;
+        void main()
+        {
+            color = vec4(ourColor, 1.0f);
+        })";
+
+    GLuint program(char const * vertex, char const * fragment)
+    {
+        char const * sources[] = { vertex, fragment };
+        GLenum stages[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+        GLuint program = glCreateProgram();
+        for (int i = 0; i < 2; i++)
+        {   GLuint shader = glCreateShader(stages[i]);
+            glShaderSource(shader, 1, & sources[i], nullptr);
+            glCompileShader(shader);
+            glAttachShader(program, shader);
+            glDeleteShader(shader);
+        }
+        glLinkProgram(program);
+        GLint status = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, & status);
+        return status ? program : 0;
+    }
+
+    struct Scene
+    {
+        std::string name;
+        std::vector<Mirage::MeshData> meshes;
+        Mirage::Shading shading;
+        glm::vec4 background;
+        bool glitter;            // Drawn by OpenGL With the Real Glitter Shaders
+    };
+
+    // The Triangle in main(), Colors in the Normal Slot, Which Is Attribute 1
+    Mirage::MeshData triangle()
+    {
+        Mirage::MeshData mesh;
+        float data[3][6] = { {  0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f },
+                             { -0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 0.0f },
+                             {  0.0f,  0.5f, 0.0f, 0.0f, 0.0f, 1.0f } };
+        for (auto const & row : data)
+        {   Mirage::Vertex vertex;
+            vertex.position = glm::vec3(row[0], row[1], row[2]);
+            vertex.normal = glm::vec3(row[3], row[4], row[5]);
+            vertex.uv = glm::vec2(0.0f, 0.0f);
+            mesh.vertices.push_back(vertex);
+        }
+        mesh.indices = { 0, 1, 2 };
+        return mesh;
+    }
+
+    Mirage::MeshData sphere(glm::vec3 const & center, float radius, int slices, int stacks)
+    {
+        Mirage::MeshData mesh;
+        for (int j = 0; j <= stacks; j++)
+        for (int i = 0; i <= slices; i++)
+        {   float theta = 3.14159265f * j / stacks, phi = 2.0f * 3.14159265f * i / slices;
+            Mirage::Vertex vertex;
+            vertex.normal = glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            vertex.position = center + vertex.normal * radius;
+            vertex.uv = glm::vec2(static_cast<float>(i) / slices, static_cast<float>(j) / stacks);
+            mesh.vertices.push_back(vertex);
+        }
+        for (int j = 0; j < stacks; j++)
+        for (int i = 0; i < slices; i++)
+        {   GLuint a = j * (slices + 1) + i, b = a + 1, c = a + slices + 1, d = c + 1;
+            GLuint quad[] = { a, c, b, b, c, d };
+            mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+        }
+        mesh.bounds = Mirage::Mesh::measure(mesh.vertices.data(), mesh.vertices.size());
+        return mesh;
+    }
+
+    // Small Triangles at Random Depths, Straight in Clip Space
+    Mirage::MeshData field(std::size_t count, std::mt19937 & random)
+    {
+        std::uniform_real_distribution<float> position(-1.0f, 1.0f), offset(-4.0f, 4.0f), unit(0.0f, 1.0f);
+        Mirage::MeshData mesh;
+        for (std::size_t t = 0; t < count; t++)
+        {   glm::vec3 center(position(random), position(random), position(random) * 0.9f);
+            glm::vec3 color(unit(random), unit(random), unit(random));
+            for (int v = 0; v < 3; v++)
+            {   Mirage::Vertex vertex;
+                vertex.position = center + glm::vec3(offset(random) / Width, offset(random) / Height, 0.0f);
+                vertex.normal = color;
+                vertex.uv = glm::vec2(0.0f, 0.0f);
+                mesh.vertices.push_back(vertex);
+                mesh.indices.push_back(static_cast<GLuint>(t * 3 + v));
+            }
+        }
+        return mesh;
+    }
+
+    // OpenGL Reference; Returns False If the Program Would Not Build
+    bool render(Scene const & scene, std::vector<unsigned char> & pixels, HeadlessContext & context)
+    {
+        GLuint shader = 0;
+        if (scene.glitter)
+        {   std::vector<std::string> defines;
+            if (scene.shading.wobble) defines.push_back("WOBBLE");
+            if (scene.shading.tint) defines.push_back("TINT");
+            auto vertex = ShaderPreprocessor::Process(PROJECT_SOURCE_DIR "/Glitter/Shaders/shader.vert", defines);
+            auto fragment = ShaderPreprocessor::Process(PROJECT_SOURCE_DIR "/Glitter/Shaders/shader.frag", defines);
+            if (vertex.valid && fragment.valid) shader = program(vertex.source.c_str(), fragment.source.c_str());
+        }
+        else shader = program(VertexSource, FragmentSource);
+        if (!shader) return false;
+
+        glUseProgram(shader);
+        glUniform1f(glGetUniformLocation(shader, "multiplier"), scene.shading.multiplier);
+        glUniformMatrix4fv(glGetUniformLocation(shader, "transform"), 1, GL_FALSE, glm::value_ptr(scene.shading.transform));
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LESS);
+        glClearColor(scene.background.x, scene.background.y, scene.background.z, scene.background.w);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        GLuint vertexArray, buffers[2];
+        glGenVertexArrays(1, & vertexArray);
+        glGenBuffers(2, buffers);
+        glBindVertexArray(vertexArray);
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        for (auto const & mesh : scene.meshes)
+        {   glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(Mirage::Vertex), mesh.vertices.data(), GL_STREAM_DRAW);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(GLuint), mesh.indices.data(), GL_STREAM_DRAW);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Mirage::Vertex), (GLvoid *) offsetof(Mirage::Vertex, position));
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Mirage::Vertex), (GLvoid *) offsetof(Mirage::Vertex, normal));
+            glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(mesh.indices.size()), GL_UNSIGNED_INT, 0);
+        }
+        context.ReadPixels(pixels);
+        glDeleteBuffers(2, buffers);
+        glDeleteVertexArrays(1, & vertexArray);
+        glDeleteProgram(shader);
+        return true;
+    }
+
+    void draw(Mirage::Rasterizer & rasterizer, Scene const & scene)
+    {
+        rasterizer.clear(scene.background);
+        rasterizer.draw(scene.meshes, scene.shading);
+        rasterizer.flush();
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    std::size_t triangles = argc > 1 ? std::max(1, std::atoi(argv[1])) : FieldTriangles;
+    int frames = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10;
+    float const Aspect = static_cast<float>(Width) / Height;
+
+    // Glitter's Triangle, Once per Permutation
+    std::vector<Scene> scenes;
+    for (int permutation = 0; permutation < 4; permutation++)
+    {   Scene scene;
+        scene.name = std::string("triangle") + (permutation & 1 ? "_wobble" : "") + (permutation & 2 ? "_tint" : "");
+        scene.meshes.push_back(triangle());
+        scene.shading.multiplier = 0.3f;
+        scene.shading.wobble = (permutation & 1) != 0;
+        scene.shading.tint = (permutation & 2) != 0;
+        scene.background = glm::vec4(0.2f, 0.3f, 0.3f, 1.0f);
+        scene.glitter = true;
+        scenes.push_back(scene);
+    }
+
+    // Overlapping Spheres; the One Beside the Camera Is Clipped by the Near Plane
+    Scene spheres;
+    spheres.name = "spheres";
+    for (int z = 0; z < 8; z++)
+    for (int x = 0; x < 8; x++)
+        spheres.meshes.push_back(sphere(glm::vec3((x - 3.5f) * 1.7f, 0.0f, -z * 1.7f), 1.0f, 48, 24));
+    spheres.meshes.push_back(sphere(glm::vec3(-1.2f, 3.2f, 8.6f), 1.0f, 48, 24));
+    spheres.shading.transform = glm::perspective(glm::radians(60.0f), Aspect, 0.5f, 100.0f)
+                              * glm::lookAt(glm::vec3(0.0f, 3.5f, 9.0f), glm::vec3(0.0f, 0.0f, -4.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    spheres.background = glm::vec4(0.1f, 0.1f, 0.15f, 1.0f);
+    spheres.glitter = false;
+    scenes.push_back(spheres);
+
+    std::mt19937 random(1337);
+    Scene small;
+    small.name = "field";
+    small.meshes.push_back(field(FieldTriangles, random));
+    small.background = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    small.glitter = false;
+    scenes.push_back(small);
+
+    // Timed Field; the Stored One Unless Another Size Was Asked For
+    Scene timed = small;
+    if (triangles != FieldTriangles)
+    {   random.seed(1337);
+        timed.meshes[0] = field(triangles, random);
+    }
+
+    Mirage::ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    Mirage::Rasterizer serial(Width, Height), parallel(Width, Height, & pool);
+    HeadlessContext context;
+    bool gpu = context.Create(Width, Height);
+    fprintf(stdout, "%dx%d, %u threads; OpenGL reference: %s\n", Width, Height, pool.size() + 1,
+            gpu ? reinterpret_cast<char const *>(glGetString(GL_RENDERER)) : "none");
+
+    // Image Diffs Against OpenGL
+    bool valid = true;
+    if (gpu) fprintf(stdout, "%-22s %10s %12s\n", "Scene", "Triangles", "OpenGL");
+    for (auto const & scene : scenes)
+    {
+        if (!gpu) break;
+        std::size_t count = 0;
+        for (auto const & mesh : scene.meshes) count += mesh.indices.size() / 3;
+        std::vector<unsigned char> one, reference;
+        draw(serial, scene);
+        serial.read(one);
+
+        char opengl[32] = "-";
+        if (render(scene, reference, context))
+        {   Mirage::ImageDifference difference = Mirage::compare(one, reference, 4);
+            snprintf(opengl, sizeof(opengl), "%.3f%%", 100.0 * difference.pixels / (Width * Height));
+            valid = valid && difference.pixels * 200 <= static_cast<std::size_t>(Width * Height);
+        }
+        fprintf(stdout, "%-22s %10zu %12s\n", scene.name.c_str(), count, opengl);
+    }
+
+    // Throughput of the Large Scenes, by Stage
+    fprintf(stdout, "\n%-10s %8s %10s %10s %10s %10s %10s %12s %12s\n", "Scene", "Threads", "Frame ms",
+            "Vertex ms", "Setup ms", "Raster ms", "Mtris/s", "Mfrags/s", "Binned/tri");
+    for (auto const * scene : { & scenes[scenes.size() - 2], & timed })
+    for (auto * rasterizer : { & serial, & parallel })
+    {
+        draw(*rasterizer, *scene);
+        rasterizer->reset();
+        auto start = Clock::now();
+        for (int frame = 0; frame < frames; frame++) draw(*rasterizer, *scene);
+        double elapsed = Milliseconds(Clock::now() - start).count();
+        auto const & statistics = rasterizer->statistics();
+        fprintf(stdout, "%-10s %8u %10.2f %10.2f %10.2f %10.2f %10.2f %12.1f %12.2f\n", scene->name.c_str(),
+                rasterizer == & serial ? 1u : pool.size() + 1, elapsed / frames,
+                statistics.vertexSeconds * 1e3 / frames, statistics.setupSeconds * 1e3 / frames,
+                statistics.rasterSeconds * 1e3 / frames, statistics.triangles / (elapsed * 1e3),
+                statistics.fragments / (elapsed * 1e3),
+                static_cast<double>(statistics.binned) / std::max<std::uint64_t>(1, statistics.triangles - statistics.culled));
+    }
+
+    if (!valid) fprintf(stderr, "Software Images Differ From OpenGL\n");
+    return valid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,307 @@
+// Local Headers
+#include "culling.hpp"
+#include "headless.hpp"
+#include "mesh.hpp"
+#include "pool.hpp"
+#include "streaming.hpp"
+
+// System Headers
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Residency, Stalls and I/O Throughput Along a Scripted Camera Path
+//
+//     bench_streaming [chunks per side] [memory MB] [frames] [world file] [image.png]
+//
+// Builds one terrain mesh covering the whole world, partitions it into
+// 64-unit chunks, gives each chunk its own block-compressed texture and
+// writes the world file. Each configuration then drops the file from the
+// page cache, loads everything around the start of the path as a loading
+// screen would, and flies a fixed loop, faster along one stretch, drawing
+// every frame through a headless context. It reports the loading time,
+// frames with holes inside the draw distance, the worst update and frame
+// times, peak residency against the memory budget, reads, evictions and
+// read throughput. Upload budgets trade stall frames for hitches; the
+// tight memory budget shows eviction at work.
+namespace
+{
+    typedef std::chrono::steady_clock Clock;
+    typedef std::chrono::duration<double, std::milli> Milliseconds;
+
+    const float ChunkSize = 64.0f;
+    const int Quads = 32;        // Per Chunk Side
+    const int TextureSize = 256;
+
+    char const * VertexSource = R"(
+        #version 330 core
+        layout(location = 0) in vec3 position;
+        layout(location = 1) in vec3 normal;
+        layout(location = 2) in vec2 uv;
+        uniform mat4 viewProjection;
+        out vec3 surface;
+        out vec2 coordinates;
+        void main()
+        {
+            surface = normal;
+            coordinates = uv;
+            gl_Position = viewProjection * vec4(position, 1.0);
+        })";
+
+    char const * FragmentSource = R"(
+        #version 330 core
+        in vec3 surface;
+        in vec2 coordinates;
+        uniform sampler2D diffuse;
+        out vec4 color;
+        void main()
+        {
+            float light = max(dot(normalize(surface), normalize(vec3(1, 3, 2))), 0.0);
+            color = vec4(texture(diffuse, coordinates).rgb * (0.35 + 0.65 * light), 1.0);
+        })";
+
+    GLuint program()
+    {
+        char const * sources[] = { VertexSource, FragmentSource };
+        GLenum stages[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+        GLuint program = glCreateProgram();
+        for (int i = 0; i < 2; i++)
+        {   GLuint shader = glCreateShader(stages[i]);
+            glShaderSource(shader, 1, & sources[i], nullptr);
+            glCompileShader(shader);
+            glAttachShader(program, shader);
+            glDeleteShader(shader);
+        }
+        glLinkProgram(program);
+        GLint status = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, & status);
+        return status ? program : 0;
+    }
+
+    float height(float x, float z)
+    {
+        return 18.0f * std::sin(x * 0.011f) * std::cos(z * 0.013f)
+             +  6.0f * std::sin(x * 0.041f + z * 0.027f)
+             +  1.5f * std::sin(x * 0.17f) * std::sin(z * 0.19f);
+    }
+
+    // One Grid Over the Whole World; UVs Repeat per Chunk So Each Chunk Maps Its Own Texture
+    Mirage::MeshData terrain(int chunks)
+    {
+        Mirage::MeshData mesh;
+        int side = chunks * Quads;
+        float step = ChunkSize / Quads;
+        for (int j = 0; j <= side; j++)
+        for (int i = 0; i <= side; i++)
+        {   Mirage::Vertex vertex;
+            float x = i * step, z = j * step;
+            vertex.position = glm::vec3(x, height(x, z), z);
+            glm::vec3 dx(2.0f * step, height(x + step, z) - height(x - step, z), 0.0f);
+            glm::vec3 dz(0.0f, height(x, z + step) - height(x, z - step), 2.0f * step);
+            vertex.normal = glm::normalize(glm::cross(dz, dx));
+            vertex.uv = glm::vec2(x / ChunkSize, z / ChunkSize);
+            mesh.vertices.push_back(vertex);
+        }
+        for (int j = 0; j < side; j++)
+        for (int i = 0; i < side; i++)
+        {   GLuint a = j * (side + 1) + i, b = a + 1, c = a + side + 1, d = c + 1;
+            GLuint quad[] = { a, c, b, b, c, d };
+            mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+        }
+        return mesh;
+    }
+
+    // Grass and Rock by Height With a Tint per Chunk, So Texture Seams Are Easy to Spot
+    Mirage::CompressedImage texture(Mirage::Bounds const & bounds)
+    {
+        std::vector<unsigned char> rgb(TextureSize * TextureSize * 3);
+        glm::vec3 origin(std::floor(bounds.min.x / ChunkSize) * ChunkSize, 0.0f, std::floor(bounds.min.z / ChunkSize) * ChunkSize);
+        int cell = static_cast<int>(origin.x / ChunkSize + origin.z / ChunkSize);
+        float tint = (cell & 1) ? 1.0f : 0.85f;
+        for (int y = 0; y < TextureSize; y++)
+        for (int x = 0; x < TextureSize; x++)
+        {   float wx = origin.x + (x + 0.5f) * ChunkSize / TextureSize;
+            float wz = origin.z + (y + 0.5f) * ChunkSize / TextureSize;
+            float h = (height(wx, wz) + 26.0f) / 52.0f;
+            float grain = 0.9f + 0.1f * std::sin(wx * 3.1f) * std::sin(wz * 2.7f);
+            glm::vec3 color = glm::vec3(0.25f, 0.5f, 0.2f) * (1.0f - h) + glm::vec3(0.55f, 0.5f, 0.45f) * h;
+            color = color * (grain * tint);
+            unsigned char * texel = & rgb[(y * TextureSize + x) * 3];
+            for (int c = 0; c < 3; c++) texel[c] = static_cast<unsigned char>(std::min(255.0f, color[c] * 255.0f));
+        }
+        return Mirage::compress(rgb.data(), TextureSize, TextureSize, 3);
+    }
+
+    // Closed Loop Over the World; Frames Between 40% and 55% of the Loop Cover Three Times the Ground
+    glm::vec3 path(float t, float extent)
+    {
+        float u = t < 0.4f ? t : t < 0.55f ? 0.4f + (t - 0.4f) * 3.0f : 0.85f + (t - 0.55f) * (0.15f / 0.45f);
+        float angle = 2.0f * 3.14159265f * u;
+        glm::vec3 center(extent * 0.5f, 0.0f, extent * 0.5f);
+        glm::vec3 position = center + glm::vec3(std::sin(angle), 0.0f, std::sin(2.0f * angle)) * (extent * 0.36f);
+        position.y = height(position.x, position.z) + 30.0f;
+        return position;
+    }
+
+    void evict(std::string const & filename)
+    {
+#ifndef _WIN32
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        close(fd);
+#else
+        (void) filename;
+#endif
+    }
+
+    struct Configuration
+    {
+        char const * name;
+        std::size_t memory;
+        std::size_t upload;
+    };
+}
+
+int main(int argc, char * argv[])
+{
+    int side = argc > 1 ? std::max(2, std::atoi(argv[1])) : 24;
+    std::size_t memory = (argc > 2 ? std::max(1, std::atoi(argv[2])) : 24) << 20;
+    int frames = argc > 3 ? std::max(10, std::atoi(argv[3])) : 600;
+    std::string filename = argc > 4 ? argv[4] : "streaming_bench.world";
+    char const * image = argc > 5 ? argv[5] : nullptr;
+    float extent = side * ChunkSize;
+
+    HeadlessContext context;
+    if (!context.Create(640, 360))
+    {   fprintf(stderr, "Failed to Create Headless OpenGL Context\n");
+        return EXIT_FAILURE;
+    }
+    GLuint shader = program();
+    if (!shader)
+    {   fprintf(stderr, "Failed to Build the Benchmark Shaders\n");
+        return EXIT_FAILURE;
+    }
+
+    // Build and Write the World; Textures Compress on the Pool
+    Mirage::ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    auto start = Clock::now();
+    std::vector<Mirage::MeshData> world(1, terrain(side));
+    std::vector<Mirage::ChunkData> chunks;
+    Mirage::partition(world, ChunkSize, chunks);
+    world.clear();
+    pool.run(chunks.size(), [&](std::size_t i) { chunks[i].texture = texture(chunks[i].mesh.bounds); });
+    if (!Mirage::WorldStreamer::write(filename, chunks))
+    {   fprintf(stderr, "Failed to Write %s\n", filename.c_str());
+        return EXIT_FAILURE;
+    }
+    std::size_t geometry = 0, textures = 0;
+    for (auto const & chunk : chunks)
+    {   geometry += chunk.mesh.vertices.size() * sizeof(Mirage::Vertex) + chunk.mesh.indices.size() * sizeof(GLuint);
+        textures += chunk.texture.data.size();
+    }
+    fprintf(stdout, "%zu chunks, %.1f MB of geometry and %.1f MB of textures, built in %.0f ms; %s\n",
+            chunks.size(), geometry / 1048576.0, textures / 1048576.0, Milliseconds(Clock::now() - start).count(),
+            glGetString(GL_RENDERER));
+    chunks.clear();
+
+    Configuration configurations[] =
+    {   { "no upload limit", memory,     0 },
+        { "1 MB/frame",      memory,     1 << 20 },
+        { "256 KB/frame",    memory,     256 << 10 },
+        { "1/3 memory",      memory / 3, 1 << 20 },
+    };
+    fprintf(stdout, "%-16s %8s %8s %8s %10s %10s %10s %9s %7s %9s %9s %9s\n", "Configuration", "Load ms", "Stalls",
+            "Missing", "Update ms", "Frame p99", "Frame max", "Peak MB", "Reads", "Evictions", "Read MB", "MB/s");
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 640.0f / 360.0f, 0.5f, 400.0f);
+    glUseProgram(shader);
+    GLint viewProjection = glGetUniformLocation(shader, "viewProjection");
+    glEnable(GL_DEPTH_TEST);
+    bool valid = true;
+    for (auto const & configuration : configurations)
+    {
+        Mirage::WorldStreamer::Settings settings;
+        settings.memoryBudget = configuration.memory;
+        settings.uploadBudget = configuration.upload;
+        settings.drawDistance = 256.0f;
+        settings.prefetchDistance = 320.0f;
+        settings.detailDistance = 48.0f;
+        Mirage::WorldStreamer streamer(pool, settings);
+        evict(filename);
+        if (!streamer.open(filename))
+        {   fprintf(stderr, "Failed to Open %s\n", filename.c_str());
+            return EXIT_FAILURE;
+        }
+
+        // Loading Screen: Stream In Everything Around the Start Before the Camera Moves
+        auto begin = Clock::now();
+        for (int i = 0; i < 100000; i++)
+        {   streamer.update(path(0.0f, extent));
+            if (streamer.telemetry().missing == 0 && streamer.telemetry().reading == 0 && streamer.telemetry().staged == 0) break;
+            std::this_thread::yield();
+        }
+        double loading = Milliseconds(Clock::now() - begin).count();
+        std::uint64_t stallsBefore = streamer.telemetry().stallFrames;
+
+        std::vector<double> times;
+        double worstUpdate = 0.0;
+        std::size_t worstMissing = 0;
+        begin = Clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            auto frameStart = Clock::now();
+            float t = static_cast<float>(frame) / frames;
+            glm::vec3 eye = path(t, extent);
+            glm::vec3 ahead = path(t + 0.01f, extent);
+            ahead.y = eye.y - 12.0f;
+            streamer.update(eye);
+            worstUpdate = std::max(worstUpdate, Milliseconds(Clock::now() - frameStart).count());
+            worstMissing = std::max(worstMissing, streamer.telemetry().missing);
+
+            glm::mat4 matrix = projection * glm::lookAt(eye, ahead, glm::vec3(0.0f, 1.0f, 0.0f));
+            Mirage::Frustum frustum(matrix);
+            glClearColor(0.55f, 0.7f, 0.85f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            glUseProgram(shader);
+            glUniformMatrix4fv(viewProjection, 1, GL_FALSE, glm::value_ptr(matrix));
+            streamer.draw(shader, & frustum);
+            glFinish();
+            times.push_back(Milliseconds(Clock::now() - frameStart).count());
+        }
+        double elapsed = Milliseconds(Clock::now() - begin).count() + loading;
+        streamer.finish();
+
+        auto const & telemetry = streamer.telemetry();
+        std::sort(times.begin(), times.end());
+        fprintf(stdout, "%-16s %8.0f %8llu %8zu %10.2f %10.2f %10.2f %9.1f %7llu %9llu %9.1f %9.1f\n",
+                configuration.name, loading, static_cast<unsigned long long>(telemetry.stallFrames - stallsBefore),
+                worstMissing, worstUpdate, times[times.size() * 99 / 100], times.back(),
+                telemetry.peakBytes / 1048576.0, static_cast<unsigned long long>(telemetry.reads),
+                static_cast<unsigned long long>(telemetry.evictions), telemetry.bytesRead / 1048576.0,
+                telemetry.bytesRead / 1048576.0 / (elapsed / 1000.0));
+        if (telemetry.failures > 0 || telemetry.peakBytes > configuration.memory)
+        {   fprintf(stderr, "%s: %llu Failed Chunks, Peak %zu of %zu Bytes\n", configuration.name,
+                    static_cast<unsigned long long>(telemetry.failures), telemetry.peakBytes, configuration.memory);
+            valid = false;
+        }
+        if (image && & configuration == & configurations[1] && !context.WriteImage(image))
+            fprintf(stderr, "Failed to Write %s\n", image);
+    }
+    return valid && glGetError() == GL_NO_ERROR ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,124 @@
+// Local Headers
+#include "compress.hpp"
+
+// System Headers
+#include <stb_image.h>
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Mip Generation and Block Compression Throughput; Runs Without an OpenGL Context
+//
+//     bench_texture_compress [--kaiser] [image ...]
+//
+// Without images, compresses synthetic RGB, RGBA and two-channel textures.
+// "raw" is what the uncompressed path keeps in VRAM for the full chain,
+// "saved" is how much of that compression removes, and PSNR compares the
+// decoded top level against the source over the channels it actually has.
+namespace
+{
+    struct Source
+    {
+        std::string name;
+        int width, height, channels;
+        std::vector<unsigned char> pixels;
+    };
+
+    Source synthesize(char const * name, int size, int channels)
+    {
+        Source source = { name, size, size, channels, std::vector<unsigned char>(size * size * channels) };
+        for (int y = 0; y < size; y++)
+        for (int x = 0; x < size; x++)
+        for (int c = 0; c < channels; c++)
+        {   float wave = std::sin(x * 0.05f * (c + 1)) * std::cos(y * 0.03f * (c + 2));
+            source.pixels[(y * size + x) * channels + c] = static_cast<unsigned char>(
+                127.5f + 100.0f * wave + ((x * 7 + y * 13 + c * 5) % 23) - 11);
+        }   return source;
+    }
+
+    std::size_t footprint(int width, int height, int channels)
+    {
+        std::size_t bytes = 0;
+        for (;;)
+        {   bytes += static_cast<std::size_t>(width) * height * channels;
+            if (width == 1 && height == 1) return bytes;
+            width  = width  > 1 ? width  / 2 : 1;
+            height = height > 1 ? height / 2 : 1;
+        }
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    using Clock = std::chrono::high_resolution_clock;
+    Mirage::MipFilter filter = Mirage::MipFilter::Box;
+    std::vector<Source> sources;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--kaiser") == 0) { filter = Mirage::MipFilter::Kaiser; continue; }
+        Source source;
+        source.name = argv[i];
+        unsigned char * pixels = stbi_load(argv[i], & source.width, & source.height, & source.channels, 0);
+        if (!pixels)
+        {   fprintf(stderr, "Failed to Load Texture %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+        source.pixels.assign(pixels, pixels + source.width * source.height * source.channels);
+        stbi_image_free(pixels);
+        sources.push_back(source);
+    }
+    if (sources.empty())
+    {   sources.push_back(synthesize("synthetic rgb",  1024, 3));
+        sources.push_back(synthesize("synthetic rgba", 1024, 4));
+        sources.push_back(synthesize("synthetic rg",   1024, 2));
+    }
+
+    static char const * formats[] = { "BC1", "BC3", "BC4", "BC5" };
+    fprintf(stdout, "%-24s %11s %6s %8s %10s %10s %7s %8s\n", "texture", "size", "format",
+            "MP/s", "raw", "packed", "saved", "PSNR");
+    std::size_t totalRaw = 0, totalPacked = 0;
+    for (auto const & source : sources)
+    {
+        // Repeat Small Images So the Timer Has Something to Measure
+        int repeats = std::max(1, (1 << 22) / (source.width * source.height));
+        Mirage::CompressedImage image;
+        auto start = Clock::now();
+        for (int i = 0; i < repeats; i++)
+            image = Mirage::compress(source.pixels.data(), source.width, source.height, source.channels, filter);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count() / repeats;
+
+        std::size_t texels = 0;
+        for (auto const & level : image.levels) texels += static_cast<std::size_t>(level.width) * level.height;
+        std::size_t raw = footprint(source.width, source.height, source.channels);
+        totalRaw += raw;
+        totalPacked += image.data.size();
+
+        std::vector<unsigned char> decoded;
+        Mirage::decompress(image, 0, decoded);
+        double error = 0.0;
+        for (int i = 0; i < source.width * source.height; i++)
+        for (int c = 0; c < source.channels; c++)
+        {   double d = double(decoded[i * 4 + c]) - source.pixels[i * source.channels + c];
+            error += d * d;
+        }
+        error /= double(source.width) * source.height * source.channels;
+        double psnr = error > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / error) : 99.0;
+
+        std::string name = source.name.substr(source.name.find_last_of("/\\") + 1);
+        char size[32];
+        std::snprintf(size, sizeof(size), "%dx%dx%d", source.width, source.height, source.channels);
+        fprintf(stdout, "%-24s %11s %6s %8.1f %10zu %10zu %6.1f%% %8.2f\n", name.c_str(), size,
+                formats[static_cast<int>(image.format)], texels / seconds * 1e-6,
+                raw, image.data.size(), 100.0 * (double(raw) - double(image.data.size())) / raw, psnr);
+    }
+    fprintf(stdout, "VRAM: %zu bytes raw, %zu compressed, %lld saved\n", totalRaw, totalPacked,
+            static_cast<long long>(totalRaw) - static_cast<long long>(totalPacked));
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,200 @@
+// Local Headers
+#include "headless.hpp"
+#include "mesh.hpp"
+#include "uniform.hpp"
+
+// Standard Headers
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <string>
+
+// Count Every Heap Allocation Made by the Process
+static std::atomic<std::size_t> allocations(0);
+void * operator new(std::size_t size)
+{
+    allocations++;
+    if (void * memory = std::malloc(size)) return memory;
+    throw std::bad_alloc();
+}
+void operator delete(void * memory) noexcept { std::free(memory); }
+
+// Allocations and Lookups per Frame for Uniform Binding
+//
+//     bench_uniform_lookup [submeshes]
+//
+// The first table is a CPU model that needs no GPU: a std::map stands in
+// for the driver's name lookup. The "string" path rebuilds sampler names
+// with std::to_string and resolves them by string compare, as Mesh::draw
+// used to with glGetUniformLocation. The "hashed" path resolves precomputed
+// hashes against a UniformTable, and the "cached" path reuses locations
+// resolved once up front. If a headless OpenGL context comes up, the second
+// table times the real thing on a linked program: "driver" rebuilds the
+// names and calls glGetUniformLocation per submesh, and "material" asks
+// Mirage::Material::locations(), which Mesh::draw uses, every submesh.
+namespace
+{
+    // Samples All Three Units, So None of the Uniforms Is Optimized Away
+    char const * VertexSource = R"(
+        #version 330 core
+        layout (location = 0) in vec3 position;
+        out vec2 uv;
+        void main()
+        {
+            uv = position.xy;
+            gl_Position = vec4(position, 1.0);
+        })";
+
+    char const * FragmentSource = R"(
+        #version 330 core
+        in vec2 uv;
+        out vec4 color;
+        uniform sampler2D diffuse;
+        uniform sampler2D diffuse2;
+        uniform sampler2D specular;
+        void main()
+        {
+            color = texture(diffuse, uv) + texture(diffuse2, uv) + texture(specular, uv);
+        })";
+
+    GLuint program()
+    {
+        char const * sources[] = { VertexSource, FragmentSource };
+        GLenum stages[] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+        GLuint program = glCreateProgram();
+        for (int i = 0; i < 2; i++)
+        {   GLuint shader = glCreateShader(stages[i]);
+            glShaderSource(shader, 1, & sources[i], nullptr);
+            glCompileShader(shader);
+            glAttachShader(program, shader);
+            glDeleteShader(shader);
+        }
+        glLinkProgram(program);
+        GLint status = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, & status);
+        if (!status) { glDeleteProgram(program); return 0; }
+        return program;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    using Clock = std::chrono::high_resolution_clock;
+    const int frames = 1000;
+    const int submeshes = argc > 1 ? std::atoi(argv[1]) : 256;
+    const char * names[] = { "diffuse", "diffuse2", "specular", "specular2", "model", "view", "projection", "multiplier" };
+
+    // Stand-Ins for the Driver's Name Lookup and the Reflected Table
+    std::map<std::string, GLint> driver;
+    Mirage::UniformTable table;
+    for (GLint i = 0; i < 8; i++)
+    {   driver[names[i]] = i;
+        table.insert(names[i], i);
+    }
+
+    // String Path
+    volatile GLint sink = 0;
+    std::size_t before = allocations;
+    auto start = Clock::now();
+    for (int frame = 0; frame < frames; frame++)
+    for (int mesh = 0; mesh < submeshes; mesh++)
+    {   unsigned int diffuse = 0, specular = 0;
+        for (auto mode : { "diffuse", "diffuse", "specular" })
+        {   std::string uniform = mode;
+                 if (uniform == "diffuse")  uniform += (diffuse++  > 0) ? std::to_string(diffuse)  : "";
+            else if (uniform == "specular") uniform += (specular++ > 0) ? std::to_string(specular) : "";
+            sink = driver[uniform];
+        }
+    }
+    double stringMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::size_t stringAllocations = allocations - before;
+    std::size_t stringLookups = static_cast<std::size_t>(frames) * submeshes * 3;
+
+    // Hashed Path
+    static constexpr std::uint32_t samplers[] = { Mirage::uniform("diffuse"), Mirage::uniform("diffuse2"), Mirage::uniform("specular") };
+    before = allocations;
+    std::size_t lookups = table.lookups();
+    start = Clock::now();
+    for (int frame = 0; frame < frames; frame++)
+    for (int mesh = 0; mesh < submeshes; mesh++)
+    for (auto hash : samplers) sink = table.find(hash);
+    double hashedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::size_t hashedAllocations = allocations - before;
+    std::size_t hashedLookups = table.lookups() - lookups;
+
+    // Cached Path: Locations Resolved Once, as Mirage::Material Does
+    GLint cached[3];
+    for (int i = 0; i < 3; i++) cached[i] = table.find(samplers[i]);
+    before = allocations;
+    lookups = table.lookups();
+    start = Clock::now();
+    for (int frame = 0; frame < frames; frame++)
+    for (int mesh = 0; mesh < submeshes; mesh++)
+    for (auto location : cached) sink = location;
+    double cachedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::size_t cachedAllocations = allocations - before;
+    std::size_t cachedLookups = table.lookups() - lookups;
+
+    fprintf(stdout, "%d submeshes x 3 samplers, %d frames\n", submeshes, frames);
+    fprintf(stdout, "\nCPU model, std::map standing in for the driver\n");
+    fprintf(stdout, "%-8s %16s %16s %12s\n", "path", "allocs/frame", "lookups/frame", "us/frame");
+    fprintf(stdout, "%-8s %16.1f %16.1f %12.2f\n", "string", double(stringAllocations) / frames,
+            double(stringLookups) / frames, stringMs * 1000.0 / frames);
+    fprintf(stdout, "%-8s %16.1f %16.1f %12.2f\n", "hashed", double(hashedAllocations) / frames,
+            double(hashedLookups) / frames, hashedMs * 1000.0 / frames);
+    fprintf(stdout, "%-8s %16.1f %16.1f %12.2f\n", "cached", double(cachedAllocations) / frames,
+            double(cachedLookups) / frames, cachedMs * 1000.0 / frames);
+
+    // The Same Sampler Set Through the Driver and Through Mirage::Material
+    std::size_t materialAllocations = 0;
+    HeadlessContext context;
+    GLuint shader = context.Create(64, 64) ? program() : 0;
+    if (shader)
+    {
+        before = allocations;
+        start = Clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        for (int mesh = 0; mesh < submeshes; mesh++)
+        {   unsigned int diffuse = 0, specular = 0;
+            for (auto mode : { "diffuse", "diffuse", "specular" })
+            {   std::string uniform = mode;
+                     if (uniform == "diffuse")  uniform += (diffuse++  > 0) ? std::to_string(diffuse)  : "";
+                else if (uniform == "specular") uniform += (specular++ > 0) ? std::to_string(specular) : "";
+                sink = glGetUniformLocation(shader, uniform.c_str());
+            }
+        }
+        double driverMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        std::size_t driverAllocations = allocations - before;
+
+        // Resolves on First Use per Program, Like the First Draw of a Mesh
+        Mirage::TextureSlots slots = { { 1, "diffuse" }, { 2, "diffuse" }, { 3, "specular" } };
+        Mirage::Material material(slots);
+        bool resolved = material.locations(shader).size() == 3;
+        for (auto location : material.locations(shader)) resolved = resolved && location != -1;
+        before = allocations;
+        start = Clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        for (int mesh = 0; mesh < submeshes; mesh++)
+        for (auto location : material.locations(shader)) sink = location;
+        double materialMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        materialAllocations = allocations - before;
+
+        char const * renderer = reinterpret_cast<char const *>(glGetString(GL_RENDERER));
+        fprintf(stdout, "\nOpenGL, %s\n", renderer ? renderer : "unknown renderer");
+        fprintf(stdout, "%-8s %16s %16s %12s\n", "path", "allocs/frame", "lookups/frame", "us/frame");
+        fprintf(stdout, "%-8s %16.1f %16.1f %12.2f\n", "driver", double(driverAllocations) / frames,
+                double(stringLookups) / frames, driverMs * 1000.0 / frames);
+        fprintf(stdout, "%-8s %16.1f %16.1f %12.2f\n", "material", double(materialAllocations) / frames,
+                0.0, materialMs * 1000.0 / frames);
+        if (!resolved) fprintf(stderr, "Material Did Not Resolve Every Sampler\n");
+        materialAllocations += resolved ? 0 : 1;
+        glDeleteProgram(shader);
+    }
+    else fprintf(stdout, "\nNo OpenGL context; only the CPU model ran\n");
+
+    (void) sink;
+    return hashedAllocations + cachedAllocations + materialAllocations == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,187 @@
+// Local Headers
+#include "gpu_allocator.hpp"
+
+// Standard Headers
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+// Linear, Ring and TLSF Offset Bookkeeping; Needs No GL Context
+//
+//     test_gpu_allocator
+//
+// Checks alignment, exhaustion and reset of the linear allocator, wrapping
+// and fence release of the ring, and splitting and coalescing of the TLSF
+// allocator. Then replays a random mix of mesh-sized allocations and frees
+// against the TLSF allocator, and drives the ring like a stream with three
+// frames in flight. Every range either returns is checked against the ranges
+// still live. Exits with failure if any check does not hold.
+namespace
+{
+    int failures = 0;
+
+    void check(bool condition, char const * what)
+    {
+        if (condition) return;
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        failures++;
+    }
+
+    // Live Ranges Keyed by Offset; Insert Fails on Any Overlap
+    bool claim(std::map<std::size_t, std::size_t> & live, std::size_t offset, std::size_t size)
+    {
+        auto next = live.lower_bound(offset);
+        if (next != live.end() && next->first < offset + size) return false;
+        if (next != live.begin() && std::prev(next)->second > offset) return false;
+        live[offset] = offset + size;
+        return true;
+    }
+
+    void linear()
+    {
+        LinearAllocator linear(256);
+        check(linear.Allocate(10) == 0 && linear.Allocate(10) == 16, "linear allocations are aligned and packed");
+        check(linear.Allocate(1, 64) == 64, "linear honours larger alignments");
+        AllocatorStats stats = linear.Stats();
+        check(stats.used == 65 && stats.live == 3 && stats.largestFree == 256 - 65, "linear counts padding as used");
+
+        check(linear.Allocate(300) == InvalidOffset && linear.Stats().failures == 1, "linear reports exhaustion");
+        linear.Reset();
+        stats = linear.Stats();
+        check(stats.used == 0 && stats.live == 0 && stats.peak == 65, "reset frees everything and keeps the peak");
+        check(linear.Allocate(256) == 0 && linear.Allocate(1) == InvalidOffset, "reset makes the whole range usable");
+    }
+
+    void ring()
+    {
+        RingAllocator ring(1024);
+        check(ring.Allocate(400) == 0, "ring starts at zero");
+        ring.Fence(1);
+        check(ring.Allocate(400) == 400, "ring allocates behind the head");
+        ring.Fence(2);
+        check(ring.Allocate(300) == InvalidOffset, "ring does not overwrite fenced frames");
+
+        // Releasing the First Frame Frees the Start; the Next Allocation Wraps and the Tail Counts as Used
+        ring.Release(1);
+        check(ring.Allocate(300) == 0, "ring wraps to the start");
+        AllocatorStats stats = ring.Stats();
+        check(stats.used == 400 + 224 + 300 && stats.live == 2, "skipped tail counts as used");
+        check(ring.Allocate(200) == InvalidOffset, "wrapped ring stops at the oldest frame");
+        ring.Fence(3);
+        check(ring.Pending() && ring.Oldest() == 2, "frames retire in order");
+
+        ring.Release(3);
+        stats = ring.Stats();
+        check(!ring.Pending() && stats.used == 0 && stats.live == 0 && stats.largestFree == 1024, "ring drains");
+        check(ring.Allocate(1024) == 0, "drained ring restarts at zero");
+    }
+
+    void tlsf()
+    {
+        TlsfAllocator tlsf(4096);
+        TlsfAllocator::Allocation a = tlsf.Allocate(1000), b = tlsf.Allocate(1000), c = tlsf.Allocate(1000);
+        check(a.Valid() && b.Valid() && c.Valid() && tlsf.Validate(), "tlsf splits the initial block");
+        check(a.size >= 1000 && a.size % TlsfAllocator::Granularity == 0, "tlsf rounds to its granularity");
+
+        // Freeing the Middle Leaves a Hole; Its Neighbours Merge Back Into One Block
+        tlsf.Free(b);
+        check(tlsf.Validate() && tlsf.Stats().freeBlocks == 2, "middle free leaves a hole");
+        tlsf.Free(a);
+        check(tlsf.Validate() && tlsf.Stats().freeBlocks == 2, "free coalesces with the next block");
+        tlsf.Free(c);
+        AllocatorStats stats = tlsf.Stats();
+        check(tlsf.Validate() && stats.freeBlocks == 1 && stats.largestFree == 4096, "free coalesces both ways");
+
+        check(!tlsf.Allocate(4097).Valid() && tlsf.Stats().failures == 1, "tlsf reports exhaustion");
+        TlsfAllocator::Allocation all = tlsf.Allocate(4096);
+        check(all.Valid() && all.offset == 0 && !tlsf.Allocate(16).Valid(), "tlsf hands out the whole range");
+        tlsf.Free(all);
+        check(tlsf.Validate() && tlsf.Stats().used == 0, "tlsf drains");
+    }
+
+    void replay(std::size_t count, std::mt19937 & random)
+    {
+        // Sizes Are Log-Uniform From 64 Bytes to 256 KB; the Live Count Hovers Around 4000
+        const std::size_t capacity = 256 << 20;
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        TlsfAllocator tlsf(capacity);
+        std::vector<TlsfAllocator::Allocation> live;
+        std::map<std::size_t, std::size_t> ranges;
+        bool valid = true;
+        for (std::size_t i = 0; i < count && valid; i++)
+        {   if (!live.empty() && unit(random) < (live.size() < 4000 ? 0.4 : 0.6))
+            {   std::size_t victim = random() % live.size();
+                ranges.erase(live[victim].offset);
+                tlsf.Free(live[victim]);
+                live[victim] = live.back();
+                live.pop_back();
+            }
+            else
+            {   std::size_t size = static_cast<std::size_t>(64.0 * std::pow(4096.0, unit(random)));
+                std::size_t alignment = std::size_t(16) << (random() % 5);
+                TlsfAllocator::Allocation allocation = tlsf.Allocate(size, alignment);
+                valid = allocation.Valid() && allocation.offset % alignment == 0 && allocation.size >= size
+                     && claim(ranges, allocation.offset, allocation.size);
+                live.push_back(allocation);
+            }
+            if (i % 4096 == 0) valid = valid && tlsf.Validate();
+        }
+        check(valid, "random tlsf ranges are aligned, disjoint and valid");
+        for (auto & allocation : live) tlsf.Free(allocation);
+        AllocatorStats stats = tlsf.Stats();
+        check(tlsf.Validate() && stats.used == 0 && stats.freeBlocks == 1 && stats.largestFree == capacity,
+              "random tlsf replay coalesces back to one block");
+    }
+
+    void stream(std::size_t frames, std::mt19937 & random)
+    {
+        // Three Frames in Flight; a Frame's Ranges Must Not Be Reused Until It Is Released
+        const std::size_t capacity = 4 << 20;
+        RingAllocator ring(capacity);
+        std::map<std::size_t, std::size_t> ranges;
+        std::deque<std::vector<std::size_t>> inFlight;
+        bool valid = true;
+        for (std::size_t frame = 0; frame < frames && valid; frame++)
+        {
+            std::vector<std::size_t> offsets;
+            std::size_t allocations = 64 + random() % 128;
+            for (std::size_t i = 0; i < allocations; i++)
+            {   std::size_t size = 16 + random() % 8192, alignment = std::size_t(16) << (random() % 5);
+                std::size_t offset = ring.Allocate(size, alignment);
+                if (offset == InvalidOffset) continue;
+                valid = valid && offset % alignment == 0 && offset + size <= capacity
+                              && claim(ranges, offset, size);
+                offsets.push_back(offset);
+            }
+            ring.Fence(frame);
+            inFlight.push_back(offsets);
+            if (inFlight.size() > 3)
+            {   ring.Release(frame - 3);
+                for (auto offset : inFlight.front()) ranges.erase(offset);
+                inFlight.pop_front();
+            }
+        }
+        check(valid, "streamed ring ranges are aligned and never overlap a frame in flight");
+        ring.Release(frames);
+        AllocatorStats stats = ring.Stats();
+        check(stats.used == 0 && stats.live == 0 && stats.largestFree == capacity, "streamed ring drains");
+    }
+}
+
+int main()
+{
+    std::mt19937 random(1234);
+    linear();
+    ring();
+    tlsf();
+    replay(200000, random);
+    stream(2000, random);
+
+    if (failures == 0) std::printf("GPU Allocators: all checks passed\n");
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
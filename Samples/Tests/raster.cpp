@@ -0,0 +1,196 @@
+// Local Headers
+#include "mesh.hpp"
+#include "pool.hpp"
+#include "raster.hpp"
+
+// System Headers
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <stb_image.h>
+#include <stb_image_write.h>
+
+// Standard Headers
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Software Rasterizer Images Against Each Other and the Stored References; Needs No GL Context
+//
+//     test_raster [--update-references] [reference directory]
+//
+// Renders Glitter's triangle through each permutation of shader.vert and
+// shader.frag, a grid of overlapping spheres in perspective with one
+// sphere cutting through the near plane, and a field of small triangles.
+// Every scene is drawn on one thread and on the pool, and the two images
+// must be identical. Each image is also diffed against the one stored in
+// Samples/Tests/References, or the directory given, and at most 0.1% of the
+// pixels may be off by more than two levels. A missing reference fails the
+// run; --update-references rewrites them instead. bench_raster compares the
+// same scenes with OpenGL and times them.
+namespace
+{
+    const int Width = 640, Height = 360;
+    const std::size_t FieldTriangles = 200000;
+
+    struct Scene
+    {
+        std::string name;
+        std::vector<Mirage::MeshData> meshes;
+        Mirage::Shading shading;
+        glm::vec4 background;
+    };
+
+    // The Triangle in main(), Colors in the Normal Slot, Which Is Attribute 1
+    Mirage::MeshData triangle()
+    {
+        Mirage::MeshData mesh;
+        float data[3][6] = { {  0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f },
+                             { -0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 0.0f },
+                             {  0.0f,  0.5f, 0.0f, 0.0f, 0.0f, 1.0f } };
+        for (auto const & row : data)
+        {   Mirage::Vertex vertex;
+            vertex.position = glm::vec3(row[0], row[1], row[2]);
+            vertex.normal = glm::vec3(row[3], row[4], row[5]);
+            vertex.uv = glm::vec2(0.0f, 0.0f);
+            mesh.vertices.push_back(vertex);
+        }
+        mesh.indices = { 0, 1, 2 };
+        return mesh;
+    }
+
+    Mirage::MeshData sphere(glm::vec3 const & center, float radius, int slices, int stacks)
+    {
+        Mirage::MeshData mesh;
+        for (int j = 0; j <= stacks; j++)
+        for (int i = 0; i <= slices; i++)
+        {   float theta = 3.14159265f * j / stacks, phi = 2.0f * 3.14159265f * i / slices;
+            Mirage::Vertex vertex;
+            vertex.normal = glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            vertex.position = center + vertex.normal * radius;
+            vertex.uv = glm::vec2(static_cast<float>(i) / slices, static_cast<float>(j) / stacks);
+            mesh.vertices.push_back(vertex);
+        }
+        for (int j = 0; j < stacks; j++)
+        for (int i = 0; i < slices; i++)
+        {   GLuint a = j * (slices + 1) + i, b = a + 1, c = a + slices + 1, d = c + 1;
+            GLuint quad[] = { a, c, b, b, c, d };
+            mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+        }
+        mesh.bounds = Mirage::Mesh::measure(mesh.vertices.data(), mesh.vertices.size());
+        return mesh;
+    }
+
+    // Small Triangles at Random Depths, Straight in Clip Space
+    Mirage::MeshData field(std::size_t count, std::mt19937 & random)
+    {
+        std::uniform_real_distribution<float> position(-1.0f, 1.0f), offset(-4.0f, 4.0f), unit(0.0f, 1.0f);
+        Mirage::MeshData mesh;
+        for (std::size_t t = 0; t < count; t++)
+        {   glm::vec3 center(position(random), position(random), position(random) * 0.9f);
+            glm::vec3 color(unit(random), unit(random), unit(random));
+            for (int v = 0; v < 3; v++)
+            {   Mirage::Vertex vertex;
+                vertex.position = center + glm::vec3(offset(random) / Width, offset(random) / Height, 0.0f);
+                vertex.normal = color;
+                vertex.uv = glm::vec2(0.0f, 0.0f);
+                mesh.vertices.push_back(vertex);
+                mesh.indices.push_back(static_cast<GLuint>(t * 3 + v));
+            }
+        }
+        return mesh;
+    }
+
+    void draw(Mirage::Rasterizer & rasterizer, Scene const & scene)
+    {
+        rasterizer.clear(scene.background);
+        rasterizer.draw(scene.meshes, scene.shading);
+        rasterizer.flush();
+    }
+
+    int failures = 0;
+
+    void check(bool condition, std::string const & what)
+    {
+        if (condition) return;
+        std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+        failures++;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    bool update = argc > 1 && std::string(argv[1]) == "--update-references";
+    if (update) { argc--; argv++; }
+    std::string directory = argc > 1 ? argv[1] : PROJECT_SOURCE_DIR "/Samples/Tests/References";
+    float const Aspect = static_cast<float>(Width) / Height;
+
+    // Glitter's Triangle, Once per Permutation
+    std::vector<Scene> scenes;
+    for (int permutation = 0; permutation < 4; permutation++)
+    {   Scene scene;
+        scene.name = std::string("triangle") + (permutation & 1 ? "_wobble" : "") + (permutation & 2 ? "_tint" : "");
+        scene.meshes.push_back(triangle());
+        scene.shading.multiplier = 0.3f;
+        scene.shading.wobble = (permutation & 1) != 0;
+        scene.shading.tint = (permutation & 2) != 0;
+        scene.background = glm::vec4(0.2f, 0.3f, 0.3f, 1.0f);
+        scenes.push_back(scene);
+    }
+
+    // Overlapping Spheres; the One Beside the Camera Is Clipped by the Near Plane
+    Scene spheres;
+    spheres.name = "spheres";
+    for (int z = 0; z < 8; z++)
+    for (int x = 0; x < 8; x++)
+        spheres.meshes.push_back(sphere(glm::vec3((x - 3.5f) * 1.7f, 0.0f, -z * 1.7f), 1.0f, 48, 24));
+    spheres.meshes.push_back(sphere(glm::vec3(-1.2f, 3.2f, 8.6f), 1.0f, 48, 24));
+    spheres.shading.transform = glm::perspective(glm::radians(60.0f), Aspect, 0.5f, 100.0f)
+                              * glm::lookAt(glm::vec3(0.0f, 3.5f, 9.0f), glm::vec3(0.0f, 0.0f, -4.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    spheres.background = glm::vec4(0.1f, 0.1f, 0.15f, 1.0f);
+    scenes.push_back(spheres);
+
+    std::mt19937 random(1337);
+    Scene small;
+    small.name = "field";
+    small.meshes.push_back(field(FieldTriangles, random));
+    small.background = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    scenes.push_back(small);
+
+    Mirage::ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    Mirage::Rasterizer serial(Width, Height), parallel(Width, Height, & pool);
+    for (auto const & scene : scenes)
+    {
+        std::vector<unsigned char> one, many;
+        draw(serial, scene);
+        draw(parallel, scene);
+        serial.read(one);
+        parallel.read(many);
+        check(Mirage::compare(one, many).pixels == 0, scene.name + " is the same on one thread and on the pool");
+
+        std::string path = directory + "/" + scene.name + ".png";
+        if (update)
+        {   check(stbi_write_png(path.c_str(), Width, Height, 3, one.data(), Width * 3) != 0, "writes " + path);
+            continue;
+        }
+        int width, height, channels;
+        unsigned char * image = stbi_load(path.c_str(), & width, & height, & channels, 3);
+        check(image && width == Width && height == Height, path + " exists and is " + std::to_string(Width) + "x" + std::to_string(Height));
+        if (image && width == Width && height == Height)
+        {   std::vector<unsigned char> expected(image, image + Width * Height * 3);
+            Mirage::ImageDifference difference = Mirage::compare(one, expected, 2);
+            check(difference.pixels * 1000 <= static_cast<std::size_t>(Width * Height), scene.name + " matches its reference");
+            std::printf("%-22s %.3f%% of pixels differ from the reference\n", scene.name.c_str(),
+                        100.0 * difference.pixels / (Width * Height));
+        }
+        if (image) stbi_image_free(image);
+    }
+
+    if (failures == 0) std::printf("Rasterizer: all checks passed\n");
+    else if (!update) std::fprintf(stderr, "Run With --update-references to Store New Images After an Intended Change\n");
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,140 @@
+// Local Headers
+#include "texture.hpp"
+
+// Standard Headers
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+// TextureCache Bookkeeping With a Fake Backend and a Stub Loader; Needs No GL Context
+//
+//     test_texture_cache
+//
+// Checks hits and misses, resident textures and bytes, that the texture is
+// destroyed with its last reference, that a later acquire decodes it again
+// and that a hit pending on another loader is ready once this one finishes.
+// Exits with failure if any check does not hold.
+namespace
+{
+    // Hands Out Increasing Handles and Remembers Which Are Still Alive
+    class FakeBackend : public Mirage::TextureCache::Backend
+    {
+    public:
+        FakeBackend(std::set<GLuint> & live, int & created) : mLive(live), mCreated(created), mNext(1) {}
+        GLuint create(Mirage::Image const &) { mCreated++; mLive.insert(mNext); return mNext++; }
+        void destroy(GLuint texture) { mLive.erase(texture); }
+
+    private:
+        std::set<GLuint> & mLive;
+        int & mCreated;
+        GLuint mNext;
+    };
+
+    // Queues Requests Instead of Decoding; finish() Delivers a 4x4 RGBA Image to Each
+    struct StubLoader
+    {
+        std::vector<std::pair<std::string, Mirage::AssetLoader::Callback>> queued;
+
+        std::shared_ptr<Mirage::Texture> acquire(Mirage::TextureCache & cache, std::string const & filename)
+        {
+            return cache.acquire(filename, [this](std::string const & path, Mirage::AssetLoader::Callback callback)
+            {   queued.push_back(std::make_pair(path, callback));
+            }, this);
+        }
+
+        void finish()
+        {
+            for (auto & entry : queued)
+            {   Mirage::Image image;
+                image.filename = entry.first;
+                image.width = image.height = 4;
+                image.channels = 4;
+                entry.second(image);
+            }   queued.clear();
+        }
+    };
+
+    int failures = 0;
+
+    void check(bool condition, char const * what)
+    {
+        if (condition) return;
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+int main()
+{
+    // 4x4 RGBA With Mipmaps: 64 + 16 + 4 Bytes
+    const std::size_t Bytes = 84;
+    std::set<GLuint> live;
+    int created = 0;
+    Mirage::TextureCache cache(std::unique_ptr<Mirage::TextureCache::Backend>(new FakeBackend(live, created)));
+    StubLoader loader;
+
+    // First Request Misses, the Second for the Same Canonical Path Hits
+    auto a = loader.acquire(cache, "textures/wall.png");
+    auto b = loader.acquire(cache, "textures/../textures/./wall.png");
+    auto c = loader.acquire(cache, "textures/floor.png");
+    Mirage::TextureCache::Statistics stats = cache.statistics();
+    check(a == b, "same path shares one texture");
+    check(a != c, "different paths get different textures");
+    check(stats.misses == 2 && stats.hits == 1, "two misses and one hit");
+    check(stats.textures == 2, "two textures resident");
+    check(loader.queued.size() == 2, "one decode per distinct path");
+    check(a->get() == 0 && stats.bytes == 0, "nothing uploaded before the loader finishes");
+
+    loader.finish();
+    stats = cache.statistics();
+    check(created == 2 && live.size() == 2, "one upload per distinct path");
+    check(a->get() != 0 && a->get() != c->get(), "uploads give distinct handles");
+    check(a->bytes() == Bytes && stats.bytes == 2 * Bytes, "bytes count the mip chain");
+
+    // Dropping One of Two References Keeps the Texture; Dropping the Last Destroys It
+    GLuint handle = a->get();
+    a.reset();
+    check(live.count(handle) == 1 && cache.statistics().textures == 2, "texture survives while referenced");
+    b.reset();
+    stats = cache.statistics();
+    check(live.count(handle) == 0, "last reference destroys the GL texture");
+    check(stats.textures == 1 && stats.bytes == Bytes, "released texture leaves the totals");
+
+    // An Expired Entry Misses Again and Is Decoded and Uploaded Anew
+    auto d = loader.acquire(cache, "textures/wall.png");
+    stats = cache.statistics();
+    check(stats.misses == 3 && stats.hits == 1, "re-acquire after expiry misses");
+    check(loader.queued.size() == 1, "re-acquire after expiry decodes again");
+    loader.finish();
+    check(d->get() != 0 && d->get() != handle && created == 3, "re-acquire uploads a new texture");
+
+    // A Texture Released Before Its Upload Is Never Created
+    auto e = loader.acquire(cache, "textures/sky.png");
+    e.reset();
+    loader.finish();
+    check(created == 3, "no upload for a texture nobody holds");
+
+    // A Hit Pending on Another Loader Is Requested Here Too, and Uploaded Only Once
+    StubLoader other;
+    auto f = other.acquire(cache, "textures/roof.png");
+    auto g = loader.acquire(cache, "textures/roof.png");
+    check(f == g && other.queued.size() == 1 && loader.queued.size() == 1, "pending hit requests on its own loader");
+    loader.finish();
+    check(g->get() != 0 && created == 4, "pending hit is ready after its own loader finishes");
+    other.finish();
+    check(created == 4 && cache.statistics().bytes == 3 * Bytes, "second upload of the same texture is skipped");
+    f.reset();
+    g.reset();
+
+    c.reset();
+    d.reset();
+    stats = cache.statistics();
+    check(live.empty() && stats.textures == 0 && stats.bytes == 0, "everything released");
+
+    if (failures == 0) std::printf("TextureCache: all checks passed\n");
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
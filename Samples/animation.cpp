@@ -0,0 +1,524 @@
+// Local Headers
+#include "animation.hpp"
+#include "mesh.hpp"
+#include "pool.hpp"
+
+// System Headers
+#include <assimp/Importer.hpp>
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Standard Headers
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <set>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        // Thin Wrappers So Each Kernel Is Written Once for AVX, SSE2 and Scalar Builds
+#if defined(__AVX__)
+        typedef __m256 Lanes;
+        const std::size_t Width = 8;
+        inline Lanes load(float const * p) { return _mm256_loadu_ps(p); }
+        inline void store(float * p, Lanes v) { _mm256_storeu_ps(p, v); }
+        inline Lanes splat(float v) { return _mm256_set1_ps(v); }
+        inline Lanes add(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+        inline Lanes sub(Lanes a, Lanes b) { return _mm256_sub_ps(a, b); }
+        inline Lanes mul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+        inline Lanes rsqrt(Lanes v) { return _mm256_div_ps(splat(1.0f), _mm256_sqrt_ps(v)); }
+        inline Lanes flip(Lanes v, Lanes sign) { return _mm256_xor_ps(v, _mm256_and_ps(sign, splat(-0.0f))); }
+        inline Lanes widen(std::int16_t const * p)
+        {
+            // AVX Lacks 256-Bit Integer Unpacks; Sign-Extend Each Half in SSE Registers
+            __m128i v  = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+            return _mm256_cvtepi32_ps(_mm256_insertf128_si256(_mm256_castsi128_si256(lo), hi, 1));
+        }
+#elif defined(__SSE2__)
+        typedef __m128 Lanes;
+        const std::size_t Width = 4;
+        inline Lanes load(float const * p) { return _mm_loadu_ps(p); }
+        inline void store(float * p, Lanes v) { _mm_storeu_ps(p, v); }
+        inline Lanes splat(float v) { return _mm_set1_ps(v); }
+        inline Lanes add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+        inline Lanes sub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+        inline Lanes mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+        inline Lanes rsqrt(Lanes v) { return _mm_div_ps(splat(1.0f), _mm_sqrt_ps(v)); }
+        inline Lanes flip(Lanes v, Lanes sign) { return _mm_xor_ps(v, _mm_and_ps(sign, splat(-0.0f))); }
+        inline Lanes widen(std::int16_t const * p)
+        {
+            __m128i v = _mm_loadl_epi64(reinterpret_cast<__m128i const *>(p));
+            return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+        }
+#else
+        typedef float Lanes;
+        const std::size_t Width = 1;
+        inline Lanes load(float const * p) { return *p; }
+        inline void store(float * p, Lanes v) { *p = v; }
+        inline Lanes splat(float v) { return v; }
+        inline Lanes add(Lanes a, Lanes b) { return a + b; }
+        inline Lanes sub(Lanes a, Lanes b) { return a - b; }
+        inline Lanes mul(Lanes a, Lanes b) { return a * b; }
+        inline Lanes rsqrt(Lanes v) { return 1.0f / std::sqrt(v); }
+        inline Lanes flip(Lanes v, Lanes sign) { return sign < 0.0f ? -v : v; }
+        inline Lanes widen(std::int16_t const * p) { return static_cast<float>(*p); }
+#endif
+
+        inline Lanes lerp(Lanes a, Lanes b, Lanes t) { return add(a, mul(sub(b, a), t)); }
+
+        // Normalized Lerp of Width Quaternions, Negating b Where It Points Into the Other Hemisphere
+        inline void nlerp(Lanes const a[4], Lanes b[4], Lanes t, Pose & pose, std::size_t j)
+        {
+            Lanes dot = add(add(mul(a[0], b[0]), mul(a[1], b[1])),
+                            add(mul(a[2], b[2]), mul(a[3], b[3])));
+            Lanes q[4];
+            for (int c = 0; c < 4; c++) q[c] = lerp(a[c], flip(b[c], dot), t);
+            Lanes scale = rsqrt(add(add(mul(q[0], q[0]), mul(q[1], q[1])),
+                                    add(mul(q[2], q[2]), mul(q[3], q[3]))));
+            for (int c = 0; c < 4; c++) store(pose[Pose::QX + c] + j, mul(q[c], scale));
+        }
+
+        // Rotation-Scale-Translation Rows for Width Joints, Written Column-Wise Into rows
+        inline void compose(Pose const & pose, std::size_t j, float rows[12][8], std::size_t lane)
+        {
+            Lanes x = load(pose[Pose::QX] + j), y = load(pose[Pose::QY] + j);
+            Lanes z = load(pose[Pose::QZ] + j), w = load(pose[Pose::QW] + j);
+            Lanes sx = load(pose[Pose::SX] + j), sy = load(pose[Pose::SY] + j), sz = load(pose[Pose::SZ] + j);
+            Lanes x2 = add(x, x), y2 = add(y, y), z2 = add(z, z), one = splat(1.0f);
+            Lanes xx = mul(x, x2), yy = mul(y, y2), zz = mul(z, z2);
+            Lanes xy = mul(x, y2), xz = mul(x, z2), yz = mul(y, z2);
+            Lanes wx = mul(w, x2), wy = mul(w, y2), wz = mul(w, z2);
+            store(rows[0]  + lane, mul(sub(one, add(yy, zz)), sx));
+            store(rows[1]  + lane, mul(sub(xy, wz), sy));
+            store(rows[2]  + lane, mul(add(xz, wy), sz));
+            store(rows[3]  + lane, load(pose[Pose::TX] + j));
+            store(rows[4]  + lane, mul(add(xy, wz), sx));
+            store(rows[5]  + lane, mul(sub(one, add(xx, zz)), sy));
+            store(rows[6]  + lane, mul(sub(yz, wx), sz));
+            store(rows[7]  + lane, load(pose[Pose::TY] + j));
+            store(rows[8]  + lane, mul(sub(xz, wy), sx));
+            store(rows[9]  + lane, mul(add(yz, wx), sy));
+            store(rows[10] + lane, mul(sub(one, add(xx, yy)), sz));
+            store(rows[11] + lane, load(pose[Pose::TZ] + j));
+        }
+
+        // c = a * b With the Implied Bottom Row (0, 0, 0, 1); c Must Not Alias a or b
+        inline void multiply(Affine const & a, Affine const & b, Affine & c)
+        {
+#if defined(__SSE2__)
+            __m128 b0 = _mm_loadu_ps(& b.rows[0].x);
+            __m128 b1 = _mm_loadu_ps(& b.rows[1].x);
+            __m128 b2 = _mm_loadu_ps(& b.rows[2].x);
+            __m128 b3 = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+            for (int r = 0; r < 3; r++)
+            {   __m128 row = _mm_loadu_ps(& a.rows[r].x);
+                __m128 result = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(0, 0, 0, 0)), b0),
+                               _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(1, 1, 1, 1)), b1)),
+                    _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(2, 2, 2, 2)), b2),
+                               _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(3, 3, 3, 3)), b3)));
+                _mm_storeu_ps(& c.rows[r].x, result);
+            }
+#else
+            for (int r = 0; r < 3; r++)
+            {   c.rows[r] = a.rows[r].x * b.rows[0] + a.rows[r].y * b.rows[1] + a.rows[r].z * b.rows[2];
+                c.rows[r].w += a.rows[r].w;
+            }
+#endif
+        }
+
+        Affine toAffine(glm::mat4 const & m)
+        {
+            Affine affine;
+            for (int r = 0; r < 3; r++) affine.rows[r] = glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]);
+            return affine;
+        }
+
+        glm::mat4 toMatrix(aiMatrix4x4 const & m)
+        {
+            // Assimp Matrices Are Row-Major
+            return glm::transpose(glm::mat4(m.a1, m.a2, m.a3, m.a4,
+                                            m.b1, m.b2, m.b3, m.b4,
+                                            m.c1, m.c2, m.c3, m.c4,
+                                            m.d1, m.d2, m.d3, m.d4));
+        }
+
+        void decompose(glm::mat4 const & m, glm::vec3 & translation, glm::quat & rotation, glm::vec3 & scale)
+        {
+            translation = glm::vec3(m[3]);
+            scale = glm::vec3(glm::length(glm::vec3(m[0])), glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2])));
+            if (glm::determinant(glm::mat3(m)) < 0.0f) scale.x = -scale.x;
+            glm::vec3 x = glm::vec3(m[0]) / scale.x, y = glm::vec3(m[1]) / scale.y, z = glm::vec3(m[2]) / scale.z;
+            rotation = glm::normalize(glm::quat_cast(glm::mat3(x, y, z)));
+        }
+
+        std::int16_t quantize(float value)
+        {
+            return static_cast<std::int16_t>(std::lround(std::max(-1.0f, std::min(1.0f, value)) * 32767.0f));
+        }
+
+        aiNode const * findNode(aiNode const * node, char const * name)
+        {
+            if (std::strcmp(node->mName.C_Str(), name) == 0) return node;
+            for (unsigned int i = 0; i < node->mNumChildren; i++)
+                if (aiNode const * found = findNode(node->mChildren[i], name)) return found;
+            return nullptr;
+        }
+
+        void gather(aiNode const * node, int parent, std::set<aiNode const *> const & used, Skeleton & skeleton)
+        {
+            if (used.count(node))
+                parent = static_cast<int>(skeleton.add(node->mName.C_Str(), parent, toMatrix(node->mTransformation)));
+            for (unsigned int i = 0; i < node->mNumChildren; i++)
+                gather(node->mChildren[i], parent, used, skeleton);
+        }
+
+        // Bracketing Keys for time, Holding the First and Last Keys Outside Their Range
+        template<typename Key>
+        unsigned int bracket(Key const * keys, unsigned int count, double time, float & t)
+        {
+            unsigned int next = static_cast<unsigned int>(std::upper_bound(keys, keys + count, time,
+                [](double time, Key const & key) { return time < key.mTime; }) - keys);
+            t = 0.0f;
+            if (next == 0) return 0;
+            if (next == count) return count - 1;
+            double span = keys[next].mTime - keys[next - 1].mTime;
+            if (span > 0.0) t = static_cast<float>((time - keys[next - 1].mTime) / span);
+            return next - 1;
+        }
+
+        glm::vec3 interpolate(aiVectorKey const * keys, unsigned int count, double time)
+        {
+            float t;
+            unsigned int k = bracket(keys, count, time, t);
+            aiVector3D const & a = keys[k].mValue, & b = keys[std::min(k + 1, count - 1)].mValue;
+            return glm::mix(glm::vec3(a.x, a.y, a.z), glm::vec3(b.x, b.y, b.z), t);
+        }
+
+        glm::quat interpolate(aiQuatKey const * keys, unsigned int count, double time)
+        {
+            float t;
+            unsigned int k = bracket(keys, count, time, t);
+            aiQuaternion const & a = keys[k].mValue, & b = keys[std::min(k + 1, count - 1)].mValue;
+            return glm::slerp(glm::quat(a.w, a.x, a.y, a.z), glm::quat(b.w, b.x, b.y, b.z), t);
+        }
+
+        // Per-Thread Scratch Poses for computePalettes()
+        thread_local Pose sPrimary, sSecondary;
+    }
+
+    const std::size_t Skeleton::MaxJoints;
+
+    void Pose::resize(std::size_t joints)
+    {
+        mJoints = joints;
+        mStride = pad(joints);
+        mData.assign(Components * mStride, 0.0f);
+        for (int c : { QW, SX, SY, SZ })
+            std::fill(mData.begin() + c * mStride, mData.begin() + (c + 1) * mStride, 1.0f);
+    }
+
+    void Pose::set(std::size_t joint, glm::vec3 const & translation, glm::quat const & rotation, glm::vec3 const & scale)
+    {
+        glm::quat q = glm::normalize(rotation);
+        float values[Components] = { translation.x, translation.y, translation.z,
+                                     q.x, q.y, q.z, q.w, scale.x, scale.y, scale.z };
+        for (int c = 0; c < Components; c++) mData[c * mStride + joint] = values[c];
+    }
+
+    void Pose::get(std::size_t joint, glm::vec3 & translation, glm::quat & rotation, glm::vec3 & scale) const
+    {
+        auto at = [&](int c) { return mData[c * mStride + joint]; };
+        translation = glm::vec3(at(TX), at(TY), at(TZ));
+        rotation    = glm::quat(at(QW), at(QX), at(QY), at(QZ));
+        scale       = glm::vec3(at(SX), at(SY), at(SZ));
+    }
+
+    std::size_t Skeleton::add(std::string const & name, int parent, glm::mat4 const & local)
+    {
+        std::size_t joint = mParents.size();
+        glm::mat4 model = parent < 0 ? local : mModel[parent] * local;
+        mParents.push_back(parent);
+        mNames.push_back(name);
+        mModel.push_back(model);
+        mInverseBind.push_back(toAffine(glm::inverse(model)));
+
+        // Grow the Bind Pose by One Joint, Keeping the Others
+        Pose pose(joint + 1);
+        glm::vec3 translation, scale;
+        glm::quat rotation;
+        for (std::size_t i = 0; i < joint; i++)
+        {   mBindPose.get(i, translation, rotation, scale);
+            pose.set(i, translation, rotation, scale);
+        }
+        decompose(local, translation, rotation, scale);
+        pose.set(joint, translation, rotation, scale);
+        mBindPose = pose;
+        return joint;
+    }
+
+    void Skeleton::bind(std::size_t joint, glm::mat4 const & inverseBind)
+    {
+        mInverseBind[joint] = toAffine(inverseBind);
+    }
+
+    int Skeleton::find(std::string const & name) const
+    {
+        auto found = std::find(mNames.begin(), mNames.end(), name);
+        return found == mNames.end() ? -1 : static_cast<int>(found - mNames.begin());
+    }
+
+    void Skeleton::palette(Pose const & pose, Affine * palette) const
+    {
+        // Local Matrices Eight Joints at a Time, Then Parents Before Children
+        Affine model[MaxJoints];
+        float rows[12][8];
+        std::size_t joints = std::min(size(), MaxJoints);
+        for (std::size_t base = 0; base < joints; base += 8)
+        {
+            for (std::size_t lane = 0; lane < 8; lane += Width)
+                compose(pose, base + lane, rows, lane);
+            for (std::size_t j = base; j < std::min(base + 8, joints); j++)
+            {   Affine local;
+                std::size_t lane = j - base;
+                for (int r = 0; r < 3; r++)
+                    local.rows[r] = glm::vec4(rows[r * 4][lane], rows[r * 4 + 1][lane],
+                                              rows[r * 4 + 2][lane], rows[r * 4 + 3][lane]);
+                if (mParents[j] < 0) model[j] = local;
+                else multiply(model[mParents[j]], local, model[j]);
+                multiply(model[j], mInverseBind[j], palette[j]);
+            }
+        }
+    }
+
+    bool Skeleton::import(aiScene const * scene, Skeleton & skeleton)
+    {
+        // Mark Every Referenced Node and Its Ancestors; Stop at the First Already Marked
+        skeleton = Skeleton();
+        std::set<aiNode const *> used;
+        auto mark = [&](aiNode const * node)
+        {   for (; node && used.insert(node).second; node = node->mParent) {}
+        };
+        for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+        for (unsigned int j = 0; j < scene->mMeshes[i]->mNumBones; j++)
+            mark(findNode(scene->mRootNode, scene->mMeshes[i]->mBones[j]->mName.C_Str()));
+        for (unsigned int i = 0; i < scene->mNumAnimations; i++)
+        for (unsigned int j = 0; j < scene->mAnimations[i]->mNumChannels; j++)
+            mark(findNode(scene->mRootNode, scene->mAnimations[i]->mChannels[j]->mNodeName.C_Str()));
+        if (used.empty()) return false;
+        if (used.size() > MaxJoints)
+        {   fprintf(stderr, "Skeleton Has %zu Joints; Only %zu Are Supported\n", used.size(), MaxJoints);
+            return false;
+        }
+
+        // Depth-First Order Puts Parents First; Bones Override the Computed Inverse Bind
+        gather(scene->mRootNode, -1, used, skeleton);
+        for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+        for (unsigned int j = 0; j < scene->mMeshes[i]->mNumBones; j++)
+        {   aiBone const * bone = scene->mMeshes[i]->mBones[j];
+            int joint = skeleton.find(bone->mName.C_Str());
+            if (joint >= 0) skeleton.bind(joint, toMatrix(bone->mOffsetMatrix));
+        }   return true;
+    }
+
+    AnimationClip::AnimationClip(Skeleton const & skeleton, float duration, float rate, std::string const & name)
+        : mName(name)
+        , mFrames(static_cast<std::size_t>(std::ceil(std::max(duration, 0.0f) * rate)) + 1)
+        , mJoints(skeleton.size())
+        , mStride(Pose::pad(skeleton.size()))
+        , mRate(rate)
+        , mDuration(std::max(duration, 0.0f))
+    {
+        // Start Every Frame From the Bind Pose; Padding Lanes Copy Its Identity
+        Pose const & bind = skeleton.bindPose();
+        mVectors.resize(mFrames * 6 * mStride);
+        mRotations.resize(mFrames * 4 * mStride);
+        static const int Vectors[6] = { Pose::TX, Pose::TY, Pose::TZ, Pose::SX, Pose::SY, Pose::SZ };
+        for (std::size_t frame = 0; frame < mFrames; frame++)
+        for (std::size_t j = 0; j < mStride; j++)
+        {   for (int c = 0; c < 6; c++) mVectors[(frame * 6 + c) * mStride + j] = bind[Vectors[c]][j];
+            for (int c = 0; c < 4; c++) mRotations[(frame * 4 + c) * mStride + j] = quantize(bind[Pose::QX + c][j]);
+        }
+    }
+
+    void AnimationClip::set(std::size_t frame, std::size_t joint, glm::vec3 const & translation,
+                            glm::quat const & rotation, glm::vec3 const & scale)
+    {
+        glm::quat q = glm::normalize(rotation);
+        float vectors[6] = { translation.x, translation.y, translation.z, scale.x, scale.y, scale.z };
+        float rotations[4] = { q.x, q.y, q.z, q.w };
+        for (int c = 0; c < 6; c++) mVectors[(frame * 6 + c) * mStride + joint] = vectors[c];
+        for (int c = 0; c < 4; c++) mRotations[(frame * 4 + c) * mStride + joint] = quantize(rotations[c]);
+    }
+
+    float AnimationClip::time(std::size_t frame) const
+    {
+        return mFrames > 1 ? mDuration * frame / (mFrames - 1) : 0.0f;
+    }
+
+    void AnimationClip::sample(float time, Pose & pose, bool loop) const
+    {
+        if (pose.stride() != mStride || pose.size() != mJoints) pose.resize(mJoints);
+        if (mFrames == 0) return;
+
+        // Locate the Two Frames Around time
+        float last = static_cast<float>(mFrames - 1);
+        float position = mDuration > 0.0f ? time / mDuration * last : 0.0f;
+        if (loop && last > 0.0f) position -= last * std::floor(position / last);
+        position = std::max(0.0f, std::min(position, last));
+        std::size_t frame = std::min(static_cast<std::size_t>(position), mFrames - 1);
+        std::size_t next  = std::min(frame + 1, mFrames - 1);
+        Lanes t = splat(position - static_cast<float>(frame));
+
+        // Translations and Scales Lerp Component by Component
+        static const int Vectors[6] = { Pose::TX, Pose::TY, Pose::TZ, Pose::SX, Pose::SY, Pose::SZ };
+        float const * va = & mVectors[frame * 6 * mStride];
+        float const * vb = & mVectors[next  * 6 * mStride];
+        for (int c = 0; c < 6; c++)
+        for (std::size_t j = 0; j < mStride; j += Width)
+            store(pose[Vectors[c]] + j, lerp(load(va + c * mStride + j), load(vb + c * mStride + j), t));
+
+        // Rotations Skip the snorm Scale; nlerp Renormalises Anyway
+        std::int16_t const * ra = & mRotations[frame * 4 * mStride];
+        std::int16_t const * rb = & mRotations[next  * 4 * mStride];
+        for (std::size_t j = 0; j < mStride; j += Width)
+        {   Lanes a[4], b[4];
+            for (int c = 0; c < 4; c++)
+            {   a[c] = widen(ra + c * mStride + j);
+                b[c] = widen(rb + c * mStride + j);
+            }   nlerp(a, b, t, pose, j);
+        }
+    }
+
+    bool AnimationClip::import(aiAnimation const * animation, Skeleton const & skeleton,
+                               AnimationClip & clip, float rate)
+    {
+        // Resample Keys at Evenly Spaced Times; Channels May Each Have Their Own Keys
+        double ticks = animation->mTicksPerSecond > 0.0 ? animation->mTicksPerSecond : 25.0;
+        clip = AnimationClip(skeleton, static_cast<float>(animation->mDuration / ticks), rate,
+                             animation->mName.C_Str());
+        for (unsigned int i = 0; i < animation->mNumChannels; i++)
+        {
+            aiNodeAnim const * channel = animation->mChannels[i];
+            int joint = skeleton.find(channel->mNodeName.C_Str());
+            if (joint < 0) continue;
+            glm::vec3 bindTranslation, bindScale;
+            glm::quat bindRotation;
+            skeleton.bindPose().get(joint, bindTranslation, bindRotation, bindScale);
+            for (std::size_t frame = 0; frame < clip.frames(); frame++)
+            {   double time = clip.time(frame) * ticks;
+                clip.set(frame, joint,
+                    channel->mNumPositionKeys ? interpolate(channel->mPositionKeys, channel->mNumPositionKeys, time) : bindTranslation,
+                    channel->mNumRotationKeys ? interpolate(channel->mRotationKeys, channel->mNumRotationKeys, time) : bindRotation,
+                    channel->mNumScalingKeys  ? interpolate(channel->mScalingKeys,  channel->mNumScalingKeys,  time) : bindScale);
+            }
+        }   return clip.frames() > 0;
+    }
+
+    void blend(Pose const & a, Pose const & b, float weight, Pose & result)
+    {
+        if (result.stride() != a.stride() || result.size() != a.size()) result.resize(a.size());
+        Lanes t = splat(weight);
+        for (int c : { Pose::TX, Pose::TY, Pose::TZ, Pose::SX, Pose::SY, Pose::SZ })
+        for (std::size_t j = 0; j < a.stride(); j += Width)
+            store(result[c] + j, lerp(load(a[c] + j), load(b[c] + j), t));
+        for (std::size_t j = 0; j < a.stride(); j += Width)
+        {   Lanes qa[4], qb[4];
+            for (int c = 0; c < 4; c++)
+            {   qa[c] = load(a[Pose::QX + c] + j);
+                qb[c] = load(b[Pose::QX + c] + j);
+            }   nlerp(qa, qb, t, result, j);
+        }
+    }
+
+    void computePalettes(Skeleton const & skeleton, AnimationState const * states,
+                         std::size_t count, Affine * palettes, ThreadPool * pool)
+    {
+        // Batches Amortise Task Dispatch; Each Thread Reuses Its Own Scratch Poses
+        const std::size_t Batch = 16;
+        std::size_t joints = skeleton.size();
+        auto animate = [&](std::size_t batch)
+        {
+            Pose & pose = sPrimary, & other = sSecondary;
+            for (std::size_t i = batch * Batch; i < std::min(count, (batch + 1) * Batch); i++)
+            {   AnimationState const & state = states[i];
+                if (state.clips[0]) state.clips[0]->sample(state.times[0], pose);
+                else pose = skeleton.bindPose();
+                if (state.clips[1] && state.weight > 0.0f)
+                {   state.clips[1]->sample(state.times[1], other);
+                    blend(pose, other, state.weight, pose);
+                }   skeleton.palette(pose, palettes + i * joints);
+            }
+        };
+        std::size_t batches = (count + Batch - 1) / Batch;
+        if (pool) pool->run(batches, animate);
+        else for (std::size_t i = 0; i < batches; i++) animate(i);
+    }
+
+    bool importAnimations(std::string const & filename, Skeleton & skeleton,
+                          std::vector<AnimationClip> & clips, float rate)
+    {
+        // Same Flags as Mesh::import(), So Both See the Same Node Graph and Joint Order
+        Assimp::Importer loader;
+        aiScene const * scene = loader.ReadFile(filename, Mesh::ImportFlags);
+        if (!scene)
+        {   fprintf(stderr, "%s\n", loader.GetErrorString());
+            return false;
+        }
+        clips.clear();
+        if (!Skeleton::import(scene, skeleton)) return false;
+        for (unsigned int i = 0; i < scene->mNumAnimations; i++)
+        {   AnimationClip clip;
+            if (AnimationClip::import(scene->mAnimations[i], skeleton, clip, rate))
+                clips.push_back(clip);
+        }   return true;
+    }
+
+    PaletteBuffer::PaletteBuffer(std::size_t capacity)
+        : mStream(GL_TEXTURE_BUFFER, capacity)
+        , mTexture(0)
+    {
+        glGenTextures(1, & mTexture);
+        glBindTexture(GL_TEXTURE_BUFFER, mTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, mStream.Buffer());
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+    PaletteBuffer::~PaletteBuffer()
+    {
+        glDeleteTextures(1, & mTexture);
+    }
+
+    Affine * PaletteBuffer::allocate(std::size_t count, GLint & base)
+    {
+        // Texel Alignment Is Enough; Offsets Are Passed to the Shader, Not Bound
+        StreamBuffer::Span span = mStream.Allocate(count * sizeof(Affine), sizeof(glm::vec4));
+        base = span.data ? static_cast<GLint>(span.offset / sizeof(glm::vec4)) : -1;
+        return static_cast<Affine *>(span.data);
+    }
+
+    GLint PaletteBuffer::upload(Affine const * palettes, std::size_t count)
+    {
+        GLint base;
+        Affine * destination = allocate(count, base);
+        if (!destination) return -1;
+        std::memcpy(destination, palettes, count * sizeof(Affine));
+        flush();
+        return base;
+    }
+
+    void PaletteBuffer::bind(GLuint unit) const
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_BUFFER, mTexture);
+    }
+};
@@ -0,0 +1,225 @@
+#pragma once
+
+// Local Headers
+#include "gpu_buffer.hpp"
+
+// System Headers
+#include <assimp/scene.h>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Forward Declarations
+    class ThreadPool;
+
+    // Top Three Rows of an Affine Transform; the Upload Format of Skinning Palettes
+    struct Affine
+    {
+        glm::vec4 rows[3];
+    };
+
+    // Local Joint Transforms as Structure-of-Arrays
+    //
+    // Ten arrays of stride() floats: translation x, y, z, rotation quaternion
+    // x, y, z, w and scale x, y, z. The joint count is padded to a multiple of
+    // eight so every loop runs whole AVX vectors; padding joints hold the
+    // identity and never reach a palette.
+    class Pose
+    {
+    public:
+
+        // Component Arrays, in Storage Order
+        enum Component { TX, TY, TZ, QX, QY, QZ, QW, SX, SY, SZ, Components };
+
+        // Implement Custom Constructors
+        Pose() : mJoints(0), mStride(0) {}
+        Pose(std::size_t joints) { resize(joints); }
+
+        // Public Member Functions
+        void resize(std::size_t joints); // Resets Every Joint to the Identity
+        void set(std::size_t joint, glm::vec3 const & translation, glm::quat const & rotation, glm::vec3 const & scale);
+        void get(std::size_t joint, glm::vec3 & translation, glm::quat & rotation, glm::vec3 & scale) const;
+        float       * operator[](int component)       { return & mData[component * mStride]; }
+        float const * operator[](int component) const { return & mData[component * mStride]; }
+        std::size_t size() const { return mJoints; }
+        std::size_t stride() const { return mStride; }
+
+        // Joints Rounded Up to Whole SIMD Vectors
+        static std::size_t pad(std::size_t joints) { return (joints + 7) & ~std::size_t(7); }
+
+    private:
+
+        // Private Member Containers
+        std::vector<float> mData;
+
+        // Private Member Variables
+        std::size_t mJoints;
+        std::size_t mStride;
+
+    };
+
+    // Joint Hierarchy Sorted So Every Parent Precedes Its Children
+    class Skeleton
+    {
+    public:
+
+        // Public Member Functions
+        std::size_t add(std::string const & name, int parent, glm::mat4 const & local); // Parent Must Exist; -1 for a Root
+        void bind(std::size_t joint, glm::mat4 const & inverseBind); // Defaults to the Inverse of the Bind Pose
+        int find(std::string const & name) const; // -1 If Missing
+        int parent(std::size_t joint) const { return mParents[joint]; }
+        std::string const & name(std::size_t joint) const { return mNames[joint]; }
+        Pose const & bindPose() const { return mBindPose; }
+        std::size_t size() const { return mParents.size(); }
+
+        // Model-Space Joints Times Inverse Bind, size() Entries
+        void palette(Pose const & pose, Affine * palette) const;
+
+        // Scene Nodes That Bones or Animation Channels Refer To, Plus Their Ancestors
+        static bool import(aiScene const * scene, Skeleton & skeleton);
+
+        // Vertices Store Joint Indices as Bytes
+        static const std::size_t MaxJoints = 256;
+
+    private:
+
+        // Private Member Containers
+        std::vector<int> mParents;
+        std::vector<std::string> mNames;
+        std::vector<Affine> mInverseBind;
+        std::vector<glm::mat4> mModel; // Bind Pose in Model Space
+        Pose mBindPose;
+
+    };
+
+    // Keyframes Resampled at a Fixed Rate Into Compact Structure-of-Arrays
+    //
+    // Every frame stores every joint, so sampling is two contiguous reads and
+    // a blend with no key search. Translations and scales stay floats;
+    // rotations are snorm16 quaternions, renormalised after interpolation,
+    // which costs well under a thousandth of a radian. Joints the source
+    // does not animate hold their bind pose.
+    class AnimationClip
+    {
+    public:
+
+        // Implement Custom Constructors
+        AnimationClip() : mFrames(0), mJoints(0), mStride(0), mRate(30.0f), mDuration(0.0f) {}
+        AnimationClip(Skeleton const & skeleton, float duration, float rate = 30.0f,
+                      std::string const & name = "");
+
+        // Public Member Functions
+        void set(std::size_t frame, std::size_t joint, glm::vec3 const & translation,
+                 glm::quat const & rotation, glm::vec3 const & scale);
+        void sample(float time, Pose & pose, bool loop = true) const;
+        float time(std::size_t frame) const; // Frames Are Evenly Spaced Over duration()
+        std::string const & name() const { return mName; }
+        std::size_t frames() const { return mFrames; }
+        std::size_t bytes() const { return mVectors.size() * sizeof(float) + mRotations.size() * sizeof(std::int16_t); }
+        float duration() const { return mDuration; }
+        float rate() const { return mRate; }
+
+        // Resample One aiAnimation Against a Skeleton Imported From the Same Scene
+        static bool import(aiAnimation const * animation, Skeleton const & skeleton,
+                           AnimationClip & clip, float rate = 30.0f);
+
+    private:
+
+        // Private Member Containers
+        std::vector<float> mVectors;          // Per Frame: TX TY TZ SX SY SZ
+        std::vector<std::int16_t> mRotations; // Per Frame: QX QY QZ QW
+        std::string mName;
+
+        // Private Member Variables
+        std::size_t mFrames;
+        std::size_t mJoints;
+        std::size_t mStride;
+        float mRate;
+        float mDuration;
+
+    };
+
+    // Blend Toward b by weight; Rotations Take the Shorter Arc. result May Alias a or b
+    void blend(Pose const & a, Pose const & b, float weight, Pose & result);
+
+    // One Character: Two Clips Cross-Faded by weight; clips[1] May Be Null
+    struct AnimationState
+    {
+        AnimationClip const * clips[2];
+        float times[2];
+        float weight;
+    };
+
+    // Sample, Blend and Build Palettes for Many Characters Sharing a Skeleton,
+    // Writing skeleton.size() Entries per Character; Parallel Over the Pool If Given
+    void computePalettes(Skeleton const & skeleton, AnimationState const * states,
+                         std::size_t count, Affine * palettes, ThreadPool * pool = nullptr);
+
+    // Import the Skeleton and Every Clip of a Model, Matching Mesh::import's Joint Indices
+    bool importAnimations(std::string const & filename, Skeleton & skeleton,
+                          std::vector<AnimationClip> & clips, float rate = 30.0f);
+
+    // Skinning Palettes Streamed to a Buffer Texture Every Frame
+    //
+    // Palettes go through a StreamBuffer, so uploads never stall on frames
+    // still in flight, and a buffer texture exposes the whole ring, which
+    // works on OpenGL 3.1. allocate() hands out space to compute palettes
+    // into directly, which is the mapped buffer itself when it is
+    // persistent; flush() must follow before drawing. upload() does both
+    // for palettes computed elsewhere. Each returns the first texel of its
+    // range; a vertex shader skins with
+    //
+    //     layout(location = 3) in uvec4 joints;
+    //     layout(location = 4) in vec4 weights;
+    //     uniform samplerBuffer palettes;
+    //     uniform int paletteBase; // From upload()
+    //     uniform int jointCount;  // Palettes Are Packed per Instance
+    //
+    //     vec4 skin(vec4 position)
+    //     {
+    //         int base = paletteBase + gl_InstanceID * jointCount * 3;
+    //         vec4 rows[3] = vec4[3](vec4(0.0), vec4(0.0), vec4(0.0));
+    //         for (int i = 0; i < 4; i++)
+    //         for (int r = 0; r < 3; r++)
+    //             rows[r] += weights[i] * texelFetch(palettes, base + int(joints[i]) * 3 + r);
+    //         return vec4(dot(rows[0], position), dot(rows[1], position), dot(rows[2], position), 1.0);
+    //     }
+    //
+    // Call advance() once per frame after the draws that read the palettes.
+    class PaletteBuffer
+    {
+    public:
+
+        // Implement Custom Constructor and Destructor
+         PaletteBuffer(std::size_t capacity); // Bytes, Shared by Every Frame in Flight
+        ~PaletteBuffer();
+
+        // Public Member Functions
+        Affine * allocate(std::size_t count, GLint & base); // Null If It Did Not Fit
+        GLint upload(Affine const * palettes, std::size_t count); // -1 If It Did Not Fit
+        void flush() { mStream.Flush(); }
+        void bind(GLuint unit) const;
+        void advance() { mStream.Advance(); }
+        StreamBuffer const & stream() const { return mStream; }
+
+    private:
+
+        // Disable Copying and Assignment
+        PaletteBuffer(PaletteBuffer const &) = delete;
+        PaletteBuffer & operator=(PaletteBuffer const &) = delete;
+
+        // Private Member Variables
+        StreamBuffer mStream;
+        GLuint mTexture;
+
+    };
+};
@@ -0,0 +1,168 @@
+// Local Headers
+#include "batch.hpp"
+
+// Define Namespace
+namespace Mirage
+{
+    MeshBatch::MeshBatch(std::size_t vertexCapacity, std::size_t indexCapacity)
+        : mVertexCapacity(0)
+        , mIndexCapacity(0)
+        , mVertexCount(0)
+        , mIndexCount(0)
+        , mCommands(0)
+        , mInstances(1)
+        , mDirty(false)
+    {
+        glGenVertexArrays(1, & mVertexArray);
+        glGenBuffers(1, & mVertexBuffer);
+        glGenBuffers(1, & mElementBuffer);
+        glGenBuffers(1, & mIndirectBuffer);
+        glBindVertexArray(mVertexArray);
+        reserve(mVertexBuffer,  GL_ARRAY_BUFFER,         mVertexCapacity, 0, vertexCapacity * sizeof(Vertex));
+        reserve(mElementBuffer, GL_ELEMENT_ARRAY_BUFFER, mIndexCapacity,  0, indexCapacity  * sizeof(GLuint));
+        attributes();
+        glBindVertexArray(0);
+    }
+
+    MeshBatch::~MeshBatch()
+    {
+        glDeleteVertexArrays(1, & mVertexArray);
+        glDeleteBuffers(1, & mVertexBuffer);
+        glDeleteBuffers(1, & mElementBuffer);
+        glDeleteBuffers(1, & mIndirectBuffer);
+    }
+
+    void MeshBatch::append(Vertex const * vertices, std::size_t vertexCount,
+                           GLuint const * indices,  std::size_t indexCount,
+                           TextureSlots const & textures)
+    {
+        // Grow the Arena Geometrically When It Runs Out
+        glBindVertexArray(mVertexArray);
+        std::size_t vertexBytes = (mVertexCount + vertexCount) * sizeof(Vertex);
+        std::size_t indexBytes  = (mIndexCount  + indexCount)  * sizeof(GLuint);
+        bool grown = vertexBytes > mVertexCapacity || indexBytes > mIndexCapacity;
+        reserve(mVertexBuffer,  GL_ARRAY_BUFFER,         mVertexCapacity, mVertexCount * sizeof(Vertex), vertexBytes);
+        reserve(mElementBuffer, GL_ELEMENT_ARRAY_BUFFER, mIndexCapacity,  mIndexCount  * sizeof(GLuint), indexBytes);
+        if (grown) attributes();
+
+        // Indices Stay Submesh-Relative; baseVertex Rebases Them at Draw Time
+        glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+        glBufferSubData(GL_ARRAY_BUFFER, mVertexCount * sizeof(Vertex),
+                        vertexCount * sizeof(Vertex), vertices);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, mIndexCount * sizeof(GLuint),
+                        indexCount * sizeof(GLuint), indices);
+        glBindVertexArray(0);
+
+        Command command;
+        command.count         = static_cast<GLuint>(indexCount);
+        command.instanceCount = 1;
+        command.firstIndex    = static_cast<GLuint>(mIndexCount);
+        command.baseVertex    = static_cast<GLint>(mVertexCount);
+        command.baseInstance  = 0;
+        auto group = mGroups.find(textures);
+        if (group == mGroups.end())
+        {   group = mGroups.insert(std::make_pair(textures, Group())).first;
+            group->second.material = Material(textures);
+        }   group->second.commands.push_back(command);
+
+        mVertexCount += vertexCount;
+        mIndexCount  += indexCount;
+        mCommands++;
+        mDirty = true;
+    }
+
+    void MeshBatch::draw(GLuint shader, bool indirect, GLuint instances)
+    {
+        if (instances != mInstances) mDirty = true;
+        mInstances = instances;
+        if (mDirty) prepare();
+        indirect = indirect && GLAD_GL_VERSION_4_3;
+
+        glBindVertexArray(mVertexArray);
+        if (indirect) glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mIndirectBuffer);
+        for (auto & group : mGroups)
+        {
+            group.second.material.bind(shader);
+            if (indirect)
+                glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                            (GLvoid const *) group.second.indirect,
+                                            static_cast<GLsizei>(group.second.commands.size()), 0);
+            else if (instances > 1) // No Instanced Variant of glMultiDrawElementsBaseVertex
+                for (std::size_t i = 0; i < group.second.commands.size(); i++)
+                    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, group.second.counts[i],
+                                                      GL_UNSIGNED_INT, group.second.offsets[i],
+                                                      instances, group.second.baseVertices[i]);
+            else
+                glMultiDrawElementsBaseVertex(GL_TRIANGLES,
+                                              group.second.counts.data(), GL_UNSIGNED_INT,
+                                              group.second.offsets.data(),
+                                              static_cast<GLsizei>(group.second.commands.size()),
+                                              group.second.baseVertices.data());
+        }
+        if (indirect) glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+
+    void MeshBatch::reserve(GLuint & buffer, GLenum target, std::size_t & capacity,
+                            std::size_t used, std::size_t required)
+    {
+        if (required <= capacity) return;
+        std::size_t size = capacity > 0 ? capacity : required;
+        while (size < required) size *= 2;
+
+        // Copy the Live Prefix Into a Larger Buffer on the GPU
+        GLuint larger;
+        glGenBuffers(1, & larger);
+        glBindBuffer(target, larger);
+        glBufferData(target, size, nullptr, GL_STATIC_DRAW);
+        if (used > 0)
+        {   glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, larger);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used);
+        }
+        glDeleteBuffers(1, & buffer);
+        buffer = larger;
+        capacity = size;
+    }
+
+    void MeshBatch::attributes()
+    {
+        // Set Shader Attributes; Expects the Vertex Array to Be Bound
+        glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mElementBuffer);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) offsetof(Vertex, position));
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) offsetof(Vertex, normal));
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) offsetof(Vertex, uv));
+        glEnableVertexAttribArray(0); // Vertex Positions
+        glEnableVertexAttribArray(1); // Vertex Normals
+        glEnableVertexAttribArray(2); // Vertex UVs
+    }
+
+    void MeshBatch::prepare()
+    {
+        // Rebuild the Per-Group Draw Arrays and the Shared Indirect Buffer
+        std::vector<Command> commands;
+        commands.reserve(mCommands);
+        for (auto & group : mGroups)
+        {
+            Group & g = group.second;
+            g.indirect = commands.size() * sizeof(Command);
+            g.counts.clear();
+            g.offsets.clear();
+            g.baseVertices.clear();
+            for (auto & command : g.commands)
+            {   command.instanceCount = mInstances;
+                g.counts.push_back(static_cast<GLsizei>(command.count));
+                g.offsets.push_back((GLvoid const *) (command.firstIndex * sizeof(GLuint)));
+                g.baseVertices.push_back(command.baseVertex);
+                commands.push_back(command);
+            }
+        }
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mIndirectBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(Command),
+                     commands.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        mDirty = false;
+    }
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+// Local Headers
+#include "mesh.hpp"
+
+// Standard Headers
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Shared Vertex and Index Arena Drawn with Multi-Draw Calls
+    //
+    // Every submesh appended to a batch lands in one vertex buffer and one
+    // index buffer, so the whole batch shares a single vertex array object.
+    // Submeshes that use the same textures are grouped together, so each group
+    // costs one texture bind and one glMultiDrawElementsBaseVertex call, or
+    // one glMultiDrawElementsIndirect call on OpenGL 4.3 and newer. Drawing
+    // several instances repeats every submesh, as glDrawElementsInstanced does.
+    class MeshBatch
+    {
+    public:
+
+        // Matches the Layout Expected by GL_DRAW_INDIRECT_BUFFER
+        struct Command
+        {
+            GLuint count;
+            GLuint instanceCount;
+            GLuint firstIndex;
+            GLint  baseVertex;
+            GLuint baseInstance;
+        };
+
+        // Implement Custom Constructor and Destructor
+         MeshBatch(std::size_t vertexCapacity = 1 << 16, std::size_t indexCapacity = 1 << 18);
+        ~MeshBatch();
+
+        // Public Member Functions
+        void append(Vertex const * vertices, std::size_t vertexCount,
+                    GLuint const * indices,  std::size_t indexCount,
+                    TextureSlots const & textures);
+        void append(Vertex const * vertices, std::size_t vertexCount,
+                    GLuint const * indices,  std::size_t indexCount,
+                    std::map<GLuint, std::string> const & textures)
+        {   append(vertices, vertexCount, indices, indexCount, TextureSlots(textures.begin(), textures.end()));
+        }
+        void draw(GLuint shader, bool indirect = true, GLuint instances = 1);
+        std::size_t commands() const { return mCommands; }
+        std::size_t groups() const { return mGroups.size(); }
+
+    private:
+
+        // Disable Copying and Assignment
+        MeshBatch(MeshBatch const &) = delete;
+        MeshBatch & operator=(MeshBatch const &) = delete;
+
+        // Draws Sharing One Set of Textures
+        struct Group
+        {
+            Material material;
+            std::vector<Command> commands;
+            std::vector<GLsizei> counts;
+            std::vector<GLvoid const *> offsets;
+            std::vector<GLint> baseVertices;
+            std::size_t indirect;
+        };
+
+        // Private Member Functions
+        void reserve(GLuint & buffer, GLenum target, std::size_t & capacity,
+                     std::size_t used, std::size_t required);
+        void attributes();
+        void prepare();
+
+        // Private Member Containers
+        std::map<TextureSlots, Group> mGroups;
+
+        // Private Member Variables
+        GLuint mVertexArray;
+        GLuint mVertexBuffer;
+        GLuint mElementBuffer;
+        GLuint mIndirectBuffer;
+        std::size_t mVertexCapacity;
+        std::size_t mIndexCapacity;
+        std::size_t mVertexCount;
+        std::size_t mIndexCount;
+        std::size_t mCommands;
+        GLuint mInstances;
+        bool mDirty;
+
+    };
+};
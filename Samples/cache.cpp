@@ -0,0 +1,315 @@
+// Local Headers
+#include "cache.hpp"
+
+// System Headers
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Standard Headers
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// Define Namespace
+namespace Mirage
+{
+    // File Layout: Header, Record Table, Texture Strings, Then Aligned Arrays
+    namespace
+    {
+        const std::uint32_t Magic = 0x4347524d; // "MRGC"
+        const std::size_t Alignment = 16;
+
+        struct Header
+        {
+            std::uint32_t magic;
+            std::uint32_t version;
+            std::uint64_t key;
+            std::uint32_t vertexSize;
+            std::uint32_t meshCount;
+        };
+
+        struct Record
+        {
+            std::uint64_t vertexOffset;
+            std::uint64_t indexOffset;
+            std::uint64_t textureOffset;
+            std::uint64_t lodIndexOffset;
+            std::uint64_t lodOffset;
+            std::uint64_t skinOffset;
+            std::uint32_t vertexCount;
+            std::uint32_t indexCount;
+            std::uint32_t textureCount;
+            std::uint32_t lodIndexCount;
+            std::uint32_t lodCount;
+            std::uint32_t skinCount; // Zero or vertexCount
+            float boundsMin[3];
+            float boundsMax[3];
+        };
+
+        std::size_t align(std::size_t offset)
+        { return (offset + Alignment - 1) & ~(Alignment - 1); }
+
+        template<typename T> void write(std::vector<unsigned char> & out, std::size_t offset, T const & value)
+        { std::memcpy(& out[offset], & value, sizeof(T)); }
+
+        void append(std::vector<unsigned char> & out, std::string const & str)
+        {
+            std::uint32_t length = static_cast<std::uint32_t>(str.size());
+            out.insert(out.end(), reinterpret_cast<unsigned char const *>(& length),
+                                  reinterpret_cast<unsigned char const *>(& length) + sizeof(length));
+            out.insert(out.end(), str.begin(), str.end());
+        }
+
+        bool extract(unsigned char const * data, std::size_t size, std::size_t & offset, std::string & str)
+        {
+            std::uint32_t length;
+            if (offset + sizeof(length) > size) return false;
+            std::memcpy(& length, data + offset, sizeof(length));
+            offset += sizeof(length);
+            if (offset + length > size) return false;
+            str.assign(reinterpret_cast<char const *>(data + offset), length);
+            offset += length;
+            return true;
+        }
+    }
+
+    const std::uint32_t MeshCache::Version;
+
+    bool MappedFile::open(std::string const & filename)
+    {
+        close();
+#ifdef _WIN32
+        std::ifstream fd(filename, std::ios::binary);
+        if (!fd) return false;
+        mFallback.assign(std::istreambuf_iterator<char>(fd),
+                         std::istreambuf_iterator<char>());
+        mData = mFallback.data();
+        mSize = mFallback.size();
+        return true;
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, & info) != 0 || info.st_size <= 0)
+        {   ::close(fd);
+            return false;
+        }
+
+        // Keep the Mapping Private; the Descriptor Is Not Needed Afterwards
+        void * address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (address == MAP_FAILED) return false;
+        mData = static_cast<unsigned char *>(address);
+        mSize = static_cast<std::size_t>(info.st_size);
+        return true;
+#endif
+    }
+
+    void MappedFile::close()
+    {
+#ifndef _WIN32
+        if (mData) munmap(mData, mSize);
+#endif
+        mFallback.clear();
+        mData = nullptr;
+        mSize = 0;
+    }
+
+    std::uint64_t MeshCache::hash(void const * data, std::size_t size, std::uint64_t seed)
+    {
+        // 64-bit FNV-1a; Fast Enough to Run Over Every Source File at Startup
+        auto bytes = static_cast<unsigned char const *>(data);
+        for (std::size_t i = 0; i < size; i++)
+        {   seed ^= bytes[i];
+            seed *= 1099511628211ull;
+        }   return seed;
+    }
+
+    std::uint64_t MeshCache::key(std::string const & source, unsigned int flags)
+    {
+        MappedFile file;
+        if (!file.open(source)) return 0;
+        std::uint64_t seed = hash(file.data(), file.size());
+        seed = hash(& flags, sizeof(flags), seed);
+        return hash(& Version, sizeof(Version), seed);
+    }
+
+    std::string MeshCache::locate(std::string const & source) const
+    {
+        // Disambiguate Identically Named Models Living in Different Folders
+        char suffix[32];
+        std::snprintf(suffix, sizeof(suffix), ".%016llx.mesh",
+                      static_cast<unsigned long long>(hash(source.data(), source.size())));
+        auto index = source.find_last_of("/\\");
+        auto name = (index == std::string::npos) ? source : source.substr(index + 1);
+        return mDirectory + "/" + name + suffix;
+    }
+
+    bool MeshCache::load(std::string const & source, unsigned int flags, Entry & entry) const
+    {
+        entry.meshes.clear();
+        std::uint64_t expected = key(source, flags);
+        if (expected == 0 || !entry.file.open(locate(source))) return false;
+
+        // Reject Stale or Foreign Files Before Trusting Any Offsets
+        auto data = entry.file.data();
+        auto size = entry.file.size();
+        Header header;
+        if (size < sizeof(Header)) return false;
+        std::memcpy(& header, data, sizeof(Header));
+        if (header.magic      != Magic
+        ||  header.version    != Version
+        ||  header.key        != expected
+        ||  header.vertexSize != sizeof(Vertex)
+        ||  sizeof(Header) + header.meshCount * sizeof(Record) > size)
+        {   entry.file.close();
+            return false;
+        }
+
+        entry.meshes.resize(header.meshCount);
+        for (std::uint32_t i = 0; i < header.meshCount; i++)
+        {
+            Record record;
+            std::memcpy(& record, data + sizeof(Header) + i * sizeof(Record), sizeof(Record));
+            if (record.vertexOffset + record.vertexCount * sizeof(Vertex) > size
+            ||  record.indexOffset  + record.indexCount  * sizeof(GLuint) > size
+            ||  record.lodIndexOffset + record.lodIndexCount * sizeof(GLuint) > size
+            ||  record.lodOffset + record.lodCount * sizeof(LevelOfDetail) > size
+            ||  (record.skinCount != 0 && record.skinCount != record.vertexCount)
+            ||  record.skinOffset + record.skinCount * sizeof(SkinWeight) > size)
+            {   entry.meshes.clear();
+                entry.file.close();
+                return false;
+            }
+
+            // Point Directly Into the Mapping
+            View & view = entry.meshes[i];
+            view.vertices    = reinterpret_cast<Vertex const *>(data + record.vertexOffset);
+            view.indices     = reinterpret_cast<GLuint const *>(data + record.indexOffset);
+            view.vertexCount = record.vertexCount;
+            view.indexCount  = record.indexCount;
+            view.bounds.min  = glm::vec3(record.boundsMin[0], record.boundsMin[1], record.boundsMin[2]);
+            view.bounds.max  = glm::vec3(record.boundsMax[0], record.boundsMax[1], record.boundsMax[2]);
+            view.lodIndices  = reinterpret_cast<GLuint const *>(data + record.lodIndexOffset);
+            view.skin        = record.skinCount ? reinterpret_cast<SkinWeight const *>(data + record.skinOffset) : nullptr;
+            view.lods.resize(record.lodCount);
+            if (record.lodCount > 0)
+                std::memcpy(view.lods.data(), data + record.lodOffset, record.lodCount * sizeof(LevelOfDetail));
+            for (auto const & lod : view.lods)
+            if (lod.indexOffset + static_cast<std::uint64_t>(lod.indexCount) > record.lodIndexCount)
+            {   entry.meshes.clear();
+                entry.file.close();
+                return false;
+            }
+
+            std::size_t offset = record.textureOffset;
+            view.textures.resize(record.textureCount);
+            for (auto & texture : view.textures)
+            if (!extract(data, size, offset, texture.filename)
+            ||  !extract(data, size, offset, texture.mode))
+            {   entry.meshes.clear();
+                entry.file.close();
+                return false;
+            }
+        }   return true;
+    }
+
+    bool MeshCache::store(std::string const & source, unsigned int flags,
+                          std::vector<MeshData> const & meshes) const
+    {
+        Header header;
+        header.magic      = Magic;
+        header.version    = Version;
+        header.key        = key(source, flags);
+        header.vertexSize = sizeof(Vertex);
+        header.meshCount  = static_cast<std::uint32_t>(meshes.size());
+        if (header.key == 0) return false;
+
+        // Lay Out the Header, Record Table and Texture Strings
+        std::vector<unsigned char> out(sizeof(Header) + meshes.size() * sizeof(Record));
+        std::vector<Record> records(meshes.size());
+        for (std::size_t i = 0; i < meshes.size(); i++)
+        {
+            records[i].textureOffset = out.size();
+            records[i].textureCount  = static_cast<std::uint32_t>(meshes[i].textures.size());
+            for (auto const & texture : meshes[i].textures)
+            {   append(out, texture.filename);
+                append(out, texture.mode);
+            }
+        }
+
+        // Append Vertex and Index Arrays at Aligned Offsets
+        for (std::size_t i = 0; i < meshes.size(); i++)
+        {
+            auto const & mesh = meshes[i];
+            records[i].vertexCount   = static_cast<std::uint32_t>(mesh.vertices.size());
+            records[i].indexCount    = static_cast<std::uint32_t>(mesh.indices.size());
+            records[i].lodIndexCount = static_cast<std::uint32_t>(mesh.lodIndices.size());
+            records[i].lodCount      = static_cast<std::uint32_t>(mesh.lods.size());
+            records[i].skinCount     = static_cast<std::uint32_t>(mesh.skin.size());
+            for (int axis = 0; axis < 3; axis++)
+            {   records[i].boundsMin[axis] = mesh.bounds.min[axis];
+                records[i].boundsMax[axis] = mesh.bounds.max[axis];
+            }
+            records[i].vertexOffset = align(out.size());
+            out.resize(records[i].vertexOffset + mesh.vertices.size() * sizeof(Vertex));
+            if (!mesh.vertices.empty())
+                std::memcpy(& out[records[i].vertexOffset], mesh.vertices.data(),
+                              mesh.vertices.size() * sizeof(Vertex));
+
+            records[i].skinOffset = align(out.size());
+            out.resize(records[i].skinOffset + mesh.skin.size() * sizeof(SkinWeight));
+            if (!mesh.skin.empty())
+                std::memcpy(& out[records[i].skinOffset], mesh.skin.data(),
+                              mesh.skin.size() * sizeof(SkinWeight));
+
+            records[i].indexOffset = align(out.size());
+            out.resize(records[i].indexOffset + mesh.indices.size() * sizeof(GLuint));
+            if (!mesh.indices.empty())
+                std::memcpy(& out[records[i].indexOffset], mesh.indices.data(),
+                              mesh.indices.size() * sizeof(GLuint));
+
+            records[i].lodIndexOffset = align(out.size());
+            out.resize(records[i].lodIndexOffset + mesh.lodIndices.size() * sizeof(GLuint));
+            if (!mesh.lodIndices.empty())
+                std::memcpy(& out[records[i].lodIndexOffset], mesh.lodIndices.data(),
+                              mesh.lodIndices.size() * sizeof(GLuint));
+
+            records[i].lodOffset = align(out.size());
+            out.resize(records[i].lodOffset + mesh.lods.size() * sizeof(LevelOfDetail));
+            if (!mesh.lods.empty())
+                std::memcpy(& out[records[i].lodOffset], mesh.lods.data(),
+                              mesh.lods.size() * sizeof(LevelOfDetail));
+        }
+
+        write(out, 0, header);
+        for (std::size_t i = 0; i < records.size(); i++)
+            write(out, sizeof(Header) + i * sizeof(Record), records[i]);
+
+        // Write to a Temporary and Rename, So Readers Never See a Torn File
+#ifdef _WIN32
+        _mkdir(mDirectory.c_str());
+#else
+        mkdir(mDirectory.c_str(), 0755);
+#endif
+        std::string filename = locate(source);
+        std::string temporary = filename + ".tmp";
+        {
+            std::ofstream fd(temporary, std::ios::binary | std::ios::trunc);
+            fd.write(reinterpret_cast<char const *>(out.data()), out.size());
+            if (!fd)
+            {   fprintf(stderr, "Failed to Write Mesh Cache %s\n", temporary.c_str());
+                return false;
+            }
+        }
+        std::remove(filename.c_str());
+        return std::rename(temporary.c_str(), filename.c_str()) == 0;
+    }
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+// Local Headers
+#include "mesh.hpp"
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Read-Only Memory Mapping of a Whole File
+    class MappedFile
+    {
+    public:
+
+        // Implement Default Constructor and Destructor
+         MappedFile() : mData(nullptr), mSize(0) {}
+        ~MappedFile() { close(); }
+
+        // Public Member Functions
+        bool open(std::string const & filename);
+        void close();
+        unsigned char const * data() const { return mData; }
+        std::size_t size() const { return mSize; }
+
+    private:
+
+        // Disable Copying and Assignment
+        MappedFile(MappedFile const &) = delete;
+        MappedFile & operator=(MappedFile const &) = delete;
+
+        // Private Member Variables
+        unsigned char * mData;
+        std::size_t mSize;
+        std::vector<unsigned char> mFallback;
+
+    };
+
+    // On-Disk Cache of Flattened Assimp Imports
+    //
+    // One versioned binary file is kept per source model. The header stores a
+    // hash of the source bytes and import flags, so edits to either invalidate
+    // the entry transparently. Simplified levels follow each submesh's index
+    // array, and skin weights follow its vertices when it has any. Vertex and
+    // index arrays are 16-byte aligned and
+    // stored in native layout, which lets a warm load hand the mapped pages
+    // straight to glBufferData. Cache files are machine-local: they are not
+    // portable across endianness or changes to the Vertex layout.
+    class MeshCache
+    {
+    public:
+
+        // Zero-Copy View of One Cached Submesh
+        struct View
+        {
+            Vertex const * vertices;
+            GLuint const * indices;
+            std::uint32_t  vertexCount;
+            std::uint32_t  indexCount;
+            std::vector<TextureReference> textures;
+            Bounds bounds;
+            GLuint const * lodIndices;
+            std::vector<LevelOfDetail> lods;
+            SkinWeight const * skin; // Null Unless Skinned
+        };
+
+        // A Validated Cache Entry; Views Remain Valid While This Lives
+        struct Entry
+        {
+            MappedFile file;
+            std::vector<View> meshes;
+        };
+
+        // Implement Custom Constructor
+        MeshCache(std::string const & directory) : mDirectory(directory) {}
+
+        // Public Member Functions
+        bool load(std::string const & source, unsigned int flags, Entry & entry) const;
+        bool store(std::string const & source, unsigned int flags,
+                   std::vector<MeshData> const & meshes) const;
+        std::string locate(std::string const & source) const;
+        static std::uint64_t key(std::string const & source, unsigned int flags);
+        static std::uint64_t hash(void const * data, std::size_t size,
+                                  std::uint64_t seed = 14695981039346656037ull);
+
+        // Bump Whenever the File Layout or the Stored Contents Change
+        static const std::uint32_t Version = 5;
+
+    private:
+
+        // Private Member Variables
+        std::string mDirectory;
+
+    };
+};
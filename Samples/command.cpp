@@ -0,0 +1,210 @@
+// Local Headers
+#include "command.hpp"
+#include "mesh.hpp"
+
+// System Headers
+#include <glm/gtc/type_ptr.hpp>
+
+// Standard Headers
+#include <algorithm>
+#include <cstring>
+
+// Define Namespace
+namespace Mirage
+{
+    std::uint64_t sortKey(unsigned int pass, GLuint program, std::uint16_t material, float depth)
+    {
+        // Non-Negative Floats Compare Like Their Bit Patterns; Negatives and NaN Clamp to Zero
+        std::uint32_t bits = 0;
+        if (depth > 0.0f) std::memcpy(& bits, & depth, sizeof(bits));
+        if (pass >= TranslucentPass) bits = ~bits;
+        return (std::uint64_t(pass & 0xF) << 60) | (std::uint64_t(program & 0xFFF) << 48)
+             | (std::uint64_t(material) << 32) | bits;
+    }
+
+    DrawPacket & CommandBucket::draw(std::uint64_t key)
+    {
+        // The Packet Takes Every Uniform Set Since the Last Draw, or the Set Before That
+        mSealed = true;
+        DrawPacket packet = { 0, 0, nullptr, 0, 0, 1, mFirst,
+                              static_cast<std::uint32_t>(mUniforms.size()) - mFirst };
+        mKeys.push_back(key);
+        mPackets.push_back(packet);
+        return mPackets.back();
+    }
+
+    void CommandBucket::uniform(GLint location, float value)
+    {
+        uniform(location, GL_FLOAT, & value, 1);
+    }
+
+    void CommandBucket::uniform(GLint location, glm::vec4 const & value)
+    {
+        uniform(location, GL_FLOAT_VEC4, glm::value_ptr(value), 4);
+    }
+
+    void CommandBucket::uniform(GLint location, glm::mat4 const & value)
+    {
+        uniform(location, GL_FLOAT_MAT4, glm::value_ptr(value), 16);
+    }
+
+    void CommandBucket::uniform(GLint location, GLenum type, float const * value, std::size_t floats)
+    {
+        // The First Value After a Draw Starts a New Set
+        if (mSealed)
+        {   mFirst = static_cast<std::uint32_t>(mUniforms.size());
+            mSealed = false;
+        }
+        UniformValue entry = { location, type, static_cast<std::uint32_t>(mData.size()) };
+        mUniforms.push_back(entry);
+        mData.insert(mData.end(), value, value + floats);
+    }
+
+    void CommandBucket::clear()
+    {
+        mKeys.clear();
+        mPackets.clear();
+        mUniforms.clear();
+        mData.clear();
+        mFirst = 0;
+        mSealed = true;
+    }
+
+    void RenderBackend::execute(DrawPacket const & packet, UniformValue const * uniforms, float const * data)
+    {
+        if (!mTracking || packet.program != mProgram)
+        {   glUseProgram(packet.program);
+            mProgram = packet.program;
+            mUniforms = nullptr;
+            mChanges.programs++;
+        }
+        if (!mTracking || packet.vertexArray != mVertexArray)
+        {   glBindVertexArray(packet.vertexArray);
+            mVertexArray = packet.vertexArray;
+            mChanges.vertexArrays++;
+        }
+
+        // Textures Stay Bound Across Programs; Sampler Values Are Program State
+        if (packet.material)
+        {
+            std::vector<GLuint> const & textures = packet.material->textures();
+            std::vector<GLint> const & locations = packet.material->locations(packet.program);
+            if (mTextures.size() < textures.size()) mTextures.resize(textures.size(), ~0u);
+            for (std::size_t unit = 0; unit < textures.size(); unit++)
+            {
+                if (!mTracking || mTextures[unit] != textures[unit])
+                {   if (!mTracking || mUnit != unit)
+                    {   glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(unit));
+                        mUnit = static_cast<GLenum>(unit);
+                        mChanges.units++;
+                    }
+                    glBindTexture(GL_TEXTURE_2D, textures[unit]);
+                    mTextures[unit] = textures[unit];
+                    mChanges.textures++;
+                }
+                std::uint64_t sampler = (std::uint64_t(packet.program) << 32) | std::uint32_t(locations[unit]);
+                auto value = mSamplers.find(sampler);
+                if (!mTracking || value == mSamplers.end() || value->second != GLint(unit))
+                {   glUniform1i(locations[unit], static_cast<GLint>(unit));
+                    mSamplers[sampler] = static_cast<GLint>(unit);
+                    mChanges.samplers++;
+                }
+            }
+        }
+
+        // Consecutive Packets Sharing One Uniform Set Apply It Once
+        UniformValue const * first = uniforms + packet.firstUniform;
+        if (packet.uniformCount > 0 && (!mTracking || first != mUniforms))
+        {   for (UniformValue const * uniform = first; uniform != first + packet.uniformCount; uniform++)
+            {   float const * value = data + uniform->offset;
+                     if (uniform->type == GL_FLOAT_MAT4) glUniformMatrix4fv(uniform->location, 1, GL_FALSE, value);
+                else if (uniform->type == GL_FLOAT_VEC4) glUniform4fv(uniform->location, 1, value);
+                else glUniform1fv(uniform->location, 1, value);
+            }
+            mUniforms = first;
+            mChanges.uniforms += packet.uniformCount;
+        }
+
+        GLvoid const * indices = (GLvoid const *) packet.offset;
+        if (packet.instances == 1) glDrawElements(GL_TRIANGLES, packet.count, GL_UNSIGNED_INT, indices);
+        else glDrawElementsInstanced(GL_TRIANGLES, packet.count, GL_UNSIGNED_INT, indices, packet.instances);
+        mChanges.draws++;
+    }
+
+    void RenderBackend::invalidate()
+    {
+        // Names OpenGL Never Hands Out, So the Next Packet Binds Everything
+        mTextures.clear();
+        mSamplers.clear();
+        mUniforms = nullptr;
+        mProgram = ~0u;
+        mVertexArray = ~0u;
+        mUnit = ~0u;
+    }
+
+    CommandBuffer::CommandBuffer(std::size_t buckets)
+    {
+        for (std::size_t i = 0; i < std::max<std::size_t>(buckets, 1); i++)
+            mBuckets.emplace_back(new CommandBucket());
+    }
+
+    std::size_t CommandBuffer::size() const
+    {
+        std::size_t size = 0;
+        for (auto const & bucket : mBuckets) size += bucket->size();
+        return size;
+    }
+
+    void CommandBuffer::gather()
+    {
+        // Bucket by Bucket, Each in Recording Order
+        mEntries.clear();
+        for (std::size_t b = 0; b < mBuckets.size(); b++)
+        for (std::size_t i = 0; i < mBuckets[b]->size(); i++)
+        {   Entry entry = { mBuckets[b]->mKeys[i], static_cast<std::uint32_t>(b), static_cast<std::uint32_t>(i) };
+            mEntries.push_back(entry);
+        }
+    }
+
+    void CommandBuffer::sort()
+    {
+        gather();
+
+        // Count All Eight Digits in One Pass Over the Keys
+        std::size_t counts[8][256] = {};
+        for (auto const & entry : mEntries)
+            for (int digit = 0; digit < 8; digit++) counts[digit][(entry.key >> (digit * 8)) & 0xFF]++;
+
+        // Least Significant Digit First; Each Pass Is a Stable Scatter Into mScratch
+        mScratch.resize(mEntries.size());
+        for (int digit = 0; digit < 8; digit++)
+        {
+            std::size_t * count = counts[digit];
+            if (mEntries.empty() || count[(mEntries.front().key >> (digit * 8)) & 0xFF] == mEntries.size()) continue;
+            std::size_t offset = 0;
+            for (int value = 0; value < 256; value++)
+            {   std::size_t next = offset + count[value];
+                count[value] = offset;
+                offset = next;
+            }
+            for (auto const & entry : mEntries) mScratch[count[(entry.key >> (digit * 8)) & 0xFF]++] = entry;
+            mEntries.swap(mScratch);
+        }
+    }
+
+    void CommandBuffer::submit(RenderBackend & backend)
+    {
+        if (mEntries.size() != size()) gather();
+        backend.begin();
+        for (auto const & entry : mEntries)
+        {   CommandBucket const & bucket = *mBuckets[entry.bucket];
+            backend.execute(bucket.mPackets[entry.index], bucket.mUniforms.data(), bucket.mData.data());
+        }
+    }
+
+    void CommandBuffer::clear()
+    {
+        for (auto & bucket : mBuckets) bucket->clear();
+        mEntries.clear();
+    }
+};
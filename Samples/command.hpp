@@ -0,0 +1,200 @@
+#pragma once
+
+// System Headers
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Forward Declarations
+    class Material;
+
+    // 64-Bit Sort Key, Most Significant Field First
+    //
+    //     | pass : 4 | program : 12 | material : 16 | depth : 32 |
+    //
+    // Within a pass, draws group by program, then by material, then run
+    // front to back so early depth testing rejects what is hidden. Passes
+    // from TranslucentPass on run back to front instead, which blending
+    // needs. Depth is a non-negative view distance; its float bits order
+    // like the value. Program names above 4095 share key bits, which only
+    // costs a few extra binds since packets carry their real state.
+    const unsigned int TranslucentPass = 8;
+    std::uint64_t sortKey(unsigned int pass, GLuint program, std::uint16_t material, float depth);
+
+    // Everything One Indexed Draw Needs, Recorded Without Touching OpenGL
+    struct DrawPacket
+    {
+        GLuint program;
+        GLuint vertexArray;
+        Material * material;       // Textures and Sampler Uniforms; May Be Null
+        GLsizei count;
+        std::size_t offset;        // Bytes Into the Element Buffer
+        GLsizei instances;
+        std::uint32_t firstUniform;
+        std::uint32_t uniformCount;
+    };
+
+    // Per-Draw Uniform Value, Stored in the Recording Bucket's Float Array
+    struct UniformValue
+    {
+        GLint location;
+        GLenum type;               // GL_FLOAT, GL_FLOAT_VEC4 or GL_FLOAT_MAT4
+        std::uint32_t offset;
+    };
+
+    // Calls the Backend Issued, by Kind
+    struct StateChanges
+    {
+        std::size_t programs;
+        std::size_t vertexArrays;
+        std::size_t units;         // glActiveTexture
+        std::size_t textures;
+        std::size_t samplers;      // glUniform1i on Sampler Uniforms
+        std::size_t uniforms;
+        std::size_t draws;
+        std::size_t total() const { return programs + vertexArrays + units + textures + samplers; }
+    };
+
+    // Commands Recorded by One Thread
+    //
+    // Uniforms set before a draw() apply to it and to every draw() after it
+    // up to the next uniform() call, so all submeshes of a mesh share one
+    // copy of its transform. Buckets are never shared between threads.
+    class CommandBucket
+    {
+    public:
+
+        // Implement Default Constructor
+        CommandBucket() : mFirst(0), mSealed(true) {}
+
+        // Public Member Functions
+        DrawPacket & draw(std::uint64_t key);
+        void uniform(GLint location, float value);
+        void uniform(GLint location, glm::vec4 const & value);
+        void uniform(GLint location, glm::mat4 const & value);
+        void clear();
+        std::size_t size() const { return mPackets.size(); }
+
+    private:
+
+        // Disable Copying and Assignment
+        CommandBucket(CommandBucket const &) = delete;
+        CommandBucket & operator=(CommandBucket const &) = delete;
+
+        // Private Member Functions
+        void uniform(GLint location, GLenum type, float const * value, std::size_t floats);
+
+        // Private Member Containers
+        std::vector<std::uint64_t> mKeys;
+        std::vector<DrawPacket> mPackets;
+        std::vector<UniformValue> mUniforms;
+        std::vector<float> mData;
+
+        // Private Member Variables
+        std::uint32_t mFirst;
+        bool mSealed;
+
+        friend class CommandBuffer;
+
+    };
+
+    // Issues Packets While Mirroring the OpenGL State They Change
+    //
+    // With tracking on, a bind is skipped when the state it would set is
+    // already current, and sampler uniforms are set once per program. With
+    // tracking off every packet binds everything, exactly like
+    // Mesh::draw(), which gives the baseline to compare against. Call
+    // invalidate() after any OpenGL calls made outside the backend.
+    class RenderBackend
+    {
+    public:
+
+        // Implement Custom Constructor
+        RenderBackend(bool tracking = true) : mTracking(tracking) { invalidate(); reset(); }
+
+        // Public Member Functions
+        void execute(DrawPacket const & packet, UniformValue const * uniforms, float const * data);
+        void invalidate();
+        void reset() { mChanges = StateChanges(); }
+        StateChanges const & changes() const { return mChanges; }
+
+    private:
+
+        // Disable Copying and Assignment
+        RenderBackend(RenderBackend const &) = delete;
+        RenderBackend & operator=(RenderBackend const &) = delete;
+
+        // Uniform Sets Are Told Apart by Address, Which Buckets Reuse Every Frame
+        void begin() { mUniforms = nullptr; }
+
+        // Private Member Containers
+        std::vector<GLuint> mTextures;                       // Bound per Unit
+        std::unordered_map<std::uint64_t, GLint> mSamplers;  // Program and Location to Unit
+
+        // Private Member Variables
+        StateChanges mChanges;
+        UniformValue const * mUniforms;                      // Last Set Applied, Until the Program Changes
+        GLuint mProgram;
+        GLuint mVertexArray;
+        GLenum mUnit;
+        bool mTracking;
+
+        friend class CommandBuffer;
+
+    };
+
+    // Per-Thread Buckets Merged Into One Stream and Radix Sorted by Key
+    //
+    // Threads record into their own bucket with no locking; sort() and
+    // submit() run on the thread owning the context once recording is
+    // done. The sort is stable, so packets with equal keys keep the order
+    // they were recorded in, and it skips the byte positions every key
+    // agrees on.
+    class CommandBuffer
+    {
+    public:
+
+        // Implement Custom Constructor
+        CommandBuffer(std::size_t buckets);
+
+        // Public Member Functions
+        CommandBucket & bucket(std::size_t index) { return *mBuckets[index]; }
+        std::size_t buckets() const { return mBuckets.size(); }
+        std::size_t size() const;
+        void sort();
+        void submit(RenderBackend & backend); // In Recorded Order Unless sort() Ran
+        void clear();
+
+    private:
+
+        // Disable Copying and Assignment
+        CommandBuffer(CommandBuffer const &) = delete;
+        CommandBuffer & operator=(CommandBuffer const &) = delete;
+
+        // Private Member Functions
+        void gather();
+
+        // Packet Reference Into a Bucket
+        struct Entry
+        {
+            std::uint64_t key;
+            std::uint32_t bucket;
+            std::uint32_t index;
+        };
+
+        // Private Member Containers
+        std::vector<std::unique_ptr<CommandBucket>> mBuckets; // Separate Allocations Keep Threads Apart
+        std::vector<Entry> mEntries;
+        std::vector<Entry> mScratch;
+
+    };
+};
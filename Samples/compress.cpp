@@ -0,0 +1,491 @@
+// Local Headers
+#include "cache.hpp"
+#include "compress.hpp"
+
+// System Headers
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Standard Headers
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+// S3TC Tokens Are Extension-Only; Spell Them Out for Core Profile Loaders
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT  0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        std::uint32_t fourCC(char const * code)
+        { return code[0] | (code[1] << 8) | (code[2] << 16) | (static_cast<std::uint32_t>(code[3]) << 24); }
+
+        // Modified Bessel Function of the First Kind, Order Zero
+        double bessel(double x)
+        {
+            double sum = 1.0, term = 1.0;
+            for (int k = 1; k < 32; k++)
+            {   term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                sum += term;
+            }   return sum;
+        }
+
+        // Six Taps of a Kaiser-Windowed Sinc, Centered Between Two Source Texels
+        void kaiser(float * weights)
+        {
+            const double alpha = 4.0, radius = 3.0, pi = 3.14159265358979323846;
+            double total = 0.0;
+            for (int i = 0; i < 6; i++)
+            {
+                double d = i - 2.5;
+                double sinc = std::sin(pi * d * 0.5) / (pi * d * 0.5);
+                double window = bessel(alpha * std::sqrt(1.0 - (d / radius) * (d / radius))) / bessel(alpha);
+                weights[i] = static_cast<float>(sinc * window);
+                total += weights[i];
+            }
+            for (int i = 0; i < 6; i++) weights[i] = static_cast<float>(weights[i] / total);
+        }
+
+        std::uint16_t to565(int r, int g, int b)
+        {
+            return static_cast<std::uint16_t>(((r * 31 + 127) / 255) << 11
+                                            | ((g * 63 + 127) / 255) << 5
+                                            | ((b * 31 + 127) / 255));
+        }
+
+        void from565(std::uint16_t color, int * rgb)
+        {
+            int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+            rgb[0] = (r << 3) | (r >> 2);
+            rgb[1] = (g << 2) | (g >> 4);
+            rgb[2] = (b << 3) | (b >> 2);
+        }
+
+        // Both Endpoint Orders Map to the Same Palette Layout
+        void palette1(std::uint16_t c0, std::uint16_t c1, int (*colors)[4])
+        {
+            from565(c0, colors[0]); colors[0][3] = 255;
+            from565(c1, colors[1]); colors[1][3] = 255;
+            for (int i = 0; i < 3; i++)
+            {   if (c0 > c1)
+                {   colors[2][i] = (2 * colors[0][i] + colors[1][i]) / 3;
+                    colors[3][i] = (colors[0][i] + 2 * colors[1][i]) / 3;
+                }
+                else
+                {   colors[2][i] = (colors[0][i] + colors[1][i]) / 2;
+                    colors[3][i] = 0;
+                }
+            }
+            colors[2][3] = 255;
+            colors[3][3] = c0 > c1 ? 255 : 0;
+        }
+
+        void palette4(int a0, int a1, int * values)
+        {
+            values[0] = a0;
+            values[1] = a1;
+            if (a0 > a1)
+                for (int i = 2; i < 8; i++) values[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+            else
+            {   for (int i = 2; i < 6; i++) values[i] = ((6 - i) * a0 + (i - 1) * a1) / 5;
+                values[6] = 0;
+                values[7] = 255;
+            }
+        }
+
+        void decodeBC1(unsigned char const * block, unsigned char * texels)
+        {
+            int colors[4][4];
+            palette1(static_cast<std::uint16_t>(block[0] | block[1] << 8),
+                     static_cast<std::uint16_t>(block[2] | block[3] << 8), colors);
+            std::uint32_t indices = block[4] | block[5] << 8 | block[6] << 16 | static_cast<std::uint32_t>(block[7]) << 24;
+            for (int i = 0; i < 16; i++)
+            for (int c = 0; c < 4; c++)
+                texels[i * 4 + c] = static_cast<unsigned char>(colors[(indices >> (2 * i)) & 3][c]);
+        }
+
+        void decodeBC4(unsigned char const * block, int channel, unsigned char * texels)
+        {
+            int values[8];
+            palette4(block[0], block[1], values);
+            std::uint64_t indices = 0;
+            for (int i = 0; i < 6; i++) indices |= static_cast<std::uint64_t>(block[2 + i]) << (8 * i);
+            for (int i = 0; i < 16; i++)
+                texels[i * 4 + channel] = static_cast<unsigned char>(values[(indices >> (3 * i)) & 7]);
+        }
+    }
+
+    GLenum CompressedImage::internalFormat() const
+    {
+        switch (format)
+        {
+            case BlockFormat::BC1 : return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            case BlockFormat::BC3 : return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            case BlockFormat::BC4 : return GL_COMPRESSED_RED_RGTC1;
+            case BlockFormat::BC5 : return GL_COMPRESSED_RG_RGTC2;
+        }   return 0;
+    }
+
+    void downsample(unsigned char const * source, int width, int height,
+                    unsigned char * destination, MipFilter filter)
+    {
+        int halfWidth = std::max(1, width / 2), halfHeight = std::max(1, height / 2);
+        if (filter == MipFilter::Kaiser)
+        {
+            // Separable: Filter Rows Into a Float Buffer, Then Columns Into the Destination
+            float weights[6];
+            kaiser(weights);
+            std::vector<float> rows(halfWidth * height * 4);
+#ifdef __SSE2__
+            // One Texel's Four Channels per Register; Same Tap Order as the Scalar Path
+            __m128 taps[6];
+            for (int i = 0; i < 6; i++) taps[i] = _mm_set1_ps(weights[i]);
+            __m128i const zero = _mm_setzero_si128();
+            for (int y = 0; y < height; y++)
+            for (int x = 0; x < halfWidth; x++)
+            {   __m128 sum = _mm_setzero_ps();
+                for (int i = 0; i < 6; i++)
+                {   int sx = std::min(std::max(2 * x - 2 + i, 0), width - 1), texel;
+                    std::memcpy(&texel, source + (y * width + sx) * 4, 4);
+                    __m128i wide = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(texel), zero), zero);
+                    sum = _mm_add_ps(sum, _mm_mul_ps(taps[i], _mm_cvtepi32_ps(wide)));
+                }   _mm_storeu_ps(&rows[(y * halfWidth + x) * 4], sum);
+            }
+
+            __m128 const half = _mm_set1_ps(0.5f), ceiling = _mm_set1_ps(255.0f);
+            for (int y = 0; y < halfHeight; y++)
+            for (int x = 0; x < halfWidth; x++)
+            {   __m128 sum = _mm_setzero_ps();
+                for (int i = 0; i < 6; i++)
+                {   int sy = std::min(std::max(2 * y - 2 + i, 0), height - 1);
+                    sum = _mm_add_ps(sum, _mm_mul_ps(taps[i], _mm_loadu_ps(&rows[(sy * halfWidth + x) * 4])));
+                }
+                __m128i packed = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(sum, half), _mm_setzero_ps()), ceiling));
+                packed = _mm_packus_epi16(_mm_packs_epi32(packed, packed), zero);
+                int texel = _mm_cvtsi128_si32(packed);
+                std::memcpy(destination + (y * halfWidth + x) * 4, &texel, 4);
+            }
+#else
+            for (int y = 0; y < height; y++)
+            for (int x = 0; x < halfWidth; x++)
+            for (int c = 0; c < 4; c++)
+            {   float sum = 0.0f;
+                for (int i = 0; i < 6; i++)
+                {   int sx = std::min(std::max(2 * x - 2 + i, 0), width - 1);
+                    sum += weights[i] * source[(y * width + sx) * 4 + c];
+                }   rows[(y * halfWidth + x) * 4 + c] = sum;
+            }
+
+            for (int y = 0; y < halfHeight; y++)
+            for (int x = 0; x < halfWidth; x++)
+            for (int c = 0; c < 4; c++)
+            {   float sum = 0.0f;
+                for (int i = 0; i < 6; i++)
+                {   int sy = std::min(std::max(2 * y - 2 + i, 0), height - 1);
+                    sum += weights[i] * rows[(sy * halfWidth + x) * 4 + c];
+                }   destination[(y * halfWidth + x) * 4 + c] = static_cast<unsigned char>(
+                        std::min(std::max(sum + 0.5f, 0.0f), 255.0f));
+            }
+#endif
+            return;
+        }
+
+        for (int y = 0; y < halfHeight; y++)
+        {
+            unsigned char const * row0 = source + std::min(2 * y,     height - 1) * width * 4;
+            unsigned char const * row1 = source + std::min(2 * y + 1, height - 1) * width * 4;
+            unsigned char * out = destination + y * halfWidth * 4;
+            int x = 0;
+#ifdef __SSE2__
+            // Average Rows, Then Split Even and Odd Texels and Average Those; Four Outputs per Pass
+            for (; 2 * x + 8 <= width && x + 4 <= halfWidth; x += 4)
+            {
+                __m128i a = _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(row0 + 8 * x)),
+                                         _mm_loadu_si128(reinterpret_cast<__m128i const *>(row1 + 8 * x)));
+                __m128i b = _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(row0 + 8 * x + 16)),
+                                         _mm_loadu_si128(reinterpret_cast<__m128i const *>(row1 + 8 * x + 16)));
+                __m128 even = _mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0));
+                __m128 odd  = _mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(3, 1, 3, 1));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 4 * x),
+                                 _mm_avg_epu8(_mm_castps_si128(even), _mm_castps_si128(odd)));
+            }
+#endif
+            for (; x < halfWidth; x++)
+            {   int x0 = std::min(2 * x, width - 1) * 4, x1 = std::min(2 * x + 1, width - 1) * 4;
+                for (int c = 0; c < 4; c++)
+                    out[4 * x + c] = static_cast<unsigned char>((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+            }
+        }
+    }
+
+    void encodeBC1(unsigned char const * rgba, unsigned char * block)
+    {
+        // Principal Axis of the Colors by Power Iteration on Their Covariance
+        float mean[3] = { 0.0f, 0.0f, 0.0f };
+        for (int i = 0; i < 16; i++)
+        for (int c = 0; c < 3; c++) mean[c] += rgba[i * 4 + c] / 16.0f;
+        float covariance[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+        for (int i = 0; i < 16; i++)
+        {   float r = rgba[i * 4] - mean[0], g = rgba[i * 4 + 1] - mean[1], b = rgba[i * 4 + 2] - mean[2];
+            covariance[0] += r * r; covariance[1] += r * g; covariance[2] += r * b;
+            covariance[3] += g * g; covariance[4] += g * b; covariance[5] += b * b;
+        }
+        float axis[3] = { 1.0f, 1.0f, 1.0f };
+        for (int iteration = 0; iteration < 4; iteration++)
+        {   float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+            float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+            float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+            float length = std::max(std::fabs(x), std::max(std::fabs(y), std::fabs(z)));
+            if (length < 1e-6f) break;
+            axis[0] = x / length; axis[1] = y / length; axis[2] = z / length;
+        }
+
+        // Extreme Texels Along the Axis, Pulled In by a Sixteenth to Spread the Error
+        int low = 0, high = 0;
+        float lowest = 1e30f, highest = -1e30f;
+        for (int i = 0; i < 16; i++)
+        {   float d = rgba[i * 4] * axis[0] + rgba[i * 4 + 1] * axis[1] + rgba[i * 4 + 2] * axis[2];
+            if (d < lowest)  { lowest  = d; low  = i; }
+            if (d > highest) { highest = d; high = i; }
+        }
+        int endpoints[2][3];
+        for (int c = 0; c < 3; c++)
+        {   int inset = (rgba[high * 4 + c] - rgba[low * 4 + c]) / 16;
+            endpoints[0][c] = std::min(255, std::max(0, rgba[high * 4 + c] - inset));
+            endpoints[1][c] = std::min(255, std::max(0, rgba[low  * 4 + c] + inset));
+        }
+
+        // Keep color0 > color1 for Four-Color Mode
+        std::uint16_t c0 = to565(endpoints[0][0], endpoints[0][1], endpoints[0][2]);
+        std::uint16_t c1 = to565(endpoints[1][0], endpoints[1][1], endpoints[1][2]);
+        if (c0 < c1) std::swap(c0, c1);
+        std::uint32_t indices = 0;
+        if (c0 != c1)
+        {
+            int colors[4][4];
+            palette1(c0, c1, colors);
+            for (int i = 0; i < 16; i++)
+            {   int best = 0, bestError = 1 << 30;
+                for (int j = 0; j < 4; j++)
+                {   int dr = rgba[i * 4] - colors[j][0], dg = rgba[i * 4 + 1] - colors[j][1], db = rgba[i * 4 + 2] - colors[j][2];
+                    int error = dr * dr + dg * dg + db * db;
+                    if (error < bestError) { bestError = error; best = j; }
+                }   indices |= static_cast<std::uint32_t>(best) << (2 * i);
+            }
+        }
+
+        block[0] = c0 & 0xff; block[1] = c0 >> 8;
+        block[2] = c1 & 0xff; block[3] = c1 >> 8;
+        for (int i = 0; i < 4; i++) block[4 + i] = (indices >> (8 * i)) & 0xff;
+    }
+
+    void encodeBC4(unsigned char const * rgba, int channel, unsigned char * block)
+    {
+        // Eight-Value Mode Spans the Exact Range of the Block
+        int a0 = 0, a1 = 255;
+        for (int i = 0; i < 16; i++)
+        {   a0 = std::max(a0, static_cast<int>(rgba[i * 4 + channel]));
+            a1 = std::min(a1, static_cast<int>(rgba[i * 4 + channel]));
+        }
+
+        std::uint64_t indices = 0;
+        if (a0 != a1)
+        {
+            int values[8];
+            palette4(a0, a1, values);
+            for (int i = 0; i < 16; i++)
+            {   int best = 0, bestError = 256;
+                for (int j = 0; j < 8; j++)
+                {   int error = std::abs(rgba[i * 4 + channel] - values[j]);
+                    if (error < bestError) { bestError = error; best = j; }
+                }   indices |= static_cast<std::uint64_t>(best) << (3 * i);
+            }
+        }
+
+        block[0] = static_cast<unsigned char>(a0);
+        block[1] = static_cast<unsigned char>(a1);
+        for (int i = 0; i < 6; i++) block[2 + i] = (indices >> (8 * i)) & 0xff;
+    }
+
+    CompressedImage compress(unsigned char const * pixels, int width, int height, int channels,
+                             MipFilter filter)
+    {
+        CompressedImage image;
+        image.channels = channels;
+        image.format = channels == 1 ? BlockFormat::BC4
+                     : channels == 2 ? BlockFormat::BC5
+                     : channels == 3 ? BlockFormat::BC1 : BlockFormat::BC3;
+
+        // Expand to RGBA the Way OpenGL Samples RED, RG and RGB Textures
+        std::vector<unsigned char> level(width * height * 4), next;
+        for (int i = 0; i < width * height; i++)
+        for (int c = 0; c < 4; c++)
+            level[i * 4 + c] = c < channels ? pixels[i * channels + c] : (c == 3 ? 255 : 0);
+
+        for (;;)
+        {
+            // Encode Every 4x4 Block, Repeating Edge Texels to Fill Partial Ones
+            CompressedImage::Level info;
+            info.width = width;
+            info.height = height;
+            info.offset = image.data.size();
+            int blocksWide = (width + 3) / 4, blocksHigh = (height + 3) / 4;
+            info.size = blocksWide * blocksHigh * image.blockBytes();
+            image.data.resize(info.offset + info.size);
+            image.levels.push_back(info);
+
+            unsigned char texels[64];
+            unsigned char * out = & image.data[info.offset];
+            for (int by = 0; by < blocksHigh; by++)
+            for (int bx = 0; bx < blocksWide; bx++)
+            {
+                for (int i = 0; i < 16; i++)
+                {   int x = std::min(bx * 4 + (i & 3), width - 1), y = std::min(by * 4 + (i >> 2), height - 1);
+                    std::memcpy(texels + i * 4, & level[(y * width + x) * 4], 4);
+                }
+                switch (image.format)
+                {
+                    case BlockFormat::BC1 : encodeBC1(texels, out); break;
+                    case BlockFormat::BC3 : encodeBC4(texels, 3, out); encodeBC1(texels, out + 8); break;
+                    case BlockFormat::BC4 : encodeBC4(texels, 0, out); break;
+                    case BlockFormat::BC5 : encodeBC4(texels, 0, out); encodeBC4(texels, 1, out + 8); break;
+                }   out += image.blockBytes();
+            }
+
+            if (width == 1 && height == 1) break;
+            next.resize(std::max(1, width / 2) * std::max(1, height / 2) * 4);
+            downsample(level.data(), width, height, next.data(), filter);
+            level.swap(next);
+            width  = std::max(1, width  / 2);
+            height = std::max(1, height / 2);
+        }   return image;
+    }
+
+    void decompress(CompressedImage const & image, std::size_t index, std::vector<unsigned char> & rgba)
+    {
+        auto const & level = image.levels[index];
+        rgba.assign(level.width * level.height * 4, 0);
+        int blocksWide = (level.width + 3) / 4, blocksHigh = (level.height + 3) / 4;
+        unsigned char const * in = & image.data[level.offset];
+        unsigned char texels[64];
+        for (int by = 0; by < blocksHigh; by++)
+        for (int bx = 0; bx < blocksWide; bx++)
+        {
+            std::memset(texels, 0, sizeof(texels));
+            for (int i = 0; i < 16; i++) texels[i * 4 + 3] = 255;
+            switch (image.format)
+            {
+                case BlockFormat::BC1 : decodeBC1(in, texels); break;
+                case BlockFormat::BC3 : decodeBC1(in + 8, texels); decodeBC4(in, 3, texels); break;
+                case BlockFormat::BC4 : decodeBC4(in, 0, texels); break;
+                case BlockFormat::BC5 : decodeBC4(in, 0, texels); decodeBC4(in + 8, 1, texels); break;
+            }   in += image.blockBytes();
+
+            for (int i = 0; i < 16; i++)
+            {   int x = bx * 4 + (i & 3), y = by * 4 + (i >> 2);
+                if (x < level.width && y < level.height)
+                    std::memcpy(& rgba[(y * level.width + x) * 4], texels + i * 4, 4);
+            }
+        }
+    }
+
+    // DDS Header After the Magic, as 31 Little-Endian Words
+    //
+    //      0 size         1 flags        2 height       3 width
+    //      4 linear size  6 mip count    7..8 key       9 channels
+    //     18 pixel format size           19 pixel format flags
+    //     20 FourCC      26 caps
+    std::vector<unsigned char> writeDDS(CompressedImage const & image, std::uint64_t key)
+    {
+        std::uint32_t header[32] = {};
+        char const * codes[] = { "DXT1", "DXT5", "ATI1", "ATI2" };
+        header[0]  = fourCC("DDS ");
+        header[1]  = 124;
+        header[2]  = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000;
+        header[3]  = image.levels[0].height;
+        header[4]  = image.levels[0].width;
+        header[5]  = static_cast<std::uint32_t>(image.levels[0].size);
+        header[7]  = static_cast<std::uint32_t>(image.levels.size());
+        header[8]  = static_cast<std::uint32_t>(key);
+        header[9]  = static_cast<std::uint32_t>(key >> 32);
+        header[10] = image.channels;
+        header[19] = 32;
+        header[20] = 0x4;
+        header[21] = fourCC(codes[static_cast<int>(image.format)]);
+        header[27] = 0x1000 | 0x400000 | 0x8;
+
+        std::vector<unsigned char> bytes(sizeof(header) + image.data.size());
+        std::memcpy(bytes.data(), header, sizeof(header));
+        if (!image.data.empty()) std::memcpy(bytes.data() + sizeof(header), image.data.data(), image.data.size());
+        return bytes;
+    }
+
+    bool readDDS(unsigned char const * data, std::size_t size, CompressedImage & image, std::uint64_t key)
+    {
+        std::uint32_t header[32];
+        if (!data || size < sizeof(header)) return false;
+        std::memcpy(header, data, sizeof(header));
+        if (header[0] != fourCC("DDS ") || header[1] != 124 || !(header[20] & 0x4)) return false;
+        if (key != 0 && (header[8] != static_cast<std::uint32_t>(key) || header[9] != static_cast<std::uint32_t>(key >> 32)))
+            return false;
+
+             if (header[21] == fourCC("DXT1")) image.format = BlockFormat::BC1;
+        else if (header[21] == fourCC("DXT5")) image.format = BlockFormat::BC3;
+        else if (header[21] == fourCC("ATI1") || header[21] == fourCC("BC4U")) image.format = BlockFormat::BC4;
+        else if (header[21] == fourCC("ATI2") || header[21] == fourCC("BC5U")) image.format = BlockFormat::BC5;
+        else return false;
+        static const int defaults[] = { 3, 4, 1, 2 };
+        image.channels = header[10] >= 1 && header[10] <= 4 ? static_cast<int>(header[10])
+                                                             : defaults[static_cast<int>(image.format)];
+
+        // Rebuild the Level Table From the Dimensions, Rejecting Truncated Files
+        int width = header[4], height = header[3];
+        std::size_t offset = 0, count = std::max<std::uint32_t>(1, header[7]);
+        image.levels.clear();
+        for (std::size_t i = 0; i < count && width > 0 && height > 0; i++)
+        {   CompressedImage::Level level = { width, height, offset,
+                                             ((width + 3) / 4) * ((height + 3) / 4) * image.blockBytes() };
+            image.levels.push_back(level);
+            offset += level.size;
+            if (width == 1 && height == 1) break;
+            width  = std::max(1, width  / 2);
+            height = std::max(1, height / 2);
+        }
+        if (image.levels.empty() || sizeof(header) + offset > size) return false;
+        image.data.assign(data + sizeof(header), data + sizeof(header) + offset);
+        return true;
+    }
+
+    bool saveDDS(std::string const & filename, CompressedImage const & image, std::uint64_t key)
+    {
+        // Write to a Temporary and Rename, Like the Mesh Cache
+        std::vector<unsigned char> bytes = writeDDS(image, key);
+        std::string temporary = filename + ".tmp";
+        {
+            std::ofstream fd(temporary, std::ios::binary | std::ios::trunc);
+            fd.write(reinterpret_cast<char const *>(bytes.data()), bytes.size());
+            if (!fd)
+            {   fprintf(stderr, "Failed to Write Texture Cache %s\n", temporary.c_str());
+                return false;
+            }
+        }
+        std::remove(filename.c_str());
+        return std::rename(temporary.c_str(), filename.c_str()) == 0;
+    }
+
+    bool loadDDS(std::string const & filename, CompressedImage & image, std::uint64_t key)
+    {
+        MappedFile file;
+        return file.open(filename) && readDDS(file.data(), file.size(), image, key);
+    }
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+// System Headers
+#include <glad/glad.h>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Block-Compressed Formats Produced by compress(), Chosen by Channel Count
+    //
+    //     1 channel  -> BC4 (RGTC1, core since OpenGL 3.0)
+    //     2 channels -> BC5 (RGTC2, core since OpenGL 3.0; normal maps)
+    //     3 channels -> BC1 (S3TC DXT1, EXT_texture_compression_s3tc)
+    //     4 channels -> BC3 (S3TC DXT5, EXT_texture_compression_s3tc)
+    enum class BlockFormat { BC1, BC3, BC4, BC5 };
+
+    enum class MipFilter { Box, Kaiser };
+
+    // Whole Mip Chain of One Texture in a Single Allocation
+    struct CompressedImage
+    {
+        struct Level
+        {
+            int width;
+            int height;
+            std::size_t offset;
+            std::size_t size;
+        };
+
+        BlockFormat format;
+        int channels;
+        std::vector<Level> levels;
+        std::vector<unsigned char> data;
+
+        GLenum internalFormat() const;
+        std::size_t blockBytes() const { return (format == BlockFormat::BC1 || format == BlockFormat::BC4) ? 8 : 16; }
+    };
+
+    // Halve an RGBA8 Image; Odd Edges Repeat Their Last Texel
+    void downsample(unsigned char const * source, int width, int height,
+                    unsigned char * destination, MipFilter filter = MipFilter::Box);
+
+    // Expand to RGBA8, Build Every Mip Level and Encode Them All
+    CompressedImage compress(unsigned char const * pixels, int width, int height, int channels,
+                             MipFilter filter = MipFilter::Box);
+
+    // Decode One Level Back to RGBA8, for Drivers Without S3TC and for Measuring Error
+    void decompress(CompressedImage const & image, std::size_t level, std::vector<unsigned char> & rgba);
+
+    // Single-Block Encoders; Input Is 16 RGBA8 Texels in Row Order
+    void encodeBC1(unsigned char const * rgba, unsigned char * block);
+    void encodeBC4(unsigned char const * rgba, int channel, unsigned char * block);
+
+    // Legacy DDS Container With FourCC Codes; key Is Kept in the Reserved Words
+    bool saveDDS(std::string const & filename, CompressedImage const & image, std::uint64_t key);
+    bool loadDDS(std::string const & filename, CompressedImage & image, std::uint64_t key);
+
+    // The Same Container in Memory, for Images Stored Inside a Package
+    std::vector<unsigned char> writeDDS(CompressedImage const & image, std::uint64_t key);
+    bool readDDS(unsigned char const * data, std::size_t size, CompressedImage & image, std::uint64_t key);
+};
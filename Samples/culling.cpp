@@ -0,0 +1,458 @@
+// Local Headers
+#include "culling.hpp"
+
+// System Headers
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Standard Headers
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Define Namespace
+namespace Mirage
+{
+    Bounds transform(Bounds const & bounds, glm::mat4 const & model)
+    {
+        // Start From the Translation and Pick the Extreme Product per Matrix Entry
+        Bounds result;
+        for (int row = 0; row < 3; row++)
+        {   result.min[row] = result.max[row] = model[3][row];
+            for (int column = 0; column < 3; column++)
+            {   float a = model[column][row] * bounds.min[column];
+                float b = model[column][row] * bounds.max[column];
+                result.min[row] += std::min(a, b);
+                result.max[row] += std::max(a, b);
+            }
+        }   return result;
+    }
+
+    Frustum::Frustum(glm::mat4 const & viewProjection)
+    {
+        // Left, Right, Bottom, Top, Near and Far Are Sums of Matrix Rows
+        for (int i = 0; i < 6; i++)
+        {
+            float sign = (i % 2 == 0) ? 1.0f : -1.0f;
+            glm::vec4 plane;
+            for (int column = 0; column < 4; column++)
+                plane[column] = viewProjection[column][3] + sign * viewProjection[column][i / 2];
+            float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+            if (length > 0.0f) plane = plane * (1.0f / length);
+            mX[i] = plane.x; mAbsX[i] = std::fabs(plane.x);
+            mY[i] = plane.y; mAbsY[i] = std::fabs(plane.y);
+            mZ[i] = plane.z; mAbsZ[i] = std::fabs(plane.z);
+            mW[i] = plane.w;
+        }
+
+        // Padding Planes Sit at Distance One From Everything
+        for (int i = 6; i < 8; i++)
+        {   mX[i] = mY[i] = mZ[i] = 0.0f;
+            mAbsX[i] = mAbsY[i] = mAbsZ[i] = 0.0f;
+            mW[i] = 1.0f;
+        }
+    }
+
+    Frustum::Result Frustum::classify(glm::vec3 const & center, glm::vec3 const & extent) const
+    {
+        // A Box Is Outside a Plane If Its Center Lies Further Behind It Than Its Projected Radius
+        int outside = 0, straddling = 0;
+#if defined(__AVX__)
+        __m256 cx = _mm256_set1_ps(center.x), ex = _mm256_set1_ps(extent.x);
+        __m256 cy = _mm256_set1_ps(center.y), ey = _mm256_set1_ps(extent.y);
+        __m256 cz = _mm256_set1_ps(center.z), ez = _mm256_set1_ps(extent.z);
+        __m256 zero = _mm256_setzero_ps();
+        __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(mX), cx),
+                                               _mm256_mul_ps(_mm256_loadu_ps(mY), cy)),
+                                 _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(mZ), cz),
+                                               _mm256_loadu_ps(mW)));
+        __m256 r = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(mAbsX), ex),
+                                               _mm256_mul_ps(_mm256_loadu_ps(mAbsY), ey)),
+                                 _mm256_mul_ps(_mm256_loadu_ps(mAbsZ), ez));
+        outside    = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_add_ps(d, r), zero, _CMP_LT_OQ));
+        straddling = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_sub_ps(d, r), zero, _CMP_LT_OQ));
+#elif defined(__SSE2__)
+        __m128 cx = _mm_set1_ps(center.x), ex = _mm_set1_ps(extent.x);
+        __m128 cy = _mm_set1_ps(center.y), ey = _mm_set1_ps(extent.y);
+        __m128 cz = _mm_set1_ps(center.z), ez = _mm_set1_ps(extent.z);
+        __m128 zero = _mm_setzero_ps();
+        for (int i = 0; i < 8; i += 4)
+        {
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(mX + i), cx),
+                                             _mm_mul_ps(_mm_loadu_ps(mY + i), cy)),
+                                  _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(mZ + i), cz),
+                                             _mm_loadu_ps(mW + i)));
+            __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(mAbsX + i), ex),
+                                             _mm_mul_ps(_mm_loadu_ps(mAbsY + i), ey)),
+                                  _mm_mul_ps(_mm_loadu_ps(mAbsZ + i), ez));
+            outside    |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(d, r), zero));
+            straddling |= _mm_movemask_ps(_mm_cmplt_ps(_mm_sub_ps(d, r), zero));
+        }
+#else
+        for (int i = 0; i < 6; i++)
+        {
+            float d = (mX[i] * center.x + mY[i] * center.y) + (mZ[i] * center.z + mW[i]);
+            float r = (mAbsX[i] * extent.x + mAbsY[i] * extent.y) + mAbsZ[i] * extent.z;
+            outside    |= d + r < 0.0f;
+            straddling |= d - r < 0.0f;
+        }
+#endif
+        if (outside) return Outside;
+        return straddling ? Intersecting : Inside;
+    }
+
+    bool Frustum::visible(Bounds const & bounds) const
+    {
+        // Same Arithmetic as classify(), One Plane at a Time
+        glm::vec3 center = (bounds.min + bounds.max) * 0.5f;
+        glm::vec3 extent = (bounds.max - bounds.min) * 0.5f;
+        for (int i = 0; i < 6; i++)
+        {
+            float d = (mX[i] * center.x + mY[i] * center.y) + (mZ[i] * center.z + mW[i]);
+            float r = (mAbsX[i] * extent.x + mAbsY[i] * extent.y) + mAbsZ[i] * extent.z;
+            if (d + r < 0.0f) return false;
+        }   return true;
+    }
+
+    namespace
+    {
+        // Reject Geometry This Close to the Eye Instead of Clipping It
+        const float NearW = 1e-4f;
+
+        void corners(Bounds const & bounds, glm::vec3 * out)
+        {
+            for (int i = 0; i < 8; i++)
+                out[i] = glm::vec3((i & 1) ? bounds.max.x : bounds.min.x,
+                                   (i & 2) ? bounds.max.y : bounds.min.y,
+                                   (i & 4) ? bounds.max.z : bounds.min.z);
+        }
+    }
+
+    OcclusionBuffer::OcclusionBuffer(int width, int height)
+        : mDepth(width * height, 1.0f)
+        , mViewProjection(1.0f)
+        , mWidth(width)
+        , mHeight(height)
+        , mTilesWide((width + Tile - 1) / Tile)
+    {
+        mTiles.assign(mTilesWide * ((height + Tile - 1) / Tile), 1.0f);
+    }
+
+    const int OcclusionBuffer::Tile;
+
+    void OcclusionBuffer::begin(glm::mat4 const & viewProjection)
+    {
+        std::fill(mDepth.begin(), mDepth.end(), 1.0f);
+        std::fill(mTiles.begin(), mTiles.end(), 1.0f);
+        mViewProjection = viewProjection;
+    }
+
+    void OcclusionBuffer::rasterize(Bounds const & bounds)
+    {
+        // Only the Front Faces Matter, but Winding Depends on the View; Draw All Twelve
+        static const int faces[12][3] = {
+            { 0, 1, 3 }, { 0, 3, 2 }, { 4, 6, 7 }, { 4, 7, 5 },
+            { 0, 4, 5 }, { 0, 5, 1 }, { 2, 3, 7 }, { 2, 7, 6 },
+            { 0, 2, 6 }, { 0, 6, 4 }, { 1, 5, 7 }, { 1, 7, 3 },
+        };
+        glm::vec3 points[8];
+        glm::vec4 clip[8];
+        corners(bounds, points);
+        for (int i = 0; i < 8; i++) clip[i] = mViewProjection * glm::vec4(points[i], 1.0f);
+        for (auto const & face : faces) triangle(clip[face[0]], clip[face[1]], clip[face[2]]);
+    }
+
+    void OcclusionBuffer::rasterize(Vertex const * vertices, GLuint const * indices,
+                                    std::size_t indexCount, glm::mat4 const & model)
+    {
+        glm::mat4 transform = mViewProjection * model;
+        for (std::size_t i = 0; i + 2 < indexCount; i += 3)
+            triangle(transform * glm::vec4(vertices[indices[i + 0]].position, 1.0f),
+                     transform * glm::vec4(vertices[indices[i + 1]].position, 1.0f),
+                     transform * glm::vec4(vertices[indices[i + 2]].position, 1.0f));
+    }
+
+    void OcclusionBuffer::triangle(glm::vec4 const & a, glm::vec4 const & b, glm::vec4 const & c)
+    {
+        if (a.w <= NearW || b.w <= NearW || c.w <= NearW) return;
+
+        // Project to Pixel Coordinates With Depth Remapped to [0, 1]
+        glm::vec3 p[3];
+        glm::vec4 const * clip[3] = { & a, & b, & c };
+        for (int i = 0; i < 3; i++)
+            p[i] = glm::vec3((clip[i]->x / clip[i]->w * 0.5f + 0.5f) * mWidth,
+                             (clip[i]->y / clip[i]->w * 0.5f + 0.5f) * mHeight,
+                              clip[i]->z / clip[i]->w * 0.5f + 0.5f);
+        if (p[0].z > 1.0f && p[1].z > 1.0f && p[2].z > 1.0f) return;
+
+        // Make the Winding Counter-Clockwise So All Edge Functions Agree in Sign
+        float area = (p[1].x - p[0].x) * (p[2].y - p[0].y) - (p[1].y - p[0].y) * (p[2].x - p[0].x);
+        if (area == 0.0f) return;
+        if (area < 0.0f) { std::swap(p[1], p[2]); area = -area; }
+
+        int x0 = std::max(0, static_cast<int>(std::floor(std::min(p[0].x, std::min(p[1].x, p[2].x)))));
+        int y0 = std::max(0, static_cast<int>(std::floor(std::min(p[0].y, std::min(p[1].y, p[2].y)))));
+        int x1 = std::min(mWidth  - 1, static_cast<int>(std::ceil(std::max(p[0].x, std::max(p[1].x, p[2].x)))));
+        int y1 = std::min(mHeight - 1, static_cast<int>(std::ceil(std::max(p[0].y, std::max(p[1].y, p[2].y)))));
+
+        // Step the Edge Functions Incrementally Across Each Row
+        float inverse = 1.0f / area;
+        for (int y = y0; y <= y1; y++)
+        {
+            float py = y + 0.5f, px = x0 + 0.5f;
+            float e[3], step[3];
+            for (int i = 0; i < 3; i++)
+            {   glm::vec3 const & u = p[(i + 1) % 3];
+                glm::vec3 const & v = p[(i + 2) % 3];
+                e[i] = (v.x - u.x) * (py - u.y) - (v.y - u.y) * (px - u.x);
+                step[i] = -(v.y - u.y);
+            }
+
+            float * row = & mDepth[y * mWidth];
+            for (int x = x0; x <= x1; x++)
+            {   if (e[0] >= 0.0f && e[1] >= 0.0f && e[2] >= 0.0f)
+                {   float z = (e[0] * p[0].z + e[1] * p[1].z + e[2] * p[2].z) * inverse;
+                    row[x] = std::min(row[x], std::max(z, 0.0f));
+                }   e[0] += step[0]; e[1] += step[1]; e[2] += step[2];
+            }
+        }
+
+        // Refresh the Farthest Depth of Every Tile the Triangle Touched
+        for (int ty = y0 / Tile; ty <= y1 / Tile; ty++)
+        for (int tx = x0 / Tile; tx <= x1 / Tile; tx++)
+        {   float farthest = 0.0f;
+            for (int y = ty * Tile; y < std::min(mHeight, (ty + 1) * Tile); y++)
+            for (int x = tx * Tile; x < std::min(mWidth,  (tx + 1) * Tile); x++)
+                farthest = std::max(farthest, mDepth[y * mWidth + x]);
+            mTiles[ty * mTilesWide + tx] = farthest;
+        }
+    }
+
+    bool OcclusionBuffer::visible(Bounds const & bounds) const
+    {
+        // Project the Corners; Anything Reaching Past the Near Plane Stays Visible
+        glm::vec3 points[8];
+        corners(bounds, points);
+        float minX =  std::numeric_limits<float>::max(), minY = minX, minZ = minX;
+        float maxX = -std::numeric_limits<float>::max(), maxY = maxX;
+        for (auto const & point : points)
+        {
+            glm::vec4 clip = mViewProjection * glm::vec4(point, 1.0f);
+            if (clip.w <= NearW) return true;
+            float x = (clip.x / clip.w * 0.5f + 0.5f) * mWidth;
+            float y = (clip.y / clip.w * 0.5f + 0.5f) * mHeight;
+            minX = std::min(minX, x); maxX = std::max(maxX, x);
+            minY = std::min(minY, y); maxY = std::max(maxY, y);
+            minZ = std::min(minZ, clip.z / clip.w * 0.5f + 0.5f);
+        }
+
+        // Off-Screen Boxes Are the Frustum's Business, Not Ours
+        int x0 = std::max(0, static_cast<int>(std::floor(minX)));
+        int y0 = std::max(0, static_cast<int>(std::floor(minY)));
+        int x1 = std::min(mWidth  - 1, static_cast<int>(std::floor(maxX)));
+        int y1 = std::min(mHeight - 1, static_cast<int>(std::floor(maxY)));
+        if (x0 > x1 || y0 > y1) return true;
+
+        // Visible If Any Covered Pixel Is Further Away Than the Nearest Corner;
+        // Tiles Whose Farthest Pixel Is Still Closer Are Skipped Whole
+        for (int ty = y0 / Tile; ty <= y1 / Tile; ty++)
+        for (int tx = x0 / Tile; tx <= x1 / Tile; tx++)
+        {
+            if (minZ > mTiles[ty * mTilesWide + tx]) continue;
+            for (int y = std::max(y0, ty * Tile); y <= std::min(y1, (ty + 1) * Tile - 1); y++)
+            {   float const * row = & mDepth[y * mWidth];
+                for (int x = std::max(x0, tx * Tile); x <= std::min(x1, (tx + 1) * Tile - 1); x++)
+                    if (minZ <= row[x]) return true;
+            }
+        }   return false;
+    }
+
+    const std::uint32_t Scene::LeafSize;
+
+    void Scene::clear()
+    {
+        mItems.clear();
+        mNodes.clear();
+    }
+
+    void Scene::add(Bounds const & bounds, std::uint32_t id)
+    {
+        Item item;
+        item.center = (bounds.min + bounds.max) * 0.5f;
+        item.extent = (bounds.max - bounds.min) * 0.5f;
+        item.id = id;
+        mItems.push_back(item);
+    }
+
+    void Scene::add(Mesh const & mesh, glm::mat4 const & model)
+    {
+        // Ids Are Submesh Indices, Ready for Mesh::draw(shader, visible)
+        for (std::size_t i = 0; i < mesh.submeshes(); i++)
+            add(transform(mesh.bounds(i), model), static_cast<std::uint32_t>(i));
+    }
+
+    void Scene::build()
+    {
+        mNodes.clear();
+        if (mItems.empty()) return;
+        mNodes.reserve(2 * mItems.size() / LeafSize + 1);
+        split(0, static_cast<std::uint32_t>(mItems.size()));
+    }
+
+    std::uint32_t Scene::split(std::uint32_t first, std::uint32_t count)
+    {
+        // Bound the Items and Their Centers in One Pass
+        glm::vec3 lower( std::numeric_limits<float>::max()), upper(-lower);
+        glm::vec3 centerLower(lower), centerUpper(upper);
+        for (std::uint32_t i = first; i < first + count; i++)
+        {   lower = glm::min(lower, mItems[i].center - mItems[i].extent);
+            upper = glm::max(upper, mItems[i].center + mItems[i].extent);
+            centerLower = glm::min(centerLower, mItems[i].center);
+            centerUpper = glm::max(centerUpper, mItems[i].center);
+        }
+
+        std::uint32_t index = static_cast<std::uint32_t>(mNodes.size());
+        Node node;
+        node.center = (lower + upper) * 0.5f;
+        node.extent = (upper - lower) * 0.5f;
+        node.first = first;
+        node.count = count;
+        node.right = 0;
+        mNodes.push_back(node);
+        if (count <= LeafSize) return index;
+
+        // Median Split Along the Widest Spread of Centers
+        glm::vec3 spread = centerUpper - centerLower;
+        int axis = (spread.x > spread.y && spread.x > spread.z) ? 0 : (spread.y > spread.z ? 1 : 2);
+        std::uint32_t half = count / 2;
+        std::nth_element(mItems.begin() + first, mItems.begin() + first + half, mItems.begin() + first + count,
+                         [axis](Item const & a, Item const & b) { return a.center[axis] < b.center[axis]; });
+        split(first, half);
+        std::uint32_t right = split(first + half, count - half);
+        mNodes[index].right = right;
+        return index;
+    }
+
+    Scene::Statistics Scene::cull(Frustum const & frustum, std::vector<std::uint32_t> & visible,
+                                  ThreadPool * pool, OcclusionBuffer const * occlusion) const
+    {
+        Output output;
+        output.statistics = Statistics();
+        output.statistics.total = mItems.size();
+        visible.clear();
+        if (mNodes.empty()) return output.statistics;
+
+        // Test the Root Here So Both Traversals Start From an Accepted Node
+        output.statistics.tested++;
+        auto result = frustum.classify(mNodes[0].center, mNodes[0].extent);
+        if (result == Frustum::Outside)
+        {   output.statistics.frustum = mItems.size();
+            return output.statistics;
+        }
+
+        if (!pool)
+        {
+            output.visible.swap(visible);
+            visit(0, result == Frustum::Inside, 0, frustum, occlusion, output, nullptr);
+            output.visible.swap(visible);
+            return output.statistics;
+        }
+
+        // Descend Until There Are a Few Subtrees per Thread, Then Hand Them Out
+        unsigned int depth = 0;
+        while ((1u << depth) < 4 * (pool->size() + 1)) depth++;
+        std::vector<Task> tasks;
+        visit(0, result == Frustum::Inside, depth, frustum, occlusion, output, & tasks);
+
+        std::vector<Output> outputs(tasks.size());
+        pool->run(tasks.size(), [&](std::size_t i)
+        {   outputs[i].statistics = Statistics();
+            visit(tasks[i].node, tasks[i].inside, 0, frustum, occlusion, outputs[i], nullptr);
+        });
+
+        // Concatenate in Task Order, Which Is Tree Order
+        visible.swap(output.visible);
+        for (auto const & partial : outputs)
+        {   visible.insert(visible.end(), partial.visible.begin(), partial.visible.end());
+            output.statistics.tested   += partial.statistics.tested;
+            output.statistics.frustum  += partial.statistics.frustum;
+            output.statistics.occluded += partial.statistics.occluded;
+            output.statistics.visible  += partial.statistics.visible;
+        }   return output.statistics;
+    }
+
+    void Scene::visit(std::uint32_t index, bool inside, unsigned int depth, Frustum const & frustum,
+                      OcclusionBuffer const * occlusion, Output & output, std::vector<Task> * deferred) const
+    {
+        // The Caller Has Already Accepted This Node Against the Frustum; While
+        // Gathering Tasks, Defer Everything That Would Emit So Order Is Preserved
+        Node const & node = mNodes[index];
+        if (deferred && (depth == 0 || node.right == 0 || (inside && !occlusion)))
+        {   Task task = { index, inside };
+            deferred->push_back(task);
+            return;
+        }
+
+        if (occlusion)
+        {   Bounds bounds = { node.center - node.extent, node.center + node.extent };
+            if (!occlusion->visible(bounds))
+            {   output.statistics.occluded += node.count;
+                return;
+            }
+        }
+
+        // Fully Inside With Nothing Else to Check: Emit the Whole Run
+        if (inside && !occlusion)
+        {   for (std::uint32_t i = node.first; i < node.first + node.count; i++)
+                output.visible.push_back(mItems[i].id);
+            output.statistics.visible += node.count;
+            return;
+        }
+
+        if (node.right == 0)
+        {   for (std::uint32_t i = node.first; i < node.first + node.count; i++)
+                emit(mItems[i], inside, frustum, occlusion, output);
+            return;
+        }
+
+        std::uint32_t children[2] = { index + 1, node.right };
+        for (auto child : children)
+        {
+            auto result = Frustum::Inside;
+            if (!inside)
+            {   output.statistics.tested++;
+                result = frustum.classify(mNodes[child].center, mNodes[child].extent);
+            }
+            if (result == Frustum::Outside)
+                output.statistics.frustum += mNodes[child].count;
+            else visit(child, result == Frustum::Inside, depth > 0 ? depth - 1 : 0,
+                       frustum, occlusion, output, deferred);
+        }
+    }
+
+    void Scene::emit(Item const & item, bool inside, Frustum const & frustum,
+                     OcclusionBuffer const * occlusion, Output & output) const
+    {
+        if (!inside)
+        {   output.statistics.tested++;
+            if (frustum.classify(item.center, item.extent) == Frustum::Outside)
+            {   output.statistics.frustum++;
+                return;
+            }
+        }
+
+        if (occlusion)
+        {   Bounds bounds = { item.center - item.extent, item.center + item.extent };
+            if (!occlusion->visible(bounds))
+            {   output.statistics.occluded++;
+                return;
+            }
+        }
+
+        output.visible.push_back(item.id);
+        output.statistics.visible++;
+    }
+};
@@ -0,0 +1,171 @@
+#pragma once
+
+// Local Headers
+#include "mesh.hpp"
+#include "pool.hpp"
+
+// System Headers
+#include <glm/glm.hpp>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // World-Space Bounds of a Model-Space Box (Arvo, "Transforming Axis-Aligned Bounding Boxes")
+    Bounds transform(Bounds const & bounds, glm::mat4 const & model);
+
+    // Clip Planes Extracted From a View-Projection Matrix (Gribb and Hartmann)
+    //
+    // The planes are kept as structure-of-arrays padded to eight lanes, so
+    // one box is tested against all of them with two SSE or one AVX pass.
+    // The two padding planes always classify as inside.
+    class Frustum
+    {
+    public:
+
+        enum Result { Outside, Intersecting, Inside };
+
+        // Implement Custom Constructor
+        Frustum(glm::mat4 const & viewProjection);
+
+        // Public Member Functions
+        Result classify(glm::vec3 const & center, glm::vec3 const & extent) const;
+        bool visible(Bounds const & bounds) const; // Scalar Reference for Validation
+
+    private:
+
+        // Private Member Containers
+        float mX[8], mY[8], mZ[8], mW[8];
+        float mAbsX[8], mAbsY[8], mAbsZ[8];
+
+    };
+
+    // Coarse Software Depth Buffer for Occlusion Queries
+    //
+    // Occluders are rasterized with pixel-center coverage and interpolated
+    // depth; occludees are tested by the depth of their nearest corner over
+    // every pixel their projected rectangle touches, skipping whole tiles
+    // whose farthest depth is already closer. Triangles crossing the
+    // near plane are skipped, and boxes crossing it always count as visible,
+    // so the buffer only ever under-occludes. Queries are read-only and may
+    // run on several threads at once.
+    class OcclusionBuffer
+    {
+    public:
+
+        // Implement Custom Constructor
+        OcclusionBuffer(int width = 256, int height = 128);
+
+        // Public Member Functions
+        void begin(glm::mat4 const & viewProjection);
+        void rasterize(Bounds const & bounds);
+        void rasterize(Vertex const * vertices, GLuint const * indices, std::size_t indexCount,
+                       glm::mat4 const & model);
+        bool visible(Bounds const & bounds) const;
+        float depth(int x, int y) const { return mDepth[y * mWidth + x]; }
+        int width()  const { return mWidth;  }
+        int height() const { return mHeight; }
+
+        // Side of the Square Tiles That Track Their Farthest Depth
+        static const int Tile = 8;
+
+    private:
+
+        // Private Member Functions
+        void triangle(glm::vec4 const & a, glm::vec4 const & b, glm::vec4 const & c);
+
+        // Private Member Containers
+        std::vector<float> mDepth;
+        std::vector<float> mTiles;
+
+        // Private Member Variables
+        glm::mat4 mViewProjection;
+        int mWidth;
+        int mHeight;
+        int mTilesWide;
+
+    };
+
+    // Bounding Volume Hierarchy over Submesh Bounds
+    //
+    // Nodes are stored depth first, so every subtree covers a contiguous run
+    // of items and a node that is entirely inside the frustum emits its run
+    // without testing anything below it. cull() writes the ids of surviving
+    // items in tree order; given a pool, the upper levels are tested on the
+    // calling thread and the subtrees below them are split across workers,
+    // which produces exactly the same list as the single-threaded traversal.
+    class Scene
+    {
+    public:
+
+        // Culled-vs-Total Counters for One cull() Call
+        struct Statistics
+        {
+            std::size_t total;    // Items in the Scene
+            std::size_t tested;   // Node and Item Frustum Tests
+            std::size_t frustum;  // Items Rejected by the Frustum
+            std::size_t occluded; // Items Rejected by the Occlusion Buffer
+            std::size_t visible;  // Items Written to the Visible List
+        };
+
+        // Public Member Functions
+        void clear();
+        void add(Bounds const & bounds, std::uint32_t id);
+        void add(Mesh const & mesh, glm::mat4 const & model);
+        void build();
+        Statistics cull(Frustum const & frustum, std::vector<std::uint32_t> & visible,
+                        ThreadPool * pool = nullptr, OcclusionBuffer const * occlusion = nullptr) const;
+        std::size_t size() const { return mItems.size(); }
+        std::size_t nodes() const { return mNodes.size(); }
+
+        // Largest Number of Items Stored in One Leaf
+        static const std::uint32_t LeafSize = 4;
+
+    private:
+
+        // Private Data Structures
+        struct Item
+        {
+            glm::vec3 center;
+            glm::vec3 extent;
+            std::uint32_t id;
+        };
+
+        struct Node
+        {
+            glm::vec3 center;
+            glm::vec3 extent;
+            std::uint32_t first; // First Item Covered by This Subtree
+            std::uint32_t count; // Items Covered by This Subtree
+            std::uint32_t right; // Right Child; the Left Child Follows Directly, Zero for Leaves
+        };
+
+        struct Output
+        {
+            std::vector<std::uint32_t> visible;
+            Statistics statistics;
+        };
+
+        struct Task
+        {
+            std::uint32_t node;
+            bool inside;
+        };
+
+        // Private Member Functions
+        std::uint32_t split(std::uint32_t first, std::uint32_t count);
+        void visit(std::uint32_t node, bool inside, unsigned int depth, Frustum const & frustum,
+                   OcclusionBuffer const * occlusion, Output & output, std::vector<Task> * deferred) const;
+        void emit(Item const & item, bool inside, Frustum const & frustum,
+                  OcclusionBuffer const * occlusion, Output & output) const;
+
+        // Private Member Containers
+        std::vector<Item> mItems;
+        std::vector<Node> mNodes;
+
+    };
+};
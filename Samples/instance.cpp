@@ -0,0 +1,116 @@
+// Local Headers
+#include "instance.hpp"
+
+// Standard Headers
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// Define Namespace
+namespace Mirage
+{
+    InstanceBuffer::InstanceBuffer(std::size_t capacity, unsigned int frames)
+        : mInstances(capacity)
+        , mDirty(frames > 0 ? frames : 1, Range(0, 0))
+        , mFences(frames > 0 ? frames : 1, nullptr)
+        , mBuffer(0)
+        , mCount(0)
+        , mUploaded(0)
+        , mFrame(0)
+        , mMapped(nullptr)
+    {
+        if (!GLAD_GL_VERSION_4_3 && !GLAD_GL_ARB_shader_storage_buffer_object)
+            fprintf(stderr, "Instancing Requires Shader Storage Buffers (OpenGL 4.3)\n");
+
+        // Every Slot Must Start on a Valid glBindBufferRange Offset
+        GLint alignment = 256;
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, & alignment);
+        std::size_t bytes = std::max<std::size_t>(capacity, 1) * sizeof(Instance);
+        mStride = (bytes + alignment - 1) / alignment * alignment;
+
+        glGenBuffers(1, & mBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mBuffer);
+        GLsizeiptr size = mStride * mFences.size();
+        if (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage)
+        {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_SHADER_STORAGE_BUFFER, size, nullptr, flags);
+            mMapped = static_cast<unsigned char *>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, size, flags));
+        }
+        if (!mMapped) glBufferData(GL_SHADER_STORAGE_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    InstanceBuffer::~InstanceBuffer()
+    {
+        for (auto fence : mFences) if (fence) glDeleteSync(fence);
+        if (mMapped)
+        {   glBindBuffer(GL_SHADER_STORAGE_BUFFER, mBuffer);
+            glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        }   glDeleteBuffers(1, & mBuffer);
+    }
+
+    Instance * InstanceBuffer::edit(std::size_t first, std::size_t count)
+    {
+        // Editing Past the End Grows the Live Count
+        if (first + count > mCount) resize(first + count);
+        dirty(first, first + count);
+        return & mInstances[first];
+    }
+
+    void InstanceBuffer::resize(std::size_t count)
+    {
+        count = std::min(count, mInstances.size());
+        if (count > mCount) dirty(mCount, count);
+        mCount = count;
+    }
+
+    void InstanceBuffer::dirty(std::size_t first, std::size_t last)
+    {
+        // Merge Into One Range per Slot; Cheaper to Track Than a List
+        for (auto & range : mDirty)
+        {   if (range.first == range.second) range = Range(first, last);
+            else range = Range(std::min(range.first, first), std::max(range.second, last));
+        }
+    }
+
+    void InstanceBuffer::bind(GLuint binding)
+    {
+        // Bring This Slot Up to Date With Everything Edited Since It Was Last Used
+        Range & range = mDirty[mFrame];
+        std::size_t last = std::min(range.second, mCount);
+        mUploaded = 0;
+        if (range.first < last)
+        {
+            std::size_t offset = mFrame * mStride + range.first * sizeof(Instance);
+            mUploaded = (last - range.first) * sizeof(Instance);
+            if (mMapped) std::memcpy(mMapped + offset, & mInstances[range.first], mUploaded);
+            else
+            {   glBindBuffer(GL_SHADER_STORAGE_BUFFER, mBuffer);
+                glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, mUploaded, & mInstances[range.first]);
+                glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+            }
+        }
+        range = Range(0, 0);
+
+        std::size_t bytes = std::max<std::size_t>(mCount, 1) * sizeof(Instance);
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, mBuffer, mFrame * mStride, bytes);
+    }
+
+    void InstanceBuffer::advance()
+    {
+        // Fence the Slot Just Submitted, Then Wait Only If the Next One Is Still in Flight
+        if (mFences[mFrame]) glDeleteSync(mFences[mFrame]);
+        mFences[mFrame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        mFrame = (mFrame + 1) % mFences.size();
+        if (GLsync fence = mFences[mFrame])
+        {
+            GLenum status = glClientWaitSync(fence, 0, 0);
+            while (status == GL_TIMEOUT_EXPIRED)
+                status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            glDeleteSync(fence);
+            mFences[mFrame] = nullptr;
+        }
+    }
+};
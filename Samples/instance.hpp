@@ -0,0 +1,80 @@
+#pragma once
+
+// System Headers
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Standard Headers
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Per-Instance Data; Matches This std430 Declaration
+    //
+    //     struct Instance { mat4 transform; vec4 color; };
+    //     layout(std430, binding = 0) readonly buffer Instances { Instance instances[]; };
+    //
+    // Shaders index it with gl_InstanceID.
+    struct Instance
+    {
+        glm::mat4 transform;
+        glm::vec4 color;
+    };
+
+    // Instance Array Shared With the GPU Through a Shader Storage Buffer
+    //
+    // Edits go to a CPU copy and are tracked as one dirty range per frame in
+    // flight. bind() copies only the current slot's range, so a scene that
+    // moves a handful of instances pays for a handful. With OpenGL 4.4 or
+    // ARB_buffer_storage the slots are persistently mapped and publishing is
+    // a memcpy; otherwise it falls back to glBufferSubData. Slots are fenced
+    // like UniformRing and only waited on when the ring wraps around.
+    // Requires OpenGL 4.3 or ARB_shader_storage_buffer_object.
+    class InstanceBuffer
+    {
+    public:
+
+        // Implement Custom Constructor and Destructor
+         InstanceBuffer(std::size_t capacity, unsigned int frames = 3);
+        ~InstanceBuffer();
+
+        // Public Member Functions
+        Instance const & operator[](std::size_t index) const { return mInstances[index]; }
+        Instance * edit(std::size_t first, std::size_t count = 1);
+        void set(std::size_t index, Instance const & instance) { *edit(index) = instance; }
+        void resize(std::size_t count);
+        void bind(GLuint binding);
+        void advance();
+        std::size_t size() const { return mCount; }
+        std::size_t capacity() const { return mInstances.size(); }
+        std::size_t uploaded() const { return mUploaded; }
+        bool persistent() const { return mMapped != nullptr; }
+
+    private:
+
+        // Disable Copying and Assignment
+        InstanceBuffer(InstanceBuffer const &) = delete;
+        InstanceBuffer & operator=(InstanceBuffer const &) = delete;
+
+        // Half-Open Range of Instances Each Slot Has Yet to Receive
+        typedef std::pair<std::size_t, std::size_t> Range;
+        void dirty(std::size_t first, std::size_t last);
+
+        // Private Member Containers
+        std::vector<Instance> mInstances;
+        std::vector<Range> mDirty;
+        std::vector<GLsync> mFences;
+
+        // Private Member Variables
+        GLuint mBuffer;
+        std::size_t mCount;
+        std::size_t mStride;
+        std::size_t mUploaded;
+        unsigned int mFrame;
+        unsigned char * mMapped;
+
+    };
+};
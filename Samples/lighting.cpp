@@ -0,0 +1,594 @@
+// Local Headers
+#include "lighting.hpp"
+
+// System Headers
+#include <glm/gtc/type_ptr.hpp>
+
+// Standard Headers
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        // Declarations and Shading Shared by the Forward and Deferred Paths
+        char const * Shading = R"(
+            struct Light { vec4 position; vec4 color; };
+            layout(std430, binding = 4) readonly buffer Lights { Light lights[]; };
+            uniform uint lightCount;
+            const vec3 Ambient = vec3(0.03);
+
+            // Blinn-Phong With a Windowed Falloff That Reaches Zero at the Radius
+            vec3 shade(Light light, vec3 position, vec3 normal, vec3 albedo, float specular)
+            {
+                vec3 toLight = light.position.xyz - position;
+                float distance2 = dot(toLight, toLight);
+                float radius2 = light.position.w * light.position.w;
+                if (distance2 >= radius2) return vec3(0.0);
+                vec3 l = toLight * inversesqrt(max(distance2, 1e-8));
+                vec3 h = normalize(l + normalize(-position));
+                float falloff = 1.0 - distance2 / radius2;
+                float diffuse = max(dot(normal, l), 0.0);
+                float highlight = pow(max(dot(normal, h), 0.0), 32.0) * specular;
+                return light.color.rgb * light.color.w * falloff * falloff * (albedo * diffuse + highlight);
+            })";
+
+        char const * SurfaceVertex = R"(
+            layout(location = 0) in vec3 position;
+            layout(location = 1) in vec3 normal;
+            layout(location = 2) in vec2 uv;
+            uniform mat4 model;
+            uniform mat4 view;
+            uniform mat4 projection;
+            out vec3 viewPosition;
+            out vec3 viewNormal;
+            out vec2 texcoord;
+            void main()
+            {
+                vec4 p = view * model * vec4(position, 1.0);
+                viewPosition = p.xyz;
+                viewNormal = mat3(view * model) * normal;
+                texcoord = uv;
+                gl_Position = projection * p;
+            })";
+
+        char const * ForwardFragment = R"(
+            in vec3 viewPosition;
+            in vec3 viewNormal;
+            in vec2 texcoord;
+            uniform sampler2D diffuse;
+            uniform sampler2D specular;
+            uniform vec4 color;
+            out vec4 fragment;
+            void main()
+            {
+                vec3 albedo = color.rgb * texture(diffuse, texcoord).rgb;
+                float shininess = color.a * texture(specular, texcoord).r;
+                vec3 normal = normalize(viewNormal);
+                vec3 total = albedo * Ambient;
+                for (uint i = 0u; i < lightCount; i++)
+                    total += shade(lights[i], viewPosition, normal, albedo, shininess);
+                fragment = vec4(total, 1.0);
+            })";
+
+        char const * GeometryFragment = R"(
+            in vec3 viewPosition;
+            in vec3 viewNormal;
+            in vec2 texcoord;
+            uniform sampler2D diffuse;
+            uniform sampler2D specular;
+            uniform vec4 color;
+            layout(location = 0) out vec4 albedo;
+            layout(location = 1) out vec4 normal;
+            void main()
+            {
+                albedo = vec4(color.rgb * texture(diffuse, texcoord).rgb, color.a * texture(specular, texcoord).r);
+                normal = vec4(normalize(viewNormal), 0.0);
+            })";
+
+        // One Triangle Covering the Screen, Generated From gl_VertexID
+        char const * FullscreenVertex = R"(
+            void main()
+            {
+                vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+                gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+            })";
+
+        char const * Clusters = R"(
+            layout(std430, binding = 5) buffer Cells { uvec2 cells[]; };
+            layout(std430, binding = 6) buffer Indices { uint indices[]; };
+            uniform mat4 inverseProjection;
+            uniform uvec3 clusters;
+            uniform ivec2 screen;
+            uniform int tileSize;
+            uniform float zNear;
+            uniform float zFar;)";
+
+        char const * LightingFragment = R"(
+            uniform sampler2D albedoTexture;
+            uniform sampler2D normalTexture;
+            uniform sampler2D depthTexture;
+            out vec4 fragment;
+            void main()
+            {
+                ivec2 pixel = ivec2(gl_FragCoord.xy);
+                float depth = texelFetch(depthTexture, pixel, 0).r;
+                if (depth == 1.0) discard;
+                vec4 surface = texelFetch(albedoTexture, pixel, 0);
+                vec3 normal = texelFetch(normalTexture, pixel, 0).xyz;
+
+                // Reconstruct the View-Space Position, Then Find Its Cluster
+                vec2 ndc = (vec2(pixel) + 0.5) / vec2(screen) * 2.0 - 1.0;
+                vec4 p = inverseProjection * vec4(ndc, depth * 2.0 - 1.0, 1.0);
+                vec3 position = p.xyz / p.w;
+                float slice = floor(log(-position.z / zNear) / log(zFar / zNear) * float(clusters.z));
+                uint z = uint(clamp(slice, 0.0, float(clusters.z - 1u)));
+                uvec2 tile = uvec2(pixel) / uint(tileSize);
+                uvec2 cell = cells[tile.x + clusters.x * (tile.y + clusters.y * z)];
+
+                vec3 total = surface.rgb * Ambient;
+                for (uint i = 0u; i < cell.y; i++)
+                    total += shade(lights[indices[cell.x + i]], position, normal, surface.rgb, surface.a);
+                fragment = vec4(total, 1.0);
+            })";
+
+        // One Invocation per Cluster; Mirrors ClusterGrid::bounds() and bin()
+        char const * BinningCompute = R"(
+            layout(local_size_x = 64) in;
+            layout(std430, binding = 7) buffer Counter { uint next; };
+            uniform uint capacity;
+            void main()
+            {
+                uint cluster = gl_GlobalInvocationID.x;
+                if (cluster >= clusters.x * clusters.y * clusters.z) return;
+                int x = int(cluster % clusters.x);
+                int y = int((cluster / clusters.x) % clusters.y);
+                int z = int(cluster / (clusters.x * clusters.y));
+
+                float x0 = float(x * tileSize) / float(screen.x) * 2.0 - 1.0;
+                float x1 = float(min((x + 1) * tileSize, screen.x)) / float(screen.x) * 2.0 - 1.0;
+                float y0 = float(y * tileSize) / float(screen.y) * 2.0 - 1.0;
+                float y1 = float(min((y + 1) * tileSize, screen.y)) / float(screen.y) * 2.0 - 1.0;
+                float d0 = zNear * pow(zFar / zNear, float(z) / float(clusters.z));
+                float d1 = zNear * pow(zFar / zNear, float(z + 1) / float(clusters.z));
+                vec3 lower = vec3(3.0e38), upper = vec3(-3.0e38);
+                for (int i = 0; i < 4; i++)
+                {
+                    vec4 p = inverseProjection * vec4((i & 1) != 0 ? x1 : x0, (i & 2) != 0 ? y1 : y0, -1.0, 1.0);
+                    vec3 v = p.xyz / p.w;
+                    vec3 a = v * (d0 / -v.z), b = v * (d1 / -v.z);
+                    lower = min(lower, min(a, b));
+                    upper = max(upper, max(a, b));
+                }
+
+                uint found[MAX_LIGHTS];
+                uint count = 0u;
+                for (uint i = 0u; i < lightCount && count < uint(MAX_LIGHTS); i++)
+                {
+                    vec3 center = lights[i].position.xyz;
+                    vec3 d = clamp(center, lower, upper) - center;
+                    if (dot(d, d) <= lights[i].position.w * lights[i].position.w) found[count++] = i;
+                }
+                uint offset = atomicAdd(next, count);
+                count = offset >= capacity ? 0u : min(count, capacity - offset);
+                for (uint i = 0u; i < count; i++) indices[offset + i] = found[i];
+                cells[cluster] = uvec2(offset, count);
+            })";
+
+        GLuint texture(GLenum internal, GLenum format, GLenum type, int width, int height)
+        {
+            GLuint handle;
+            glGenTextures(1, & handle);
+            glBindTexture(GL_TEXTURE_2D, handle);
+            glTexImage2D(GL_TEXTURE_2D, 0, internal, width, height, 0, format, type, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+            return handle;
+        }
+    }
+
+    ClusterGrid::ClusterGrid(int width, int height, float zNear, float zFar, int tileSize, int slices)
+        : width(std::max(width, 1)), height(std::max(height, 1))
+        , tileSize(tileSize), slices(slices)
+        , tilesX((this->width  + tileSize - 1) / tileSize)
+        , tilesY((this->height + tileSize - 1) / tileSize)
+        , zNear(zNear), zFar(zFar) {}
+
+    int ClusterGrid::slice(float depth) const
+    {
+        float slice = std::floor(std::log(depth / zNear) / std::log(zFar / zNear) * slices);
+        return static_cast<int>(std::min(std::max(slice, 0.0f), float(slices - 1)));
+    }
+
+    Bounds ClusterGrid::bounds(std::size_t cluster, glm::mat4 const & inverseProjection) const
+    {
+        // Tile Corners on the Near Plane, Pushed Out Along Their Rays to Both Slice Depths
+        int x = static_cast<int>(cluster % tilesX);
+        int y = static_cast<int>((cluster / tilesX) % tilesY);
+        int z = static_cast<int>(cluster / (static_cast<std::size_t>(tilesX) * tilesY));
+        float x0 = float(x * tileSize) / float(width) * 2.0f - 1.0f;
+        float x1 = float(std::min((x + 1) * tileSize, width)) / float(width) * 2.0f - 1.0f;
+        float y0 = float(y * tileSize) / float(height) * 2.0f - 1.0f;
+        float y1 = float(std::min((y + 1) * tileSize, height)) / float(height) * 2.0f - 1.0f;
+        float d0 = zNear * std::pow(zFar / zNear, float(z) / float(slices));
+        float d1 = zNear * std::pow(zFar / zNear, float(z + 1) / float(slices));
+
+        Bounds bounds;
+        bounds.min = glm::vec3( 3.0e38f);
+        bounds.max = glm::vec3(-3.0e38f);
+        for (int i = 0; i < 4; i++)
+        {   glm::vec4 p = inverseProjection * glm::vec4((i & 1) ? x1 : x0, (i & 2) ? y1 : y0, -1.0f, 1.0f);
+            glm::vec3 v = glm::vec3(p.x, p.y, p.z) / p.w;
+            glm::vec3 a = v * (d0 / -v.z), b = v * (d1 / -v.z);
+            bounds.min = glm::min(bounds.min, glm::min(a, b));
+            bounds.max = glm::max(bounds.max, glm::max(a, b));
+        }   return bounds;
+    }
+
+    void bin(ClusterGrid const & grid, glm::mat4 const & projection,
+             std::vector<PointLight> const & lights, LightGrid & result, ThreadPool * pool)
+    {
+        // Each Slice Builds Its Own Lists; Concatenating in Order Keeps the Output Deterministic
+        glm::mat4 inverse = glm::inverse(projection);
+        std::size_t perSlice = static_cast<std::size_t>(grid.tilesX) * grid.tilesY;
+        std::vector<std::vector<std::uint32_t>> slices(grid.slices);
+        result.cells.assign(grid.size() * 2, 0);
+        auto slice = [&](std::size_t z)
+        {
+            std::vector<std::uint32_t> & list = slices[z];
+            for (std::size_t cluster = z * perSlice; cluster < (z + 1) * perSlice; cluster++)
+            {   Bounds box = grid.bounds(cluster, inverse);
+                std::uint32_t count = 0;
+                result.cells[cluster * 2] = static_cast<std::uint32_t>(list.size());
+                for (std::uint32_t i = 0; i < lights.size() && count < ClusteredRenderer::MaxLightsPerCluster; i++)
+                {   glm::vec3 center(lights[i].position.x, lights[i].position.y, lights[i].position.z);
+                    glm::vec3 d = glm::clamp(center, box.min, box.max) - center;
+                    if (glm::dot(d, d) <= lights[i].position.w * lights[i].position.w)
+                    {   list.push_back(i);
+                        count++;
+                    }
+                }   result.cells[cluster * 2 + 1] = count;
+            }
+        };
+        if (pool) pool->run(slices.size(), slice);
+        else for (std::size_t z = 0; z < slices.size(); z++) slice(z);
+
+        result.indices.clear();
+        for (std::size_t z = 0; z < slices.size(); z++)
+        {   std::uint32_t base = static_cast<std::uint32_t>(result.indices.size());
+            for (std::size_t cluster = z * perSlice; cluster < (z + 1) * perSlice; cluster++)
+                result.cells[cluster * 2] += base;
+            result.indices.insert(result.indices.end(), slices[z].begin(), slices[z].end());
+        }
+    }
+
+    ClusteredRenderer::ClusteredRenderer(int width, int height, std::size_t maxLights)
+        : mStream(GL_SHADER_STORAGE_BUFFER, (maxLights * sizeof(PointLight) + 256) * 3)
+        , mGrid(width, height)
+        , mMode(Mode::Deferred)
+        , mBinning(Binning::Gpu)
+        , mPool(nullptr)
+        , mMaxLights(maxLights)
+        , mCapacity(0)
+        , mDropped(0)
+        , mReadbackFrame(0)
+        , mAlignment(256)
+        , mFramebuffer(0)
+        , mCells(0)
+        , mIndices(0)
+        , mCounter(0)
+        , mReadback(0)
+    {
+        if (!GLAD_GL_VERSION_4_3 && !GLAD_GL_ARB_compute_shader)
+            fprintf(stderr, "Clustered Shading Requires Compute Shaders (OpenGL 4.3)\n");
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, & mAlignment);
+
+        // Every Stage Shares the Version Line; Fragments Are Assembled Per Program
+        std::string version = "#version 430 core\n";
+        std::string limit = "#define MAX_LIGHTS " + std::to_string(MaxLightsPerCluster) + "\n";
+        build(mForward,  { { GL_VERTEX_SHADER,   version + SurfaceVertex },
+                           { GL_FRAGMENT_SHADER, version + Shading + ForwardFragment } });
+        build(mGeometry, { { GL_VERTEX_SHADER,   version + SurfaceVertex },
+                           { GL_FRAGMENT_SHADER, version + GeometryFragment } });
+        build(mLighting, { { GL_VERTEX_SHADER,   version + FullscreenVertex },
+                           { GL_FRAGMENT_SHADER, version + Shading + Clusters + LightingFragment } });
+        build(mBinner,   { { GL_COMPUTE_SHADER,  version + limit + Shading + Clusters + BinningCompute } });
+
+        // Untextured Meshes Sample a Single White Texel
+        unsigned char white[] = { 255, 255, 255, 255 };
+        glGenTextures(1, & mWhite);
+        glBindTexture(GL_TEXTURE_2D, mWhite);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glGenVertexArrays(1, & mEmpty);
+        allocate();
+    }
+
+    ClusteredRenderer::~ClusteredRenderer()
+    {
+        release();
+        for (Program * program : { & mForward, & mGeometry, & mLighting, & mBinner })
+            glDeleteProgram(program->handle);
+        glDeleteTextures(1, & mWhite);
+        glDeleteVertexArrays(1, & mEmpty);
+    }
+
+    void ClusteredRenderer::build(Program & program, std::vector<std::pair<GLenum, std::string>> const & stages)
+    {
+        program.handle = glCreateProgram();
+        for (auto const & stage : stages)
+        {   GLuint shader = glCreateShader(stage.first);
+            char const * source = stage.second.c_str();
+            glShaderSource(shader, 1, & source, nullptr);
+            glCompileShader(shader);
+            GLint status, length;
+            glGetShaderiv(shader, GL_COMPILE_STATUS, & status);
+            if (!status)
+            {   glGetShaderiv(shader, GL_INFO_LOG_LENGTH, & length);
+                std::unique_ptr<char[]> buffer(new char[length + 1]());
+                glGetShaderInfoLog(shader, length, nullptr, buffer.get());
+                fprintf(stderr, "Clustered Shading Stage Failed to Compile\n%s", buffer.get());
+            }
+            glAttachShader(program.handle, shader);
+            glDeleteShader(shader);
+        }
+        glLinkProgram(program.handle);
+
+        // Resolve Every Active Uniform Once, Keyed by Hashed Name
+        GLint count = 0, length = 0;
+        glGetProgramiv(program.handle, GL_ACTIVE_UNIFORMS, & count);
+        glGetProgramiv(program.handle, GL_ACTIVE_UNIFORM_MAX_LENGTH, & length);
+        std::vector<char> name(length + 1);
+        for (GLint i = 0; i < count; i++)
+        {   GLint size; GLenum type;
+            glGetActiveUniform(program.handle, i, length + 1, nullptr, & size, & type, name.data());
+            GLint location = glGetUniformLocation(program.handle, name.data());
+            if (location != -1) program.uniforms.insert(name.data(), location);
+        }
+    }
+
+    void ClusteredRenderer::allocate()
+    {
+        // G-Buffer: Albedo With Specular in Alpha, View-Space Normal, Depth
+        GLint previous = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, & previous);
+        glGenFramebuffers(1, & mFramebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+        mTextures[0] = texture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, mGrid.width, mGrid.height);
+        mTextures[1] = texture(GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, mGrid.width, mGrid.height);
+        mTextures[2] = texture(GL_DEPTH_COMPONENT32F, GL_DEPTH_COMPONENT, GL_FLOAT, mGrid.width, mGrid.height);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mTextures[0], 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, mTextures[1], 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,  GL_TEXTURE_2D, mTextures[2], 0);
+        GLenum attachments[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glDrawBuffers(2, attachments);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            fprintf(stderr, "G-Buffer Is Incomplete\n");
+        glBindFramebuffer(GL_FRAMEBUFFER, previous);
+
+        // Room for a Quarter of the Longest Lists in Every Cluster
+        mCapacity = mGrid.size() * MaxLightsPerCluster / 4;
+        GLuint * buffers[] = { & mCells, & mIndices, & mCounter };
+        std::size_t sizes[] = { mGrid.size() * 2 * sizeof(GLuint), mCapacity * sizeof(GLuint), sizeof(GLuint) };
+        for (int i = 0; i < 3; i++)
+        {   glGenBuffers(1, buffers[i]);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, *buffers[i]);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, sizes[i], nullptr, GL_DYNAMIC_DRAW);
+        }
+
+        // So read() Finds an Empty List Before Any Binning
+        GLuint zero = 0;
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), & zero);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        glGenBuffers(1, & mReadback);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, mReadback);
+        glBufferData(GL_COPY_WRITE_BUFFER, sizeof(mFences) / sizeof(mFences[0]) * sizeof(GLuint), nullptr, GL_STREAM_READ);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        for (auto & fence : mFences) fence = nullptr;
+    }
+
+    void ClusteredRenderer::release()
+    {
+        glDeleteFramebuffers(1, & mFramebuffer);
+        glDeleteTextures(3, mTextures);
+        glDeleteBuffers(1, & mCells);
+        glDeleteBuffers(1, & mIndices);
+        glDeleteBuffers(1, & mCounter);
+        glDeleteBuffers(1, & mReadback);
+        for (auto fence : mFences) if (fence) glDeleteSync(fence);
+    }
+
+    void ClusteredRenderer::resize(int width, int height)
+    {
+        if (width == mGrid.width && height == mGrid.height) return;
+        release();
+        mGrid = ClusterGrid(width, height, mGrid.zNear, mGrid.zFar, mGrid.tileSize, mGrid.slices);
+        allocate();
+    }
+
+    void ClusteredRenderer::upload(glm::mat4 const & view)
+    {
+        // Lights Move Every Frame, So They Go Through the Stream in View Space
+        std::size_t count = std::min(mLights.size(), mMaxLights);
+        if (count < mLights.size())
+            fprintf(stderr, "Clustered Shading Keeps %zu of %zu Lights\n", count, mLights.size());
+        mViewLights.resize(count);
+        for (std::size_t i = 0; i < count; i++)
+        {   glm::vec4 position = view * glm::vec4(mLights[i].position.x, mLights[i].position.y, mLights[i].position.z, 1.0f);
+            mViewLights[i].position = glm::vec4(position.x, position.y, position.z, mLights[i].position.w);
+            mViewLights[i].color = mLights[i].color;
+        }
+
+        std::size_t bytes = std::max<std::size_t>(count, 1) * sizeof(PointLight);
+        StreamBuffer::Span span = mStream.Allocate(bytes, mAlignment);
+        if (!span.data) return;
+        if (count > 0) std::copy(mViewLights.begin(), mViewLights.end(), static_cast<PointLight *>(span.data));
+        mStream.Flush();
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 4, mStream.Buffer(), span.offset, bytes);
+    }
+
+    void ClusteredRenderer::cluster(glm::mat4 const & projection)
+    {
+        if (mBinning == Binning::Cpu)
+        {
+            bin(mGrid, projection, mViewLights, mCpuGrid, mPool);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, mIndices);
+            if (mCpuGrid.indices.size() > mCapacity)
+            {   mCapacity = mCpuGrid.indices.size();
+                glBufferData(GL_SHADER_STORAGE_BUFFER, mCapacity * sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+            }
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, mCpuGrid.indices.size() * sizeof(GLuint), mCpuGrid.indices.data());
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, mCells);
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, mCpuGrid.cells.size() * sizeof(GLuint), mCpuGrid.cells.data());
+            GLuint total = static_cast<GLuint>(mCpuGrid.indices.size());
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, mCounter);
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), & total);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        }
+        else poll();
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, mCells);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, mIndices);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, mCounter);
+        if (mBinning == Binning::Cpu) return;
+
+        // One Invocation per Cluster; the Counter Hands Out Ranges of the Index List
+        GLuint zero = 0;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mCounter);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), & zero);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        UniformTable const & uniforms = mBinner.uniforms;
+        glUseProgram(mBinner.handle);
+        glUniformMatrix4fv(uniforms.find("inverseProjection"), 1, GL_FALSE, glm::value_ptr(glm::inverse(projection)));
+        glUniform3ui(uniforms.find("clusters"), mGrid.tilesX, mGrid.tilesY, mGrid.slices);
+        glUniform2i(uniforms.find("screen"), mGrid.width, mGrid.height);
+        glUniform1i(uniforms.find("tileSize"), mGrid.tileSize);
+        glUniform1f(uniforms.find("zNear"), mGrid.zNear);
+        glUniform1f(uniforms.find("zFar"), mGrid.zFar);
+        glUniform1ui(uniforms.find("lightCount"), static_cast<GLuint>(mViewLights.size()));
+        glUniform1ui(uniforms.find("capacity"), static_cast<GLuint>(mCapacity));
+        glDispatchCompute(static_cast<GLuint>((mGrid.size() + 63) / 64), 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+        // Keep What the Binning Asked For; poll() Reads It Once the GPU Is Done.
+        // A Copy Still Pending After a Full Ring Is Given Up Rather Than Waited On
+        std::size_t slot = mReadbackFrame++ % (sizeof(mFences) / sizeof(mFences[0]));
+        if (mFences[slot]) glDeleteSync(mFences[slot]);
+        glBindBuffer(GL_COPY_READ_BUFFER, mCounter);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, mReadback);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, slot * sizeof(GLuint), sizeof(GLuint));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        mFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        mCapacities[slot] = mCapacity;
+    }
+
+    void ClusteredRenderer::poll()
+    {
+        for (std::size_t slot = 0; slot < sizeof(mFences) / sizeof(mFences[0]); slot++)
+        {
+            if (!mFences[slot]) continue;
+            GLenum status = glClientWaitSync(mFences[slot], 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED) continue;
+            glDeleteSync(mFences[slot]);
+            mFences[slot] = nullptr;
+            if (status == GL_WAIT_FAILED) continue;
+
+            // Clusters Past the End Kept Only the Lights That Fit; Grow Before Binning Again
+            GLuint requested = 0;
+            glBindBuffer(GL_COPY_READ_BUFFER, mReadback);
+            glGetBufferSubData(GL_COPY_READ_BUFFER, slot * sizeof(GLuint), sizeof(GLuint), & requested);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            if (requested <= mCapacities[slot]) continue;
+            mDropped += requested - mCapacities[slot];
+            fprintf(stderr, "Clustered Light List Dropped %zu of %u Indices\n", requested - mCapacities[slot], requested);
+            if (requested > mCapacity)
+            {   mCapacity = requested + requested / 4;
+                glBindBuffer(GL_SHADER_STORAGE_BUFFER, mIndices);
+                glBufferData(GL_SHADER_STORAGE_BUFFER, mCapacity * sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+                glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+            }
+        }
+    }
+
+    void ClusteredRenderer::render(glm::mat4 const & view, glm::mat4 const & projection,
+                                   std::function<void(Pass const &)> const & draw)
+    {
+        // Near and Far Planes Recovered From a Standard Perspective Matrix
+        mGrid.zNear = projection[3][2] / (projection[2][2] - 1.0f);
+        mGrid.zFar  = projection[3][2] / (projection[2][2] + 1.0f);
+        GLint target = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, & target);
+        upload(view);
+
+        // Surface Pass: Straight to the Target, or Into the G-Buffer
+        Program & surface = mMode == Mode::Forward ? mForward : mGeometry;
+        if (mMode == Mode::Deferred) glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+        glViewport(0, 0, mGrid.width, mGrid.height);
+        glEnable(GL_DEPTH_TEST);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glUseProgram(surface.handle);
+        glUniformMatrix4fv(surface.uniforms.find("view"), 1, GL_FALSE, glm::value_ptr(view));
+        glUniformMatrix4fv(surface.uniforms.find("projection"), 1, GL_FALSE, glm::value_ptr(projection));
+        glUniform1ui(surface.uniforms.find("lightCount"), static_cast<GLuint>(mViewLights.size()));
+        glUniform1i(surface.uniforms.find("diffuse"), 0);
+        glUniform1i(surface.uniforms.find("specular"), 1);
+        for (GLenum unit : { GL_TEXTURE1, GL_TEXTURE0 })
+        {   glActiveTexture(unit);
+            glBindTexture(GL_TEXTURE_2D, mWhite);
+        }
+        Pass pass = { surface.handle, surface.uniforms.find("model"), surface.uniforms.find("color") };
+        glUniform4f(pass.color, 1.0f, 1.0f, 1.0f, 1.0f);
+        draw(pass);
+
+        if (mMode == Mode::Deferred)
+        {
+            cluster(projection);
+
+            // Lighting Pass: Every Covered Pixel Against Its Own Cluster
+            glBindFramebuffer(GL_FRAMEBUFFER, target);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            glDisable(GL_DEPTH_TEST);
+            UniformTable const & uniforms = mLighting.uniforms;
+            glUseProgram(mLighting.handle);
+            char const * samplers[] = { "albedoTexture", "normalTexture", "depthTexture" };
+            for (int i = 0; i < 3; i++)
+            {   glActiveTexture(GL_TEXTURE0 + i);
+                glBindTexture(GL_TEXTURE_2D, mTextures[i]);
+                glUniform1i(uniforms.find(samplers[i]), i);
+            }
+            glUniformMatrix4fv(uniforms.find("inverseProjection"), 1, GL_FALSE, glm::value_ptr(glm::inverse(projection)));
+            glUniform3ui(uniforms.find("clusters"), mGrid.tilesX, mGrid.tilesY, mGrid.slices);
+            glUniform2i(uniforms.find("screen"), mGrid.width, mGrid.height);
+            glUniform1i(uniforms.find("tileSize"), mGrid.tileSize);
+            glUniform1f(uniforms.find("zNear"), mGrid.zNear);
+            glUniform1f(uniforms.find("zFar"), mGrid.zFar);
+            glBindVertexArray(mEmpty);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            glBindVertexArray(0);
+            glActiveTexture(GL_TEXTURE0);
+            glEnable(GL_DEPTH_TEST);
+        }
+        mStream.Advance();
+    }
+
+    void ClusteredRenderer::read(LightGrid & grid)
+    {
+        // Only Meaningful After a Deferred Frame; Waits for the GPU
+        GLuint total = 0;
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mCounter);
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), & total);
+        grid.cells.resize(mGrid.size() * 2);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mCells);
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, grid.cells.size() * sizeof(GLuint), grid.cells.data());
+        grid.indices.resize(std::min<std::size_t>(total, mCapacity));
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, mIndices);
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, grid.indices.size() * sizeof(GLuint), grid.indices.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+};
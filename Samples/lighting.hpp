@@ -0,0 +1,178 @@
+#pragma once
+
+// Local Headers
+#include "gpu_buffer.hpp"
+#include "mesh.hpp"
+#include "pool.hpp"
+#include "uniform.hpp"
+
+// System Headers
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Point Light; Matches This std430 Declaration
+    //
+    //     struct Light { vec4 position; vec4 color; };
+    //
+    // position.w is the radius past which the light contributes nothing, and
+    // color.w scales the color. Binning and shading expect view space.
+    struct PointLight
+    {
+        glm::vec4 position;
+        glm::vec4 color;
+    };
+
+    // Screen Tiles Times Exponential Depth Slices (Olsson et al., "Clustered Deferred and Forward Shading")
+    //
+    // Slice k spans zNear * (zFar / zNear)^(k / slices) to the next one, so
+    // clusters stay roughly cube-shaped at every distance. Clusters are
+    // numbered x fastest, then y, then slice.
+    struct ClusterGrid
+    {
+        // Implement Custom Constructor
+        ClusterGrid(int width = 1, int height = 1, float zNear = 0.1f, float zFar = 100.0f,
+                    int tileSize = 64, int slices = 24);
+
+        // Public Member Functions
+        std::size_t size() const { return static_cast<std::size_t>(tilesX) * tilesY * slices; }
+        int slice(float depth) const; // Positive Distance Along -Z
+        Bounds bounds(std::size_t cluster, glm::mat4 const & inverseProjection) const;
+
+        // Public Member Variables
+        int width, height, tileSize, slices, tilesX, tilesY;
+        float zNear, zFar;
+    };
+
+    // Per-Cluster Light Lists, Laid Out Exactly as the Shaders Read Them
+    //
+    //     layout(std430, binding = 5) buffer Cells { uvec2 cells[]; };    // offset, count
+    //     layout(std430, binding = 6) buffer Indices { uint indices[]; };
+    //
+    // Each list keeps lights in ascending order, so two binnings of the same
+    // scene can be compared list by list whatever their offsets.
+    struct LightGrid
+    {
+        std::vector<std::uint32_t> cells;
+        std::vector<std::uint32_t> indices;
+    };
+
+    // CPU Reference for the Compute Binning Pass; Same Box Test, Same Caps
+    void bin(ClusterGrid const & grid, glm::mat4 const & projection,
+             std::vector<PointLight> const & lights, LightGrid & result, ThreadPool * pool = nullptr);
+
+    // Forward or Clustered Deferred Shading of Many Point Lights
+    //
+    // The forward path loops over every light for every fragment of every
+    // object, which is the baseline the deferred path is measured against.
+    // The deferred path writes albedo, specular and view-space normals to a
+    // G-buffer, bins lights into clusters with a compute shader (or on the
+    // CPU, for comparison), then shades each pixel against its cluster only.
+    // Both paths switch freely between frames. Lights are uploaded each frame
+    // through a StreamBuffer. Shader storage bindings 4 to 7 are taken; the
+    // draw callback must set model and color for each object before drawing
+    // it. Requires OpenGL 4.3 or ARB_compute_shader. When the GPU binning runs
+    // out of room in the light index list, clusters past the end keep only
+    // the lights that fit. Each binning's total is copied aside behind a
+    // fence and checked a frame or more later without waiting on the GPU; an
+    // overflow then grows the list, and dropped() counts what was lost.
+    class ClusteredRenderer
+    {
+    public:
+
+        enum class Mode { Forward, Deferred };
+        enum class Binning { Gpu, Cpu };
+
+        // Uniform Locations the Draw Callback Sets
+        struct Pass
+        {
+            GLuint program;
+            GLint model;
+            GLint color;
+        };
+
+        // Implement Custom Constructor and Destructor
+         ClusteredRenderer(int width, int height, std::size_t maxLights = 1024);
+        ~ClusteredRenderer();
+
+        // Public Member Functions
+        void resize(int width, int height);
+        void render(glm::mat4 const & view, glm::mat4 const & projection,
+                    std::function<void(Pass const &)> const & draw);
+        void read(LightGrid & grid); // Last Binning Result, Read Back From the GPU
+        std::vector<PointLight> & lights() { return mLights; }
+        ClusterGrid const & grid() const { return mGrid; }
+        Mode mode() const { return mMode; }
+        Binning binning() const { return mBinning; }
+        void mode(Mode mode) { mMode = mode; }
+        void binning(Binning binning) { mBinning = binning; }
+        void pool(ThreadPool * pool) { mPool = pool; }
+        std::uint64_t dropped() const { return mDropped; } // Indices the GPU Binning Had No Room For, So Far
+
+        // Longest List a Cluster Keeps; Further Lights Are Dropped
+        static const std::uint32_t MaxLightsPerCluster = 128;
+
+    private:
+
+        // Disable Copying and Assignment
+        ClusteredRenderer(ClusteredRenderer const &) = delete;
+        ClusteredRenderer & operator=(ClusteredRenderer const &) = delete;
+
+        // Linked Program With Its Uniforms Reflected Once
+        struct Program
+        {
+            GLuint handle;
+            UniformTable uniforms;
+        };
+
+        // Private Member Functions
+        static void build(Program & program, std::vector<std::pair<GLenum, std::string>> const & stages);
+        void allocate();
+        void release();
+        void upload(glm::mat4 const & view);
+        void cluster(glm::mat4 const & projection);
+        void poll(); // Checks Finished Binnings for Overflow
+
+        // Private Member Containers
+        std::vector<PointLight> mLights;
+        std::vector<PointLight> mViewLights;
+        LightGrid mCpuGrid;
+        StreamBuffer mStream;
+
+        // Private Member Variables
+        ClusterGrid mGrid;
+        Mode mMode;
+        Binning mBinning;
+        ThreadPool * mPool;
+        std::size_t mMaxLights;
+        std::size_t mCapacity;
+        std::uint64_t mDropped;
+        unsigned int mReadbackFrame;
+        GLint mAlignment;
+        Program mForward;
+        Program mGeometry;
+        Program mLighting;
+        Program mBinner;
+        GLuint mFramebuffer;
+        GLuint mTextures[3]; // Albedo and Specular, Normal, Depth
+        GLuint mWhite;
+        GLuint mEmpty;
+        GLuint mCells;
+        GLuint mIndices;
+        GLuint mCounter;
+        GLuint mReadback;             // Counter Copies, One per Binning in Flight
+        GLsync mFences[3];
+        std::size_t mCapacities[3];   // Each Copy's Capacity When It Was Binned
+
+    };
+};
@@ -0,0 +1,215 @@
+// Local Headers
+#include "cache.hpp"
+#include "loader.hpp"
+
+// System Headers
+#include <stb_image.h>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Standard Headers
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        // Bump Whenever the Encoders or the Mip Filters Change Their Output
+        const std::uint32_t TextureVersion = 1;
+    }
+
+    Image::~Image() { if (pixels) stbi_image_free(pixels); }
+
+    AssetLoader::AssetLoader(unsigned int workers, Upload upload)
+        : mFilter(MipFilter::Box)
+        , mUpload(upload ? upload : Upload(& AssetLoader::create))
+        , mPending(0)
+        , mPool(workers)
+    {}
+
+    AssetLoader & AssetLoader::instance()
+    {
+        // Never Destroyed, Like BufferHeap::Default(); Its Workers Just Idle Until Exit
+        static AssetLoader * loader = []()
+        {   AssetLoader * shared = new AssetLoader(std::thread::hardware_concurrency());
+            shared->compress(PROJECT_SOURCE_DIR "/Mirage/Cache");
+            return shared;
+        }();
+        return *loader;
+    }
+
+    std::size_t AssetLoader::request(std::string const & filename)
+    {
+        std::size_t handle = mTextures.size();
+        return request(filename, [this, handle](Image const & image)
+                                 { mTextures[handle] = mUpload(image); });
+    }
+
+    std::size_t AssetLoader::request(std::string const & filename, Callback callback)
+    {
+        std::size_t handle = mTextures.size();
+        mTextures.push_back(0);
+        mCallbacks.push_back(callback);
+        {   std::lock_guard<std::mutex> lock(mMutex);
+            mPending++;
+        }
+
+        // Decode Off-Thread; Failures Still Enqueue So finish() Terminates
+        std::string directory = mCompressed;
+        MipFilter filter = mFilter;
+        mPool.submit([this, handle, filename, directory, filter]()
+        {
+            std::unique_ptr<Image> image(new Image);
+            image->handle = handle;
+            image->filename = filename;
+
+            // Compressed Copies Are Keyed by the Source Contents, Like the Mesh Cache
+            std::uint64_t key = 0;
+            std::string cached;
+            if (!directory.empty())
+            {   MappedFile source;
+                if (source.open(filename))
+                {   key = MeshCache::hash(source.data(), source.size());
+                    key = MeshCache::hash(& TextureVersion, sizeof(TextureVersion), key);
+                    key = MeshCache::hash(& filter, sizeof(filter), key);
+                }
+                char suffix[32];
+                std::snprintf(suffix, sizeof(suffix), ".%016llx.dds",
+                              static_cast<unsigned long long>(MeshCache::hash(filename.data(), filename.size())));
+                cached = directory + "/" + filename.substr(filename.find_last_of("/\\") + 1) + suffix;
+            }
+
+            if (key == 0 || !loadDDS(cached, image->compressed, key))
+            {
+                image->pixels = stbi_load(filename.c_str(), & image->width, & image->height, & image->channels, 0);
+                if (!image->pixels) fprintf(stderr, "%s %s\n", "Failed to Load Texture", filename.c_str());
+                else if (key != 0)
+                {   image->compressed = Mirage::compress(image->pixels, image->width, image->height,
+                                                         image->channels, filter);
+                    saveDDS(cached, image->compressed, key);
+                    stbi_image_free(image->pixels);
+                    image->pixels = nullptr;
+                }
+            }
+            if (!image->compressed.levels.empty())
+            {   image->width    = image->compressed.levels[0].width;
+                image->height   = image->compressed.levels[0].height;
+                image->channels = image->compressed.channels;
+            }
+
+            {   std::lock_guard<std::mutex> lock(mMutex);
+                mReady.push_back(std::move(image));
+            }   mSignal.notify_one();
+        });
+        return handle;
+    }
+
+    std::size_t AssetLoader::upload(std::size_t budget)
+    {
+        // Upload at Most budget Images, So Callers Can Spread Work Across Frames
+        std::size_t uploaded = 0;
+        while (uploaded < budget)
+        {
+            std::unique_ptr<Image> image;
+            {   std::lock_guard<std::mutex> lock(mMutex);
+                if (mReady.empty()) break;
+                image = std::move(mReady.front());
+                mReady.pop_front();
+                mPending--;
+            }
+            if (image->pixels || !image->compressed.levels.empty()) mCallbacks[image->handle](*image);
+            mCallbacks[image->handle] = nullptr;
+            uploaded++;
+        }   return uploaded;
+    }
+
+    void AssetLoader::finish()
+    {
+        for (;;)
+        {
+            {   std::unique_lock<std::mutex> lock(mMutex);
+                mSignal.wait(lock, [this]() { return mPending == 0 || !mReady.empty(); });
+                if (mPending == 0) return;
+            }   upload(mTextures.size());
+        }
+    }
+
+    void AssetLoader::compress(std::string const & directory, MipFilter filter)
+    {
+#ifdef _WIN32
+        _mkdir(directory.c_str());
+#else
+        mkdir(directory.c_str(), 0755);
+#endif
+        mCompressed = directory;
+        mFilter = filter;
+    }
+
+    // RGTC Is Core; S3TC Is Only There If the Driver Lists It
+    bool AssetLoader::supported(GLenum format)
+    {
+        if (format == GL_COMPRESSED_RED_RGTC1 || format == GL_COMPRESSED_RG_RGTC2) return true;
+        static std::vector<GLint> formats;
+        if (formats.empty())
+        {   GLint count = 0;
+            glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, & count);
+            formats.resize(count + 1); // The Spare Zero Keeps an Empty List From Being Requeried
+            if (count > 0) glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+        }   return std::find(formats.begin(), formats.end(), static_cast<GLint>(format)) != formats.end();
+    }
+
+    GLuint AssetLoader::create(Image const & image)
+    {
+        // Set the Correct Channel Format
+        GLenum format = GL_RGB;
+        switch (image.channels)
+        {
+            case 1 : format = GL_ALPHA;     break;
+            case 2 : format = GL_LUMINANCE; break;
+            case 3 : format = GL_RGB;       break;
+            case 4 : format = GL_RGBA;      break;
+        }
+
+        // Bind Texture and Set Filtering Levels
+        GLuint texture;
+        glGenTextures(1, & texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        if (image.compressed.levels.empty())
+        {   glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height,
+                         0, format, GL_UNSIGNED_BYTE, image.pixels);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            glBindTexture(GL_TEXTURE_2D, 0);
+            return texture;
+        }
+
+        // Stream Every Prebuilt Level; Decode on the CPU Only If the Driver Lacks the Format
+        auto const & compressed = image.compressed;
+        GLenum internal = compressed.internalFormat();
+        bool native = supported(internal);
+        std::vector<unsigned char> rgba;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(compressed.levels.size() - 1));
+        for (std::size_t i = 0; i < compressed.levels.size(); i++)
+        {   auto const & level = compressed.levels[i];
+            if (native)
+                glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), internal, level.width, level.height,
+                                       0, static_cast<GLsizei>(level.size), & compressed.data[level.offset]);
+            else
+            {   decompress(compressed, i, rgba);
+                glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), GL_RGBA8, level.width, level.height,
+                             0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+            }
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+// Local Headers
+#include "compress.hpp"
+#include "pool.hpp"
+
+// System Headers
+#include <glad/glad.h>
+
+// Standard Headers
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Decoded Image Waiting for Upload; Owns the stb_image Allocation
+    struct Image
+    {
+         Image() : handle(0), width(0), height(0), channels(0), pixels(nullptr) {}
+        ~Image();
+
+        std::size_t handle;
+        std::string filename;
+        int width;
+        int height;
+        int channels;
+        unsigned char * pixels;
+        CompressedImage compressed; // Used Instead of pixels When It Has Levels
+
+    private:
+
+        // Disable Copying and Assignment
+        Image(Image const &) = delete;
+        Image & operator=(Image const &) = delete;
+
+    };
+
+    // Decodes Images on a Thread Pool and Uploads Them on the GL Thread
+    //
+    // request() may be called from the thread owning the GL context only;
+    // decoding then runs on the workers, and the finished images wait in a
+    // queue until upload() or finish() hands them to the upload function, or
+    // to the callback given with the request. After compress(), workers also
+    // build the mip chain and block-compress it, keeping the result as a DDS
+    // file in the given directory so later runs skip decoding entirely.
+    class AssetLoader
+    {
+    public:
+
+        // Upload Hook; Defaults to glTexImage2D, Replaceable for Headless Use
+        typedef std::function<GLuint(Image const &)> Upload;
+        typedef std::function<void(Image const &)> Callback;
+
+        // Implement Custom Constructor
+        AssetLoader(unsigned int workers, Upload upload = Upload());
+
+        // Public Member Functions
+        std::size_t request(std::string const & filename);
+        std::size_t request(std::string const & filename, Callback callback);
+        std::size_t upload(std::size_t budget);
+        void finish();
+        void compress(std::string const & directory, MipFilter filter = MipFilter::Box);
+        GLuint texture(std::size_t handle) const { return mTextures[handle]; }
+        ThreadPool & pool() { return mPool; }
+
+        // Default OpenGL Upload with Mipmaps
+        static GLuint create(Image const & image);
+
+        // Whether the Driver Takes a Compressed Format as Is, Without decompress()
+        static bool supported(GLenum internalFormat);
+
+        // Shared Loader for Meshes Given No Loader; Compresses Into Mirage/Cache
+        static AssetLoader & instance();
+
+    private:
+
+        // Disable Copying and Assignment
+        AssetLoader(AssetLoader const &) = delete;
+        AssetLoader & operator=(AssetLoader const &) = delete;
+
+        // Private Member Containers
+        std::deque<std::unique_ptr<Image>> mReady;
+        std::vector<Callback> mCallbacks;
+        std::vector<GLuint> mTextures;
+
+        // Private Member Variables
+        std::string mCompressed;
+        MipFilter mFilter;
+        Upload mUpload;
+        std::size_t mPending;
+        std::mutex mMutex;
+        std::condition_variable mSignal;
+        ThreadPool mPool;
+
+    };
+};
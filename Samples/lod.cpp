@@ -0,0 +1,431 @@
+// Local Headers
+#include "lod.hpp"
+#include "optimize.hpp"
+
+// Standard Headers
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        // Levels Below This Many Triangles Are Not Worth a Draw Call of Their Own
+        const std::size_t MinimumTriangles = 16;
+
+        // Open Edges Resist Moving Inwards This Many Times More Than Faces Resist Bending
+        const double BorderWeight = 10.0;
+
+        // Symmetric 4x4 Quadric as Its Upper Triangle, Plus the Total Weight Added
+        struct Quadric
+        {
+            Quadric() : weight(0.0) { std::fill(q, q + 10, 0.0); }
+
+            void add(double a, double b, double c, double d, double w)
+            {
+                q[0] += w * a * a; q[1] += w * a * b; q[2] += w * a * c; q[3] += w * a * d;
+                q[4] += w * b * b; q[5] += w * b * c; q[6] += w * b * d;
+                q[7] += w * c * c; q[8] += w * c * d; q[9] += w * d * d;
+                weight += w;
+            }
+
+            void add(Quadric const & other)
+            {
+                for (int i = 0; i < 10; i++) q[i] += other.q[i];
+                weight += other.weight;
+            }
+
+            // Weighted Sum of Squared Distances to Every Plane Added
+            double evaluate(double x, double y, double z) const
+            {
+                return q[0] * x * x + 2.0 * q[1] * x * y + 2.0 * q[2] * x * z + 2.0 * q[3] * x
+                     + q[4] * y * y + 2.0 * q[5] * y * z + 2.0 * q[6] * y
+                     + q[7] * z * z + 2.0 * q[8] * z + q[9];
+            }
+
+            double q[10];
+            double weight;
+        };
+
+        // Edge Collapse State Shared by simplify() and generateLevels()
+        //
+        // Vertices are welded into groups by position; quadrics, adjacency and
+        // collapses all work on groups, while triangles keep pointing at the
+        // original vertices so attributes survive. Collapsing group U into V
+        // moves every vertex of U to the vertex of V it shares an edge with.
+        class Simplifier
+        {
+        public:
+
+            Simplifier(std::vector<Vertex> const & vertices, std::vector<GLuint> const & indices);
+
+            // Collapse Until targetIndexCount; False If maxError or the Topology Stops It First
+            bool run(std::size_t targetIndexCount, float maxError);
+            void extract(std::vector<GLuint> & result) const;
+            std::size_t indexCount() const { return mLive * 3; }
+            float error() const { return mError; }
+
+        private:
+
+            struct Candidate
+            {
+                float cost;
+                GLuint from, to;
+                std::uint32_t stamp;
+                bool operator<(Candidate const & other) const { return cost > other.cost; }
+            };
+
+            bool evaluate(GLuint from, GLuint to, std::vector<GLuint> const & around, float & cost);
+            void consider(GLuint group);
+            void collapse(GLuint from, GLuint to);
+            void neighbours(GLuint group, std::vector<GLuint> & result) const;
+            GLuint corner(std::uint32_t face, GLuint group) const;
+
+            std::vector<GLuint> mGroups;
+            std::vector<glm::vec3> mPoints;
+            std::vector<Quadric> mQuadrics;
+            std::vector<std::vector<std::uint32_t>> mFaces;
+            std::vector<GLuint> mTriangles;
+            std::vector<bool> mAlive;
+            std::vector<bool> mBorder;
+            std::vector<bool> mLocked;
+            std::vector<bool> mQueued;
+            std::vector<std::uint32_t> mStamps;
+            std::priority_queue<Candidate> mQueue;
+            std::vector<std::pair<GLuint, GLuint>> mPartners;
+            std::vector<GLuint> mAround, mTo;
+            std::size_t mLive;
+            float mError;
+        };
+
+        Simplifier::Simplifier(std::vector<Vertex> const & vertices, std::vector<GLuint> const & indices)
+            : mGroups(vertices.size()), mTriangles(indices), mAlive(indices.size() / 3, false), mLive(0), mError(0.0f)
+        {
+            // Weld Vertices With Identical Positions, Whatever Their Other Attributes
+            std::vector<GLuint> order(vertices.size());
+            std::iota(order.begin(), order.end(), 0);
+            auto less = [&](GLuint a, GLuint b)
+            {   glm::vec3 const & p = vertices[a].position, & q = vertices[b].position;
+                return p.x < q.x || (p.x == q.x && (p.y < q.y || (p.y == q.y && p.z < q.z)));
+            };
+            std::sort(order.begin(), order.end(), less);
+            for (std::size_t i = 0; i < order.size(); i++)
+            {   if (i == 0 || less(order[i - 1], order[i])) mPoints.push_back(vertices[order[i]].position);
+                mGroups[order[i]] = static_cast<GLuint>(mPoints.size() - 1);
+            }
+
+            std::size_t groups = mPoints.size();
+            mQuadrics.resize(groups);
+            mFaces.resize(groups);
+            mBorder.assign(groups, false);
+            mLocked.assign(groups, false);
+            mQueued.assign(groups, false);
+            mStamps.assign(groups, 0);
+
+            // Area-Weighted Face Planes; Triangles Already Degenerate After Welding Are Dropped
+            std::unordered_map<std::uint64_t, std::pair<std::uint32_t, std::uint32_t>> edges;
+            for (std::uint32_t f = 0; f < mAlive.size(); f++)
+            {
+                GLuint g[3] = { mGroups[mTriangles[f * 3]], mGroups[mTriangles[f * 3 + 1]], mGroups[mTriangles[f * 3 + 2]] };
+                if (g[0] == g[1] || g[1] == g[2] || g[0] == g[2]) continue;
+                mAlive[f] = true;
+                mLive++;
+                for (int k = 0; k < 3; k++)
+                {   mFaces[g[k]].push_back(f);
+                    GLuint a = std::min(g[k], g[(k + 1) % 3]), b = std::max(g[k], g[(k + 1) % 3]);
+                    auto & edge = edges[(static_cast<std::uint64_t>(a) << 32) | b];
+                    edge.first++;
+                    edge.second = f;
+                }
+
+                glm::vec3 normal = glm::cross(mPoints[g[1]] - mPoints[g[0]], mPoints[g[2]] - mPoints[g[0]]);
+                float length = glm::length(normal);
+                if (length == 0.0f) continue;
+                normal = normal / length;
+                for (int k = 0; k < 3; k++)
+                    mQuadrics[g[k]].add(normal.x, normal.y, normal.z, -glm::dot(normal, mPoints[g[0]]), length * 0.5);
+            }
+
+            // Open Edges Get a Plane Through Them, Perpendicular to Their Face; Non-Manifold Ones Stay Put
+            for (auto const & edge : edges)
+            {
+                GLuint a = static_cast<GLuint>(edge.first >> 32), b = static_cast<GLuint>(edge.first & 0xffffffffu);
+                if (edge.second.first > 2) mLocked[a] = mLocked[b] = true;
+                if (edge.second.first != 1) continue;
+                mBorder[a] = mBorder[b] = true;
+
+                std::uint32_t f = edge.second.second;
+                glm::vec3 const & p0 = mPoints[mGroups[mTriangles[f * 3]]];
+                glm::vec3 normal = glm::cross(mPoints[mGroups[mTriangles[f * 3 + 1]]] - p0,
+                                              mPoints[mGroups[mTriangles[f * 3 + 2]]] - p0);
+                glm::vec3 along = mPoints[b] - mPoints[a];
+                glm::vec3 plane = glm::cross(along, normal);
+                float length = glm::length(plane);
+                if (length == 0.0f) continue;
+                plane = plane / length;
+                double weight = BorderWeight * glm::dot(along, along);
+                double d = -glm::dot(plane, mPoints[a]);
+                mQuadrics[a].add(plane.x, plane.y, plane.z, d, weight);
+                mQuadrics[b].add(plane.x, plane.y, plane.z, d, weight);
+            }
+
+            for (GLuint g = 0; g < groups; g++) consider(g);
+        }
+
+        GLuint Simplifier::corner(std::uint32_t face, GLuint group) const
+        {
+            for (int k = 0; k < 3; k++)
+                if (mGroups[mTriangles[face * 3 + k]] == group) return mTriangles[face * 3 + k];
+            return ~0u;
+        }
+
+        void Simplifier::neighbours(GLuint group, std::vector<GLuint> & result) const
+        {
+            result.clear();
+            for (auto f : mFaces[group])
+            {   if (!mAlive[f]) continue;
+                for (int k = 0; k < 3; k++)
+                {   GLuint g = mGroups[mTriangles[f * 3 + k]];
+                    if (g != group) result.push_back(g);
+                }
+            }
+            std::sort(result.begin(), result.end());
+            result.erase(std::unique(result.begin(), result.end()), result.end());
+        }
+
+        bool Simplifier::evaluate(GLuint from, GLuint to, std::vector<GLuint> const & around, float & cost)
+        {
+            if (mLocked[from]) return false;
+
+            // Every Copy of the Moving Vertex Needs Exactly One Partner Across a Shared Edge
+            mPartners.clear();
+            std::size_t shared = 0;
+            for (auto f : mFaces[from])
+            {
+                if (!mAlive[f]) continue;
+                GLuint u = corner(f, from), v = corner(f, to);
+                if (v == ~0u) continue;
+                shared++;
+                auto partner = std::find_if(mPartners.begin(), mPartners.end(),
+                                            [u](std::pair<GLuint, GLuint> const & p) { return p.first == u; });
+                if (partner == mPartners.end()) mPartners.push_back(std::make_pair(u, v));
+                else if (partner->second != v) return false;
+            }
+            if (shared == 0 || (mBorder[from] && (!mBorder[to] || shared != 1))) return false;
+            for (auto f : mFaces[from])
+            {   if (!mAlive[f]) continue;
+                GLuint u = corner(f, from);
+                if (std::find_if(mPartners.begin(), mPartners.end(),
+                    [u](std::pair<GLuint, GLuint> const & p) { return p.first == u; }) == mPartners.end()) return false;
+            }
+
+            // Link Condition: Only the Faces Being Removed May Share Both Endpoints
+            neighbours(to, mTo);
+            std::vector<GLuint>::const_iterator a = around.begin(), b = mTo.begin();
+            std::size_t common = 0;
+            while (a != around.end() && b != mTo.end())
+                if (*a < *b) ++a; else if (*b < *a) ++b; else { common++; ++a; ++b; }
+            if (common > shared) return false;
+
+            // Reject Collapses That Fold a Surviving Face Over or Rotate It Too Far
+            glm::vec3 const & target = mPoints[to];
+            for (auto f : mFaces[from])
+            {
+                if (!mAlive[f] || corner(f, to) != ~0u) continue;
+                glm::vec3 p[3], q[3];
+                for (int k = 0; k < 3; k++)
+                {   GLuint g = mGroups[mTriangles[f * 3 + k]];
+                    p[k] = mPoints[g];
+                    q[k] = g == from ? target : p[k];
+                }
+                glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                glm::vec3 after  = glm::cross(q[1] - q[0], q[2] - q[0]);
+                if (glm::dot(before, after) <= 0.25f * glm::length(before) * glm::length(after)) return false;
+            }
+
+            Quadric quadric = mQuadrics[from];
+            quadric.add(mQuadrics[to]);
+            double error = quadric.weight > 0.0 ? quadric.evaluate(target.x, target.y, target.z) / quadric.weight : 0.0;
+            cost = static_cast<float>(std::sqrt(std::max(error, 0.0)));
+            return true;
+        }
+
+        void Simplifier::consider(GLuint group)
+        {
+            // Queue the Cheapest Legal Collapse of This Group; Older Entries Are Ignored
+            neighbours(group, mAround);
+            Candidate best = { 0.0f, group, 0, ++mStamps[group] };
+            bool found = false;
+            for (auto to : mAround)
+            {   float cost;
+                if (evaluate(group, to, mAround, cost) && (!found || cost < best.cost))
+                {   best.cost = cost;
+                    best.to = to;
+                    found = true;
+                }
+            }
+            mQueued[group] = found;
+            if (found) mQueue.push(best);
+        }
+
+        void Simplifier::collapse(GLuint from, GLuint to)
+        {
+            // evaluate() Just Filled mPartners for This Pair
+            for (auto f : mFaces[from])
+            {
+                if (!mAlive[f]) continue;
+                bool degenerate = false;
+                for (int k = 0; k < 3; k++)
+                {   GLuint & index = mTriangles[f * 3 + k];
+                    if (mGroups[index] == to) degenerate = true;
+                    if (mGroups[index] != from) continue;
+                    for (auto const & partner : mPartners)
+                        if (partner.first == index) { index = partner.second; break; }
+                }
+                if (degenerate) { mAlive[f] = false; mLive--; }
+                else mFaces[to].push_back(f);
+            }
+            mFaces[from].clear();
+            mFaces[from].shrink_to_fit();
+            auto & faces = mFaces[to];
+            faces.erase(std::remove_if(faces.begin(), faces.end(), [this](std::uint32_t f) { return !mAlive[f]; }), faces.end());
+            mQuadrics[to].add(mQuadrics[from]);
+
+            // Queued Neighbours Are Checked Again When Popped; Only Find Options for the Rest
+            std::vector<GLuint> around;
+            neighbours(to, around);
+            consider(to);
+            for (auto g : around)
+                if (!mQueued[g]) consider(g);
+        }
+
+        bool Simplifier::run(std::size_t targetIndexCount, float maxError)
+        {
+            while (mLive * 3 > targetIndexCount && !mQueue.empty())
+            {
+                Candidate candidate = mQueue.top();
+                mQueue.pop();
+                if (candidate.stamp != mStamps[candidate.from]) continue;
+                mQueued[candidate.from] = false;
+
+                // Neighbouring Collapses May Have Made This One Illegal or Dearer Since It Was Queued
+                float cost;
+                neighbours(candidate.from, mAround);
+                if (!evaluate(candidate.from, candidate.to, mAround, cost) || cost > candidate.cost * 1.001f + 1e-12f)
+                {   consider(candidate.from);
+                    continue;
+                }
+                if (cost > maxError)
+                {   mQueue.push(candidate);
+                    mQueued[candidate.from] = true;
+                    return false;
+                }
+                collapse(candidate.from, candidate.to);
+                mError = std::max(mError, cost);
+            }   return mLive * 3 <= targetIndexCount;
+        }
+
+        void Simplifier::extract(std::vector<GLuint> & result) const
+        {
+            result.clear();
+            result.reserve(mLive * 3);
+            for (std::size_t f = 0; f < mAlive.size(); f++)
+                if (mAlive[f]) result.insert(result.end(), mTriangles.begin() + f * 3, mTriangles.begin() + f * 3 + 3);
+        }
+    }
+
+    float simplify(std::vector<Vertex> const & vertices, std::vector<GLuint> const & indices,
+                   std::size_t targetIndexCount, float maxError, std::vector<GLuint> & result)
+    {
+        Simplifier simplifier(vertices, indices);
+        simplifier.run(targetIndexCount, maxError);
+        simplifier.extract(result);
+        return simplifier.error();
+    }
+
+    void generateLevels(MeshData & mesh, std::size_t maxLevels, float ratio, float maxError)
+    {
+        mesh.lodIndices.clear();
+        mesh.lods.clear();
+        if (mesh.indices.size() < MinimumTriangles * 6) return;
+
+        // One Simplifier Runs Through Every Level, Each Continuing From the Last
+        float limit = maxError * glm::length(mesh.bounds.max - mesh.bounds.min);
+        Simplifier simplifier(mesh.vertices, mesh.indices);
+        std::size_t previous = mesh.indices.size();
+        std::vector<GLuint> level;
+        while (mesh.lods.size() < maxLevels)
+        {
+            std::size_t target = static_cast<std::size_t>(previous / 3 * ratio) * 3;
+            if (target < MinimumTriangles * 3) break;
+            bool reached = simplifier.run(target, limit);
+
+            // A Level Has to Save at Least a Tenth of the One Before to Be Worth Its Memory
+            if (simplifier.indexCount() * 10 > previous * 9) break;
+            simplifier.extract(level);
+            optimizeVertexCache(level, mesh.vertices.size());
+            LevelOfDetail lod = { static_cast<std::uint32_t>(mesh.lodIndices.size()),
+                                  static_cast<std::uint32_t>(level.size()), simplifier.error() };
+            mesh.lodIndices.insert(mesh.lodIndices.end(), level.begin(), level.end());
+            mesh.lods.push_back(lod);
+            previous = level.size();
+            if (!reached) break;
+        }
+    }
+
+    void LodSelector::viewport(glm::mat4 const & projection, int height)
+    {
+        // A Model-Space Length at Unit Distance, in Pixels
+        mPixelsPerUnit = projection[1][1] * height * 0.5f;
+    }
+
+    std::size_t LodSelector::select(std::size_t instance, Mesh const & mesh, glm::mat4 const & modelView)
+    {
+        // Distance to the Bounding Sphere, and Errors Scaled Into View Space
+        Bounds bounds = mesh.extent();
+        glm::vec3 center = (bounds.min + bounds.max) * 0.5f;
+        float radius = glm::length(bounds.max - bounds.min) * 0.5f;
+        float scale = 0.0f;
+        for (int axis = 0; axis < 3; axis++)
+            scale = std::max(scale, glm::length(glm::vec3(modelView[axis].x, modelView[axis].y, modelView[axis].z)));
+        glm::vec4 view = modelView * glm::vec4(center.x, center.y, center.z, 1.0f);
+        float distance = glm::length(glm::vec3(view.x, view.y, view.z)) - radius * scale;
+
+        mErrors.resize(mesh.levels());
+        for (std::size_t level = 0; level < mErrors.size(); level++)
+            mErrors[level] = mesh.error(level) * scale;
+        return select(instance, mErrors.data(), mErrors.size(), distance);
+    }
+
+    std::size_t LodSelector::select(std::size_t instance, float const * errors, std::size_t levels, float distance)
+    {
+        // New Instances Start From the Full Mesh and Do Not Count as Switching
+        bool fresh = instance >= mLevels.size();
+        if (fresh) mLevels.resize(instance + 1, 0);
+        std::size_t current = std::min<std::size_t>(mLevels[instance], levels - 1), target = current;
+
+        // Inside the Bounding Sphere Every Error Is Too Large to Hide
+        if (distance <= 0.0f) target = 0;
+        else
+        {
+            float pixels = mPixelsPerUnit / distance;
+            auto coarsest = [&](float limit)
+            {   std::size_t level = 0;
+                for (std::size_t i = 1; i < levels; i++)
+                    if (errors[i] * pixels <= limit) level = i;
+                return level;
+            };
+            if (errors[current] * pixels > mThreshold * (1.0f + mHysteresis)) target = coarsest(mThreshold);
+            else target = std::max(current, coarsest(mThreshold * (1.0f - mHysteresis)));
+        }
+
+        if (!fresh && target != mLevels[instance]) mSwitches++;
+        mLevels[instance] = static_cast<std::uint8_t>(target);
+        return target;
+    }
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+// Local Headers
+#include "mesh.hpp"
+
+// System Headers
+#include <glm/glm.hpp>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Quadric Error Metric Simplification (Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics")
+    //
+    // Edges collapse onto one of their endpoints, so the result indexes the
+    // original vertex array unchanged. Vertices sharing a position (UV or
+    // normal seams) move as one, and only along edges every copy of them
+    // has, which keeps seams closed; open borders only collapse along
+    // themselves. Stops at targetIndexCount or once the next collapse would
+    // exceed maxError, and returns the error reached in model units.
+    float simplify(std::vector<Vertex> const & vertices, std::vector<GLuint> const & indices,
+                   std::size_t targetIndexCount, float maxError, std::vector<GLuint> & result);
+
+    // Fill MeshData::lods From Its Full Index Buffer
+    //
+    // Each level keeps about ratio of the previous level's triangles and is
+    // reordered for the vertex cache. maxError is relative to the diagonal
+    // of the mesh bounds; the chain ends early once a level would exceed it
+    // or stops shrinking. Run after optimize(), which renumbers vertices.
+    void generateLevels(MeshData & mesh, std::size_t maxLevels = 6,
+                        float ratio = 0.5f, float maxError = 0.05f);
+
+    // Per-Instance Level Choice by Projected Screen-Space Error
+    //
+    // A level is acceptable while its error, projected to pixels at the
+    // instance's distance, stays under the threshold. Instances move to a
+    // coarser level only once it projects below threshold * (1 - hysteresis),
+    // and back to a finer one only once their current level projects above
+    // threshold * (1 + hysteresis), so objects hovering at a switching
+    // distance do not pop back and forth every frame.
+    class LodSelector
+    {
+    public:
+
+        // Implement Custom Constructor
+        LodSelector(float threshold = 1.0f, float hysteresis = 0.25f)
+            : mThreshold(threshold), mHysteresis(hysteresis), mPixelsPerUnit(1.0f), mSwitches(0) {}
+
+        // Public Member Functions
+        void viewport(glm::mat4 const & projection, int height); // Once per Frame, Before select()
+        std::size_t select(std::size_t instance, Mesh const & mesh, glm::mat4 const & modelView);
+        std::size_t select(std::size_t instance, float const * errors, std::size_t levels, float distance);
+        std::size_t level(std::size_t instance) const { return instance < mLevels.size() ? mLevels[instance] : 0; }
+        std::size_t switches() const { return mSwitches; }
+        void reset() { mLevels.clear(); mSwitches = 0; }
+
+    private:
+
+        // Private Member Containers
+        std::vector<std::uint8_t> mLevels;
+        std::vector<float> mErrors;
+
+        // Private Member Variables
+        float mThreshold;
+        float mHysteresis;
+        float mPixelsPerUnit;
+        std::size_t mSwitches;
+
+    };
+};
@@ -3,27 +3,151 @@
 
 // Local Headers
 #include "mesh.hpp"
+#include "animation.hpp"
+#include "batch.hpp"
+#include "cache.hpp"
+#include "command.hpp"
+#include "loader.hpp"
+#include "lod.hpp"
+#include "optimize.hpp"
+#include "texture.hpp"
 
 // System Headers
 #include <stb_image.h>
 
+// Standard Headers
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
 // Define Namespace
 namespace Mirage
 {
+    const unsigned int Mesh::ImportFlags = aiProcessPreset_TargetRealtime_MaxQuality |
+                                           aiProcess_OptimizeGraph                   |
+                                           aiProcess_FlipUVs;
+
+    Material::Material(TextureSlots const & textures) : mProgram(0), mKey(0)
+    {
+        unsigned int diffuse = 0, specular = 0;
+        for (auto &i : textures)
+        {   // Set Correct Uniform Names Using Texture Type (Omit ID for 0th Texture)
+            std::string uniform = i.second;
+                 if (i.second == "diffuse")  uniform += (diffuse++  > 0) ? std::to_string(diffuse)  : "";
+            else if (i.second == "specular") uniform += (specular++ > 0) ? std::to_string(specular) : "";
+            mTextures.push_back(i.first);
+            mUniforms.push_back(uniform);
+        }
+
+        // Fold the Bound Texture Handles Into a Sort Key So Equal Sets Draw Back to Back
+        std::uint32_t hash = 2166136261u;
+        for (auto texture : mTextures) hash = (hash ^ texture) * 16777619u;
+        if (!mTextures.empty()) mKey = static_cast<std::uint16_t>(hash ^ (hash >> 16));
+    }
+
+    std::vector<GLint> const & Material::locations(GLuint shader)
+    {
+        // Look Up Sampler Locations Only When the Program Changes
+        if (shader != mProgram)
+        {   mLocations.clear();
+            for (auto const & uniform : mUniforms)
+                mLocations.push_back(glGetUniformLocation(shader, uniform.c_str()));
+            mProgram = shader;
+        }   return mLocations;
+    }
+
+    void Material::bind(GLuint shader)
+    {
+        // Bind Correct Textures Before Drawing
+        locations(shader);
+        for (std::size_t unit = 0; unit < mTextures.size(); unit++)
+        {   glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(unit));
+            glBindTexture(GL_TEXTURE_2D, mTextures[unit]);
+            glUniform1i(mLocations[unit], static_cast<GLint>(unit));
+        }
+    }
+
     Mesh::Mesh(std::string const & filename) : Mesh()
     {
-        // Load a Model from File
-        Assimp::Importer loader;
-        aiScene const * scene = loader.ReadFile(
-            PROJECT_SOURCE_DIR "/Mirage/Models/" + filename,
-            aiProcessPreset_TargetRealtime_MaxQuality |
-            aiProcess_OptimizeGraph                   |
-            aiProcess_FlipUVs);
+        create(filename, AssetLoader::instance(), nullptr);
+    }
+
+    Mesh::Mesh(std::string const & filename, AssetLoader & loader) : Mesh()
+    {
+        create(filename, loader, nullptr);
+    }
 
-        // Walk the Tree of Scene Nodes
-        auto index = filename.find_last_of("/");
-        if (!scene) fprintf(stderr, "%s\n", loader.GetErrorString());
-        else parse(filename.substr(0, index), scene->mRootNode, scene);
+    Mesh::Mesh(std::string const & filename, AssetLoader & loader, MeshBatch & batch) : Mesh()
+    {
+        create(filename, loader, & batch);
+    }
+
+    void Mesh::create(std::string const & filename, AssetLoader & loader, MeshBatch * batch)
+    {
+        // Prefer the Binary Cache; Only Fall Back to Assimp on a Miss
+        std::string source = PROJECT_SOURCE_DIR "/Mirage/Models/" + filename;
+        std::string path = filename.substr(0, filename.find_last_of("/"));
+        MeshCache cache(PROJECT_SOURCE_DIR "/Mirage/Cache");
+        MeshCache::Entry entry;
+        std::vector<MeshData> meshes;
+        if (!cache.load(source, ImportFlags, entry))
+        {
+            if (!import(source, meshes, & loader.pool())) return;
+            loader.pool().run(meshes.size(), [&](std::size_t i)
+            {   optimize(meshes[i]);
+                generateLevels(meshes[i]);
+            });
+            cache.store(source, ImportFlags, meshes);
+
+            // View Freshly Imported Data Exactly Like a Cache Entry
+            for (auto const & mesh : meshes)
+            {   MeshCache::View view = { mesh.vertices.data(), mesh.indices.data(),
+                                         static_cast<std::uint32_t>(mesh.vertices.size()),
+                                         static_cast<std::uint32_t>(mesh.indices.size()),
+                                         mesh.textures, mesh.bounds,
+                                         mesh.lodIndices.data(), mesh.lods,
+                                         mesh.skin.empty() ? nullptr : mesh.skin.data() };
+                entry.meshes.push_back(view);
+            }
+        }
+
+        // Queue Texture Decodes First So Workers Overlap with Geometry Uploads
+        std::size_t count = entry.meshes.size();
+        std::vector<std::vector<std::shared_ptr<Texture>>> textures(count);
+        for (std::size_t i = 0; i < count; i++)
+        for (auto const & texture : entry.meshes[i].textures)
+            textures[i].push_back(TextureCache::instance().acquire(
+                PROJECT_SOURCE_DIR "/Mirage/Models/" + path + "/" + texture.filename, loader));
+
+        std::map<GLuint, std::string> none;
+        if (!batch)
+        for (auto const & view : entry.meshes)
+            mSubMeshes.push_back(std::unique_ptr<Mesh>(new Mesh(
+                view.vertices, view.vertexCount,
+                view.indices,  view.indexCount, none, & view.bounds,
+                view.lodIndices, view.lods, view.skin)));
+
+        // Upload Decoded Images on This Thread and Attach Them
+        loader.finish();
+        for (std::size_t i = 0; i < count; i++)
+        {
+            auto const & view = entry.meshes[i];
+            TextureSlots bound;
+            for (std::size_t j = 0; j < textures[i].size(); j++)
+                bound.push_back(std::make_pair(textures[i][j]->get(), view.textures[j].mode));
+
+            // Batched Submeshes Live in the Shared Arena and Draw in Their Bind Pose; the Mesh Keeps Textures Alive
+            if (batch)
+            {   batch->append(view.vertices, view.vertexCount, view.indices, view.indexCount, bound);
+                mShared.insert(mShared.end(), textures[i].begin(), textures[i].end());
+            }
+            else
+            {   mSubMeshes[i]->mTextures = bound;
+                mSubMeshes[i]->mMaterial = Material(bound);
+                mSubMeshes[i]->mShared = textures[i];
+            }
+        }
     }
 
     Mesh::Mesh(std::vector<Vertex> const & vertices,
@@ -31,139 +155,272 @@ namespace Mirage
                std::map<GLuint, std::string> const & textures)
                     : mIndices(indices)
                     , mVertices(vertices)
-                    , mTextures(textures)
+                    , mTextures(textures.begin(), textures.end())
+                    , mMaterial(textures)
+                    , mBounds(measure(vertices.data(), vertices.size()))
+    {
+        upload(mVertices.data(), mVertices.size(), mIndices.data(), mIndices.size());
+    }
+
+    Mesh::Mesh(Vertex const * vertices, std::size_t vertexCount,
+               GLuint const * indices,  std::size_t indexCount,
+               std::map<GLuint, std::string> const & textures,
+               Bounds const * bounds,
+               GLuint const * lodIndices,
+               std::vector<LevelOfDetail> const & lods,
+               SkinWeight const * skin)
+                    : mTextures(textures.begin(), textures.end())
+                    , mMaterial(textures)
+                    , mBounds(bounds ? *bounds : measure(vertices, vertexCount))
+    {
+        upload(vertices, vertexCount, indices, indexCount, lodIndices, lods, skin);
+    }
+
+    Bounds Mesh::measure(Vertex const * vertices, std::size_t vertexCount)
+    {
+        Bounds bounds;
+        bounds.min = glm::vec3( std::numeric_limits<float>::max());
+        bounds.max = glm::vec3(-std::numeric_limits<float>::max());
+        for (std::size_t i = 0; i < vertexCount; i++)
+        {   bounds.min = glm::min(bounds.min, vertices[i].position);
+            bounds.max = glm::max(bounds.max, vertices[i].position);
+        }   return bounds;
+    }
+
+    void Mesh::upload(Vertex const * vertices, std::size_t vertexCount,
+                      GLuint const * indices,  std::size_t indexCount,
+                      GLuint const * lodIndices,
+                      std::vector<LevelOfDetail> const & lods,
+                      SkinWeight const * skin)
     {
-        // Bind a Vertex Array Object
+        mIndexCount = static_cast<GLsizei>(indexCount);
+        mIndexOffset = 0;
         glGenVertexArrays(1, & mVertexArray);
-        glBindVertexArray(mVertexArray);
 
-        // Copy Vertex Buffer Data
-        glGenBuffers(1, & mVertexBuffer);
-        glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
-        glBufferData(GL_ARRAY_BUFFER,
-                     mVertices.size() * sizeof(Vertex),
-                   & mVertices.front(), GL_STATIC_DRAW);
+        // Simplified Levels Follow the Full Index List, So One Element Buffer Serves Them All
+        std::size_t lodIndexCount = 0;
+        mLevels.clear();
+        if (lodIndices)
+        for (auto lod : lods)
+        {   lodIndexCount = std::max<std::size_t>(lodIndexCount, lod.indexOffset + lod.indexCount);
+            lod.indexOffset += static_cast<std::uint32_t>(indexCount);
+            mLevels.push_back(lod);
+        }
+
+        // Sub-Allocate Vertices, Skin Weights and Indices Together from the Shared Geometry Heap
+        BufferHeap & heap = BufferHeap::Default();
+        std::size_t vertexBytes = vertexCount * sizeof(Vertex);
+        std::size_t skinBytes = skin ? vertexCount * sizeof(SkinWeight) : 0;
+        std::size_t indexBase = vertexBytes + skinBytes;
+        mGeometry = heap.Allocate(indexBase + (indexCount + lodIndexCount) * sizeof(GLuint));
+        if (!mGeometry.Valid()) { mIndexCount = 0; mLevels.clear(); return; }
+        heap.Upload(mGeometry, vertices, vertexBytes);
+        if (skin) heap.Upload(mGeometry, skin, skinBytes, vertexBytes);
+        heap.Upload(mGeometry, indices, indexCount * sizeof(GLuint), indexBase);
+        if (lodIndexCount > 0)
+            heap.Upload(mGeometry, lodIndices, lodIndexCount * sizeof(GLuint), indexBase + indexCount * sizeof(GLuint));
+        mIndexOffset = mGeometry.offset + indexBase;
 
-        // Copy Index Buffer Data
-        glGenBuffers(1, & mElementBuffer);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mElementBuffer);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                     mIndices.size() * sizeof(GLuint),
-                   & mIndices.front(), GL_STATIC_DRAW);
+        // Bind a Vertex Array Object Sourcing Both From the Shared Buffer
+        glBindVertexArray(mVertexArray);
+        glBindBuffer(GL_ARRAY_BUFFER, mGeometry.buffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mGeometry.buffer);
 
         // Set Shader Attributes
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) offsetof(Vertex, position));
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) offsetof(Vertex, normal));
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) offsetof(Vertex, uv));
+        std::size_t base = mGeometry.offset;
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) (base + offsetof(Vertex, position)));
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) (base + offsetof(Vertex, normal)));
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (GLvoid *) (base + offsetof(Vertex, uv)));
         glEnableVertexAttribArray(0); // Vertex Positions
         glEnableVertexAttribArray(1); // Vertex Normals
         glEnableVertexAttribArray(2); // Vertex UVs
-
-        // Cleanup Buffers
+        if (skin)
+        {   std::size_t weights = base + vertexBytes;
+            glVertexAttribIPointer(3, 4, GL_UNSIGNED_BYTE, sizeof(SkinWeight), (GLvoid *) (weights + offsetof(SkinWeight, joints)));
+            glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SkinWeight), (GLvoid *) (weights + offsetof(SkinWeight, weights)));
+            glEnableVertexAttribArray(3); // Joint Indices
+            glEnableVertexAttribArray(4); // Joint Weights
+        }
         glBindVertexArray(0);
-        glDeleteBuffers(1, & mVertexBuffer);
-        glDeleteBuffers(1, & mElementBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
-    void Mesh::draw(GLuint shader)
+    void Mesh::draw(GLuint shader, GLsizei instances)
     {
-        unsigned int unit = 0, diffuse = 0, specular = 0;
-        for (auto &i : mSubMeshes) i->draw(shader);
-        for (auto &i : mTextures)
-        {   // Set Correct Uniform Names Using Texture Type (Omit ID for 0th Texture)
-            std::string uniform = i.second;
-                 if (i.second == "diffuse")  uniform += (diffuse++  > 0) ? std::to_string(diffuse)  : "";
-            else if (i.second == "specular") uniform += (specular++ > 0) ? std::to_string(specular) : "";
+        drawLevel(shader, 0, instances);
+    }
 
-            // Bind Correct Textures and Vertex Array Before Drawing
-            glActiveTexture(GL_TEXTURE0 + unit);
-            glBindTexture(GL_TEXTURE_2D, i.first);
-            glUniform1f(glGetUniformLocation(shader, uniform.c_str()), ++unit);
-        }   glBindVertexArray(mVertexArray);
-            glDrawElements(GL_TRIANGLES, mIndices.size(), GL_UNSIGNED_INT, 0);
+    void Mesh::drawLevel(GLuint shader, std::size_t level, GLsizei instances)
+    {
+        for (auto &i : mSubMeshes) i->drawLevel(shader, level, instances);
+        mMaterial.bind(shader);
+        glBindVertexArray(mVertexArray);
+
+        GLsizei count;
+        std::size_t offset;
+        range(level, count, offset);
+        GLvoid const * indices = (GLvoid const *) offset;
+        if (instances == 1) glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, indices);
+        else glDrawElementsInstanced(GL_TRIANGLES, count, GL_UNSIGNED_INT, indices, instances);
+    }
+
+    void Mesh::record(CommandBucket & bucket, unsigned int pass, GLuint shader, float depth,
+                      std::size_t level, GLsizei instances)
+    {
+        // Same Calls as drawLevel(), Deferred; Nothing Here Touches OpenGL
+        for (auto &i : mSubMeshes) i->record(bucket, pass, shader, depth, level, instances);
+        if (mIndexCount == 0) return;
+        DrawPacket & packet = bucket.draw(sortKey(pass, shader, mMaterial.key(), depth));
+        packet.program = shader;
+        packet.vertexArray = mVertexArray;
+        packet.material = & mMaterial;
+        packet.instances = instances;
+        range(level, packet.count, packet.offset);
+    }
+
+    void Mesh::range(std::size_t level, GLsizei & count, std::size_t & offset) const
+    {
+        // Submeshes With Shorter Chains Stay at Their Coarsest Level
+        count = mIndexCount;
+        offset = mIndexOffset;
+        if (level > 0 && !mLevels.empty())
+        {   LevelOfDetail const & lod = mLevels[std::min(level, mLevels.size()) - 1];
+            count = static_cast<GLsizei>(lod.indexCount);
+            offset += lod.indexOffset * sizeof(GLuint);
+        }
+    }
+
+    Bounds Mesh::extent() const
+    {
+        if (mSubMeshes.empty()) return mBounds;
+        Bounds bounds = mSubMeshes.front()->extent();
+        for (auto const & i : mSubMeshes)
+        {   Bounds child = i->extent();
+            bounds.min = glm::min(bounds.min, child.min);
+            bounds.max = glm::max(bounds.max, child.max);
+        }   return bounds;
     }
 
-    void Mesh::parse(std::string const & path, aiNode const * node, aiScene const * scene)
+    std::size_t Mesh::levels() const
+    {
+        std::size_t count = mLevels.size() + 1;
+        for (auto const & i : mSubMeshes) count = std::max(count, i->levels());
+        return count;
+    }
+
+    float Mesh::error(std::size_t level) const
+    {
+        float error = (level == 0 || mLevels.empty()) ? 0.0f : mLevels[std::min(level, mLevels.size()) - 1].error;
+        for (auto const & i : mSubMeshes) error = std::max(error, i->error(level));
+        return error;
+    }
+
+    void Mesh::draw(GLuint shader, std::vector<std::uint32_t> const & visible, GLsizei instances)
+    {
+        // Draw Only the Submeshes That Survived Culling
+        for (auto i : visible) mSubMeshes[i]->draw(shader, instances);
+    }
+
+    bool Mesh::import(std::string const & filename, std::vector<MeshData> & meshes,
+                      ThreadPool * pool)
+    {
+        // Load a Model from File
+        Assimp::Importer loader;
+        aiScene const * scene = loader.ReadFile(filename, ImportFlags);
+        if (!scene)
+        {   fprintf(stderr, "%s\n", loader.GetErrorString());
+            return false;
+        }
+
+        // Walk the Tree of Scene Nodes, Then Flatten Each aiMesh Independently
+        std::vector<aiMesh const *> nodes;
+        Skeleton skeleton;
+        Skeleton::import(scene, skeleton);
+        parse(scene->mRootNode, scene, nodes);
+        meshes.resize(nodes.size());
+        auto flatten = [&](std::size_t i) { parse(nodes[i], scene, skeleton, meshes[i]); };
+        if (pool) pool->run(nodes.size(), flatten);
+        else for (std::size_t i = 0; i < nodes.size(); i++) flatten(i);
+        return true;
+    }
+
+    void Mesh::parse(aiNode const * node, aiScene const * scene, std::vector<aiMesh const *> & meshes)
     {
         for (unsigned int i = 0; i < node->mNumMeshes; i++)
-            parse(path, scene->mMeshes[node->mMeshes[i]], scene);
+            meshes.push_back(scene->mMeshes[node->mMeshes[i]]);
         for (unsigned int i = 0; i < node->mNumChildren; i++)
-            parse(path, node->mChildren[i], scene);
+            parse(node->mChildren[i], scene, meshes);
     }
 
-    void Mesh::parse(std::string const & path, aiMesh const * mesh, aiScene const * scene)
+    void Mesh::parse(aiMesh const * mesh, aiScene const * scene, Skeleton const & skeleton, MeshData & data)
     {
         // Create Vertex Data from Mesh Node
-        std::vector<Vertex> vertices; Vertex vertex;
+        data.vertices.resize(mesh->mNumVertices);
         for (unsigned int i = 0; i < mesh->mNumVertices; i++)
-        {   if (mesh->mTextureCoords[0])
+        {   Vertex & vertex = data.vertices[i];
+            if (mesh->mTextureCoords[0])
             vertex.uv       = glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y);
             vertex.position = glm::vec3(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z);
             vertex.normal   = glm::vec3(mesh->mNormals[i].x,  mesh->mNormals[i].y,  mesh->mNormals[i].z);
-            vertices.push_back(vertex);
         }
+        data.bounds = measure(data.vertices.data(), data.vertices.size());
 
         // Create Mesh Indices for Indexed Drawing
-        std::vector<GLuint> indices;
+        std::size_t count = 0;
+        for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+            count += mesh->mFaces[i].mNumIndices;
+        data.indices.reserve(count);
         for (unsigned int i = 0; i < mesh->mNumFaces; i++)
         for (unsigned int j = 0; j < mesh->mFaces[i].mNumIndices; j++)
-            indices.push_back(mesh->mFaces[i].mIndices[j]);
+            data.indices.push_back(mesh->mFaces[i].mIndices[j]);
 
-        // Load Mesh Textures into VRAM
-        std::map<GLuint, std::string> textures;
-        auto diffuse  = process(path, scene->mMaterials[mesh->mMaterialIndex], aiTextureType_DIFFUSE);
-        auto specular = process(path, scene->mMaterials[mesh->mMaterialIndex], aiTextureType_SPECULAR);
-        textures.insert(diffuse.begin(), diffuse.end());
-        textures.insert(specular.begin(), specular.end());
+        // Keep the Four Strongest Influences per Vertex, Quantized So Each Set Sums to Exactly 255
+        if (mesh->mNumBones > 0 && skeleton.size() > 0)
+        {
+            std::vector<std::pair<float, int>> influences(mesh->mNumVertices * 4, std::make_pair(0.0f, 0));
+            for (unsigned int i = 0; i < mesh->mNumBones; i++)
+            {   aiBone const * bone = mesh->mBones[i];
+                int joint = skeleton.find(bone->mName.C_Str());
+                if (joint < 0) continue;
+                for (unsigned int j = 0; j < bone->mNumWeights; j++)
+                {   aiVertexWeight const & weight = bone->mWeights[j];
+                    if (weight.mVertexId >= mesh->mNumVertices) continue;
+                    auto slots = influences.begin() + weight.mVertexId * 4;
+                    auto weakest = std::min_element(slots, slots + 4);
+                    if (weight.mWeight > weakest->first) *weakest = std::make_pair(weight.mWeight, joint);
+                }
+            }
+            data.skin.resize(mesh->mNumVertices);
+            for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+            {   auto slots = influences.begin() + i * 4;
+                std::sort(slots, slots + 4, std::greater<std::pair<float, int>>());
+                float total = slots[0].first + slots[1].first + slots[2].first + slots[3].first;
+                if (total <= 0.0f) slots[0] = std::make_pair(total = 1.0f, 0); // Unweighted Vertices Follow the Root
+                int sum = 0;
+                for (int k = 0; k < 4; k++)
+                {   data.skin[i].joints[k]  = static_cast<std::uint8_t>(slots[k].second);
+                    data.skin[i].weights[k] = static_cast<std::uint8_t>(std::lround(slots[k].first / total * 255.0f));
+                    sum += data.skin[i].weights[k];
+                }   data.skin[i].weights[0] = static_cast<std::uint8_t>(data.skin[i].weights[0] + 255 - sum);
+            }
+        }
 
-        // Create New Mesh Node
-        mSubMeshes.push_back(std::unique_ptr<Mesh>(new Mesh(vertices, indices, textures)));
+        // Record Mesh Texture References
+        process(scene->mMaterials[mesh->mMaterialIndex], aiTextureType_DIFFUSE,  data.textures);
+        process(scene->mMaterials[mesh->mMaterialIndex], aiTextureType_SPECULAR, data.textures);
     }
 
-    std::map<GLuint, std::string> Mesh::process(std::string const & path,
-                                                aiMaterial * material,
-                                                aiTextureType type)
+    void Mesh::process(aiMaterial * material, aiTextureType type,
+                       std::vector<TextureReference> & textures)
     {
-        std::map<GLuint, std::string> textures;
         for(unsigned int i = 0; i < material->GetTextureCount(type); i++)
         {
-            // Define Some Local Variables
-            GLenum format;
-            GLuint texture;
-            std::string mode;
-
-            // Load the Texture Image from File
             aiString str; material->GetTexture(type, i, & str);
-            std::string filename = str.C_Str(); int width, height, channels;
-            filename = PROJECT_SOURCE_DIR "/Mirage/Models/" + path + "/" + filename;
-            unsigned char * image = stbi_load(filename.c_str(), & width, & height, & channels, 0);
-            if (!image) fprintf(stderr, "%s %s\n", "Failed to Load Texture", filename.c_str());
-
-            // Set the Correct Channel Format
-            switch (channels)
-            {
-                case 1 : format = GL_ALPHA;     break;
-                case 2 : format = GL_LUMINANCE; break;
-                case 3 : format = GL_RGB;       break;
-                case 4 : format = GL_RGBA;      break;
-            }
-
-            // Bind Texture and Set Filtering Levels
-            glGenTextures(1, & texture);
-            glBindTexture(GL_TEXTURE_2D, texture);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glTexImage2D(GL_TEXTURE_2D, 0, format,
-                         width, height, 0, format, GL_UNSIGNED_BYTE, image);
-            glGenerateMipmap(GL_TEXTURE_2D);
-
-            // Release Image Pointer and Store the Texture
-            stbi_image_free(image);
-                 if (type == aiTextureType_DIFFUSE)  mode = "diffuse";
-            else if (type == aiTextureType_SPECULAR) mode = "specular";
-            textures.insert(std::make_pair(texture, mode));
-        }   return textures;
+            TextureReference texture;
+            texture.filename = str.C_Str();
+                 if (type == aiTextureType_DIFFUSE)  texture.mode = "diffuse";
+            else if (type == aiTextureType_SPECULAR) texture.mode = "specular";
+            textures.push_back(texture);
+        }
     }
 };
@@ -1,20 +1,35 @@
 #pragma once
 
+// Local Headers
+#include "gpu_buffer.hpp"
+
 // System Headers
-#include <assimp/importer.hpp>
+#include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
 // Standard Headers
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 // Define Namespace
 namespace Mirage
 {
+    // Forward Declarations
+    class AssetLoader;
+    class CommandBucket;
+    class MeshBatch;
+    class Skeleton;
+    class Texture;
+    class ThreadPool;
+
     // Vertex Format
     struct Vertex {
         glm::vec3 position;
@@ -22,22 +37,117 @@ namespace Mirage
         glm::vec2 uv;
     };
 
+    // Up to Four Joint Influences per Vertex; Weights Are unorm8 Summing to 255
+    struct SkinWeight {
+        std::uint8_t joints[4];
+        std::uint8_t weights[4];
+    };
+
+    // Texture Reference Relative to the Model Directory
+    struct TextureReference {
+        std::string filename;
+        std::string mode;
+    };
+
+    // Handle and Mode per Texture Unit, in Unit Order; Handles May Repeat or Be Zero
+    typedef std::vector<std::pair<GLuint, std::string>> TextureSlots;
+
+    // Axis-Aligned Bounding Box in Model Space
+    struct Bounds {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    // Simplified Index Range Sharing the Full Mesh's Vertices
+    struct LevelOfDetail {
+        std::uint32_t indexOffset; // Into MeshData::lodIndices
+        std::uint32_t indexCount;
+        float error;               // Geometric Deviation in Model Units
+    };
+
+    // Flattened Submesh Geometry, Independent of OpenGL State
+    struct MeshData {
+        std::vector<Vertex> vertices;
+        std::vector<GLuint> indices;
+        std::vector<TextureReference> textures;
+        Bounds bounds;
+        std::vector<GLuint> lodIndices;      // Every Simplified Level, Back to Back
+        std::vector<LevelOfDetail> lods;     // Coarser Levels After the Full Mesh
+        std::vector<SkinWeight> skin;        // Parallel to vertices; Empty Unless Skinned
+    };
+
+    // Texture Set with Sampler Uniforms Resolved Once per Program
+    class Material
+    {
+    public:
+
+        // Implement Custom Constructors
+        Material() : mProgram(0), mKey(0) {}
+        Material(TextureSlots const & textures);
+        Material(std::map<GLuint, std::string> const & textures)
+            : Material(TextureSlots(textures.begin(), textures.end())) {}
+
+        // Public Member Functions
+        void bind(GLuint shader);
+        std::vector<GLint> const & locations(GLuint shader); // Sampler Uniform per Texture Unit
+        std::vector<GLuint> const & textures() const { return mTextures; }
+        std::uint16_t key() const { return mKey; } // Equal for Equal Texture Sets
+
+    private:
+
+        // Private Member Containers
+        std::vector<GLuint> mTextures;
+        std::vector<std::string> mUniforms;
+        std::vector<GLint> mLocations;
+
+        // Private Member Variables
+        GLuint mProgram;
+        std::uint16_t mKey;
+
+    };
+
     class Mesh
     {
     public:
 
         // Implement Default Constructor and Destructor
-         Mesh() { glGenVertexArrays(1, & mVertexArray); }
-        ~Mesh() { glDeleteVertexArrays(1, & mVertexArray); }
+         Mesh() : mIndexCount(0), mIndexOffset(0) { glGenVertexArrays(1, & mVertexArray); }
+        ~Mesh() { glDeleteVertexArrays(1, & mVertexArray); BufferHeap::Default().Free(mGeometry); }
 
         // Implement Custom Constructors
-        Mesh(std::string const & filename);
+        Mesh(std::string const & filename); // Loads Through AssetLoader::instance()
+        Mesh(std::string const & filename, AssetLoader & loader);
+        Mesh(std::string const & filename, AssetLoader & loader, MeshBatch & batch); // Drawn by the Batch
         Mesh(std::vector<Vertex> const & vertices,
              std::vector<GLuint> const & indices,
              std::map<GLuint, std::string> const & textures);
+        Mesh(Vertex const * vertices, std::size_t vertexCount,
+             GLuint const * indices,  std::size_t indexCount,
+             std::map<GLuint, std::string> const & textures,
+             Bounds const * bounds = nullptr, // Measured From the Vertices If Null
+             GLuint const * lodIndices = nullptr,
+             std::vector<LevelOfDetail> const & lods = std::vector<LevelOfDetail>(),
+             SkinWeight const * skin = nullptr); // Enables Attributes 3 and 4
 
         // Public Member Functions
-        void draw(GLuint shader);
+        void draw(GLuint shader, GLsizei instances = 1);
+        void draw(GLuint shader, std::vector<std::uint32_t> const & visible, GLsizei instances = 1);
+        void drawLevel(GLuint shader, std::size_t level, GLsizei instances = 1); // Clamped per Submesh
+        void record(CommandBucket & bucket, unsigned int pass, GLuint shader, float depth,
+                    std::size_t level = 0, GLsizei instances = 1); // One Packet per Submesh
+        std::size_t submeshes() const { return mSubMeshes.size(); }
+        Bounds const & bounds(std::size_t submesh) const { return mSubMeshes[submesh]->mBounds; }
+        Bounds extent() const; // Union Over Submeshes
+        std::size_t levels() const; // Including the Full Mesh as Level 0
+        float error(std::size_t level) const; // Largest Over Submeshes
+
+        // Axis-Aligned Bounds of a Vertex Array
+        static Bounds measure(Vertex const * vertices, std::size_t vertexCount);
+
+        // Import a Model into Flat Arrays Without Touching OpenGL
+        static bool import(std::string const & filename, std::vector<MeshData> & meshes,
+                           ThreadPool * pool = nullptr);
+        static const unsigned int ImportFlags;
 
     private:
 
@@ -46,22 +156,33 @@ namespace Mirage
         Mesh & operator=(Mesh const &) = delete;
 
         // Private Member Functions
-        void parse(std::string const & path, aiNode const * node, aiScene const * scene);
-        void parse(std::string const & path, aiMesh const * mesh, aiScene const * scene);
-        std::map<GLuint, std::string> process(std::string const & path,
-                                              aiMaterial * material,
-                                              aiTextureType type);
+        void create(std::string const & filename, AssetLoader & loader, MeshBatch * batch);
+        void upload(Vertex const * vertices, std::size_t vertexCount,
+                    GLuint const * indices,  std::size_t indexCount,
+                    GLuint const * lodIndices = nullptr,
+                    std::vector<LevelOfDetail> const & lods = std::vector<LevelOfDetail>(),
+                    SkinWeight const * skin = nullptr);
+        void range(std::size_t level, GLsizei & count, std::size_t & offset) const;
+        static void parse(aiNode const * node, aiScene const * scene, std::vector<aiMesh const *> & meshes);
+        static void parse(aiMesh const * mesh, aiScene const * scene, Skeleton const & skeleton, MeshData & data);
+        static void process(aiMaterial * material, aiTextureType type,
+                            std::vector<TextureReference> & textures);
 
         // Private Member Containers
         std::vector<std::unique_ptr<Mesh>> mSubMeshes;
         std::vector<GLuint> mIndices;
         std::vector<Vertex> mVertices;
-        std::map<GLuint, std::string> mTextures;
+        TextureSlots mTextures;
+        std::vector<std::shared_ptr<Texture>> mShared;
+        std::vector<LevelOfDetail> mLevels; // Offsets Relative to the Full Index List
+        Material mMaterial;
+        Bounds mBounds;
+        BufferHeap::Allocation mGeometry; // Vertices, Skin Weights, Then Indices
 
         // Private Member Variables
         GLuint mVertexArray;
-        GLuint mVertexBuffer;
-        GLuint mElementBuffer;
+        GLsizei mIndexCount;
+        std::size_t mIndexOffset;
 
     };
 };
@@ -0,0 +1,379 @@
+// Local Headers
+#include "optimize.hpp"
+
+// Standard Headers
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        // FIFO Cache Simulation Using Insertion Timestamps
+        struct Cache
+        {
+            Cache(std::size_t vertexCount, unsigned int size)
+                : stamps(vertexCount, 0), time(size + 1), size(size) {}
+
+            bool miss(GLuint vertex)
+            {   if (time - stamps[vertex] <= size) return false;
+                stamps[vertex] = time++;
+                return true;
+            }
+
+            std::vector<unsigned int> stamps;
+            unsigned int time;
+            unsigned int size;
+        };
+
+        unsigned int misses(std::vector<GLuint> const & indices, std::size_t triangle, Cache & cache)
+        {
+            return cache.miss(indices[triangle * 3 + 0])
+                 + cache.miss(indices[triangle * 3 + 1])
+                 + cache.miss(indices[triangle * 3 + 2]);
+        }
+
+        float clamp(float value, float low, float high)
+        { return std::min(std::max(value, low), high); }
+
+        float sign(float value) { return value >= 0.0f ? 1.0f : -1.0f; }
+
+        std::uint16_t snorm16(float value)
+        { return static_cast<std::uint16_t>(static_cast<std::int16_t>(std::round(clamp(value, -1.0f, 1.0f) * 32767.0f))); }
+
+        float unsnorm16(std::uint32_t value)
+        { return std::max(static_cast<std::int16_t>(value & 0xffff) / 32767.0f, -1.0f); }
+    }
+
+    CacheStatistics analyze(std::vector<GLuint> const & indices,
+                            std::size_t vertexCount,
+                            unsigned int cacheSize)
+    {
+        CacheStatistics statistics = { 0.0f, 0.0f };
+        std::size_t triangles = indices.size() / 3;
+        if (triangles == 0) return statistics;
+
+        Cache cache(vertexCount, cacheSize);
+        std::vector<bool> seen(vertexCount, false);
+        std::size_t transformed = 0, unique = 0;
+        for (std::size_t i = 0; i < triangles; i++)
+            transformed += misses(indices, i, cache);
+        for (auto index : indices)
+            if (!seen[index]) { seen[index] = true; unique++; }
+
+        statistics.acmr = static_cast<float>(transformed) / triangles;
+        statistics.atvr = static_cast<float>(transformed) / unique;
+        return statistics;
+    }
+
+    void optimizeVertexCache(std::vector<GLuint> & indices,
+                             std::size_t vertexCount,
+                             unsigned int cacheSize)
+    {
+        std::size_t triangles = indices.size() / 3;
+        if (triangles == 0) return;
+
+        // Build Vertex-to-Triangle Adjacency in Compressed Rows
+        std::vector<unsigned int> live(vertexCount, 0);
+        std::vector<std::size_t> offsets(vertexCount + 1, 0);
+        for (auto index : indices) live[index]++;
+        for (std::size_t v = 0; v < vertexCount; v++) offsets[v + 1] = offsets[v] + live[v];
+        std::vector<std::size_t> fill(offsets.begin(), offsets.end() - 1);
+        std::vector<std::size_t> adjacency(indices.size());
+        for (std::size_t t = 0; t < triangles; t++)
+        for (std::size_t k = 0; k < 3; k++)
+            adjacency[fill[indices[t * 3 + k]]++] = t;
+
+        // Fan Around One Vertex at a Time, Preferring Ones Still in Cache
+        std::vector<unsigned int> stamps(vertexCount, 0);
+        std::vector<bool> emitted(triangles, false);
+        std::vector<GLuint> result, deadEnd, candidates;
+        result.reserve(indices.size());
+        unsigned int time = cacheSize + 1;
+        std::size_t cursor = 0;
+        long fanning = indices[0];
+        while (fanning >= 0)
+        {
+            candidates.clear();
+            for (std::size_t k = offsets[fanning]; k < offsets[fanning + 1]; k++)
+            {
+                std::size_t t = adjacency[k];
+                if (emitted[t]) continue;
+                for (std::size_t j = 0; j < 3; j++)
+                {   GLuint v = indices[t * 3 + j];
+                    result.push_back(v);
+                    deadEnd.push_back(v);
+                    candidates.push_back(v);
+                    live[v]--;
+                    if (time - stamps[v] > cacheSize) stamps[v] = time++;
+                }   emitted[t] = true;
+            }
+
+            // Choose the Candidate That Will Still Be Cached After Its Fan
+            fanning = -1;
+            long priority = -1;
+            for (auto v : candidates)
+            {
+                if (live[v] == 0) continue;
+                long p = 0;
+                if (time - stamps[v] + 2 * live[v] <= cacheSize) p = time - stamps[v];
+                if (p > priority) { priority = p; fanning = v; }
+            }
+
+            // Otherwise Backtrack Through Recent Vertices, Then Scan Linearly
+            while (fanning < 0 && !deadEnd.empty())
+            {   GLuint v = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[v] > 0) fanning = v;
+            }
+            while (fanning < 0 && cursor < vertexCount)
+            {   if (live[cursor] > 0) fanning = static_cast<long>(cursor);
+                cursor++;
+            }
+        }   indices.swap(result);
+    }
+
+    void optimizeOverdraw(std::vector<GLuint> & indices,
+                          std::vector<Vertex> const & vertices,
+                          float threshold,
+                          unsigned int cacheSize)
+    {
+        std::size_t triangles = indices.size() / 3;
+        if (triangles < 2) return;
+
+        // Hard Boundaries Fall Wherever the Cache Restarts (Three Misses)
+        std::vector<std::size_t> hard;
+        Cache cache(vertices.size(), cacheSize);
+        for (std::size_t t = 0; t < triangles; t++)
+            if (misses(indices, t, cache) == 3) hard.push_back(t);
+        hard.push_back(triangles);
+
+        // Soft Boundaries Split Hard Clusters Where Locality Is Already Paid For
+        std::vector<std::size_t> clusters;
+        for (std::size_t h = 0; h + 1 < hard.size(); h++)
+        {
+            std::size_t begin = hard[h], end = hard[h + 1], total = 0;
+            Cache whole(vertices.size(), cacheSize);
+            for (std::size_t t = begin; t < end; t++) total += misses(indices, t, whole);
+            float limit = threshold * total / (end - begin);
+
+            clusters.push_back(begin);
+            Cache running(vertices.size(), cacheSize);
+            std::size_t start = begin, count = 0;
+            for (std::size_t t = begin; t < end; t++)
+            {
+                count += misses(indices, t, running);
+                if (t + 1 < end && static_cast<float>(count) / (t + 1 - start) <= limit)
+                {   clusters.push_back(t + 1);
+                    running = Cache(vertices.size(), cacheSize);
+                    start = t + 1;
+                    count = 0;
+                }
+            }
+        }   clusters.push_back(triangles);
+
+        // Score Each Cluster by How Far Its Area-Weighted Normal Faces Outwards
+        std::size_t count = clusters.size() - 1;
+        std::vector<glm::vec3> centroids(count, glm::vec3(0.0f)), normals(count, glm::vec3(0.0f));
+        std::vector<float> areas(count, 0.0f);
+        glm::vec3 center(0.0f);
+        float area = 0.0f;
+        for (std::size_t c = 0; c < count; c++)
+        {
+            for (std::size_t t = clusters[c]; t < clusters[c + 1]; t++)
+            {
+                glm::vec3 const & a = vertices[indices[t * 3 + 0]].position;
+                glm::vec3 const & b = vertices[indices[t * 3 + 1]].position;
+                glm::vec3 const & d = vertices[indices[t * 3 + 2]].position;
+                glm::vec3 normal = glm::cross(b - a, d - a);
+                float weight = glm::length(normal) * 0.5f;
+                centroids[c] += (a + b + d) * (weight / 3.0f);
+                normals[c] += normal;
+                areas[c] += weight;
+            }
+            center += centroids[c];
+            area += areas[c];
+        }   if (area > 0.0f) center = center / area;
+
+        std::vector<float> scores(count, 0.0f);
+        std::vector<std::size_t> order(count);
+        for (std::size_t c = 0; c < count; c++)
+        {
+            order[c] = c;
+            float length = glm::length(normals[c]);
+            if (areas[c] > 0.0f && length > 0.0f)
+                scores[c] = glm::dot(centroids[c] / areas[c] - center, normals[c] / length);
+        }
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b)
+                         { return scores[a] > scores[b]; });
+
+        std::vector<GLuint> result;
+        result.reserve(indices.size());
+        for (auto c : order)
+            result.insert(result.end(), indices.begin() + clusters[c] * 3,
+                                        indices.begin() + clusters[c + 1] * 3);
+        indices.swap(result);
+    }
+
+    void optimizeVertexFetch(std::vector<Vertex> & vertices,
+                             std::vector<GLuint> & indices,
+                             std::vector<SkinWeight> * skin)
+    {
+        const GLuint unused = ~0u;
+        bool skinned = skin && skin->size() == vertices.size();
+        std::vector<GLuint> remap(vertices.size(), unused);
+        std::vector<Vertex> result;
+        std::vector<SkinWeight> weights;
+        result.reserve(vertices.size());
+        if (skinned) weights.reserve(vertices.size());
+        for (auto & index : indices)
+        {   if (remap[index] == unused)
+            {   remap[index] = static_cast<GLuint>(result.size());
+                result.push_back(vertices[index]);
+                if (skinned) weights.push_back((*skin)[index]);
+            }   index = remap[index];
+        }   vertices.swap(result);
+        if (skinned) skin->swap(weights);
+    }
+
+    void optimize(MeshData & mesh, unsigned int cacheSize)
+    {
+        optimizeVertexCache(mesh.indices, mesh.vertices.size(), cacheSize);
+        optimizeOverdraw(mesh.indices, mesh.vertices, 1.05f, cacheSize);
+        optimizeVertexFetch(mesh.vertices, mesh.indices, & mesh.skin);
+    }
+
+    void PackedMesh::enable() const
+    {
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (GLvoid *) offsetof(PackedVertex, position));
+        if (encoding == NormalEncoding::Packed1010102)
+             glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex), (GLvoid *) offsetof(PackedVertex, normal));
+        else glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (GLvoid *) offsetof(PackedVertex, normal));
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (GLvoid *) offsetof(PackedVertex, uv));
+        glEnableVertexAttribArray(0); // Quantized Positions
+        glEnableVertexAttribArray(1); // Encoded Normals
+        glEnableVertexAttribArray(2); // Half-Float UVs
+    }
+
+    PackedMesh pack(std::vector<Vertex> const & vertices, NormalEncoding encoding)
+    {
+        PackedMesh mesh;
+        mesh.encoding = encoding;
+        mesh.offset = glm::vec3(0.0f);
+        mesh.scale  = glm::vec3(1.0f);
+        if (vertices.empty()) return mesh;
+
+        // Quantize Positions Against the Bounding Box
+        glm::vec3 low = vertices[0].position, high = vertices[0].position;
+        for (auto const & vertex : vertices)
+        {   low  = glm::min(low,  vertex.position);
+            high = glm::max(high, vertex.position);
+        }
+        mesh.offset = low;
+        for (int k = 0; k < 3; k++)
+            mesh.scale[k] = high[k] > low[k] ? high[k] - low[k] : 1.0f;
+
+        mesh.vertices.resize(vertices.size());
+        for (std::size_t i = 0; i < vertices.size(); i++)
+        {
+            PackedVertex & packed = mesh.vertices[i];
+            for (int k = 0; k < 3; k++)
+                packed.position[k] = static_cast<std::uint16_t>(std::round(
+                    clamp((vertices[i].position[k] - low[k]) / mesh.scale[k], 0.0f, 1.0f) * 65535.0f));
+            packed.position[3] = 0;
+            packed.normal = encoding == NormalEncoding::Packed1010102
+                          ? encode1010102(vertices[i].normal)
+                          : encodeOctahedral(vertices[i].normal);
+            packed.uv[0] = toHalf(vertices[i].uv.x);
+            packed.uv[1] = toHalf(vertices[i].uv.y);
+        }   return mesh;
+    }
+
+    std::uint16_t toHalf(float value)
+    {
+        std::uint32_t bits;
+        std::memcpy(& bits, & value, sizeof(bits));
+        std::uint32_t sign = (bits >> 16) & 0x8000;
+        std::uint32_t mantissa = bits & 0x7fffff;
+        std::int32_t exponent = static_cast<std::int32_t>((bits >> 23) & 0xff) - 127 + 15;
+
+        // Infinity and NaN Keep Their Class; Overflow Saturates to Infinity
+        if (((bits >> 23) & 0xff) == 0xff) return static_cast<std::uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+        if (exponent >= 31) return static_cast<std::uint16_t>(sign | 0x7c00);
+
+        // Round to Nearest Even; a Carry Correctly Bumps the Exponent
+        std::uint32_t half, remainder, midpoint;
+        if (exponent <= 0)
+        {
+            if (exponent < -10) return static_cast<std::uint16_t>(sign);
+            mantissa |= 0x800000;
+            std::uint32_t shift = 14 - exponent;
+            half = mantissa >> shift;
+            remainder = mantissa & ((1u << shift) - 1);
+            midpoint = 1u << (shift - 1);
+        }
+        else
+        {
+            half = (exponent << 10) | (mantissa >> 13);
+            remainder = mantissa & 0x1fff;
+            midpoint = 0x1000;
+        }
+        if (remainder > midpoint || (remainder == midpoint && (half & 1))) half++;
+        return static_cast<std::uint16_t>(sign | half);
+    }
+
+    float fromHalf(std::uint16_t value)
+    {
+        std::uint32_t sign = static_cast<std::uint32_t>(value & 0x8000) << 16;
+        std::uint32_t exponent = (value >> 10) & 0x1f;
+        std::uint32_t mantissa = value & 0x3ff;
+        std::uint32_t bits;
+        if (exponent == 0 && mantissa == 0) bits = sign;
+        else if (exponent == 0)
+        {   // Renormalize Subnormals
+            std::uint32_t biased = 113;
+            while (!(mantissa & 0x400)) { mantissa <<= 1; biased--; }
+            bits = sign | (biased << 23) | ((mantissa & 0x3ff) << 13);
+        }
+        else if (exponent == 31) bits = sign | 0x7f800000 | (mantissa << 13);
+        else bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+        float result;
+        std::memcpy(& result, & bits, sizeof(result));
+        return result;
+    }
+
+    std::uint32_t encode1010102(glm::vec3 const & normal)
+    {
+        std::uint32_t packed = 0;
+        for (int k = 0; k < 3; k++)
+        {   auto component = static_cast<std::int32_t>(std::round(clamp(normal[k], -1.0f, 1.0f) * 511.0f));
+            packed |= (static_cast<std::uint32_t>(component) & 0x3ff) << (10 * k);
+        }   return packed;
+    }
+
+    std::uint32_t encodeOctahedral(glm::vec3 const & normal)
+    {
+        // Project onto the Octahedron, Then Fold the Lower Hemisphere Outwards
+        float sum = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+        if (sum == 0.0f) return 0;
+        float x = normal.x / sum, y = normal.y / sum;
+        if (normal.z < 0.0f)
+        {   float folded = (1.0f - std::fabs(y)) * sign(x);
+            y = (1.0f - std::fabs(x)) * sign(y);
+            x = folded;
+        }   return snorm16(x) | (static_cast<std::uint32_t>(snorm16(y)) << 16);
+    }
+
+    glm::vec3 decodeOctahedral(std::uint32_t packed)
+    {
+        glm::vec3 normal(unsnorm16(packed), unsnorm16(packed >> 16), 0.0f);
+        normal.z = 1.0f - std::fabs(normal.x) - std::fabs(normal.y);
+        float t = clamp(-normal.z, 0.0f, 1.0f);
+        normal.x += normal.x >= 0.0f ? -t : t;
+        normal.y += normal.y >= 0.0f ? -t : t;
+        return glm::normalize(normal);
+    }
+};
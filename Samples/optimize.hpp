@@ -0,0 +1,81 @@
+#pragma once
+
+// Local Headers
+#include "mesh.hpp"
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Post-Transform Cache Efficiency of an Index Buffer
+    struct CacheStatistics
+    {
+        float acmr; // Average Cache Miss Ratio: Vertex Shader Runs per Triangle
+        float atvr; // Average Transformed Vertex Ratio: Shader Runs per Unique Vertex
+    };
+
+    // Simulate a FIFO Post-Transform Cache over a Triangle List
+    CacheStatistics analyze(std::vector<GLuint> const & indices,
+                            std::size_t vertexCount,
+                            unsigned int cacheSize = 16);
+
+    // Reorder Triangles for Vertex Cache Locality (Sander et al., "Tipsify")
+    void optimizeVertexCache(std::vector<GLuint> & indices,
+                             std::size_t vertexCount,
+                             unsigned int cacheSize = 16);
+
+    // Reorder Cache-Friendly Clusters Outside-In to Reduce Overdraw; a Cluster
+    // May Only Be Split While It Stays Within threshold of Its Original ACMR
+    void optimizeOverdraw(std::vector<GLuint> & indices,
+                          std::vector<Vertex> const & vertices,
+                          float threshold = 1.05f,
+                          unsigned int cacheSize = 16);
+
+    // Renumber Vertices in First-Use Order and Drop Unreferenced Ones; Skin
+    // Weights, If Given and Non-Empty, Are Renumbered Along With Them
+    void optimizeVertexFetch(std::vector<Vertex> & vertices,
+                             std::vector<GLuint> & indices,
+                             std::vector<SkinWeight> * skin = nullptr);
+
+    // Run All Three Passes in the Order That Preserves Each Gain
+    void optimize(MeshData & mesh, unsigned int cacheSize = 16);
+
+    // Compact 16-Byte Vertex Format
+    //
+    // Positions are unorm16 within the mesh bounds, so shaders must apply
+    // PackedMesh::offset and PackedMesh::scale. Normals are either
+    // 2_10_10_10_REV snorm or octahedral snorm16x2, and UVs are half floats.
+    struct PackedVertex
+    {
+        std::uint16_t position[4];
+        std::uint32_t normal;
+        std::uint16_t uv[2];
+    };
+
+    enum class NormalEncoding { Packed1010102, Octahedral };
+
+    struct PackedMesh
+    {
+        std::vector<PackedVertex> vertices;
+        glm::vec3 offset;
+        glm::vec3 scale;
+        NormalEncoding encoding;
+
+        // Point Attributes 0..2 at the Currently Bound Vertex Buffer
+        void enable() const;
+    };
+
+    PackedMesh pack(std::vector<Vertex> const & vertices,
+                    NormalEncoding encoding = NormalEncoding::Packed1010102);
+
+    // Scalar Conversions Used by pack(), Exposed for Shaders and Tools
+    std::uint16_t toHalf(float value);
+    float fromHalf(std::uint16_t value);
+    std::uint32_t encode1010102(glm::vec3 const & normal);
+    std::uint32_t encodeOctahedral(glm::vec3 const & normal);
+    glm::vec3 decodeOctahedral(std::uint32_t packed);
+};
@@ -0,0 +1,243 @@
+// Local Headers
+#include "physics.hpp"
+
+// System Headers
+#ifdef BT_THREADSAFE
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <LinearMath/btThreads.h>
+#endif
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Standard Headers
+#include <algorithm>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        Pose pose(btTransform const & transform)
+        {
+            btVector3 const & origin = transform.getOrigin();
+            btQuaternion rotation = transform.getRotation();
+            Pose result;
+            result.position = glm::vec3(origin.x(), origin.y(), origin.z());
+            result.rotation = glm::quat(rotation.w(), rotation.x(), rotation.y(), rotation.z());
+            return result;
+        }
+    }
+
+    const int PhysicsWorld::CatchUp;
+
+    PhysicsWorld::PhysicsWorld(double step, unsigned int threads)
+        : mOrigin(Clock::now())
+        , mStep(step)
+        , mThreads(1)
+        , mRunning(false)
+        , mSteps(0)
+        , mNanoseconds(0)
+    {
+        mConfiguration.reset(new btDefaultCollisionConfiguration());
+        mBroadphase.reset(new btDbvtBroadphase());
+#ifdef BT_THREADSAFE
+        // One Scheduler for the Whole Process; Bullet Refuses to Replace It Mid-Step
+        static btITaskScheduler * scheduler = btCreateDefaultTaskScheduler();
+        if (scheduler && threads > 1)
+        {
+            btSetTaskScheduler(scheduler);
+            scheduler->setNumThreads(static_cast<int>(threads));
+            mThreads = static_cast<unsigned int>(scheduler->getNumThreads());
+            mDispatcher.reset(new btCollisionDispatcherMt(mConfiguration.get()));
+            mSolverPool.reset(new btConstraintSolverPoolMt(static_cast<int>(mThreads)));
+            mSolver.reset(new btSequentialImpulseConstraintSolverMt());
+            mWorld.reset(new btDiscreteDynamicsWorldMt(mDispatcher.get(), mBroadphase.get(),
+                                                       static_cast<btConstraintSolverPoolMt *>(mSolverPool.get()),
+                                                       mSolver.get(), mConfiguration.get()));
+        }
+#else
+        (void) threads;
+#endif
+        if (!mWorld)
+        {   mDispatcher.reset(new btCollisionDispatcher(mConfiguration.get()));
+            mSolver.reset(new btSequentialImpulseConstraintSolver());
+            mWorld.reset(new btDiscreteDynamicsWorld(mDispatcher.get(), mBroadphase.get(),
+                                                     mSolver.get(), mConfiguration.get()));
+        }   mWorld->setGravity(btVector3(0, -9.81f, 0));
+    }
+
+    PhysicsWorld::~PhysicsWorld()
+    {
+        stop();
+        for (auto & body : mBodies) mWorld->removeRigidBody(body.get());
+        mBodies.clear();
+        mWorld.reset();
+    }
+
+    btCollisionShape * PhysicsWorld::shape(std::vector<MeshData> const & meshes, bool dynamic)
+    {
+        // Moving Bodies Get One Convex Hull Around Every Submesh
+        if (dynamic)
+        {
+            auto hull = new btConvexHullShape();
+            for (auto const & mesh : meshes)
+            for (auto const & vertex : mesh.vertices)
+                hull->addPoint(btVector3(vertex.position.x, vertex.position.y, vertex.position.z), false);
+            hull->recalcLocalAabb();
+            hull->optimizeConvexHull();
+            return adopt(hull);
+        }
+
+        // Static Bodies Keep Exact Triangles; Bullet Reads Them in Place
+        auto storage = new TriangleStorage();
+        mTriangles.push_back(std::unique_ptr<TriangleStorage>(storage));
+        std::size_t vertexCount = 0, indexCount = 0;
+        for (auto const & mesh : meshes)
+        {   vertexCount += mesh.vertices.size();
+            indexCount  += mesh.indices.size();
+        }
+        storage->positions.reserve(vertexCount * 3);
+        storage->indices.reserve(indexCount);
+        storage->array.reset(new btTriangleIndexVertexArray());
+
+        // Append Every Submesh First; the Arrays Must Not Move After Registration
+        std::vector<std::pair<std::size_t, std::size_t>> offsets;
+        for (auto const & mesh : meshes)
+        {
+            offsets.push_back(std::make_pair(storage->positions.size(), storage->indices.size()));
+            for (auto const & vertex : mesh.vertices)
+            {   storage->positions.push_back(vertex.position.x);
+                storage->positions.push_back(vertex.position.y);
+                storage->positions.push_back(vertex.position.z);
+            }
+            for (auto index : mesh.indices) storage->indices.push_back(static_cast<int>(index));
+        }
+
+        for (std::size_t i = 0; i < meshes.size(); i++)
+        {
+            if (meshes[i].indices.size() < 3) continue;
+            btIndexedMesh part;
+            part.m_numTriangles        = static_cast<int>(meshes[i].indices.size() / 3);
+            part.m_triangleIndexBase   = reinterpret_cast<unsigned char const *>(& storage->indices[offsets[i].second]);
+            part.m_triangleIndexStride = 3 * sizeof(int);
+            part.m_numVertices         = static_cast<int>(meshes[i].vertices.size());
+            part.m_vertexBase          = reinterpret_cast<unsigned char const *>(& storage->positions[offsets[i].first]);
+            part.m_vertexStride        = 3 * sizeof(btScalar);
+            storage->array->addIndexedMesh(part, PHY_INTEGER);
+        }
+        return adopt(new btBvhTriangleMeshShape(storage->array.get(), true));
+    }
+
+    btCollisionShape * PhysicsWorld::adopt(btCollisionShape * shape)
+    {
+        mShapes.push_back(std::unique_ptr<btCollisionShape>(shape));
+        return shape;
+    }
+
+    std::uint32_t PhysicsWorld::add(btCollisionShape * shape, float mass, glm::mat4 const & transform)
+    {
+        btTransform start;
+        start.setFromOpenGLMatrix(glm::value_ptr(transform));
+        btVector3 inertia(0, 0, 0);
+        if (mass > 0.0f) shape->calculateLocalInertia(mass, inertia);
+
+        auto motion = new btDefaultMotionState(start);
+        mMotionStates.push_back(std::unique_ptr<btDefaultMotionState>(motion));
+        btRigidBody::btRigidBodyConstructionInfo info(mass, motion, shape, inertia);
+        auto body = new btRigidBody(info);
+        mBodies.push_back(std::unique_ptr<btRigidBody>(body));
+        mWorld->addRigidBody(body);
+        mLast.push_back(pose(start));
+        return static_cast<std::uint32_t>(mBodies.size() - 1);
+    }
+
+    void PhysicsWorld::start()
+    {
+        if (mRunning) return;
+
+        // Hand the Reader the Starting Poses Before the First Step Lands
+        Snapshot & snapshot = mSnapshots.back();
+        snapshot.previous = snapshot.current = mLast;
+        snapshot.time = time();
+        mSnapshots.publish();
+        mRunning = true;
+        mThread = std::thread(& PhysicsWorld::run, this);
+    }
+
+    void PhysicsWorld::stop()
+    {
+        mRunning = false;
+        if (mThread.joinable()) mThread.join();
+    }
+
+    void PhysicsWorld::step()
+    {
+        advance(time());
+    }
+
+    void PhysicsWorld::run()
+    {
+        // Steps Are Due on a Fixed Grid; Fall Back to Now Rather Than Spiral
+        auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(mStep));
+        auto due = Clock::now();
+        while (mRunning)
+        {
+            int stepped = 0;
+            while (Clock::now() >= due && stepped < CatchUp)
+            {   advance(std::chrono::duration<double>(due - mOrigin).count());
+                due += interval;
+                stepped++;
+            }
+            if (stepped == CatchUp) due = Clock::now();
+            std::this_thread::sleep_until(due);
+        }
+    }
+
+    void PhysicsWorld::advance(double due)
+    {
+        auto start = Clock::now();
+        mWorld->stepSimulation(static_cast<btScalar>(mStep), 0);
+        mNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        mSteps++;
+
+        // Publish Last Step's Poses Alongside This One's So the Reader Can Blend
+        Snapshot & snapshot = mSnapshots.back();
+        snapshot.previous = mLast;
+        for (std::size_t i = 0; i < mBodies.size(); i++)
+            mLast[i] = pose(mBodies[i]->getWorldTransform());
+        snapshot.current = mLast;
+        snapshot.time = due;
+        mSnapshots.publish();
+    }
+
+    bool PhysicsWorld::read(std::vector<glm::mat4> & transforms, double time)
+    {
+        bool fresh = mSnapshots.update();
+        Snapshot const & snapshot = mSnapshots.front();
+
+        // Render One Step Behind: Blend From Previous to Current Over the Step
+        float alpha = static_cast<float>((time - snapshot.time) / mStep);
+        alpha = std::min(std::max(alpha, 0.0f), 1.0f);
+        transforms.resize(snapshot.current.size());
+        for (std::size_t i = 0; i < snapshot.current.size(); i++)
+        {
+            Pose const & current = snapshot.current[i];
+            Pose const & previous = i < snapshot.previous.size() ? snapshot.previous[i] : current;
+            glm::vec3 position = glm::mix(previous.position, current.position, alpha);
+            glm::quat rotation = glm::slerp(previous.rotation, current.rotation, alpha);
+            transforms[i] = glm::translate(glm::mat4(1.0f), position) * glm::mat4_cast(rotation);
+        }   return fresh;
+    }
+
+    double PhysicsWorld::time() const
+    {
+        return std::chrono::duration<double>(Clock::now() - mOrigin).count();
+    }
+
+    double PhysicsWorld::milliseconds() const
+    {
+        return mSteps > 0 ? mNanoseconds * 1e-6 / mSteps : 0.0;
+    }
+};
@@ -0,0 +1,162 @@
+#pragma once
+
+// Local Headers
+#include "mesh.hpp"
+
+// System Headers
+#include <btBulletDynamicsCommon.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Standard Headers
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Single-Producer, Single-Consumer Handoff Without Locks
+    //
+    // The writer fills back() and publishes it; the reader calls update()
+    // and then looks at front(). Both sides own one slot each, and the
+    // third is swapped between them through a single atomic word whose
+    // spare bit says whether the middle slot holds something newer than
+    // what the reader has. Neither side ever waits on the other.
+    template<typename T> class TripleBuffer
+    {
+    public:
+
+        // Implement Default Constructor
+        TripleBuffer() : mState(1), mBack(0), mFront(2) {}
+
+        // Public Member Functions
+        T & back() { return mSlots[mBack]; }
+        T const & front() const { return mSlots[mFront]; }
+        void publish() { mBack = mState.exchange(mBack | Fresh, std::memory_order_acq_rel) & Slot; }
+        bool update()
+        {
+            if (!(mState.load(std::memory_order_relaxed) & Fresh)) return false;
+            mFront = mState.exchange(mFront, std::memory_order_acq_rel) & Slot;
+            return true;
+        }
+
+    private:
+
+        // Disable Copying and Assignment
+        TripleBuffer(TripleBuffer const &) = delete;
+        TripleBuffer & operator=(TripleBuffer const &) = delete;
+
+        // Private Member Containers
+        T mSlots[3];
+
+        // Private Member Variables
+        static const unsigned int Slot  = 3;
+        static const unsigned int Fresh = 4;
+        std::atomic<unsigned int> mState;
+        unsigned int mBack;
+        unsigned int mFront;
+
+    };
+
+    // Rigid Body Placement Handed From the Physics Thread to the Renderer
+    struct Pose
+    {
+        glm::vec3 position;
+        glm::quat rotation;
+    };
+
+    // Bullet World Stepped at a Fixed Rate on Its Own Thread
+    //
+    // Each step publishes the previous and current pose of every body
+    // through a TripleBuffer, stamped with the time the step was due.
+    // read() interpolates between the two, one step behind real time, so
+    // motion stays smooth whatever the render rate. When Bullet is built
+    // with BT_THREADSAFE the world is a btDiscreteDynamicsWorldMt running
+    // on Bullet's task scheduler, which is process-wide, so the most recent
+    // world decides the thread count. Add bodies only while stopped, and
+    // call read() from one thread only.
+    class PhysicsWorld
+    {
+    public:
+
+        typedef std::chrono::steady_clock Clock;
+
+        // Implement Custom Constructor and Destructor
+         PhysicsWorld(double step = 1.0 / 60.0, unsigned int threads = 1);
+        ~PhysicsWorld();
+
+        // Public Member Functions
+        btCollisionShape * shape(std::vector<MeshData> const & meshes, bool dynamic);
+        btCollisionShape * adopt(btCollisionShape * shape);
+        std::uint32_t add(btCollisionShape * shape, float mass, glm::mat4 const & transform);
+        btRigidBody * body(std::uint32_t id) { return mBodies[id].get(); }
+        void start();
+        void stop();
+        void step();
+        bool read(std::vector<glm::mat4> & transforms, double time);
+        double time() const;
+        double milliseconds() const;
+        std::uint64_t steps() const { return mSteps; }
+        unsigned int threads() const { return mThreads; }
+        std::size_t size() const { return mBodies.size(); }
+        btDiscreteDynamicsWorld & world() { return *mWorld; }
+
+        // Steps Run Back to Back Before the Thread Gives Up and Drops Time
+        static const int CatchUp = 5;
+
+    private:
+
+        // Disable Copying and Assignment
+        PhysicsWorld(PhysicsWorld const &) = delete;
+        PhysicsWorld & operator=(PhysicsWorld const &) = delete;
+
+        // Poses of Two Consecutive Steps
+        struct Snapshot
+        {
+            std::vector<Pose> previous;
+            std::vector<Pose> current;
+            double time;
+        };
+
+        // Triangle Data Referenced, Not Copied, by Bullet
+        struct TriangleStorage
+        {
+            std::vector<btScalar> positions;
+            std::vector<int> indices;
+            std::unique_ptr<btTriangleIndexVertexArray> array;
+        };
+
+        // Private Member Functions
+        void run();
+        void advance(double due);
+
+        // Private Member Containers
+        std::unique_ptr<btDefaultCollisionConfiguration> mConfiguration;
+        std::unique_ptr<btCollisionDispatcher> mDispatcher;
+        std::unique_ptr<btBroadphaseInterface> mBroadphase;
+        std::unique_ptr<btConstraintSolver> mSolverPool;
+        std::unique_ptr<btConstraintSolver> mSolver;
+        std::unique_ptr<btDiscreteDynamicsWorld> mWorld;
+        std::vector<std::unique_ptr<TriangleStorage>> mTriangles;
+        std::vector<std::unique_ptr<btCollisionShape>> mShapes;
+        std::vector<std::unique_ptr<btDefaultMotionState>> mMotionStates;
+        std::vector<std::unique_ptr<btRigidBody>> mBodies;
+        std::vector<Pose> mLast;
+        TripleBuffer<Snapshot> mSnapshots;
+        std::thread mThread;
+
+        // Private Member Variables
+        Clock::time_point mOrigin;
+        double mStep;
+        unsigned int mThreads;
+        std::atomic<bool> mRunning;
+        std::atomic<std::uint64_t> mSteps;
+        std::atomic<std::uint64_t> mNanoseconds;
+
+    };
+};
@@ -0,0 +1,15 @@
+// Local Headers
+#include "pool.hpp"
+
+// Define Namespace
+namespace Mirage
+{
+    void ThreadPool::run(std::size_t count, std::function<void(std::size_t)> const & task)
+    {
+        // Single Indices; Callers Already Hand Out Work in Coarse Batches
+        mJobs.ParallelFor(0, count, 1, [&task](std::size_t first, std::size_t last)
+        {
+            for (std::size_t i = first; i < last; i++) task(i);
+        });
+    }
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+// Local Headers
+#include "job_system.hpp"
+
+// Standard Headers
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+// Define Namespace
+namespace Mirage
+{
+    // Fixed-Size Pool of Worker Threads
+    //
+    // A thin front end to the work-stealing JobSystem: submit() spawns a job
+    // and run() is a ParallelFor with one index per grain, which the calling
+    // thread helps drain. Calls from the thread that built the pool or from
+    // inside a task push onto that thread's own deque, and tasks may nest
+    // run() without deadlocking. The destructor finishes every submitted task.
+    class ThreadPool
+    {
+    public:
+
+        // Implement Custom Constructor
+        ThreadPool(unsigned int workers) : mJobs(workers == 0 ? 1 : workers) {}
+
+        // Public Member Functions
+        void submit(std::function<void()> task) { mJobs.Spawn(std::move(task)); }
+        void run(std::size_t count, std::function<void(std::size_t)> const & task);
+        unsigned int size() const { return mJobs.Size(); }
+        JobSystem & jobs() { return mJobs; }
+
+    private:
+
+        // Disable Copying and Assignment
+        ThreadPool(ThreadPool const &) = delete;
+        ThreadPool & operator=(ThreadPool const &) = delete;
+
+        // Private Member Variables
+        JobSystem mJobs;
+
+    };
+};
@@ -0,0 +1,616 @@
+// Local Headers
+#include "raster.hpp"
+#include "pool.hpp"
+
+// System Headers
+#include <stb_image_write.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        const int TileSize = 64;
+        const int BlockSize = 8;
+        const int Subpixels = 256;              // 8 Fractional Bits
+        const int GuardBand = Rasterizer::Limit; // Pixels Beyond Each Side of the Viewport
+        const std::size_t BatchTriangles = 4096;
+        const std::size_t VertexGrain = 16384;
+
+        // Thin Wrappers So the Pixel Kernel Is Written Once for AVX2, SSE2 and Scalar Builds
+#if defined(__AVX2__)
+        typedef __m256 Lanes;
+        typedef __m256i Ints;
+        typedef __m256 Mask;
+        const int Width = 8;
+        inline Lanes splat(float v) { return _mm256_set1_ps(v); }
+        inline Lanes ramp(float start, float step)
+        {
+            return _mm256_add_ps(_mm256_set1_ps(start),
+                                 _mm256_mul_ps(_mm256_set1_ps(step), _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7)));
+        }
+        inline Ints ramp(std::int32_t start, std::int32_t step)
+        {
+            return _mm256_add_epi32(_mm256_set1_epi32(start),
+                                    _mm256_mullo_epi32(_mm256_set1_epi32(step), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+        }
+        inline Ints splat(std::int32_t v) { return _mm256_set1_epi32(v); }
+        inline Lanes add(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+        inline Ints add(Ints a, Ints b) { return _mm256_add_epi32(a, b); }
+        inline Lanes mul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+        inline Lanes div(Lanes a, Lanes b) { return _mm256_div_ps(a, b); }
+        inline Lanes clamp(Lanes v) { return _mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()), splat(1.0f)); }
+        inline Lanes load(float const * p) { return _mm256_loadu_ps(p); }
+        inline void store(float * p, Lanes v) { _mm256_storeu_ps(p, v); }
+        inline Ints load(std::uint32_t const * p) { return _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p)); }
+        inline void store(std::uint32_t * p, Ints v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+        inline Mask all() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+        inline Mask covered(Ints e0, Ints e1, Ints e2)
+        {
+            // Sign Bits Mark Pixels Outside Any Edge
+            Ints outside = _mm256_srai_epi32(_mm256_or_si256(_mm256_or_si256(e0, e1), e2), 31);
+            return _mm256_castsi256_ps(_mm256_xor_si256(outside, _mm256_set1_epi32(-1)));
+        }
+        inline Mask both(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+        inline Mask less(Lanes a, Lanes b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+        inline int bits(Mask m) { return _mm256_movemask_ps(m); }
+        inline Lanes select(Mask m, Lanes a, Lanes b) { return _mm256_blendv_ps(b, a, m); }
+        inline Ints select(Mask m, Ints a, Ints b)
+        {
+            return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(b), _mm256_castsi256_ps(a), m));
+        }
+        inline Ints pack(Lanes r, Lanes g, Lanes b)
+        {
+            Lanes scale = splat(255.0f), half = splat(0.5f);
+            Ints red   = _mm256_cvttps_epi32(add(mul(clamp(r), scale), half));
+            Ints green = _mm256_cvttps_epi32(add(mul(clamp(g), scale), half));
+            Ints blue  = _mm256_cvttps_epi32(add(mul(clamp(b), scale), half));
+            return _mm256_or_si256(_mm256_or_si256(red, _mm256_slli_epi32(green, 8)),
+                                   _mm256_or_si256(_mm256_slli_epi32(blue, 16), _mm256_set1_epi32(0xFF000000)));
+        }
+#elif defined(__SSE2__)
+        typedef __m128 Lanes;
+        typedef __m128i Ints;
+        typedef __m128 Mask;
+        const int Width = 4;
+        inline Lanes splat(float v) { return _mm_set1_ps(v); }
+        inline Lanes ramp(float start, float step)
+        {
+            return _mm_add_ps(_mm_set1_ps(start), _mm_mul_ps(_mm_set1_ps(step), _mm_setr_ps(0, 1, 2, 3)));
+        }
+        inline Ints ramp(std::int32_t start, std::int32_t step)
+        {
+            // SSE2 Has No 32-Bit Multiply; Four Adds Are as Cheap
+            return _mm_setr_epi32(start, start + step, start + 2 * step, start + 3 * step);
+        }
+        inline Ints splat(std::int32_t v) { return _mm_set1_epi32(v); }
+        inline Lanes add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+        inline Ints add(Ints a, Ints b) { return _mm_add_epi32(a, b); }
+        inline Lanes mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+        inline Lanes div(Lanes a, Lanes b) { return _mm_div_ps(a, b); }
+        inline Lanes clamp(Lanes v) { return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), splat(1.0f)); }
+        inline Lanes load(float const * p) { return _mm_loadu_ps(p); }
+        inline void store(float * p, Lanes v) { _mm_storeu_ps(p, v); }
+        inline Ints load(std::uint32_t const * p) { return _mm_loadu_si128(reinterpret_cast<__m128i const *>(p)); }
+        inline void store(std::uint32_t * p, Ints v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+        inline Mask all() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+        inline Mask covered(Ints e0, Ints e1, Ints e2)
+        {
+            Ints outside = _mm_srai_epi32(_mm_or_si128(_mm_or_si128(e0, e1), e2), 31);
+            return _mm_castsi128_ps(_mm_xor_si128(outside, _mm_set1_epi32(-1)));
+        }
+        inline Mask both(Mask a, Mask b) { return _mm_and_ps(a, b); }
+        inline Mask less(Lanes a, Lanes b) { return _mm_cmplt_ps(a, b); }
+        inline int bits(Mask m) { return _mm_movemask_ps(m); }
+        inline Lanes select(Mask m, Lanes a, Lanes b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+        inline Ints select(Mask m, Ints a, Ints b)
+        {
+            return _mm_castps_si128(select(m, _mm_castsi128_ps(a), _mm_castsi128_ps(b)));
+        }
+        inline Ints pack(Lanes r, Lanes g, Lanes b)
+        {
+            Lanes scale = splat(255.0f), half = splat(0.5f);
+            Ints red   = _mm_cvttps_epi32(add(mul(clamp(r), scale), half));
+            Ints green = _mm_cvttps_epi32(add(mul(clamp(g), scale), half));
+            Ints blue  = _mm_cvttps_epi32(add(mul(clamp(b), scale), half));
+            return _mm_or_si128(_mm_or_si128(red, _mm_slli_epi32(green, 8)),
+                                _mm_or_si128(_mm_slli_epi32(blue, 16), _mm_set1_epi32(0xFF000000)));
+        }
+#else
+        typedef float Lanes;
+        typedef std::int32_t Ints;
+        typedef bool Mask;
+        const int Width = 1;
+        inline Lanes splat(float v) { return v; }
+        inline Lanes ramp(float start, float) { return start; }
+        inline Ints ramp(std::int32_t start, std::int32_t) { return start; }
+        inline Ints splat(std::int32_t v) { return v; }
+        inline Lanes add(Lanes a, Lanes b) { return a + b; }
+        inline Ints add(Ints a, Ints b) { return a + b; }
+        inline Lanes mul(Lanes a, Lanes b) { return a * b; }
+        inline Lanes div(Lanes a, Lanes b) { return a / b; }
+        inline Lanes clamp(Lanes v) { return std::min(std::max(v, 0.0f), 1.0f); }
+        inline Lanes load(float const * p) { return *p; }
+        inline void store(float * p, Lanes v) { *p = v; }
+        inline Ints load(std::uint32_t const * p) { return static_cast<Ints>(*p); }
+        inline void store(std::uint32_t * p, Ints v) { *p = static_cast<std::uint32_t>(v); }
+        inline Mask all() { return true; }
+        inline Mask covered(Ints e0, Ints e1, Ints e2) { return (e0 | e1 | e2) >= 0; }
+        inline Mask both(Mask a, Mask b) { return a && b; }
+        inline Mask less(Lanes a, Lanes b) { return a < b; }
+        inline int bits(Mask m) { return m ? 1 : 0; }
+        inline Lanes select(Mask m, Lanes a, Lanes b) { return m ? a : b; }
+        inline Ints select(Mask m, Ints a, Ints b) { return m ? a : b; }
+        inline Ints pack(Lanes r, Lanes g, Lanes b)
+        {
+            std::uint32_t red   = static_cast<std::uint32_t>(clamp(r) * 255.0f + 0.5f);
+            std::uint32_t green = static_cast<std::uint32_t>(clamp(g) * 255.0f + 0.5f);
+            std::uint32_t blue  = static_cast<std::uint32_t>(clamp(b) * 255.0f + 0.5f);
+            return static_cast<Ints>(red | green << 8 | blue << 16 | 0xFF000000u);
+        }
+#endif
+
+        inline int count(int mask)
+        {
+            int total = 0;
+            for (; mask; mask &= mask - 1) total++;
+            return total;
+        }
+
+        inline std::int64_t floorDivide(std::int64_t value, std::int64_t divisor)
+        {
+            return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+        }
+
+        // Half Away From Zero, Like std::llround Without the Library Call
+        inline std::int64_t nearest(double value)
+        {
+            return static_cast<std::int64_t>(value + (value < 0.0 ? -0.5 : 0.5));
+        }
+
+        inline double seconds(Clock::time_point start)
+        {
+            return std::chrono::duration<double>(Clock::now() - start).count();
+        }
+
+        // Clip Space Planes as Coefficients of (x, y, z, w); Inside Where the Dot Product Is >= 0
+        enum Plane { Left, Right, Bottom, Top, Near, Far, GuardLeft, GuardRight, GuardBottom, GuardTop, Planes };
+        const unsigned int ViewPlanes = 0x3F;
+        const unsigned int ClipPlanes = 1 << Near | 1 << Far | 0xF << GuardLeft;
+    }
+
+    const int Rasterizer::Limit;
+
+    ImageDifference compare(std::vector<unsigned char> const & a, std::vector<unsigned char> const & b, int tolerance)
+    {
+        ImageDifference difference = { 0, 0, std::numeric_limits<double>::infinity() };
+        if (a.size() != b.size())
+        {   difference.pixels = std::max(a.size(), b.size()) / 3;
+            difference.largest = 255;
+            difference.psnr = 0.0;
+            return difference;
+        }
+        double squared = 0.0;
+        for (std::size_t i = 0; i + 2 < a.size(); i += 3)
+        {   int worst = 0;
+            for (std::size_t c = i; c < i + 3; c++)
+            {   int delta = std::abs(static_cast<int>(a[c]) - static_cast<int>(b[c]));
+                worst = std::max(worst, delta);
+                squared += delta * delta;
+            }
+            difference.largest = std::max(difference.largest, worst);
+            if (worst > tolerance) difference.pixels++;
+        }
+        if (squared > 0.0) difference.psnr = 10.0 * std::log10(255.0 * 255.0 * a.size() / squared);
+        return difference;
+    }
+
+    Rasterizer::Rasterizer(int width, int height, ThreadPool * pool)
+        : mPool(pool)
+        , mWidth(std::min(std::max(width, 1), Limit))
+        , mHeight(std::min(std::max(height, 1), Limit))
+        , mBatchCount(0)
+    {
+        mTilesX = (mWidth + TileSize - 1) / TileSize;
+        mTilesY = (mHeight + TileSize - 1) / TileSize;
+        mStride = mTilesX * TileSize;
+        mColor.resize(static_cast<std::size_t>(mStride) * mTilesY * TileSize);
+        mDepth.resize(mColor.size());
+        mTiles.resize(static_cast<std::size_t>(mTilesX) * mTilesY);
+        clear(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    }
+
+    void Rasterizer::clear(glm::vec4 const & color, float depth)
+    {
+        // Queued Triangles Would Be Covered Anyway
+        mVaryings.clear();
+        mIndices.clear();
+        glm::vec4 c = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+        std::uint32_t packed = static_cast<std::uint32_t>(c.x) | static_cast<std::uint32_t>(c.y) << 8
+                             | static_cast<std::uint32_t>(c.z) << 16 | static_cast<std::uint32_t>(c.w) << 24;
+        std::fill(mColor.begin(), mColor.end(), packed);
+        std::fill(mDepth.begin(), mDepth.end(), glm::clamp(depth, 0.0f, 1.0f));
+    }
+
+    void Rasterizer::draw(Vertex const * vertices, std::size_t vertexCount,
+                          GLuint const * indices,  std::size_t indexCount, Shading const & shading)
+    {
+        auto start = Clock::now();
+        std::size_t base = mVaryings.size();
+        mVaryings.resize(base + vertexCount);
+
+        // shader.vert, With the Transform Applied to What It Writes
+        float const Pi = 3.1415926f; // As in common.glsl
+        float m = shading.multiplier;
+        glm::vec4 wobble(std::sin(2.0f * Pi * m), std::cos(Pi * m / 3.0f), 1.0f + m, 1.0f);
+        auto shade = [&](std::size_t first, std::size_t last)
+        {
+            for (std::size_t i = first; i < last; i++)
+            {   Varying & varying = mVaryings[base + i];
+                glm::vec4 position(vertices[i].position, 1.0f);
+                if (shading.wobble) position *= wobble;
+                varying.position = shading.transform * position;
+                varying.color = vertices[i].normal;
+                if (shading.tint) varying.color *= glm::vec3(1.0f - m, m, 1.0f); // shader.frag; Linear, So Per Vertex Is Exact
+            }
+        };
+        if (mPool && vertexCount > VertexGrain)
+            mPool->run((vertexCount + VertexGrain - 1) / VertexGrain, [&](std::size_t chunk)
+            {
+                shade(chunk * VertexGrain, std::min(vertexCount, (chunk + 1) * VertexGrain));
+            });
+        else shade(0, vertexCount);
+
+        // Triangles Referencing Missing Vertices Are Dropped
+        mIndices.reserve(mIndices.size() + indexCount);
+        for (std::size_t i = 0; i + 2 < indexCount; i += 3)
+        {   if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount || indices[i + 2] >= vertexCount) continue;
+            for (std::size_t j = i; j < i + 3; j++)
+                mIndices.push_back(static_cast<std::uint32_t>(base + indices[j]));
+        }
+        mStatistics.triangles += indexCount / 3;
+        mStatistics.vertexSeconds += seconds(start);
+    }
+
+    void Rasterizer::draw(MeshData const & mesh, Shading const & shading, std::size_t level)
+    {
+        // Submeshes With Shorter Chains Stay at Their Coarsest Level
+        GLuint const * indices = mesh.indices.data();
+        std::size_t count = mesh.indices.size();
+        if (level > 0 && !mesh.lods.empty())
+        {   LevelOfDetail const & lod = mesh.lods[std::min(level, mesh.lods.size()) - 1];
+            indices = mesh.lodIndices.data() + lod.indexOffset;
+            count = lod.indexCount;
+        }
+        draw(mesh.vertices.data(), mesh.vertices.size(), indices, count, shading);
+    }
+
+    void Rasterizer::draw(std::vector<MeshData> const & meshes, Shading const & shading, std::size_t level)
+    {
+        for (auto const & mesh : meshes) draw(mesh, shading, level);
+    }
+
+    void Rasterizer::draw(std::vector<MeshData> const & meshes, std::vector<std::uint32_t> const & visible,
+                          Shading const & shading)
+    {
+        // Draw Only the Submeshes That Survived Culling
+        for (auto i : visible) draw(meshes[i], shading);
+    }
+
+    void Rasterizer::flush()
+    {
+        std::size_t triangles = mIndices.size() / 3;
+        if (triangles == 0) return;
+
+        // Set Up and Bin Fixed Runs of Triangles, So the Result Is the Same on Any Pool
+        auto start = Clock::now();
+        mBatchCount = (triangles + BatchTriangles - 1) / BatchTriangles;
+        if (mBatches.size() < mBatchCount) mBatches.resize(mBatchCount);
+        auto setupBatch = [&](std::size_t i)
+        {
+            setup(i * BatchTriangles, std::min(triangles, (i + 1) * BatchTriangles), mBatches[i]);
+        };
+        if (mPool) mPool->run(mBatchCount, setupBatch);
+        else for (std::size_t i = 0; i < mBatchCount; i++) setupBatch(i);
+        for (std::size_t i = 0; i < mBatchCount; i++)
+        {   mStatistics.clipped += mBatches[i].statistics.clipped;
+            mStatistics.culled += mBatches[i].statistics.culled;
+            mStatistics.binned += mBatches[i].statistics.binned;
+        }
+        mStatistics.setupSeconds += seconds(start);
+
+        // Tiles Own Disjoint Pixels, So They Rasterize Without Locking
+        start = Clock::now();
+        auto rasterTile = [&](std::size_t tile) { raster(tile, mTiles[tile]); };
+        if (mPool) mPool->run(mTiles.size(), rasterTile);
+        else for (std::size_t i = 0; i < mTiles.size(); i++) rasterTile(i);
+        for (auto & tile : mTiles)
+        {   mStatistics.fragments += tile.fragments;
+            mStatistics.written += tile.written;
+            tile = RasterStatistics();
+        }
+        mStatistics.rasterSeconds += seconds(start);
+        mVaryings.clear();
+        mIndices.clear();
+    }
+
+    void Rasterizer::read(std::vector<unsigned char> & pixels)
+    {
+        flush();
+        pixels.resize(static_cast<std::size_t>(mWidth) * mHeight * 3);
+        for (int y = 0; y < mHeight; y++)
+        {   std::uint32_t const * row = & mColor[static_cast<std::size_t>(y) * mStride];
+            unsigned char * out = & pixels[static_cast<std::size_t>(mHeight - 1 - y) * mWidth * 3];
+            for (int x = 0; x < mWidth; x++)
+            {   out[x * 3 + 0] = static_cast<unsigned char>(row[x]);
+                out[x * 3 + 1] = static_cast<unsigned char>(row[x] >> 8);
+                out[x * 3 + 2] = static_cast<unsigned char>(row[x] >> 16);
+            }
+        }
+    }
+
+    bool Rasterizer::write(std::string const & path)
+    {
+        std::vector<unsigned char> pixels;
+        read(pixels);
+        return stbi_write_png(path.c_str(), mWidth, mHeight, 3, pixels.data(), mWidth * 3) != 0;
+    }
+
+    void Rasterizer::setup(std::size_t first, std::size_t last, Batch & batch) const
+    {
+        batch.triangles.clear();
+        batch.statistics = RasterStatistics();
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs; // Tile, Triangle
+        pairs.reserve((last - first) * 2);
+
+        // Guard Band in Normalized Device Coordinates
+        float gx = 1.0f + 2.0f * GuardBand / mWidth;
+        float gy = 1.0f + 2.0f * GuardBand / mHeight;
+        glm::vec4 const planes[Planes] =
+        {   glm::vec4( 1, 0, 0, 1), glm::vec4(-1, 0, 0, 1), glm::vec4(0,  1, 0, 1), glm::vec4(0, -1, 0, 1),
+            glm::vec4( 0, 0, 1, 1), glm::vec4( 0, 0,-1, 1),
+            glm::vec4( 1, 0, 0, gx), glm::vec4(-1, 0, 0, gx), glm::vec4(0, 1, 0, gy), glm::vec4(0, -1, 0, gy),
+        };
+
+        for (std::size_t t = first; t < last; t++)
+        {
+            Varying polygon[3 + Planes];
+            unsigned int outside[3], shared = ~0u, any = 0u;
+            for (int v = 0; v < 3; v++)
+            {   polygon[v] = mVaryings[mIndices[t * 3 + v]];
+                glm::vec4 const & p = polygon[v].position;
+                outside[v] = (p.x < -p.w)  << Left     | (p.x > p.w)       << Right
+                           | (p.y < -p.w)  << Bottom   | (p.y > p.w)       << Top
+                           | (p.z < -p.w)  << Near     | (p.z > p.w)       << Far
+                           | (p.x < -gx * p.w) << GuardLeft   | (p.x > gx * p.w) << GuardRight
+                           | (p.y < -gy * p.w) << GuardBottom | (p.y > gy * p.w) << GuardTop;
+                shared &= outside[v];
+                any |= outside[v];
+            }
+            if (shared & ViewPlanes) { batch.statistics.culled++; continue; }
+            if (!(any & ClipPlanes)) { emit(polygon, 3, batch, pairs); continue; }
+
+            // Sutherland-Hodgman Against the Planes Some Vertex Is Outside Of
+            batch.statistics.clipped++;
+            std::size_t count = 3;
+            Varying scratch[3 + Planes];
+            for (int p = 0; p < Planes && count >= 3; p++)
+            {   if (!(any & ClipPlanes & (1u << p))) continue;
+                std::size_t kept = 0;
+                for (std::size_t i = 0; i < count; i++)
+                {   Varying const & a = polygon[i];
+                    Varying const & b = polygon[(i + 1) % count];
+                    float da = glm::dot(planes[p], a.position), db = glm::dot(planes[p], b.position);
+                    if (da >= 0.0f) scratch[kept++] = a;
+                    if ((da >= 0.0f) != (db >= 0.0f))
+                    {   float s = da / (da - db);
+                        scratch[kept].position = a.position + (b.position - a.position) * s;
+                        scratch[kept].color = a.color + (b.color - a.color) * s;
+                        kept++;
+                    }
+                }
+                std::copy(scratch, scratch + kept, polygon);
+                count = kept;
+            }
+            if (count >= 3) emit(polygon, count, batch, pairs);
+            else batch.statistics.culled++;
+        }
+
+        // Counting Sort by Tile Keeps Each Tile's Triangles in Submission Order
+        std::size_t tiles = mTiles.size();
+        batch.offsets.assign(tiles + 1, 0);
+        for (auto const & pair : pairs) batch.offsets[pair.first + 1]++;
+        for (std::size_t i = 0; i < tiles; i++) batch.offsets[i + 1] += batch.offsets[i];
+        batch.entries.resize(pairs.size());
+        std::vector<std::uint32_t> cursor(batch.offsets.begin(), batch.offsets.end() - 1);
+        for (auto const & pair : pairs) batch.entries[cursor[pair.first]++] = pair.second;
+        batch.statistics.binned = pairs.size();
+    }
+
+    void Rasterizer::emit(Varying const * polygon, std::size_t count, Batch & batch,
+                          std::vector<std::pair<std::uint32_t, std::uint32_t>> & pairs) const
+    {
+        // Snap to Fixed Point in Window Space, With GL's Viewport and Depth Range Transforms
+        std::int64_t x[3 + Planes], y[3 + Planes];
+        float z[3 + Planes], q[3 + Planes];
+        for (std::size_t i = 0; i < count; i++)
+        {   glm::vec4 const & p = polygon[i].position;
+            if (p.w <= 0.0f) { batch.statistics.culled++; return; }
+            double w = 1.0 / p.w;
+            x[i] = nearest((p.x * w * 0.5 + 0.5) * mWidth * Subpixels);
+            y[i] = nearest((p.y * w * 0.5 + 0.5) * mHeight * Subpixels);
+            z[i] = static_cast<float>(p.z * w * 0.5 + 0.5);
+            q[i] = static_cast<float>(w);
+        }
+
+        // Fan Out Clipped Polygons From Their First Vertex
+        for (std::size_t f = 1; f + 1 < count; f++)
+        {
+            std::size_t v[3] = { 0, f, f + 1 };
+            std::int64_t area = (x[v[1]] - x[v[0]]) * (y[v[2]] - y[v[0]]) - (x[v[2]] - x[v[0]]) * (y[v[1]] - y[v[0]]);
+            if (area == 0) { batch.statistics.culled++; continue; }
+            if (area < 0) { std::swap(v[1], v[2]); area = -area; } // Counterclockwise From Here On
+
+            // Pixel Centers Inside the Bounding Box, Clamped to the Viewport
+            std::int64_t left   = std::min(x[v[0]], std::min(x[v[1]], x[v[2]]));
+            std::int64_t right  = std::max(x[v[0]], std::max(x[v[1]], x[v[2]]));
+            std::int64_t bottom = std::min(y[v[0]], std::min(y[v[1]], y[v[2]]));
+            std::int64_t top    = std::max(y[v[0]], std::max(y[v[1]], y[v[2]]));
+            Triangle triangle;
+            triangle.minX = static_cast<std::int32_t>(std::max<std::int64_t>(0, -floorDivide(Subpixels / 2 - left, Subpixels)));
+            triangle.minY = static_cast<std::int32_t>(std::max<std::int64_t>(0, -floorDivide(Subpixels / 2 - bottom, Subpixels)));
+            triangle.maxX = static_cast<std::int32_t>(std::min<std::int64_t>(mWidth - 1, floorDivide(right - Subpixels / 2, Subpixels)));
+            triangle.maxY = static_cast<std::int32_t>(std::min<std::int64_t>(mHeight - 1, floorDivide(top - Subpixels / 2, Subpixels)));
+            if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+            {   batch.statistics.culled++;
+                continue;
+            }
+
+            // Edge e Is Opposite Vertex e; Non-Top-Left Edges Must Be Strictly Positive
+            double inverse = 1.0 / static_cast<double>(area), planes[3][3];
+            for (int e = 0; e < 3; e++)
+            {   std::size_t i = v[(e + 1) % 3], j = v[(e + 2) % 3];
+                std::int64_t a = y[i] - y[j], b = x[j] - x[i];
+                std::int64_t c = -(a * x[i] + b * y[i]);
+                bool topLeft = a > 0 || (a == 0 && b < 0);
+                triangle.a[e] = static_cast<std::int32_t>(a);
+                triangle.b[e] = static_cast<std::int32_t>(b);
+                triangle.k[e] = floorDivide(a * (Subpixels / 2) + b * (Subpixels / 2) + c - (topLeft ? 0 : 1), Subpixels);
+
+                // Barycentric Weight at the Center of Pixel (minX, minY), and Its Steps per Pixel
+                std::int64_t origin = a * (triangle.minX * Subpixels + Subpixels / 2)
+                                    + b * (triangle.minY * Subpixels + Subpixels / 2) + c;
+                planes[e][0] = origin * inverse;
+                planes[e][1] = a * Subpixels * inverse;
+                planes[e][2] = b * Subpixels * inverse;
+            }
+            for (int i = 0; i < 3; i++)
+            {   triangle.lambda1[i] = static_cast<float>(planes[1][i]);
+                triangle.lambda2[i] = static_cast<float>(planes[2][i]);
+            }
+            triangle.z[0] = z[v[0]];
+            triangle.z[1] = z[v[1]] - z[v[0]];
+            triangle.z[2] = z[v[2]] - z[v[0]];
+            triangle.q[0] = q[v[0]];
+            triangle.q[1] = q[v[1]] - q[v[0]];
+            triangle.q[2] = q[v[2]] - q[v[0]];
+            for (int c = 0; c < 3; c++)
+            {   float c0 = polygon[v[0]].color[c] * q[v[0]];
+                triangle.color[c][0] = c0;
+                triangle.color[c][1] = polygon[v[1]].color[c] * q[v[1]] - c0;
+                triangle.color[c][2] = polygon[v[2]].color[c] * q[v[2]] - c0;
+            }
+
+            // Bin Into Every Tile the Triangle Is Not Wholly Outside Of
+            std::uint32_t index = static_cast<std::uint32_t>(batch.triangles.size());
+            bool binned = false;
+            for (int ty = triangle.minY / TileSize; ty <= triangle.maxY / TileSize; ty++)
+            for (int tx = triangle.minX / TileSize; tx <= triangle.maxX / TileSize; tx++)
+            {   bool outside = false;
+                for (int e = 0; e < 3 && !outside; e++)
+                {   std::int64_t reach = triangle.k[e] + static_cast<std::int64_t>(triangle.a[e]) * tx * TileSize
+                                       + static_cast<std::int64_t>(triangle.b[e]) * ty * TileSize
+                                       + std::max<std::int64_t>(0, triangle.a[e]) * (TileSize - 1)
+                                       + std::max<std::int64_t>(0, triangle.b[e]) * (TileSize - 1);
+                    outside = reach < 0;
+                }
+                if (outside) continue;
+                pairs.push_back(std::make_pair(static_cast<std::uint32_t>(ty * mTilesX + tx), index));
+                binned = true;
+            }
+            if (binned) batch.triangles.push_back(triangle);
+            else batch.statistics.culled++;
+        }
+    }
+
+    void Rasterizer::raster(std::size_t tile, RasterStatistics & statistics)
+    {
+        int tileX = static_cast<int>(tile % mTilesX) * TileSize;
+        int tileY = static_cast<int>(tile / mTilesX) * TileSize;
+        for (std::size_t b = 0; b < mBatchCount; b++)
+        {   Batch const & batch = mBatches[b];
+            for (std::uint32_t n = batch.offsets[tile]; n < batch.offsets[tile + 1]; n++)
+            {
+                Triangle const & t = batch.triangles[batch.entries[n]];
+                Lanes z0 = splat(t.z[0]), z1 = splat(t.z[1]), z2 = splat(t.z[2]);
+                Lanes q0 = splat(t.q[0]), q1 = splat(t.q[1]), q2 = splat(t.q[2]);
+                Lanes up1 = splat(t.lambda1[2]), up2 = splat(t.lambda2[2]);
+                Lanes colors[3][3];
+                for (int c = 0; c < 3; c++)
+                for (int i = 0; i < 3; i++) colors[c][i] = splat(t.color[c][i]);
+                int left = std::max(t.minX, tileX), right = std::min(t.maxX, tileX + TileSize - 1);
+                int bottom = std::max(t.minY, tileY), top = std::min(t.maxY, tileY + TileSize - 1);
+                for (int by = bottom & ~(BlockSize - 1); by <= top; by += BlockSize)
+                for (int bx = left & ~(BlockSize - 1); bx <= right; bx += BlockSize)
+                {
+                    // Classify the Block Against Each Edge: Outside, Inside, or Crossing
+                    std::int32_t e[3] = {};
+                    bool partial[3] = {}, crossing = false, outside = false;
+                    for (int i = 0; i < 3 && !outside; i++)
+                    {   std::int64_t value = t.k[i] + static_cast<std::int64_t>(t.a[i]) * bx + static_cast<std::int64_t>(t.b[i]) * by;
+                        std::int64_t high = value + std::max(0, t.a[i]) * std::int64_t(BlockSize - 1) + std::max(0, t.b[i]) * std::int64_t(BlockSize - 1);
+                        std::int64_t low  = value + std::min(0, t.a[i]) * std::int64_t(BlockSize - 1) + std::min(0, t.b[i]) * std::int64_t(BlockSize - 1);
+                        outside = high < 0;
+                        partial[i] = low < 0;
+                        crossing = crossing || partial[i];
+                        if (partial[i]) e[i] = static_cast<std::int32_t>(value); // Within 7 Steps of Zero, So It Fits
+                    }
+                    if (outside) continue;
+
+                    // Coverage, Depth and Color a Column of Lanes at a Time, Stepping Edges and Weights Up the Rows
+                    int firstRow = std::max(0, bottom - by), lastRow = std::min(BlockSize - 1, top - by);
+                    int firstLane = std::max(0, left - bx) & ~(Width - 1), lastLane = std::min(BlockSize - 1, right - bx);
+                    float fy = static_cast<float>(by + firstRow - t.minY);
+                    for (int lane = firstLane; lane <= lastLane; lane += Width)
+                    {   Ints edges[3], rises[3];
+                        for (int i = 0; i < 3; i++)
+                        {   edges[i] = partial[i] ? ramp(e[i] + t.b[i] * firstRow + t.a[i] * lane, t.a[i]) : splat(0);
+                            rises[i] = splat(partial[i] ? t.b[i] : 0);
+                        }
+                        float fx = static_cast<float>(bx + lane - t.minX);
+                        Lanes l1 = ramp(t.lambda1[0] + t.lambda1[1] * fx + t.lambda1[2] * fy, t.lambda1[1]);
+                        Lanes l2 = ramp(t.lambda2[0] + t.lambda2[1] * fx + t.lambda2[2] * fy, t.lambda2[1]);
+                        Mask columns = bx + lane + Width > mWidth ? less(ramp(static_cast<float>(bx + lane), 1.0f), splat(static_cast<float>(mWidth))) : all();
+                        for (int row = firstRow; row <= lastRow; row++)
+                        {   Mask mask = crossing ? both(covered(edges[0], edges[1], edges[2]), columns) : columns;
+                            int coverage = bits(mask);
+                            std::size_t pixel = static_cast<std::size_t>(by + row) * mStride + bx + lane;
+                            if (coverage)
+                            {   Lanes z = add(z0, add(mul(l1, z1), mul(l2, z2)));
+                                Lanes previous = load(& mDepth[pixel]);
+                                Mask pass = both(mask, less(z, previous));
+                                int passed = bits(pass);
+                                statistics.fragments += count(coverage);
+                                if (passed)
+                                {   statistics.written += count(passed);
+                                    store(& mDepth[pixel], select(pass, z, previous));
+                                    Lanes q = add(q0, add(mul(l1, q1), mul(l2, q2)));
+                                    Lanes channels[3];
+                                    for (int c = 0; c < 3; c++)
+                                        channels[c] = div(add(colors[c][0], add(mul(l1, colors[c][1]), mul(l2, colors[c][2]))), q);
+                                    store(& mColor[pixel], select(pass, pack(channels[0], channels[1], channels[2]), load(& mColor[pixel])));
+                                }
+                            }
+                            for (int i = 0; i < 3; i++) edges[i] = add(edges[i], rises[i]);
+                            l1 = add(l1, up1);
+                            l2 = add(l2, up2);
+                        }
+                    }
+                }
+            }
+        }
+    }
+};
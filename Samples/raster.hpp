@@ -0,0 +1,164 @@
+#pragma once
+
+// Local Headers
+#include "mesh.hpp"
+
+// System Headers
+#include <glm/glm.hpp>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Forward Declarations
+    class ThreadPool;
+
+    // Uniforms and Permutations of Glitter/Shaders/shader.vert and shader.frag
+    //
+    // The vertex color is attribute 1, which for a Vertex is its normal, and
+    // ends up clamped to [0, 1] like any fragment output. transform is not
+    // part of the shaders: it multiplies the position shader.vert writes, so
+    // the identity reproduces them exactly and anything else lets a camera
+    // look at a mesh.
+    struct Shading
+    {
+        Shading() : transform(1.0f), multiplier(0.5f), wobble(false), tint(false) {}
+
+        glm::mat4 transform;
+        float multiplier;
+        bool wobble;             // #define WOBBLE
+        bool tint;               // #define TINT
+    };
+
+    // Counts Since the Last reset(); Seconds Are Wall Time on the Calling Thread
+    struct RasterStatistics
+    {
+        std::uint64_t triangles = 0; // Submitted
+        std::uint64_t clipped = 0;   // Crossing the Near or Far Plane or the Guard Band
+        std::uint64_t culled = 0;    // Outside the View, Degenerate or Between Pixel Centers
+        std::uint64_t binned = 0;    // Triangle and Tile Pairs
+        std::uint64_t fragments = 0; // Covered Pixels
+        std::uint64_t written = 0;   // Passed the Depth Test
+        double vertexSeconds = 0.0;
+        double setupSeconds = 0.0;   // Clipping, Setup and Binning
+        double rasterSeconds = 0.0;
+    };
+
+    // Difference Between Two Images of Equal Size
+    struct ImageDifference
+    {
+        std::size_t pixels;      // With Any Channel Off by More Than the Tolerance
+        int largest;             // Largest Channel Difference
+        double psnr;             // Infinite for Identical Images
+    };
+    ImageDifference compare(std::vector<unsigned char> const & a, std::vector<unsigned char> const & b,
+                            int tolerance = 0);
+
+    // Reference Renderer for Machines Without a GPU
+    //
+    // Draws the same content as Mesh::draw() with the shading of
+    // Glitter/Shaders, depth tested with GL_LESS and without face culling,
+    // into its own color and depth buffers. draw() runs the vertex stage at
+    // once and queues the triangles; flush(), which read() and write() call
+    // for you, clips them against the near and far planes and a guard band,
+    // sets them up in fixed point with 8 subpixel bits and the top-left
+    // rule, and bins them into 64 pixel tiles. Tiles then rasterize in
+    // parallel, each walking its triangles in submission order in 8x8
+    // blocks: blocks wholly inside a triangle skip the edge tests, and rows
+    // of pixels are tested, depth tested and shaded eight at a time with
+    // AVX2, four with SSE2, or one at a time. Colors interpolate
+    // perspective-correctly. The output does not depend on the pool or the
+    // thread count.
+    class Rasterizer
+    {
+    public:
+
+        // Implement Custom Constructor
+        Rasterizer(int width, int height, ThreadPool * pool = nullptr);
+
+        // Public Member Functions
+        void clear(glm::vec4 const & color, float depth = 1.0f);
+        void draw(Vertex const * vertices, std::size_t vertexCount,
+                  GLuint const * indices,  std::size_t indexCount, Shading const & shading);
+        void draw(MeshData const & mesh, Shading const & shading, std::size_t level = 0); // Clamped Like drawLevel()
+        void draw(std::vector<MeshData> const & meshes, Shading const & shading, std::size_t level = 0);
+        void draw(std::vector<MeshData> const & meshes, std::vector<std::uint32_t> const & visible,
+                  Shading const & shading);
+        void flush();
+        void read(std::vector<unsigned char> & pixels); // Top-Down RGB, Like HeadlessContext::ReadPixels
+        bool write(std::string const & path);
+        int width() const { return mWidth; }
+        int height() const { return mHeight; }
+        void reset() { mStatistics = RasterStatistics(); }
+        RasterStatistics const & statistics() const { return mStatistics; }
+
+        // Largest Supported Width and Height, So Fixed-Point Edges Fit in 32 Bits per Pixel Step
+        static const int Limit = 8192;
+
+    private:
+
+        // Disable Copying and Assignment
+        Rasterizer(Rasterizer const &) = delete;
+        Rasterizer & operator=(Rasterizer const &) = delete;
+
+        // Vertex Shader Output
+        struct Varying
+        {
+            glm::vec4 position;  // Clip Space
+            glm::vec3 color;
+        };
+
+        // Window Space Triangle; Planes Are Relative to the Center of Pixel (minX, minY)
+        struct Triangle
+        {
+            std::int32_t a[3], b[3];  // Edge Steps per Pixel in x and y, One Edge per Opposite Vertex
+            std::int64_t k[3];        // Edge Values at Pixel (0, 0); a Pixel Is Covered When All Are >= 0
+            std::int32_t minX, minY, maxX, maxY;
+            float lambda1[3];         // Barycentric Weights of Vertices 1 and 2: Value, d/dx, d/dy
+            float lambda2[3];
+            float z[3];               // Window Depth at Vertex 0, Then Its Deltas to Vertices 1 and 2
+            float q[3];               // 1 / w, Likewise
+            float color[3][3];        // Color / w per Channel, Likewise
+        };
+
+        // Triangles Set Up by One Job, With Their Tile Lists
+        struct Batch
+        {
+            std::vector<Triangle> triangles;
+            std::vector<std::uint32_t> offsets; // Into entries, per Tile
+            std::vector<std::uint32_t> entries; // Triangle Indices, Grouped by Tile
+            RasterStatistics statistics;
+        };
+
+        // Private Member Functions
+        void setup(std::size_t first, std::size_t last, Batch & batch) const;
+        void emit(Varying const * polygon, std::size_t count, Batch & batch,
+                  std::vector<std::pair<std::uint32_t, std::uint32_t>> & pairs) const;
+        void raster(std::size_t tile, RasterStatistics & statistics);
+
+        // Private Member Containers
+        std::vector<std::uint32_t> mColor;   // RGBA8, Bottom Row First
+        std::vector<float> mDepth;
+        std::vector<Varying> mVaryings;      // Queued Since the Last flush()
+        std::vector<std::uint32_t> mIndices; // Into mVaryings
+        std::vector<Batch> mBatches;
+        std::vector<RasterStatistics> mTiles; // Fragments and Writes per Tile
+
+        // Private Member Variables
+        ThreadPool * mPool;
+        RasterStatistics mStatistics;
+        int mWidth;
+        int mHeight;
+        int mTilesX;
+        int mTilesY;
+        int mStride;                         // Buffers Cover Whole Tiles
+        std::size_t mBatchCount;             // In Use This flush()
+
+    };
+};
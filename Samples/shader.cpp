@@ -1,10 +1,14 @@
 // Local Headers
+#include "program_cache.hpp"
 #include "shader.hpp"
+#include "shader_preprocessor.hpp"
 
 // Standard Headers
 #include <cassert>
-#include <fstream>
+#include <chrono>
+#include <cstdio>
 #include <memory>
+#include <vector>
 
 // Define Namespace
 namespace Mirage
@@ -15,21 +19,41 @@ namespace Mirage
         return *this;
     }
 
-    void Shader::bind(unsigned int location, float value) { glUniform1f(location, value); }
-    void Shader::bind(unsigned int location, glm::mat4 const & matrix)
+    void Shader::bind(GLint location, float value) { glUniform1f(location, value); }
+    void Shader::bind(GLint location, glm::mat4 const & matrix)
     { glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(matrix)); }
 
     Shader & Shader::attach(std::string const & filename)
     {
-        // Load GLSL Shader Source from File
+        // Load GLSL Shader Source from File, Resolving Includes and Defines
         std::string path = PROJECT_SOURCE_DIR "/Mirage/Shaders/";
-        std::ifstream fd(path + filename);
-        auto src = std::string(std::istreambuf_iterator<char>(fd),
-                              (std::istreambuf_iterator<char>()));
+        ShaderPreprocessor::Result result = ShaderPreprocessor::Process(path + filename, mDefines);
 
+        // The Preprocessor Names the File or Include It Failed On; Leave the Stage Out
+        if (!result.valid)
+        {   fprintf(stderr, "%s\nFailed to Preprocess; Stage Not Attached\n", filename.c_str());
+            return *this;
+        }
+
+        Stage stage;
+        stage.filename = filename;
+        stage.source = result.source;
+        mStages.push_back(stage);
+        return *this;
+    }
+
+    Shader & Shader::define(std::string const & definition)
+    {
+        // Applies to Every Stage Attached Afterwards
+        mDefines.push_back(definition);
+        return *this;
+    }
+
+    void Shader::compile(Stage const & stage)
+    {
         // Create a Shader Object
-        const char * source = src.c_str();
-        auto shader = create(filename);
+        const char * source = stage.source.c_str();
+        auto shader = create(stage.filename);
         glShaderSource(shader, 1, & source, nullptr);
         glCompileShader(shader);
         glGetShaderiv(shader, GL_COMPILE_STATUS, & mStatus);
@@ -40,13 +64,12 @@ namespace Mirage
             glGetShaderiv(shader, GL_INFO_LOG_LENGTH, & mLength);
             std::unique_ptr<char[]> buffer(new char[mLength]);
             glGetShaderInfoLog(shader, mLength, nullptr, buffer.get());
-            fprintf(stderr, "%s\n%s", filename.c_str(), buffer.get());
+            fprintf(stderr, "%s\n%s", stage.filename.c_str(), buffer.get());
         }
 
         // Attach the Shader and Free Allocated Memory
         glAttachShader(mProgram, shader);
         glDeleteShader(shader);
-        return *this;
     }
 
     GLuint Shader::create(std::string const & filename)
@@ -62,16 +85,81 @@ namespace Mirage
 
     Shader & Shader::link()
     {
-        glLinkProgram(mProgram);
-        glGetProgramiv(mProgram, GL_LINK_STATUS, & mStatus);
-        if(mStatus == false)
+        // Key on Filenames Too, Since the Extension Selects the Stage
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::string> sources;
+        for (auto const & stage : mStages)
+        {   sources.push_back(stage.filename);
+            sources.push_back(stage.source);
+        }
+        ProgramCache & cache = ProgramCache::Default();
+        std::uint64_t key = cache.Key(sources);
+        mCached = cache.Load(mProgram, key);
+
+        if (!mCached)
         {
-            glGetProgramiv(mProgram, GL_INFO_LOG_LENGTH, & mLength);
-            std::unique_ptr<char[]> buffer(new char[mLength]);
-            glGetProgramInfoLog(mProgram, mLength, nullptr, buffer.get());
-            fprintf(stderr, "%s", buffer.get());
+            // A Rejected Binary Leaves the Program Unusable, So Start Over
+            glDeleteProgram(mProgram);
+            mProgram = glCreateProgram();
+            for (auto const & stage : mStages) compile(stage);
+            glProgramParameteri(mProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+            glLinkProgram(mProgram);
+            glGetProgramiv(mProgram, GL_LINK_STATUS, & mStatus);
+            if(mStatus == false)
+            {
+                glGetProgramiv(mProgram, GL_INFO_LOG_LENGTH, & mLength);
+                std::unique_ptr<char[]> buffer(new char[mLength]);
+                glGetProgramInfoLog(mProgram, mLength, nullptr, buffer.get());
+                fprintf(stderr, "%s", buffer.get());
+            }
+            else cache.Store(mProgram, key);
+            assert(mStatus == true);
         }
-        assert(mStatus == true);
+
+        mStages.clear();
+        reflect();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        mMilliseconds = elapsed.count();
         return *this;
     }
+
+    Shader & Shader::block(std::uint32_t hash, GLuint binding)
+    {
+        GLint index = mBlocks.find(hash);
+        if (index != -1) glUniformBlockBinding(mProgram, index, binding);
+        return *this;
+    }
+
+    void Shader::reflect()
+    {
+        // Resolve Every Active Uniform Once, Keyed by Hashed Name
+        GLint count = 0;
+        mUniforms.clear();
+        glGetProgramiv(mProgram, GL_ACTIVE_UNIFORMS, & count);
+        glGetProgramiv(mProgram, GL_ACTIVE_UNIFORM_MAX_LENGTH, & mLength);
+        std::vector<char> name(mLength + 1);
+        for (GLint i = 0; i < count; i++)
+        {
+            GLint size; GLenum type;
+            glGetActiveUniform(mProgram, i, mLength + 1, nullptr, & size, & type, name.data());
+            std::string uniform = name.data();
+            GLint location = glGetUniformLocation(mProgram, uniform.c_str());
+            if (location == -1) continue; // Members of Uniform Blocks
+
+            // Arrays Report "name[0]"; Register the Bare Name Too
+            mUniforms.insert(uniform, location);
+            auto bracket = uniform.find("[0]");
+            if (bracket != std::string::npos) mUniforms.insert(uniform.substr(0, bracket), location);
+        }
+
+        // Resolve Uniform Block Indices
+        mBlocks.clear();
+        glGetProgramiv(mProgram, GL_ACTIVE_UNIFORM_BLOCKS, & count);
+        glGetProgramiv(mProgram, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, & mLength);
+        name.resize(mLength + 1);
+        for (GLint i = 0; i < count; i++)
+        {   glGetActiveUniformBlockName(mProgram, i, mLength + 1, nullptr, name.data());
+            mBlocks.insert(name.data(), i);
+        }
+    }
 };
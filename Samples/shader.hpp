@@ -1,12 +1,18 @@
 #pragma once
 
+// Local Headers
+#include "uniform.hpp"
+
 // System Headers
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 // Standard Headers
+#include <cstdint>
+#include <cstdio>
 #include <string>
+#include <vector>
 
 // Define Namespace
 namespace Mirage
@@ -16,26 +22,45 @@ namespace Mirage
     public:
 
         // Implement Custom Constructor and Destructor
-         Shader() { mProgram = glCreateProgram(); }
+         Shader() : mCached(false), mMilliseconds(0.0) { mProgram = glCreateProgram(); }
         ~Shader() { glDeleteProgram(mProgram); }
 
         // Public Member Functions
         Shader & activate();
         Shader & attach(std::string const & filename);
+        Shader & define(std::string const & definition);
         GLuint   create(std::string const & filename);
         GLuint   get() { return mProgram; }
         Shader & link();
 
         // Wrap Calls to glUniform
-        void bind(unsigned int location, float value);
-        void bind(unsigned int location, glm::mat4 const & matrix);
-        template<typename T> Shader & bind(std::string const & name, T&& value)
+        void bind(GLint location, float value);
+        void bind(GLint location, glm::mat4 const & matrix);
+        template<typename T> Shader & bind(char const * name, T&& value)
         {
-            int location = glGetUniformLocation(mProgram, name.c_str());
-            if (location == -1) fprintf(stderr, "Missing Uniform: %s\n", name.c_str());
+            int location = mUniforms.find(name);
+            if (location == -1) fprintf(stderr, "Missing Uniform: %s\n", name);
             else bind(location, std::forward<T>(value));
             return *this;
         }
+        template<typename T> Shader & bind(std::string const & name, T&& value)
+        { return bind(name.c_str(), std::forward<T>(value)); }
+        template<typename T> Shader & bind(std::uint32_t hash, T const & value) // Hashed by Mirage::uniform()
+        {
+            int location = mUniforms.find(hash);
+            if (location == -1) fprintf(stderr, "Missing Uniform: %08x\n", hash);
+            else bind(location, value);
+            return *this;
+        }
+
+        // Reflected Locations; Resolve Once and Pass to bind(location, ...)
+        GLint location(std::uint32_t hash) const { return mUniforms.find(hash); }
+        Shader & block(std::uint32_t hash, GLuint binding);
+        UniformTable const & uniforms() const { return mUniforms; }
+
+        // Startup Report: Binary Cache Hit and Time Spent in link()
+        bool cached() const { return mCached; }
+        double milliseconds() const { return mMilliseconds; }
 
     private:
 
@@ -43,10 +68,29 @@ namespace Mirage
         Shader(Shader const &) = delete;
         Shader & operator=(Shader const &) = delete;
 
+        // Sources Are Compiled Lazily, Only When the Binary Cache Misses
+        struct Stage
+        {
+            std::string filename;
+            std::string source;
+        };
+
+        // Private Member Functions
+        void compile(Stage const & stage);
+        void reflect();
+
+        // Private Member Containers
+        std::vector<Stage> mStages;
+        std::vector<std::string> mDefines;
+        UniformTable mUniforms;
+        UniformTable mBlocks;
+
         // Private Member Variables
         GLuint mProgram;
         GLint  mStatus;
         GLint  mLength;
+        bool   mCached;
+        double mMilliseconds;
 
     };
 };
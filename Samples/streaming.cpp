@@ -0,0 +1,623 @@
+// Local Headers
+#include "cache.hpp"
+#include "culling.hpp"
+#include "loader.hpp"
+#include "streaming.hpp"
+
+// System Headers
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Standard Headers
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+// Define Namespace
+namespace Mirage
+{
+    // File Layout: Header, Chunk Table, Level Table, Then Every Chunk's Geometry and Levels
+    namespace
+    {
+        const std::uint32_t Magic = 0x444c5257; // "WRLD"
+        const std::size_t Alignment = 16;
+
+        struct Header
+        {
+            std::uint32_t magic;
+            std::uint32_t version;
+            std::uint32_t chunkCount;
+            std::uint32_t levelCount;
+        };
+
+        struct Record
+        {
+            float boundsMin[3];
+            float boundsMax[3];
+            std::uint64_t offset;
+            std::uint64_t hash;
+            std::uint32_t size;
+            std::uint32_t vertexCount;
+            std::uint32_t indexCount;
+            std::uint32_t lodIndexCount;
+            std::uint32_t lodCount;
+            std::uint32_t format;
+            std::uint32_t channels;
+            std::uint32_t firstLevel; // Into the Level Table, Finest First
+            std::uint32_t levelCount;
+            std::uint32_t padding;
+        };
+
+        struct LevelRecord
+        {
+            std::uint64_t offset;
+            std::uint64_t hash;
+            std::uint32_t width;
+            std::uint32_t height;
+            std::uint32_t size;
+            std::uint32_t padding;
+        };
+
+        std::size_t align(std::size_t offset)
+        { return (offset + Alignment - 1) & ~(Alignment - 1); }
+
+        // Geometry Is Vertices, Indices, Simplified Indices, Then Level Descriptions, Each Aligned
+        std::size_t layout(std::size_t vertexCount, std::size_t indexCount, std::size_t lodIndexCount,
+                           std::size_t lodCount, std::size_t offsets[4])
+        {
+            offsets[0] = 0;
+            offsets[1] = align(offsets[0] + vertexCount * sizeof(Vertex));
+            offsets[2] = align(offsets[1] + indexCount * sizeof(GLuint));
+            offsets[3] = align(offsets[2] + lodIndexCount * sizeof(GLuint));
+            return align(offsets[3] + lodCount * sizeof(LevelOfDetail));
+        }
+
+        float distance(Bounds const & bounds, glm::vec3 const & point)
+        {
+            glm::vec3 outside = glm::max(glm::max(bounds.min - point, point - bounds.max), glm::vec3(0.0f));
+            return glm::length(outside);
+        }
+
+        typedef std::chrono::steady_clock Clock;
+    }
+
+    const std::uint32_t WorldStreamer::Version;
+
+    void partition(std::vector<MeshData> const & meshes, float size, std::vector<ChunkData> & chunks)
+    {
+        chunks.clear();
+        std::map<std::pair<int, int>, std::size_t> cells;
+        std::vector<std::unordered_map<std::uint64_t, GLuint>> remaps;
+        for (std::size_t m = 0; m < meshes.size(); m++)
+        {
+            auto const & mesh = meshes[m];
+            for (std::size_t t = 0; t + 2 < mesh.indices.size(); t += 3)
+            {
+                GLuint const * triangle = & mesh.indices[t];
+                glm::vec3 centroid = (mesh.vertices[triangle[0]].position + mesh.vertices[triangle[1]].position
+                                   +  mesh.vertices[triangle[2]].position) / 3.0f;
+                std::pair<int, int> cell(static_cast<int>(std::floor(centroid.x / size)),
+                                         static_cast<int>(std::floor(centroid.z / size)));
+                auto found = cells.find(cell);
+                if (found == cells.end())
+                {   found = cells.insert(std::make_pair(cell, chunks.size())).first;
+                    chunks.push_back(ChunkData());
+                    remaps.emplace_back();
+                }
+
+                // Vertices Shared Across a Cell Border Are Copied Into Both Cells
+                MeshData & chunk = chunks[found->second].mesh;
+                auto & remap = remaps[found->second];
+                for (int k = 0; k < 3; k++)
+                {   std::uint64_t key = (static_cast<std::uint64_t>(m) << 32) | triangle[k];
+                    auto inserted = remap.insert(std::make_pair(key, static_cast<GLuint>(chunk.vertices.size())));
+                    if (inserted.second) chunk.vertices.push_back(mesh.vertices[triangle[k]]);
+                    chunk.indices.push_back(inserted.first->second);
+                }
+            }
+        }
+        for (auto & chunk : chunks)
+            chunk.mesh.bounds = Mesh::measure(chunk.mesh.vertices.data(), chunk.mesh.vertices.size());
+    }
+
+    bool WorldStreamer::write(std::string const & filename, std::vector<ChunkData> const & chunks)
+    {
+        // Reserve the Tables, Stream Every Chunk, Then Fill the Tables In
+        std::string temporary = filename + ".tmp";
+        std::ofstream fd(temporary, std::ios::binary | std::ios::trunc);
+        if (!fd) return false;
+        std::size_t levelCount = 0;
+        for (auto const & chunk : chunks) levelCount += chunk.texture.levels.size();
+        std::vector<Record> records(chunks.size());
+        std::vector<LevelRecord> levels(levelCount);
+        std::size_t offset = align(sizeof(Header) + records.size() * sizeof(Record) + levels.size() * sizeof(LevelRecord));
+        std::vector<unsigned char> blob(offset, 0);
+        fd.write(reinterpret_cast<char const *>(blob.data()), blob.size());
+
+        std::size_t firstLevel = 0;
+        for (std::size_t i = 0; i < chunks.size(); i++)
+        {
+            MeshData const & mesh = chunks[i].mesh;
+            CompressedImage const & texture = chunks[i].texture;
+            Record & record = records[i];
+            std::memset(& record, 0, sizeof(record));
+            std::memcpy(record.boundsMin, & mesh.bounds.min, sizeof(record.boundsMin));
+            std::memcpy(record.boundsMax, & mesh.bounds.max, sizeof(record.boundsMax));
+            record.vertexCount = static_cast<std::uint32_t>(mesh.vertices.size());
+            record.indexCount = static_cast<std::uint32_t>(mesh.indices.size());
+            record.lodIndexCount = static_cast<std::uint32_t>(mesh.lodIndices.size());
+            record.lodCount = static_cast<std::uint32_t>(mesh.lods.size());
+            record.format = static_cast<std::uint32_t>(texture.format);
+            record.channels = static_cast<std::uint32_t>(texture.channels);
+            record.firstLevel = static_cast<std::uint32_t>(firstLevel);
+            record.levelCount = static_cast<std::uint32_t>(texture.levels.size());
+
+            std::size_t parts[4];
+            blob.assign(layout(mesh.vertices.size(), mesh.indices.size(), mesh.lodIndices.size(), mesh.lods.size(), parts), 0);
+            if (!mesh.vertices.empty())   std::memcpy(& blob[parts[0]], mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex));
+            if (!mesh.indices.empty())    std::memcpy(& blob[parts[1]], mesh.indices.data(), mesh.indices.size() * sizeof(GLuint));
+            if (!mesh.lodIndices.empty()) std::memcpy(& blob[parts[2]], mesh.lodIndices.data(), mesh.lodIndices.size() * sizeof(GLuint));
+            if (!mesh.lods.empty())       std::memcpy(& blob[parts[3]], mesh.lods.data(), mesh.lods.size() * sizeof(LevelOfDetail));
+            record.offset = offset;
+            record.size = static_cast<std::uint32_t>(blob.size());
+            record.hash = MeshCache::hash(blob.data(), blob.size());
+            fd.write(reinterpret_cast<char const *>(blob.data()), blob.size());
+            offset += blob.size();
+
+            // Coarsest Level First, So Every Read Down to Some Level Is One Range
+            for (std::size_t l = texture.levels.size(); l-- > 0;)
+            {   auto const & level = texture.levels[l];
+                LevelRecord & entry = levels[firstLevel + l];
+                std::memset(& entry, 0, sizeof(entry));
+                entry.offset = offset;
+                entry.width = static_cast<std::uint32_t>(level.width);
+                entry.height = static_cast<std::uint32_t>(level.height);
+                entry.size = static_cast<std::uint32_t>(level.size);
+                entry.hash = MeshCache::hash(& texture.data[level.offset], level.size);
+                blob.assign(texture.data.begin() + level.offset, texture.data.begin() + level.offset + level.size);
+                blob.resize(align(blob.size()), 0);
+                fd.write(reinterpret_cast<char const *>(blob.data()), blob.size());
+                offset += blob.size();
+            }
+            firstLevel += texture.levels.size();
+        }
+
+        Header header = { Magic, Version, static_cast<std::uint32_t>(records.size()), static_cast<std::uint32_t>(levels.size()) };
+        fd.seekp(0);
+        fd.write(reinterpret_cast<char const *>(& header), sizeof(header));
+        if (!records.empty()) fd.write(reinterpret_cast<char const *>(records.data()), records.size() * sizeof(Record));
+        if (!levels.empty())  fd.write(reinterpret_cast<char const *>(levels.data()), levels.size() * sizeof(LevelRecord));
+        fd.close();
+        if (!fd) return false;
+
+        // Replace Any Previous World Only Once This One Is Complete
+        std::remove(filename.c_str());
+        return std::rename(temporary.c_str(), filename.c_str()) == 0;
+    }
+
+    WorldStreamer::WorldStreamer(ThreadPool & pool, Settings const & settings)
+        : mPool(pool), mSettings(settings), mFrame(0), mFile(-1)
+    {}
+
+    WorldStreamer::~WorldStreamer()
+    {
+        close();
+    }
+
+    bool WorldStreamer::open(std::string const & filename)
+    {
+        close();
+        std::ifstream fd(filename, std::ios::binary | std::ios::ate);
+        std::streamoff length = fd.tellg();
+        Header header;
+        if (length < static_cast<std::streamoff>(sizeof(header)) || !fd.seekg(0)) return false;
+        if (!fd.read(reinterpret_cast<char *>(& header), sizeof(header))) return false;
+        if (header.magic != Magic || header.version != Version) return false;
+
+        // Every Range Must Lie Past the Tables and Within the File
+        std::uint64_t tables = sizeof(Header) + static_cast<std::uint64_t>(header.chunkCount) * sizeof(Record)
+                                              + static_cast<std::uint64_t>(header.levelCount) * sizeof(LevelRecord);
+        std::uint64_t fileSize = static_cast<std::uint64_t>(length);
+        if (tables > fileSize) return false;
+        auto inside = [fileSize](std::uint64_t begin, std::uint64_t offset, std::uint64_t size)
+        { return offset >= begin && offset <= fileSize && size <= fileSize - offset; };
+        std::vector<Record> records(header.chunkCount);
+        std::vector<LevelRecord> levels(header.levelCount);
+        if (!records.empty() && !fd.read(reinterpret_cast<char *>(records.data()), records.size() * sizeof(Record))) return false;
+        if (!levels.empty()  && !fd.read(reinterpret_cast<char *>(levels.data()), levels.size() * sizeof(LevelRecord))) return false;
+
+        // Only the Tables Are Read Up Front
+        mChunks.resize(records.size());
+        for (std::size_t i = 0; i < records.size(); i++)
+        {
+            Record const & record = records[i];
+            Chunk & chunk = mChunks[i];
+            if (record.firstLevel + static_cast<std::uint64_t>(record.levelCount) > levels.size()
+            ||  record.format > static_cast<std::uint32_t>(BlockFormat::BC5))
+            {   mChunks.clear();
+                return false;
+            }
+            std::memcpy(& chunk.bounds.min, record.boundsMin, sizeof(record.boundsMin));
+            std::memcpy(& chunk.bounds.max, record.boundsMax, sizeof(record.boundsMax));
+            chunk.offset = record.offset;
+            chunk.hash = record.hash;
+            chunk.size = record.size;
+            chunk.vertexCount = record.vertexCount;
+            chunk.indexCount = record.indexCount;
+            chunk.lodIndexCount = record.lodIndexCount;
+            chunk.lodCount = record.lodCount;
+            chunk.format = static_cast<BlockFormat>(record.format);
+            chunk.channels = static_cast<int>(record.channels);
+            for (std::uint32_t l = 0; l < record.levelCount; l++)
+            {   LevelRecord const & entry = levels[record.firstLevel + l];
+                chunk.levels.push_back({ entry.offset, entry.hash, entry.width, entry.height, entry.size });
+            }
+            chunk.finest = static_cast<int>(chunk.levels.size());
+
+            // Reject Geometry That Would Not Fit Its Own Record
+            std::size_t parts[4];
+            if (layout(chunk.vertexCount, chunk.indexCount, chunk.lodIndexCount, chunk.lodCount, parts) != chunk.size)
+            {   mChunks.clear();
+                return false;
+            }
+
+            // Levels Follow the Geometry Coarsest First Without Overlapping, as read() Assumes
+            std::uint64_t end = chunk.offset + chunk.size;
+            bool valid = inside(tables, chunk.offset, chunk.size);
+            for (std::size_t l = chunk.levels.size(); valid && l-- > 0;)
+            {   Level const & level = chunk.levels[l];
+                valid = inside(end, level.offset, level.size);
+                end = level.offset + level.size;
+            }
+            if (!valid)
+            {   mChunks.clear();
+                return false;
+            }
+        }
+
+#ifndef _WIN32
+        mFile = ::open(filename.c_str(), O_RDONLY);
+        if (mFile < 0)
+        {   mChunks.clear();
+            return false;
+        }
+#endif
+        mFilename = filename;
+        mTelemetry = Telemetry();
+        mTelemetry.chunks = mChunks.size();
+        return true;
+    }
+
+    void WorldStreamer::close()
+    {
+        finish();
+        {   std::lock_guard<std::mutex> lock(mMutex);
+            mCompleted.clear();
+        }   mStaged.clear();
+        for (std::size_t i = 0; i < mChunks.size(); i++) evict(i);
+        mChunks.clear();
+#ifndef _WIN32
+        if (mFile >= 0) ::close(mFile);
+#endif
+        mFile = -1;
+        mFilename.clear();
+    }
+
+    void WorldStreamer::finish()
+    {
+        mPool.jobs().Wait(mReads);
+    }
+
+    void WorldStreamer::update(glm::vec3 const & camera)
+    {
+        mFrame++;
+        mTelemetry.frames++;
+
+        // Collect Finished Reads
+        std::vector<std::unique_ptr<Result>> completed;
+        {   std::lock_guard<std::mutex> lock(mMutex);
+            completed.swap(mCompleted);
+        }
+        for (auto & result : completed)
+        {   Chunk & chunk = mChunks[result->chunk];
+            mTelemetry.reading--;
+            mTelemetry.readSeconds += result->seconds;
+            if (!result->valid)
+            {   mTelemetry.failures++;
+                mTelemetry.stagedBytes -= result->data.size();
+                chunk.failed = true;
+                chunk.busy = false;
+                continue;
+            }
+            mTelemetry.bytesRead += result->data.size();
+            mStaged.push_back(std::move(result));
+        }
+
+        // Rank Every Chunk; Texture Detail Halves With Each Doubling of Distance Past detailDistance
+        for (auto & chunk : mChunks)
+        {   chunk.distance = distance(chunk.bounds, camera);
+            if (chunk.distance <= mSettings.prefetchDistance) chunk.wanted = mFrame;
+            int levels = static_cast<int>(chunk.levels.size());
+            float ratio = chunk.distance / std::max(mSettings.detailDistance, 1e-6f);
+            chunk.desired = ratio > 1.0f ? std::min(levels - 1, static_cast<int>(std::log2(ratio))) : 0;
+            chunk.desired = std::max(chunk.desired, 0);
+        }
+
+        // Drop Staged Reads the Camera Has Left Behind; What Is Already Uploaded Stays Until Evicted
+        for (auto & result : mStaged)
+        {   Chunk & chunk = mChunks[result->chunk];
+            if (chunk.wanted == mFrame) continue;
+            mTelemetry.cancelled++;
+            mTelemetry.stagedBytes -= result->data.size();
+            chunk.busy = false;
+            result.reset();
+        }
+        mStaged.erase(std::remove(mStaged.begin(), mStaged.end(), nullptr), mStaged.end());
+
+        // Upload Nearest First Until the Frame's Budget Is Spent
+        std::stable_sort(mStaged.begin(), mStaged.end(), [this](std::unique_ptr<Result> const & a, std::unique_ptr<Result> const & b)
+                         { return mChunks[a->chunk].distance < mChunks[b->chunk].distance; });
+        std::size_t uploaded = 0;
+        for (auto & result : mStaged)
+        {
+            std::size_t bytes;
+            while ((bytes = step(*result)) > 0)
+            {   if (mSettings.uploadBudget > 0 && uploaded > 0 && uploaded + bytes > mSettings.uploadBudget) break;
+                upload(*result);
+                uploaded += bytes;
+            }
+            if (bytes > 0) break;
+            mTelemetry.stagedBytes -= result->data.size();
+            mChunks[result->chunk].busy = false;
+            result.reset();
+        }
+        mStaged.erase(std::remove(mStaged.begin(), mStaged.end(), nullptr), mStaged.end());
+        mTelemetry.uploadedBytes = uploaded;
+        mTelemetry.bytesUploaded += uploaded;
+
+        // Request Missing Data Nearest First; Holes Inside the Draw Distance Jump the Queue
+        typedef std::pair<std::pair<int, float>, std::size_t> Candidate;
+        std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> queue;
+        for (std::size_t i = 0; i < mChunks.size(); i++)
+        {   Chunk const & chunk = mChunks[i];
+            if (chunk.wanted != mFrame || chunk.busy || chunk.failed) continue;
+            if (chunk.mesh && chunk.desired >= chunk.finest) continue;
+            int urgency = !drawable(chunk) && chunk.distance <= mSettings.drawDistance ? 0 : 1;
+            queue.push(Candidate(std::make_pair(urgency, chunk.distance), i));
+        }
+        while (!queue.empty() && mTelemetry.reading < mSettings.reads)
+        {
+            std::size_t index = queue.top().second;
+            queue.pop();
+            Chunk & chunk = mChunks[index];
+            bool geometry = !chunk.mesh;
+            int last = geometry ? static_cast<int>(chunk.levels.size()) : chunk.finest;
+            std::uint64_t begin;
+            std::size_t bytes = range(chunk, geometry, chunk.desired, last, begin);
+            if (bytes > mSettings.memoryBudget)
+            {   chunk.failed = true; // Could Never Fit
+                mTelemetry.failures++;
+                continue;
+            }
+            if (!reserve(bytes, index)) break;
+            request(index, geometry, chunk.desired, last, bytes);
+        }
+
+        // A Frame Stalls When Anything Inside the Draw Distance Has Nothing to Show
+        mTelemetry.drawable = 0;
+        mTelemetry.missing = 0;
+        for (auto const & chunk : mChunks)
+        {   if (drawable(chunk)) mTelemetry.drawable++;
+            else if (chunk.distance <= mSettings.drawDistance && !chunk.failed) mTelemetry.missing++;
+        }
+        if (mTelemetry.missing > 0) mTelemetry.stallFrames++;
+        mTelemetry.staged = mStaged.size();
+        mTelemetry.peakBytes = std::max(mTelemetry.peakBytes, mTelemetry.residentBytes + mTelemetry.stagedBytes);
+    }
+
+    std::size_t WorldStreamer::draw(GLuint shader, Frustum const * frustum)
+    {
+        std::size_t drawn = 0;
+        for (auto & chunk : mChunks)
+        {   if (!drawable(chunk) || chunk.distance > mSettings.drawDistance) continue;
+            if (frustum && !frustum->visible(chunk.bounds)) continue;
+            chunk.mesh->draw(shader);
+            drawn++;
+        }   return drawn;
+    }
+
+    Mesh * WorldStreamer::mesh(std::size_t chunk) const
+    {
+        return drawable(mChunks[chunk]) ? mChunks[chunk].mesh.get() : nullptr;
+    }
+
+    int WorldStreamer::level(std::size_t chunk) const
+    {
+        Chunk const & c = mChunks[chunk];
+        return c.finest < static_cast<int>(c.levels.size()) ? c.finest : -1;
+    }
+
+    bool WorldStreamer::drawable(Chunk const & chunk) const
+    {
+        return chunk.mesh && (chunk.levels.empty() || chunk.finest < static_cast<int>(chunk.levels.size()));
+    }
+
+    std::size_t WorldStreamer::range(Chunk const & chunk, bool geometry, int first, int last, std::uint64_t & begin) const
+    {
+        begin = geometry ? chunk.offset : chunk.levels[last - 1].offset;
+        std::uint64_t end = first < last ? chunk.levels[first].offset + chunk.levels[first].size
+                                         : chunk.offset + chunk.size;
+        return static_cast<std::size_t>(end - begin);
+    }
+
+    bool WorldStreamer::reserve(std::size_t bytes, std::size_t chunk)
+    {
+        auto fits = [&]() { return mTelemetry.residentBytes + mTelemetry.stagedBytes + bytes <= mSettings.memoryBudget; };
+        if (!fits())
+        {
+            // Least Recently Wanted First, Then Wanted Chunks Farther Than the One Asking, Farthest First
+            std::vector<std::size_t> victims;
+            for (std::size_t i = 0; i < mChunks.size(); i++)
+                if (mChunks[i].mesh && !mChunks[i].busy && i != chunk) victims.push_back(i);
+            std::sort(victims.begin(), victims.end(), [this](std::size_t a, std::size_t b)
+            {   Chunk const & x = mChunks[a], & y = mChunks[b];
+                bool xWanted = x.wanted == mFrame, yWanted = y.wanted == mFrame;
+                if (xWanted != yWanted) return yWanted;
+                if (!xWanted) return x.wanted < y.wanted;
+                return x.distance > y.distance;
+            });
+            float limit = mChunks[chunk].distance;
+            for (std::size_t i = 0; i < victims.size() && !fits(); i++)
+            {   Chunk const & victim = mChunks[victims[i]];
+                if (victim.wanted == mFrame && victim.distance <= limit) break;
+                evict(victims[i]);
+                mTelemetry.evictions++;
+            }
+            if (!fits()) return false;
+        }
+        mTelemetry.stagedBytes += bytes;
+        return true;
+    }
+
+    void WorldStreamer::request(std::size_t chunk, bool geometry, int first, int last, std::size_t bytes)
+    {
+        std::unique_ptr<Result> result(new Result());
+        result->chunk = chunk;
+        result->geometry = geometry;
+        result->first = first;
+        result->last = last;
+        result->data.reserve(bytes);
+        result->valid = false;
+        result->seconds = 0.0;
+        result->next = last - 1;
+        mChunks[chunk].busy = true;
+        mTelemetry.reading++;
+        mTelemetry.reads++;
+
+        // The Job Owns the Result Until It Hands It Back Through mCompleted
+        Result * pending = result.release();
+        mPool.jobs().Spawn([this, pending]()
+        {
+            read(*pending);
+            std::lock_guard<std::mutex> lock(mMutex);
+            mCompleted.emplace_back(pending);
+        }, & mReads);
+    }
+
+    // Runs on the Pool; Touches Only the Chunk Table, Which Is Fixed While Open
+    void WorldStreamer::read(Result & result) const
+    {
+        auto start = Clock::now();
+        Chunk const & chunk = mChunks[result.chunk];
+        std::size_t size = range(chunk, result.geometry, result.first, result.last, result.offset);
+        result.data.resize(size);
+        std::size_t done = 0;
+#ifdef _WIN32
+        std::ifstream fd(mFilename, std::ios::binary);
+        if (fd.seekg(static_cast<std::streamoff>(result.offset)) && fd.read(reinterpret_cast<char *>(result.data.data()), size))
+            done = size;
+#else
+        while (done < size)
+        {   ssize_t count = pread(mFile, result.data.data() + done, size - done, static_cast<off_t>(result.offset + done));
+            if (count <= 0) break;
+            done += static_cast<std::size_t>(count);
+        }
+#endif
+        result.valid = done == size;
+        if (result.valid && result.geometry)
+            result.valid = MeshCache::hash(result.data.data(), chunk.size) == chunk.hash;
+        for (int l = result.first; result.valid && l < result.last; l++)
+        {   Level const & level = chunk.levels[l];
+            result.valid = level.offset >= result.offset && level.offset - result.offset + level.size <= size
+                        && MeshCache::hash(& result.data[level.offset - result.offset], level.size) == level.hash;
+        }
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    std::size_t WorldStreamer::step(Result const & result) const
+    {
+        if (result.geometry) return mChunks[result.chunk].size;
+        if (result.next >= result.first) return mChunks[result.chunk].levels[result.next].size;
+        return 0;
+    }
+
+    void WorldStreamer::upload(Result & result)
+    {
+        Chunk & chunk = mChunks[result.chunk];
+        if (result.geometry)
+        {
+            // Geometry Goes Through Mesh, Which Sub-Allocates It From the Shared Heap
+            std::size_t parts[4];
+            layout(chunk.vertexCount, chunk.indexCount, chunk.lodIndexCount, chunk.lodCount, parts);
+            unsigned char const * data = result.data.data();
+            std::vector<LevelOfDetail> lods(chunk.lodCount);
+            if (!lods.empty()) std::memcpy(lods.data(), data + parts[3], lods.size() * sizeof(LevelOfDetail));
+            std::map<GLuint, std::string> textures;
+            if (!chunk.levels.empty())
+            {   glGenTextures(1, & chunk.texture);
+                textures[chunk.texture] = "diffuse";
+            }
+            chunk.mesh.reset(new Mesh(reinterpret_cast<Vertex const *>(data + parts[0]), chunk.vertexCount,
+                                      reinterpret_cast<GLuint const *>(data + parts[1]), chunk.indexCount,
+                                      textures, & chunk.bounds,
+                                      chunk.lodIndexCount > 0 ? reinterpret_cast<GLuint const *>(data + parts[2]) : nullptr,
+                                      lods));
+            chunk.bytes += chunk.size;
+            mTelemetry.residentBytes += chunk.size;
+            result.geometry = false;
+            return;
+        }
+
+        // One Level, Then Let Sampling Reach Down to It
+        Level const & level = chunk.levels[result.next];
+        unsigned char const * data = & result.data[level.offset - result.offset];
+        CompressedImage image;
+        image.format = chunk.format;
+        image.channels = chunk.channels;
+        glBindTexture(GL_TEXTURE_2D, chunk.texture);
+        if (chunk.finest == static_cast<int>(chunk.levels.size()))
+        {   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(chunk.levels.size() - 1));
+        }
+        if (AssetLoader::supported(image.internalFormat()))
+            glCompressedTexImage2D(GL_TEXTURE_2D, result.next, image.internalFormat(), level.width, level.height,
+                                   0, static_cast<GLsizei>(level.size), data);
+        else
+        {   std::vector<unsigned char> rgba;
+            image.levels.push_back({ static_cast<int>(level.width), static_cast<int>(level.height), 0, level.size });
+            image.data.assign(data, data + level.size);
+            decompress(image, 0, rgba);
+            glTexImage2D(GL_TEXTURE_2D, result.next, GL_RGBA8, level.width, level.height,
+                         0, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, result.next);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        chunk.finest = result.next;
+        chunk.bytes += level.size;
+        mTelemetry.residentBytes += level.size;
+        result.next--;
+    }
+
+    void WorldStreamer::evict(std::size_t index)
+    {
+        Chunk & chunk = mChunks[index];
+        chunk.mesh.reset();
+        if (chunk.texture) glDeleteTextures(1, & chunk.texture);
+        chunk.texture = 0;
+        mTelemetry.residentBytes -= chunk.bytes;
+        chunk.bytes = 0;
+        chunk.finest = static_cast<int>(chunk.levels.size());
+    }
+};
@@ -0,0 +1,191 @@
+#pragma once
+
+// Local Headers
+#include "compress.hpp"
+#include "mesh.hpp"
+#include "pool.hpp"
+
+// System Headers
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Forward Declarations
+    class Frustum;
+
+    // One Spatial Cell of a Streamed World: Geometry Plus an Optional Mip Chain
+    struct ChunkData
+    {
+        MeshData mesh;           // Vertices, Indices and Simplified Levels; Texture References Are Ignored
+        CompressedImage texture; // No Levels for an Untextured Chunk
+    };
+
+    // Split Meshes Into Square Cells on the XZ Plane, Assigning Each Triangle by Its Centroid
+    void partition(std::vector<MeshData> const & meshes, float size, std::vector<ChunkData> & chunks);
+
+    // Keeps the Chunks of a World File Around a Moving Camera Resident
+    //
+    // write() stores every chunk's geometry followed by its mip levels,
+    // coarsest first, so loading a chunk down to any level, or refining it
+    // later, is one contiguous read. update() ranks chunks by their distance
+    // to the camera: those within prefetchDistance are requested nearest
+    // first, and each wants full texture resolution up to detailDistance and
+    // one level coarser per doubling beyond it. Reads run on the pool and are
+    // checked against a hash. Resident GPU bytes plus bytes read and not yet
+    // released stay under memoryBudget: a read that does not fit evicts the
+    // chunks wanted least recently, then wanted chunks farther away than the
+    // one being read, and waits if that is still not enough. Uploads go
+    // geometry first, then one mip level at a time, until uploadBudget bytes
+    // have gone through in a frame; a chunk draws once its geometry and its
+    // coarsest level are up. A frame stalls when a chunk within
+    // drawDistance cannot be drawn. Call update() and draw() from the thread
+    // owning the GL context.
+    class WorldStreamer
+    {
+    public:
+
+        struct Settings
+        {
+            Settings() : memoryBudget(64 << 20), uploadBudget(1 << 20), reads(8),
+                         drawDistance(256.0f), prefetchDistance(384.0f), detailDistance(32.0f) {}
+
+            std::size_t memoryBudget; // Bytes
+            std::size_t uploadBudget; // Bytes per update(); Zero for No Limit. One Step Always Goes Through
+            unsigned int reads;       // In Flight at Once
+            float drawDistance;
+            float prefetchDistance;
+            float detailDistance;
+        };
+
+        // Counts Are Current Values; Totals Accumulate Since open()
+        struct Telemetry
+        {
+            std::size_t chunks = 0;
+            std::size_t drawable = 0;
+            std::size_t reading = 0;
+            std::size_t staged = 0;        // Read, Waiting for Upload
+            std::size_t missing = 0;       // Within drawDistance but Not Drawable, This Frame
+            std::size_t residentBytes = 0; // On the GPU
+            std::size_t stagedBytes = 0;   // Reserved for Reads in Flight or Held Until Uploaded
+            std::size_t peakBytes = 0;     // Largest residentBytes + stagedBytes
+            std::size_t uploadedBytes = 0; // This Frame
+            std::uint64_t frames = 0;
+            std::uint64_t stallFrames = 0;
+            std::uint64_t reads = 0;
+            std::uint64_t bytesRead = 0;
+            std::uint64_t bytesUploaded = 0;
+            std::uint64_t evictions = 0;
+            std::uint64_t cancelled = 0;   // Reads Finished After the Camera Moved Away
+            std::uint64_t failures = 0;    // Short Reads or Hash Mismatches; Those Chunks Stay Out
+            double readSeconds = 0.0;      // Summed Over Reads, Which Overlap
+        };
+
+        // Implement Custom Constructor and Destructor
+         WorldStreamer(ThreadPool & pool, Settings const & settings = Settings());
+        ~WorldStreamer(); // Waits for Reads in Flight
+
+        // Public Member Functions
+        bool open(std::string const & filename);
+        void update(glm::vec3 const & camera);
+        std::size_t draw(GLuint shader, Frustum const * frustum = nullptr); // Returns Chunks Drawn
+        void finish(); // Waits for Reads in Flight Without Uploading Them
+        std::size_t chunks() const { return mChunks.size(); }
+        Bounds const & bounds(std::size_t chunk) const { return mChunks[chunk].bounds; }
+        Mesh * mesh(std::size_t chunk) const; // Null Unless Drawable
+        int level(std::size_t chunk) const;   // Finest Texture Level on the GPU; -1 If None
+        Settings const & settings() const { return mSettings; }
+        Telemetry const & telemetry() const { return mTelemetry; }
+
+        // Lay Out Chunks for Streaming; Meshes Keep Their Simplified Levels
+        static bool write(std::string const & filename, std::vector<ChunkData> const & chunks);
+        static const std::uint32_t Version = 1;
+
+    private:
+
+        // Disable Copying and Assignment
+        WorldStreamer(WorldStreamer const &) = delete;
+        WorldStreamer & operator=(WorldStreamer const &) = delete;
+
+        // One Texture Level as Stored on Disk
+        struct Level
+        {
+            std::uint64_t offset;
+            std::uint64_t hash;
+            std::uint32_t width;
+            std::uint32_t height;
+            std::uint32_t size;
+        };
+
+        struct Chunk
+        {
+            Bounds bounds;
+            std::uint64_t offset;   // Geometry, Then Levels Coarsest First
+            std::uint64_t hash;
+            std::uint32_t size;     // Geometry Bytes
+            std::uint32_t vertexCount, indexCount, lodIndexCount, lodCount;
+            BlockFormat format;
+            int channels;
+            std::vector<Level> levels;
+
+            std::unique_ptr<Mesh> mesh;
+            GLuint texture = 0;
+            int finest = 0;         // Finest Level Uploaded; levels.size() When None
+            std::size_t bytes = 0;  // On the GPU
+            std::uint64_t wanted = 0; // Last Frame Within prefetchDistance
+            float distance = 0.0f;
+            int desired = 0;
+            bool busy = false;      // Read in Flight or Staged
+            bool failed = false;
+        };
+
+        // One Read and What Is Left of Uploading It
+        struct Result
+        {
+            std::size_t chunk;
+            bool geometry;          // Whether the Read Starts With the Geometry
+            int first, last;        // Levels [first, last)
+            std::uint64_t offset;
+            std::vector<unsigned char> data;
+            bool valid;
+            double seconds;
+            int next;               // Next Level to Upload; Counts Down From last - 1
+        };
+
+        // Private Member Functions
+        std::size_t range(Chunk const & chunk, bool geometry, int first, int last, std::uint64_t & begin) const;
+        void request(std::size_t chunk, bool geometry, int first, int last, std::size_t bytes);
+        void read(Result & result) const;
+        bool reserve(std::size_t bytes, std::size_t chunk);
+        std::size_t step(Result const & result) const; // Bytes of Its Next Upload
+        void upload(Result & result);
+        void evict(std::size_t chunk);
+        void close();
+        bool drawable(Chunk const & chunk) const;
+
+        // Private Member Containers
+        std::vector<Chunk> mChunks;
+        std::vector<std::unique_ptr<Result>> mCompleted; // Guarded by mMutex
+        std::vector<std::unique_ptr<Result>> mStaged;
+
+        // Private Member Variables
+        ThreadPool & mPool;
+        JobSystem::Counter mReads;
+        Settings mSettings;
+        Telemetry mTelemetry;
+        std::mutex mMutex;
+        std::string mFilename;
+        std::uint64_t mFrame;
+        int mFile;
+
+    };
+};
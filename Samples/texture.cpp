@@ -0,0 +1,152 @@
+// Local Headers
+#include "texture.hpp"
+
+// Standard Headers
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    namespace
+    {
+        // Default Backend Issuing Real OpenGL Calls
+        class OpenGLBackend : public TextureCache::Backend
+        {
+        public:
+            GLuint create(Image const & image) { return AssetLoader::create(image); }
+            void destroy(GLuint texture) { glDeleteTextures(1, & texture); }
+        };
+
+        // Full Mip Chain Footprint; Compressed Images Already Carry Every Level
+        std::size_t footprint(Image const & image)
+        {
+            if (!image.compressed.levels.empty()) return image.compressed.data.size();
+            std::size_t bytes = 0;
+            std::size_t width = image.width, height = image.height;
+            for (;;)
+            {   bytes += width * height * image.channels;
+                if (width == 1 && height == 1) break;
+                width  = width  > 1 ? width  / 2 : 1;
+                height = height > 1 ? height / 2 : 1;
+            }   return bytes;
+        }
+    }
+
+    Texture::~Texture() { mCache.release(*this); }
+
+    TextureCache::TextureCache(std::unique_ptr<Backend> backend)
+        : mBackend(backend ? std::move(backend) : std::unique_ptr<Backend>(new OpenGLBackend))
+    {
+        mStatistics.hits     = 0;
+        mStatistics.misses   = 0;
+        mStatistics.textures = 0;
+        mStatistics.bytes    = 0;
+    }
+
+    TextureCache & TextureCache::instance()
+    {
+        static TextureCache cache;
+        return cache;
+    }
+
+    std::string TextureCache::canonical(std::string const & filename)
+    {
+        // Resolve Through the Filesystem When Possible
+#ifdef _WIN32
+        char buffer[_MAX_PATH];
+        if (_fullpath(buffer, filename.c_str(), _MAX_PATH)) return buffer;
+#else
+        char buffer[PATH_MAX];
+        if (realpath(filename.c_str(), buffer)) return buffer;
+#endif
+        // Otherwise Collapse Separators, "." and ".." Lexically
+        std::vector<std::string> parts;
+        std::string part;
+        for (std::size_t i = 0; i <= filename.size(); i++)
+        {
+            char c = i < filename.size() ? filename[i] : '/';
+            if (c != '/' && c != '\\') { part += c; continue; }
+                 if (part == "..") { if (!parts.empty() && parts.back() != "..") parts.pop_back();
+                                     else parts.push_back(part); }
+            else if (!part.empty() && part != ".") parts.push_back(part);
+            part.clear();
+        }
+
+        std::string path = (!filename.empty() && filename[0] == '/') ? "/" : "";
+        for (std::size_t i = 0; i < parts.size(); i++)
+            path += (i > 0 ? "/" : "") + parts[i];
+        return path;
+    }
+
+    std::shared_ptr<Texture> TextureCache::acquire(std::string const & filename, AssetLoader & loader)
+    {
+        return acquire(filename, [& loader](std::string const & path, AssetLoader::Callback callback)
+        {   loader.request(path, callback);
+        }, & loader);
+    }
+
+    std::shared_ptr<Texture> TextureCache::acquire(std::string const & filename, Request const & request,
+                                                   void const * queue)
+    {
+        std::string path = canonical(filename);
+        std::shared_ptr<Texture> texture;
+        {   std::lock_guard<std::mutex> lock(mMutex);
+            auto it = mTextures.find(path);
+            if (it != mTextures.end() && (texture = it->second.lock()))
+            {   mStatistics.hits++;
+                auto & queues = texture->mQueues;
+                if (texture->mUploaded || (queue && std::find(queues.begin(), queues.end(), queue) != queues.end()))
+                    return texture;
+            }
+            else
+            {   // Register Before Decoding So Later Requests Share This Texture
+                texture = std::shared_ptr<Texture>(new Texture(*this, path));
+                mTextures[path] = texture;
+                mStatistics.misses++;
+                mStatistics.textures++;
+            }   if (queue) texture->mQueues.push_back(queue);
+        }
+
+        // Upload on the GL Thread, Unless Every User Let Go in the Meantime
+        request(path, upload(texture));
+        return texture;
+    }
+
+    AssetLoader::Callback TextureCache::upload(std::weak_ptr<Texture> pending)
+    {
+        return [this, pending](Image const & image)
+        {
+            auto texture = pending.lock();
+            if (!texture) return;
+            {   // Only the First of Several Requests for a Texture Uploads It
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (texture->mUploaded) return;
+                texture->mUploaded = true;
+                texture->mQueues.clear();
+            }
+            texture->mHandle = mBackend->create(image);
+            texture->mBytes  = footprint(image);
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStatistics.bytes += texture->mBytes;
+        };
+    }
+
+    TextureCache::Statistics TextureCache::statistics() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mStatistics;
+    }
+
+    void TextureCache::release(Texture & texture)
+    {
+        {   std::lock_guard<std::mutex> lock(mMutex);
+            auto it = mTextures.find(texture.mFilename);
+            if (it != mTextures.end() && it->second.expired()) mTextures.erase(it);
+            mStatistics.textures--;
+            mStatistics.bytes -= texture.mBytes;
+        }   if (texture.mHandle) mBackend->destroy(texture.mHandle);
+    }
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+// Local Headers
+#include "loader.hpp"
+
+// System Headers
+#include <glad/glad.h>
+
+// Standard Headers
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Forward Declarations
+    class TextureCache;
+
+    // Shared Texture; the GL Object Is Released With the Last Reference
+    class Texture
+    {
+    public:
+
+        // Implement Destructor
+        ~Texture();
+
+        // Public Member Functions
+        GLuint get() const { return mHandle; }
+        std::size_t bytes() const { return mBytes; }
+        std::string const & filename() const { return mFilename; }
+
+    private:
+
+        // Only the Cache Creates Textures
+        friend class TextureCache;
+        Texture(TextureCache & cache, std::string const & filename)
+            : mCache(cache), mFilename(filename), mHandle(0), mBytes(0), mUploaded(false) {}
+
+        // Disable Copying and Assignment
+        Texture(Texture const &) = delete;
+        Texture & operator=(Texture const &) = delete;
+
+        // Private Member Variables
+        TextureCache & mCache;
+        std::string mFilename;
+        GLuint mHandle;
+        std::size_t mBytes;
+        bool mUploaded;                  // Guarded by the Cache's Mutex, Like mQueues
+        std::vector<void const *> mQueues; // Requests Waiting to Upload It
+
+    };
+
+    // Process-Wide Texture Cache Keyed by Canonical Path
+    //
+    // Each distinct image is decoded and uploaded once, no matter how many
+    // submeshes reference it. The cache only holds weak references, so a
+    // texture is destroyed as soon as the last mesh using it goes away; drop
+    // the final reference on the GL thread. A hit on a texture still waiting
+    // for an upload from another queue requests it on this one too, so a
+    // texture is ready once the loader given to acquire() has finished,
+    // whichever queue uploads it first. GL calls go through a Backend,
+    // which lets the bookkeeping run without a context, and decodes go
+    // through a Request, which an AssetLoader provides by default.
+    class TextureCache
+    {
+    public:
+
+        // Creates and Destroys GPU Textures on Behalf of the Cache
+        class Backend
+        {
+        public:
+            virtual ~Backend() {}
+            virtual GLuint create(Image const & image) = 0;
+            virtual void destroy(GLuint texture) = 0;
+        };
+
+        // Queues a Decode of path and Calls Back With the Image on the GL Thread
+        typedef std::function<void(std::string const & path, AssetLoader::Callback callback)> Request;
+
+        // Counters Since Construction; Textures and Bytes Are Current Values
+        struct Statistics
+        {
+            std::size_t hits;
+            std::size_t misses;
+            std::size_t textures;
+            std::size_t bytes;
+        };
+
+        // Implement Custom Constructor; Defaults to the OpenGL Backend
+        TextureCache(std::unique_ptr<Backend> backend = std::unique_ptr<Backend>());
+
+        // Public Member Functions
+        std::shared_ptr<Texture> acquire(std::string const & filename, AssetLoader & loader);
+        std::shared_ptr<Texture> acquire(std::string const & filename, Request const & request,
+                                         void const * queue = nullptr); // Identifies Where request Goes
+        Statistics statistics() const;
+        static TextureCache & instance();
+        static std::string canonical(std::string const & filename);
+
+    private:
+
+        // Disable Copying and Assignment
+        TextureCache(TextureCache const &) = delete;
+        TextureCache & operator=(TextureCache const &) = delete;
+
+        // Private Member Functions
+        friend class Texture;
+        void release(Texture & texture);
+        AssetLoader::Callback upload(std::weak_ptr<Texture> pending);
+
+        // Private Member Containers
+        std::map<std::string, std::weak_ptr<Texture>> mTextures;
+
+        // Private Member Variables
+        std::unique_ptr<Backend> mBackend;
+        mutable std::mutex mMutex;
+        Statistics mStatistics;
+
+    };
+};
@@ -0,0 +1,95 @@
+// Local Headers
+#include "uniform.hpp"
+
+// Standard Headers
+#include <cstdio>
+#include <cstring>
+
+// Define Namespace
+namespace Mirage
+{
+    bool UniformTable::insert(std::string const & name, GLint location)
+    {
+        auto hash = uniform(name.c_str());
+        auto it = mEntries.find(hash);
+        if (it != mEntries.end() && it->second.name != name)
+        {   fprintf(stderr, "Uniform Hash Collision: %s %s\n", name.c_str(), it->second.name.c_str());
+            return false;
+        }
+
+        Entry entry = { location, name };
+        mEntries[hash] = entry;
+        return true;
+    }
+
+    GLint UniformTable::find(std::uint32_t hash) const
+    {
+        mLookups++;
+        auto it = mEntries.find(hash);
+        return it == mEntries.end() ? -1 : it->second.location;
+    }
+
+    UniformRing::UniformRing(std::size_t size, unsigned int frames)
+        : mFences(frames > 0 ? frames : 1, nullptr)
+        , mSize(size)
+        , mFrame(0)
+        , mMapped(nullptr)
+    {
+        // Every Slot Must Start on a Valid glBindBufferRange Offset
+        GLint alignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, & alignment);
+        mStride = (size + alignment - 1) / alignment * alignment;
+
+        glGenBuffers(1, & mBuffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, mBuffer);
+        GLsizeiptr bytes = mStride * mFences.size();
+        if (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage)
+        {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_UNIFORM_BUFFER, bytes, nullptr, flags);
+            mMapped = static_cast<unsigned char *>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, bytes, flags));
+        }
+        if (!mMapped) glBufferData(GL_UNIFORM_BUFFER, bytes, nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        mStaging.resize(mSize);
+    }
+
+    UniformRing::~UniformRing()
+    {
+        for (auto fence : mFences) if (fence) glDeleteSync(fence);
+        if (mMapped)
+        {   glBindBuffer(GL_UNIFORM_BUFFER, mBuffer);
+            glUnmapBuffer(GL_UNIFORM_BUFFER);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        }   glDeleteBuffers(1, & mBuffer);
+    }
+
+    void * UniformRing::data() { return mStaging.data(); }
+
+    void UniformRing::bind(GLuint binding)
+    {
+        // Never Read Back From Write-Combined Memory; Publish the Shadow Copy
+        GLintptr offset = mFrame * mStride;
+        if (mMapped) std::memcpy(mMapped + offset, mStaging.data(), mSize);
+        else
+        {   glBindBuffer(GL_UNIFORM_BUFFER, mBuffer);
+            glBufferSubData(GL_UNIFORM_BUFFER, offset, mSize, mStaging.data());
+        }   glBindBufferRange(GL_UNIFORM_BUFFER, binding, mBuffer, offset, mSize);
+    }
+
+    void UniformRing::advance()
+    {
+        // Fence the Slot Just Submitted, Then Wait Only If the Next One Is Still in Flight
+        if (mFences[mFrame]) glDeleteSync(mFences[mFrame]);
+        mFences[mFrame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        mFrame = (mFrame + 1) % mFences.size();
+        if (GLsync fence = mFences[mFrame])
+        {
+            GLenum status = glClientWaitSync(fence, 0, 0);
+            while (status == GL_TIMEOUT_EXPIRED)
+                status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            glDeleteSync(fence);
+            mFences[mFrame] = nullptr;
+        }
+    }
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+// Local Headers
+#include "hash.hpp"
+
+// System Headers
+#include <glad/glad.h>
+
+// Standard Headers
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Define Namespace
+namespace Mirage
+{
+    // Hashed Uniform Name, Usable in Constant Expressions; Same Hash as Glitter's Shader::Hash
+    //
+    //     static constexpr auto Model = Mirage::uniform("model");
+    //     shader.bind(shader.location(Model), matrix);
+    constexpr std::uint32_t uniform(char const * name) { return HashName(name); }
+
+    // Reflected Name-to-Location Table; Lookups Never Allocate
+    class UniformTable
+    {
+    public:
+
+        // Implement Default Constructor
+        UniformTable() : mLookups(0) {}
+
+        // Public Member Functions
+        void clear() { mEntries.clear(); }
+        bool insert(std::string const & name, GLint location);
+        GLint find(std::uint32_t hash) const;
+        GLint find(char const * name) const { return find(uniform(name)); }
+        std::size_t size() const { return mEntries.size(); }
+        std::size_t lookups() const { return mLookups; }
+
+    private:
+
+        // Private Member Containers
+        struct Entry { GLint location; std::string name; };
+        std::unordered_map<std::uint32_t, Entry> mEntries;
+
+        // Private Member Variables
+        mutable std::size_t mLookups;
+
+    };
+
+    // Ring of Per-Frame Slots in One Uniform Buffer
+    //
+    // Writes go to a CPU shadow copy which bind() publishes into the current
+    // slot. With OpenGL 4.4 or ARB_buffer_storage the buffer is persistently
+    // and coherently mapped, so publishing is a plain memcpy; older contexts
+    // fall back to glBufferSubData. Each slot is fenced when the frame
+    // advances and only waited on when the ring wraps around.
+    class UniformRing
+    {
+    public:
+
+        // Implement Custom Constructor and Destructor
+         UniformRing(std::size_t size, unsigned int frames = 3);
+        ~UniformRing();
+
+        // Public Member Functions
+        void * data();
+        void bind(GLuint binding);
+        void advance();
+        bool persistent() const { return mMapped != nullptr; }
+
+    private:
+
+        // Disable Copying and Assignment
+        UniformRing(UniformRing const &) = delete;
+        UniformRing & operator=(UniformRing const &) = delete;
+
+        // Private Member Containers
+        std::vector<unsigned char> mStaging;
+        std::vector<GLsync> mFences;
+
+        // Private Member Variables
+        GLuint mBuffer;
+        std::size_t mSize;
+        std::size_t mStride;
+        unsigned int mFrame;
+        unsigned char * mMapped;
+
+    };
+
+    // Typed View of a Uniform Ring; T Must Follow std140 Layout Rules
+    template<typename T> class UniformBuffer
+    {
+    public:
+
+        // Implement Custom Constructor
+        UniformBuffer(unsigned int frames = 3) : mRing(sizeof(T), frames) {}
+
+        // Public Member Functions
+        T & operator*()  { return *static_cast<T *>(mRing.data()); }
+        T * operator->() { return  static_cast<T *>(mRing.data()); }
+        void bind(GLuint binding) { mRing.bind(binding); }
+        void advance() { mRing.advance(); }
+
+    private:
+
+        // Private Member Variables
+        UniformRing mRing;
+
+    };
+};